@@ -1,4 +1,5 @@
 #include "../../ForwardShadowVertex.hlsl"
+#include "../../PackedBoxVertex.hlsl"
 
 cbuffer Transform
 {
@@ -7,10 +8,9 @@ cbuffer Transform
 
 struct VSInput
 {
-    float3 position   : POSITION;
-    float3 normal     : NORMAL;
-    float2 texCoord   : TEXCOORD;
-    float4 brightness : BRIGHTNESS;
+    uint4  positionNormal : POSITION;
+    int2   texCoord       : TEXCOORD;
+    float4 brightness     : BRIGHTNESS;
 	
     nointerpolation uint texIndex : TEXINDEX;
 };
@@ -29,13 +29,13 @@ struct VSOutput
 VSOutput main(VSInput input)
 {
     VSOutput output = (VSOutput)0;
-    float4 position = float4(input.position, 1);
+    float4 position = unpackWorldPosition(input.positionNormal);
     
     output.position       = mul(position, VP);
-    output.normal         = input.normal;
-    output.texCoord       = input.texCoord;
+    output.normal         = unpackNormal(input.positionNormal);
+    output.texCoord       = float2(input.texCoord);
     output.texIndex       = input.texIndex;
-    output.brightness     = input.brightness;
+    output.brightness     = unpackBrightness(input.brightness);
     
     SHADOW_VERTEX_SHADER_COMPUTE_IMPL(output, position)
     
@@ -1,3 +1,5 @@
+#include "../../PackedBoxVertex.hlsl"
+
 cbuffer Transform
 {
     float4x4 VP;
@@ -5,8 +7,8 @@ cbuffer Transform
 
 struct VSInput
 {
-    float3 position : POSITION;
-    float2 texCoord : TEXCOORD;
+    uint4 positionNormal : POSITION;
+    int2  texCoord       : TEXCOORD;
     nointerpolation uint texIndex : TEXINDEX;
 };
 
@@ -20,8 +22,8 @@ struct VSOutput
 VSOutput main(VSInput input)
 {
     VSOutput output = (VSOutput)0;
-    output.position = mul(float4(input.position, 1), VP);
-    output.texCoord = input.texCoord;
+    output.position = mul(unpackWorldPosition(input.positionNormal), VP);
+    output.texCoord = float2(input.texCoord);
     output.texIndex = input.texIndex;
     return output;
 }
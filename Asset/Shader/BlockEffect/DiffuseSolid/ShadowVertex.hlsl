@@ -1,3 +1,5 @@
+#include "../../PackedBoxVertex.hlsl"
+
 cbuffer Transform
 {
     float4x4 VP;
@@ -5,7 +7,7 @@ cbuffer Transform
 
 struct VSInput
 {
-    float3 position : POSITION;
+    uint4 positionNormal : POSITION;
 };
 
 struct VSOutput
@@ -16,6 +18,6 @@ struct VSOutput
 VSOutput main(VSInput input)
 {
     VSOutput output = (VSOutput)0;
-    output.position = mul(float4(input.position, 1), VP);
+    output.position = mul(unpackWorldPosition(input.positionNormal), VP);
     return output;
 }
@@ -0,0 +1,29 @@
+cbuffer Section
+{
+    float3 SectionOrigin;
+    float  _sectionPad;
+};
+
+static const float PACKED_POSITION_SCALE = 1.0 / 256;
+
+static const float3 PACKED_NORMALS[6] =
+{
+    float3(+1, 0, 0), float3(-1, 0, 0),
+    float3(0, +1, 0), float3(0, -1, 0),
+    float3(0, 0, +1), float3(0, 0, -1)
+};
+
+float4 unpackWorldPosition(uint4 packedPositionNormal)
+{
+    return float4(SectionOrigin + PACKED_POSITION_SCALE * float3(packedPositionNormal.xyz), 1);
+}
+
+float3 unpackNormal(uint4 packedPositionNormal)
+{
+    return PACKED_NORMALS[packedPositionNormal.w];
+}
+
+float4 unpackBrightness(float4 packedBrightness)
+{
+    return packedBrightness * packedBrightness;
+}
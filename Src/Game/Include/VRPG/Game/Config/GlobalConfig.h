@@ -18,6 +18,19 @@ struct ShadowMapConfig
 
     float distance = 60;
 
+    float farCasterMargin = 16; // far SM的阴影投射者在光源空间中按外扩此距离的范围挑选，范围仍覆盖far SM时跨帧复用
+
+    void Load(const libconfig::Setting &setting);
+
+    void Print();
+};
+
+struct BlockUpdaterConfig
+{
+    int threadCount = 2; // 并行执行方块更新的额外线程数，为0时只在逻辑线程上执行
+
+    float timeBudget = 4; // 每个world tick中执行方块更新的时间预算，单位为毫秒
+
     void Load(const libconfig::Setting &setting);
 
     void Print();
@@ -29,9 +42,18 @@ struct ChunkManagerConfig
     int loadDistance   = 3;
     int unloadDistance = 5;
 
+    int simulationDistance = 2; // 在此距离内的区块执行方块更新，应小于loadDistance
+
+    int fullDetailDistance = 2; // 在此距离内的区块使用原精度的section model
+    int halfDetailDistance = 2; // 在此距离内的区块使用2倍降采样的section model，更远处使用4倍降采样
+
     int backgroundPoolSize    = 20;
     int backgroundThreadCount = 1;
 
+    bool enableGreedyMeshing = false; // 是否合并共面的diffuse box面片
+
+    int sectionModelCacheSize = 1024; // 按内容哈希缓存的section model数量，为0时禁用
+
     void Load(const libconfig::Setting &setting);
 
     void Print();
@@ -104,6 +126,17 @@ struct MiscConfig
     void Print();
 };
 
+struct NavigationConfig
+{
+    int threadCount      = 1;    // 执行寻路查询的后台线程数
+    int maxSearchRegions = 4096; // 一次查询在抽象图上至多展开的区域数
+    int snapshotBudget   = 256;  // 每个world tick中至多生成的阻挡快照数
+
+    void Load(const libconfig::Setting &setting);
+
+    void Print();
+};
+
 class GlobalConfig
 {
 public:
@@ -112,8 +145,10 @@ public:
 
     void LoadFromFile(const char *configFilename);
 
+    const BlockUpdaterConfig &BLOCK_UPDATER;
     const ChunkManagerConfig &CHUNK_MANAGER;
     const MiscConfig         &MISC;
+    const NavigationConfig   &NAVIGATION;
     const PlayerConfig       &PLAYER;
     const ShadowMapConfig    &SHADOW_MAP;
     const WindowConfig       &WINDOW;
@@ -122,8 +157,10 @@ public:
 
 private:
 
+    BlockUpdaterConfig blockUpdater_;
     ChunkManagerConfig chunkManager_;
     MiscConfig         misc_;
+    NavigationConfig   navigation_;
     PlayerConfig       player_;
     ShadowMapConfig    shadowMap_;
     WindowConfig       window_;
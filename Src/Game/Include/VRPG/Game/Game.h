@@ -6,8 +6,10 @@
 #include <VRPG/Game/Misc/CascadeShadowMapping.h>
 #include <VRPG/Game/Misc/ChosenWireframe.h>
 #include <VRPG/Game/Misc/Crosshair.h>
+#include <VRPG/Game/Navigation/NavigationService.h>
+#include <VRPG/Game/Physics/EntityPhysics.h>
 #include <VRPG/Game/Player/Player.h>
-#include <VRPG/Game/World/BlockUpdater/BlockUpdater.h>
+#include <VRPG/Game/World/BlockUpdater/LiquidUpdater.h>
 #include <VRPG/Game/World/Chunk/ChunkManager.h>
 #include <VRPG/Game/World/Chunk/ChunkRenderer.h>
 
@@ -58,7 +60,16 @@ private:
     std::unique_ptr<ChunkRenderer> chunkRenderer_;
     std::unique_ptr<ChunkManager>  chunkManager_;
 
+    // 上次生成渲染队列时摄像机所在的section，摄像机进入新的section时需要重新计算可见集合
+    std::optional<Vec3i> lastCameraSection_;
+
     std::unique_ptr<BlockUpdaterManager> blockUpdaterManager_;
+    LiquidUpdater                       *liquidUpdater_ = nullptr;
+
+    std::unique_ptr<EntityPhysics> entityPhysics_;
+
+    std::unique_ptr<NavigationService> navigationService_;
+    BlockChangeSubscriberHandle        navigationSubscriber_ = 0;
 
     std::unique_ptr<ChosenWireframeRenderer> chosenBlockWireframeRenderer_;
     std::optional<Vec3i>                     chosenBlockPosition_;
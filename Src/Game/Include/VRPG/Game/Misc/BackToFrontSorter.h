@@ -0,0 +1,122 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include <VRPG/Game/Common.h>
+
+VRPG_GAME_BEGIN
+
+/**
+ * @brief 距离量化的精度，即每个方块长度对应的键值数量
+ *
+ * 16位的键可以表示的最大距离为65535 / BACK_TO_FRONT_SORT_KEY_SCALE个方块，更远的元素会被视为等距
+ */
+constexpr float BACK_TO_FRONT_SORT_KEY_SCALE = 32;
+
+/**
+ * @brief 将到观察点距离的平方量化为排序键，越远的元素键值越小
+ */
+inline uint16_t BackToFrontSortKey(float distanceSquare) noexcept
+{
+    float quantized = (std::min)(std::sqrt(distanceSquare) * BACK_TO_FRONT_SORT_KEY_SCALE, 65535.0f);
+    return uint16_t(65535 - uint16_t(quantized));
+}
+
+/**
+ * @brief 按量化后的距离由远到近对元素进行稳定排序
+ *
+ * keys[i]是items[i]的排序键（见BackToFrontSortKey），排序时两者一同移动。
+ * 临时缓冲区在多次排序之间复用，预热后不再分配内存
+ */
+template<typename T>
+class BackToFrontSorter
+{
+    std::vector<T> tempItems_;
+    std::vector<uint16_t> tempKeys_;
+
+    void RadixPass(std::vector<T> &srcItems, std::vector<uint16_t> &srcKeys,
+                   std::vector<T> &dstItems, std::vector<uint16_t> &dstKeys, int shift)
+    {
+        size_t offsets[256] = {};
+        for(uint16_t key : srcKeys)
+        {
+            ++offsets[(key >> shift) & 0xff];
+        }
+
+        size_t sum = 0;
+        for(auto &offset : offsets)
+        {
+            size_t count = offset;
+            offset = sum;
+            sum += count;
+        }
+
+        for(size_t i = 0; i < srcKeys.size(); ++i)
+        {
+            size_t dst = offsets[(srcKeys[i] >> shift) & 0xff]++;
+            dstItems[dst] = std::move(srcItems[i]);
+            dstKeys[dst] = srcKeys[i];
+        }
+    }
+
+public:
+
+    /**
+     * @brief 两趟8位基数排序
+     */
+    void RadixSort(std::vector<T> &items, std::vector<uint16_t> &keys)
+    {
+        assert(items.size() == keys.size());
+
+        tempItems_.resize(items.size());
+        tempKeys_.resize(keys.size());
+
+        RadixPass(items, keys, tempItems_, tempKeys_, 0);
+        RadixPass(tempItems_, tempKeys_, items, keys, 8);
+    }
+
+    /**
+     * @brief 对接近有序的序列进行插入排序
+     *
+     * 元素移动次数超过maxMoveCount时放弃并返回false，此时序列仍是原序列的一个排列，可以继续交给RadixSort
+     */
+    bool InsertionSort(std::vector<T> &items, std::vector<uint16_t> &keys, size_t maxMoveCount)
+    {
+        assert(items.size() == keys.size());
+
+        size_t moveCount = 0;
+        for(size_t i = 1; i < keys.size(); ++i)
+        {
+            if(keys[i - 1] <= keys[i])
+            {
+                continue;
+            }
+
+            T item = std::move(items[i]);
+            uint16_t key = keys[i];
+
+            size_t j = i;
+            while(j > 0 && keys[j - 1] > key)
+            {
+                items[j] = std::move(items[j - 1]);
+                keys[j] = keys[j - 1];
+                --j;
+                ++moveCount;
+            }
+
+            items[j] = std::move(item);
+            keys[j] = key;
+
+            if(moveCount > maxMoveCount)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+VRPG_GAME_END
@@ -0,0 +1,52 @@
+﻿#pragma once
+
+#include <cassert>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include <VRPG/Game/Common.h>
+
+VRPG_GAME_BEGIN
+
+/**
+ * @brief 返回mask中最低的被置位的位的下标，要求mask != 0
+ */
+inline int FindLowestSetBit(uint64_t mask) noexcept
+{
+    assert(mask);
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return int(index);
+#else
+    return __builtin_ctzll(mask);
+#endif
+}
+
+/**
+ * @brief 对mask中每个被置位的位，按从低到高的顺序调用func(index)
+ */
+template<typename Func>
+void ForEachSetBit(uint64_t mask, Func &&func)
+{
+    while(mask)
+    {
+        func(FindLowestSetBit(mask));
+        mask &= mask - 1;
+    }
+}
+
+/**
+ * @brief 构造[low, high]位均为1、其余位为0的掩码，要求0 <= low <= high < 64
+ */
+inline uint64_t MakeBitRangeMask(int low, int high) noexcept
+{
+    assert(0 <= low && low <= high && high < 64);
+    uint64_t highMask = high == 63 ? ~uint64_t(0) : (uint64_t(1) << (high + 1)) - 1;
+    return highMask & ~((uint64_t(1) << low) - 1);
+}
+
+VRPG_GAME_END
@@ -1,5 +1,8 @@
 ﻿#pragma once
 
+#include <algorithm>
+#include <iterator>
+
 #include <VRPG/Game/World/Block/BlockBrightness.h>
 #include <VRPG/Game/World/Block/BlockDescription.h>
 
@@ -36,6 +39,13 @@ inline void GenerateBoxFaceDynamic(Direction normalDirection, Vec3 position[4])
  */
 inline void GenerateBoxFaceiDynamic(Direction normalDirection, Vec3i position[4]) noexcept;
 
+/**
+ * @brief 取得box型方块上面片ABCD划分为两个三角形时的顶点下标（0, 1, 2, 3分别对应A, B, C, D）
+ *
+ * 沿亮度之和较大的对角线划分，使单个暗角的影响局限在一个三角形内，插值后的光照不会出现各向异性的条纹
+ */
+inline const int *BoxFaceQuadIndices(const Vec4 &lhtA, const Vec4 &lhtB, const Vec4 &lhtC, const Vec4 &lhtD) noexcept;
+
 /**
  * @brief 计算box型的方块的顶点亮度
  *
@@ -45,6 +55,74 @@ inline void GenerateBoxFaceiDynamic(Direction normalDirection, Vec3i position[4]
  */
 inline Vec4 BoxVertexBrightness(const BlockNeighborhood blocks, Direction vertexNormal, const Vec3 &localVertexPosition) noexcept;
 
+/**
+ * @brief box型方块上某个顶点的亮度采样位置
+ *
+ * 各字段均为BlockNeighborhood::Offset的返回值。
+ * 顶点亮度由法线方向上与顶点相邻的四个方块给出，当两个侧向方块均完全遮光时忽略对角方块
+ */
+struct BoxVertexLightSamples
+{
+    int centre = 0;
+    int side0  = 0;
+    int side1  = 0;
+    int corner = 0;
+    float brightnessRatio = 1;
+};
+
+/**
+ * @brief 求box型方块上某个顶点的亮度采样位置
+ *
+ * @param vertexNormal        顶点法线
+ * @param localVertexPosition 顶点位置
+ */
+inline BoxVertexLightSamples BakeBoxVertexLightSamples(Direction vertexNormal, const Vec3 &localVertexPosition) noexcept;
+
+/**
+ * @brief 按预先求得的采样位置计算box型方块的顶点亮度
+ */
+inline Vec4 BoxVertexBrightness(const BlockNeighborhood blocks, const BoxVertexLightSamples &samples) noexcept;
+
+/**
+ * @brief 某个朝向下box型方块的一个面的预计算数据
+ */
+struct BoxFaceTemplate
+{
+    Direction rotatedNormal = PositiveX;     // 旋转后的法线方向
+    int       neighborOffset = 0;            // 法线方向上的相邻方块，为BlockNeighborhood::Offset的返回值
+    Vec3      normal;                        // 旋转后的法线
+    Vec3      position[4];                   // 旋转后的顶点位置
+    Vec2      texCoord[4];                   // 顶点纹理坐标
+    BoxVertexLightSamples lightSamples[4];   // 顶点亮度采样位置
+};
+
+/**
+ * @brief 所有合法朝向下box型方块六个面的预计算数据
+ *
+ * 这些数据仅与方块朝向和面的方向有关，所有box型方块共用一份
+ */
+class BoxFaceTemplateTable : public Base::Singleton<BoxFaceTemplateTable>
+{
+public:
+
+    BoxFaceTemplateTable();
+
+    /**
+     * @brief 取得朝向为orientation的方块上，旋转前法线为originNormal的面的预计算数据
+     */
+    const BoxFaceTemplate &GetTemplate(BlockOrientation orientation, Direction originNormal) const noexcept
+    {
+        return templates_[rawToIndex_[orientation.GetRawValue()] * 6 + int(originNormal)];
+    }
+
+private:
+
+    static BoxFaceTemplate BakeTemplate(BlockOrientation orientation, Direction originNormal) noexcept;
+
+    uint8_t rawToIndex_[BlockOrientation::RAW_VALUE_COUNT];
+    std::vector<BoxFaceTemplate> templates_;
+};
+
 template<>
 inline void GenerateBoxFace<PositiveX>(Vec3 vertices[4]) noexcept
 {
@@ -161,6 +239,15 @@ inline const Vec2 BOX_FACE_TEXCOORD[] =
     { 1, 1 }
 };
 
+inline const int *BoxFaceQuadIndices(const Vec4 &lhtA, const Vec4 &lhtB, const Vec4 &lhtC, const Vec4 &lhtD) noexcept
+{
+    static const int SPLIT_ALONG_AC[6] = { 0, 1, 2, 0, 2, 3 };
+    static const int SPLIT_ALONG_BD[6] = { 0, 1, 3, 1, 2, 3 };
+
+    auto sum = [](const Vec4 &v) { return v.x + v.y + v.z + v.w; };
+    return sum(lhtA) + sum(lhtC) >= sum(lhtB) + sum(lhtD) ? SPLIT_ALONG_AC : SPLIT_ALONG_BD;
+}
+
 inline void GenerateBoxFaceDynamic(Direction normalDirection, Vec3 position[4]) noexcept
 {
     switch(normalDirection)
@@ -187,7 +274,7 @@ inline void GenerateBoxFaceiDynamic(Direction normalDirection, Vec3i position[4]
     }
 }
 
-inline Vec4 BoxVertexBrightness(const BlockNeighborhood blocks, Direction vertexNormal, const Vec3 &localVertexPosition) noexcept
+inline BoxVertexLightSamples BakeBoxVertexLightSamples(Direction vertexNormal, const Vec3 &localVertexPosition) noexcept
 {
     struct FaceInfo
     {
@@ -211,31 +298,95 @@ inline Vec4 BoxVertexBrightness(const BlockNeighborhood blocks, Direction vertex
     int sideOffset0 = localVertexPosition[sideAxis0] > 0 ? 1 : -1;
     int sideOffset1 = localVertexPosition[sideAxis1] > 0 ? 1 : -1;
 
-    Vec3i i0, i1, i2;
+    Vec3i i0, i1, i2, i3;
     i0[normalAxis] = faceIndex, i0[sideAxis0] = 1, i0[sideAxis1] = 1;
     i1[normalAxis] = faceIndex, i1[sideAxis0] = 1 + sideOffset0, i1[sideAxis1] = 1;
     i2[normalAxis] = faceIndex, i2[sideAxis0] = 1, i2[sideAxis1] = 1 + sideOffset1;
+    i3[normalAxis] = faceIndex, i3[sideAxis0] = 1 + sideOffset0, i3[sideAxis1] = 1 + sideOffset1;
+
+    BoxVertexLightSamples ret;
+    ret.centre = BlockNeighborhood::Offset(i0.x, i0.y, i0.z);
+    ret.side0  = BlockNeighborhood::Offset(i1.x, i1.y, i1.z);
+    ret.side1  = BlockNeighborhood::Offset(i2.x, i2.y, i2.z);
+    ret.corner = BlockNeighborhood::Offset(i3.x, i3.y, i3.z);
+    ret.brightnessRatio = vertexNormal == PositiveY ? 1 : SIDE_VERTEX_BRIGHTNESS_RATIO;
+    return ret;
+}
+
+inline Vec4 BoxVertexBrightness(const BlockNeighborhood blocks, const BoxVertexLightSamples &samples) noexcept
+{
+    auto &blockDescMgr = BlockDescManager::GetInstance();
+
+    const CompactBlockInstance &centre = blocks.GetByOffset(samples.centre);
+    const CompactBlockInstance &side0  = blocks.GetByOffset(samples.side0);
+    const CompactBlockInstance &side1  = blocks.GetByOffset(samples.side1);
+
+    if(blockDescMgr.IsFullOpaque(side0.id) &&
+       blockDescMgr.IsFullOpaque(side1.id))
+    {
+        return samples.brightnessRatio * ComputeVertexBrightness(
+            centre.brightness, side0.brightness, side1.brightness);
+    }
+
+    return samples.brightnessRatio * ComputeVertexBrightness(
+        centre.brightness, side0.brightness, side1.brightness,
+        blocks.GetByOffset(samples.corner).brightness);
+}
 
-    float brightnessRatio = vertexNormal == PositiveY ? 1 : SIDE_VERTEX_BRIGHTNESS_RATIO;
+inline Vec4 BoxVertexBrightness(const BlockNeighborhood blocks, Direction vertexNormal, const Vec3 &localVertexPosition) noexcept
+{
+    return BoxVertexBrightness(blocks, BakeBoxVertexLightSamples(vertexNormal, localVertexPosition));
+}
 
-    if(blocks[i1.x][i1.y][i1.z].desc->IsFullOpaque() && blocks[i2.x][i2.y][i2.z].desc->IsFullOpaque())
+inline BoxFaceTemplateTable::BoxFaceTemplateTable()
+{
+    // 未旋转的朝向位于下标0处，非法的朝向编码也映射到此处
+
+    std::fill(std::begin(rawToIndex_), std::end(rawToIndex_), uint8_t(0));
+
+    auto addOrientation = [&](BlockOrientation orientation)
     {
-        return brightnessRatio * ComputeVertexBrightness(
-            blocks[i0.x][i0.y][i0.z].brightness,
-            blocks[i1.x][i1.y][i1.z].brightness,
-            blocks[i2.x][i2.y][i2.z].brightness);
+        rawToIndex_[orientation.GetRawValue()] = uint8_t(templates_.size() / 6);
+        for(int i = 0; i < 6; ++i)
+        {
+            templates_.push_back(BakeTemplate(orientation, Direction(i)));
+        }
+    };
+
+    const BlockOrientation identity;
+    addOrientation(identity);
+
+    for(int x = 0; x < 6; ++x)
+    {
+        for(int y = 0; y < 6; ++y)
+        {
+            const BlockOrientation orientation{ Direction(x), Direction(y) };
+            if(x / 2 != y / 2 && orientation.GetRawValue() != identity.GetRawValue())
+            {
+                addOrientation(orientation);
+            }
+        }
     }
+}
+
+inline BoxFaceTemplate BoxFaceTemplateTable::BakeTemplate(BlockOrientation orientation, Direction originNormal) noexcept
+{
+    BoxFaceTemplate ret;
+    ret.rotatedNormal = orientation.OriginToRotated(originNormal);
+
+    Vec3i neighborIndex = Vec3i(1) + DirectionToVectori(ret.rotatedNormal);
+    ret.neighborOffset = BlockNeighborhood::Offset(neighborIndex.x, neighborIndex.y, neighborIndex.z);
 
-    Vec3i i3;
-    i3[normalAxis] = faceIndex;
-    i3[sideAxis0] = 1 + sideOffset0;
-    i3[sideAxis1] = 1 + sideOffset1;
+    GenerateBoxFaceDynamic(originNormal, ret.position);
+    for(int i = 0; i < 4; ++i)
+    {
+        ret.position[i]     = RotateLocalPosition(orientation, ret.position[i]);
+        ret.texCoord[i]     = BOX_FACE_TEXCOORD[i];
+        ret.lightSamples[i] = BakeBoxVertexLightSamples(ret.rotatedNormal, ret.position[i]);
+    }
+    ret.normal = cross(ret.position[1] - ret.position[0], ret.position[2] - ret.position[1]).normalize();
 
-    return brightnessRatio * ComputeVertexBrightness(
-        blocks[i0.x][i0.y][i0.z].brightness,
-        blocks[i1.x][i1.y][i1.z].brightness,
-        blocks[i2.x][i2.y][i2.z].brightness,
-        blocks[i3.x][i3.y][i3.z].brightness);
+    return ret;
 }
 
 VRPG_GAME_END
@@ -1,5 +1,7 @@
 ﻿#pragma once
 
+#include <vector>
+
 #include <VRPG/Game/Common.h>
 
 VRPG_GAME_BEGIN
@@ -10,22 +12,73 @@ struct CullingBoundingBox
     Vec3 high;
 };
 
-class FrustumCuller
+/**
+ * @brief 以struct-of-arrays形式存储的一组包围盒，供FrustumCuller批量剔除
+ *
+ * 各数组的末尾总是额外保留BATCH_SIZE个元素，批量测试时可以从任意位置一次读取一整批包围盒而不越界
+ */
+class CullingBoundingBoxArray
 {
-    Vec4 cullingFaces_[5];
+public:
+
+    static constexpr size_t BATCH_SIZE = 4;
+
+    CullingBoundingBoxArray()
+    {
+        Clear();
+    }
+
+    void Clear()
+    {
+        size_ = 0;
+        for(auto arr : { &lowX, &lowY, &lowZ, &highX, &highY, &highZ })
+        {
+            arr->assign(BATCH_SIZE, 0.0f);
+        }
+    }
+
+    void Add(const CullingBoundingBox &bbox)
+    {
+        lowX [size_] = bbox.low.x;
+        lowY [size_] = bbox.low.y;
+        lowZ [size_] = bbox.low.z;
+        highX[size_] = bbox.high.x;
+        highY[size_] = bbox.high.y;
+        highZ[size_] = bbox.high.z;
+        ++size_;
 
-    static bool IsNegativeForAllVertices(const Vec4 &f, const CullingBoundingBox &bbox) noexcept
+        for(auto arr : { &lowX, &lowY, &lowZ, &highX, &highY, &highZ })
+        {
+            arr->resize(size_ + BATCH_SIZE, 0.0f);
+        }
+    }
+
+    size_t GetSize() const noexcept
     {
-        return dot(f, { bbox.low.x,  bbox.low.y,  bbox.low.z,  1 }) < -0.01f &&
-               dot(f, { bbox.low.x,  bbox.low.y,  bbox.high.z, 1 }) < -0.01f &&
-               dot(f, { bbox.low.x,  bbox.high.y, bbox.low.z,  1 }) < -0.01f &&
-               dot(f, { bbox.low.x,  bbox.high.y, bbox.high.z, 1 }) < -0.01f &&
-               dot(f, { bbox.high.x, bbox.low.y,  bbox.low.z,  1 }) < -0.01f &&
-               dot(f, { bbox.high.x, bbox.low.y,  bbox.high.z, 1 }) < -0.01f &&
-               dot(f, { bbox.high.x, bbox.high.y, bbox.low.z,  1 }) < -0.01f &&
-               dot(f, { bbox.high.x, bbox.high.y, bbox.high.z, 1 }) < -0.01f;
+        return size_;
     }
 
+    std::vector<float> lowX, lowY, lowZ;
+    std::vector<float> highX, highY, highZ;
+
+private:
+
+    size_t size_ = 0;
+};
+
+/**
+ * @brief 视锥剔除
+ *
+ * 对每个裁剪面只需测试包围盒在其法线方向上最远的顶点（p-vertex），该顶点位于裁剪面外侧时整个包围盒不可见
+ */
+class FrustumCuller
+{
+    static constexpr int CULLING_FACE_COUNT = 5;
+
+    static constexpr float CULLING_EPSILON = 0.01f;
+
+    Vec4 cullingFaces_[CULLING_FACE_COUNT];
+
 public:
 
     FrustumCuller() = default;
@@ -41,12 +94,28 @@ public:
 
     bool IsVisible(const CullingBoundingBox &bbox) const noexcept
     {
-        return !IsNegativeForAllVertices(cullingFaces_[0], bbox) &&
-               !IsNegativeForAllVertices(cullingFaces_[1], bbox) &&
-               !IsNegativeForAllVertices(cullingFaces_[2], bbox) &&
-               !IsNegativeForAllVertices(cullingFaces_[3], bbox) &&
-               !IsNegativeForAllVertices(cullingFaces_[4], bbox);
+        for(auto &f : cullingFaces_)
+        {
+            Vec4 p = {
+                f.x > 0 ? bbox.high.x : bbox.low.x,
+                f.y > 0 ? bbox.high.y : bbox.low.y,
+                f.z > 0 ? bbox.high.z : bbox.low.z,
+                1
+            };
+            if(dot(f, p) < -CULLING_EPSILON)
+            {
+                return false;
+            }
+        }
+        return true;
     }
+
+    /**
+     * @brief 批量测试boxes中下标位于[begin, end)内的包围盒，将其中可见者在位集合visibility中的对应位置1
+     *
+     * visibility的第i位位于visibility[i / 64]的第i % 64位，调用方需保证其容量足够
+     */
+    void ComputeVisibility(const CullingBoundingBoxArray &boxes, size_t begin, size_t end, uint64_t *visibility) const noexcept;
 };
 
 VRPG_GAME_END
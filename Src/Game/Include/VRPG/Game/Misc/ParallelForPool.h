@@ -0,0 +1,61 @@
+﻿#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <VRPG/Game/Common.h>
+
+VRPG_GAME_BEGIN
+
+/**
+ * @brief 常驻的fork-join线程池，用于将一批互相独立的任务分摊到多个核心上
+ *
+ * 调用Run的线程本身也参与执行任务，因此workerCount为0时所有任务都在调用线程上串行执行
+ */
+class ParallelForPool : public agz::misc::uncopyable_t
+{
+public:
+
+    explicit ParallelForPool(int workerCount);
+
+    ~ParallelForPool();
+
+    int GetWorkerCount() const noexcept;
+
+    /**
+     * @brief 对[0, taskCount)中的每个i调用一次func(i)，阻塞直至所有调用完成
+     *
+     * 不同的i可能在不同线程上以任意顺序执行，func不应抛出异常
+     */
+    void Run(int taskCount, const std::function<void(int)> &func);
+
+private:
+
+    void RunTasks();
+
+    void WorkerFunc();
+
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable startCond_;
+    std::condition_variable finishCond_;
+
+    const std::function<void(int)> *func_;
+    int taskCount_;
+    std::atomic<int> nextTask_;
+
+    // 尚未完成本批任务的worker数量
+    int runningWorkerCount_;
+
+    // 每发布一批任务加一，worker据此判断是否有新任务
+    uint64_t generation_;
+
+    bool exit_;
+};
+
+VRPG_GAME_END
@@ -36,6 +36,16 @@ struct ForwardRenderParams
 struct ShadowRenderParams
 {
     Mat4 shadowViewProj;
+
+    int cascadeIndex = 0;
+
+    /**
+     * @brief 用于在CPU端挑选阴影投射者的视锥，需覆盖shadowViewProj在光源空间中的xy范围
+     *
+     * casterCullingRevision为0时每次都重新挑选；否则只要其值不变，上次的挑选结果就可以继续使用
+     */
+    Mat4 casterCullingViewProj;
+    uint64_t casterCullingRevision = 0;
 };
 
 VRPG_GAME_END
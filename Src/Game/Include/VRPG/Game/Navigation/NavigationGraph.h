@@ -0,0 +1,161 @@
+﻿#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <VRPG/Game/World/Chunk/Common.h>
+
+/*
+体素寻路图
+    寻路以格子为单位，格子c可站立当且仅当c下方的方块阻挡移动，且从c开始向上的clearanceHeight个方块都不阻挡移动，
+    方块是否阻挡移动由其在BlockDescManager中烘焙的碰撞AABB表决定
+
+    移动只在水平的4个方向上进行，可以同时上升至多maxStepHeight格或下落至多maxDropHeight格
+
+    每个section中的可站立格子按section内可双向通行的移动划分为若干区域（region），
+    同一区域中的任意两个格子在该区域内互相可达。离开区域的移动称为入口（portal），
+    区域和入口组成分层A*使用的抽象图
+*/
+
+VRPG_GAME_BEGIN
+
+/**
+ * @brief 寻路个体的尺寸与移动能力
+ */
+struct NavigationAgentParams
+{
+    int clearanceHeight = 2; // 个体占据的格子高度
+    int maxStepHeight   = 1; // 一次移动能上升的最大高度
+    int maxDropHeight   = 3; // 一次移动能下落的最大高度
+
+    /**
+     * @brief 由轴对齐圆柱体的尺寸计算寻路参数
+     *
+     * 寻路在格子上进行，半径不超过0.5的个体都可以通过一格宽的通道
+     */
+    static NavigationAgentParams FromCylinder(float radius, float height) noexcept;
+};
+
+/**
+ * @brief section中各方块是否阻挡移动的只读快照
+ */
+class SectionSolidity
+{
+public:
+
+    bool IsSolid(const Vec3i &blockInSection) const noexcept
+    {
+        return (columns_[blockInSection.x][blockInSection.z] >> blockInSection.y) & 1;
+    }
+
+    /**
+     * @brief 由区块中的数据生成指定section的快照
+     *
+     * 借助区块的碰撞位掩码只检查具有碰撞体积的方块，不含任何阻挡方块的section共享同一个快照对象
+     */
+    static std::shared_ptr<const SectionSolidity> Build(const Chunk &chunk, const Vec3i &sectionInChunk);
+
+private:
+
+    // columns_[x][z]的第y位表示section中(x, y, z)处的方块是否阻挡移动
+    uint16_t columns_[CHUNK_SECTION_SIZE_X][CHUNK_SECTION_SIZE_Z] = { { 0 } };
+};
+
+/**
+ * @brief 单个section的寻路图
+ *
+ * 只存储可站立的格子，按列排序，建立后不再改变，可以被多个线程同时读取
+ */
+class SectionNavGraph
+{
+public:
+
+    static constexpr int NO_REGION = -1;
+
+    /**
+     * @brief 从区域中的格子fromCell移动到区域外的格子toCell
+     */
+    struct Portal
+    {
+        Vec3i fromCell;
+        Vec3i toCell;
+    };
+
+    struct Region
+    {
+        Vec3 centre;                 // 区域中所有格子的平均位置
+        std::vector<Portal> portals; // 所有离开该区域的移动
+    };
+
+    /**
+     * @param neighborhood 以globalSection为中心的3x3x3个section的快照，下标为(dx + 1) * 9 + (dy + 1) * 3 + (dz + 1)，
+     *                     nullptr表示不含阻挡方块
+     */
+    SectionNavGraph(
+        const Vec3i &globalSection, const NavigationAgentParams &agent, const SectionSolidity *const neighborhood[27]);
+
+    const Vec3i &GetGlobalSection() const noexcept { return globalSection_; }
+
+    const std::vector<Region> &GetRegions() const noexcept { return regions_; }
+
+    /**
+     * @brief 取得全局坐标为globalCell的格子所在的区域，该格子不可站立时返回NO_REGION
+     *
+     * globalCell须位于此section中
+     */
+    int GetRegion(const Vec3i &globalCell) const noexcept;
+
+    /**
+     * @brief 对可站立的格子globalCell出发的每个移动调用func(toCell, deltaY)
+     *
+     * toCell可能位于其他section中
+     */
+    template<typename Func>
+    void ForEachMove(const Vec3i &globalCell, Func &&func) const;
+
+private:
+
+    // 每个方向的移动用3位编码，0表示不可移动，否则为deltaY + MOVE_DELTA_Y_BIAS
+    static constexpr int MOVE_BITS = 3;
+    static constexpr int MOVE_DELTA_Y_BIAS = 4;
+
+    static constexpr int MOVE_DIRECTION_COUNT = 4;
+    static constexpr int MOVE_DIRECTION_X[MOVE_DIRECTION_COUNT] = { 1, -1, 0,  0 };
+    static constexpr int MOVE_DIRECTION_Z[MOVE_DIRECTION_COUNT] = { 0,  0, 1, -1 };
+
+    /**
+     * @brief 在[columnBegin_[column], columnBegin_[column + 1])中查找格子，不存在时返回-1
+     */
+    int FindCell(const Vec3i &cellInSection) const noexcept;
+
+    Vec3i globalSection_;
+    Vec3i lowCell_;
+
+    // 可站立格子的列表，按(x, z)所在的列排序，列内按y排序
+    uint16_t columnBegin_[CHUNK_SECTION_SIZE_X * CHUNK_SECTION_SIZE_Z + 1];
+    std::vector<uint8_t>  cellY_;
+    std::vector<uint16_t> cellMoves_;
+    std::vector<uint16_t> cellRegions_;
+
+    std::vector<Region> regions_;
+};
+
+template<typename Func>
+void SectionNavGraph::ForEachMove(const Vec3i &globalCell, Func &&func) const
+{
+    int cellIndex = FindCell(globalCell - lowCell_);
+    assert(cellIndex >= 0);
+
+    uint16_t moves = cellMoves_[cellIndex];
+    for(int direction = 0; direction < MOVE_DIRECTION_COUNT; ++direction)
+    {
+        int code = (moves >> (direction * MOVE_BITS)) & ((1 << MOVE_BITS) - 1);
+        if(code)
+        {
+            int deltaY = code - MOVE_DELTA_Y_BIAS;
+            func(globalCell + Vec3i(MOVE_DIRECTION_X[direction], deltaY, MOVE_DIRECTION_Z[direction]), deltaY);
+        }
+    }
+}
+
+VRPG_GAME_END
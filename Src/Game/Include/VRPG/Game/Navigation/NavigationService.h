@@ -0,0 +1,206 @@
+﻿#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <VRPG/Game/Misc/ScalarHistory.h>
+#include <VRPG/Game/Navigation/NavigationGraph.h>
+
+/*
+分层寻路服务
+    寻路查询在后台线程上异步执行，结果通过TakeFinishedQueries取回
+
+    后台线程不访问ChunkManager。逻辑线程在Update中为查询所需的section生成只读的阻挡快照（SectionSolidity），
+    后台线程由快照生成section寻路图（SectionNavGraph）并缓存。
+    查询所需的快照尚不存在时，查询被挂起，待逻辑线程生成快照后重新执行
+
+    每次查询先在区域和入口组成的抽象图上用A*求出一条区域走廊，再在走廊内的格子上用A*求出具体路径
+
+    方块改变时只丢弃可能受其影响的section寻路图，见OnBlockChanged
+*/
+
+VRPG_GAME_BEGIN
+
+using PathQueryID = uint64_t;
+
+struct NavigationServiceParams
+{
+    NavigationAgentParams agent;
+
+    int threadCount      = 1;    // 执行寻路查询的后台线程数
+    int maxSearchRegions = 4096; // 一次查询在抽象图上至多展开的区域数
+    int snapshotBudget   = 256;  // 每次Update至多为等待中的查询生成的阻挡快照数
+};
+
+struct PathQueryResult
+{
+    enum class Status
+    {
+        Found,           // 找到了路径
+        NoPath,          // 搜索范围内不存在路径
+        InvalidEndpoint, // 起点或终点不可站立
+        Unloaded,        // 搜索涉及尚未加载的区块
+    };
+
+    PathQueryID id = 0;
+    Status status  = Status::NoPath;
+
+    // 从起点到终点依次经过的格子，包含起点和终点
+    std::vector<Vec3i> path;
+};
+
+class NavigationService : public agz::misc::uncopyable_t
+{
+public:
+
+    struct Statistics
+    {
+        size_t pendingQueryCount   = 0; // 尚未完成的查询数，包括被挂起的查询
+        size_t cachedGraphCount    = 0;
+        size_t cachedSnapshotCount = 0;
+        float  meanQueryTime       = 0; // 最近完成的查询的平均执行时间，单位为毫秒，不含挂起等待的时间
+    };
+
+    NavigationService(const NavigationServiceParams &params, const ChunkManager *chunkManager);
+
+    ~NavigationService();
+
+    /**
+     * @brief 添加一个从startCell到goalCell的寻路查询，返回其id
+     *
+     * 可以在任意线程上调用
+     */
+    PathQueryID AddQuery(const Vec3i &startCell, const Vec3i &goalCell);
+
+    /**
+     * @brief 取得所有已完成的查询的结果
+     *
+     * 调用后内部的结果列表被清空
+     */
+    std::vector<PathQueryResult> TakeFinishedQueries();
+
+    /**
+     * @brief 通知globalBlock处的方块发生了改变，只能在逻辑线程上调用
+     *
+     * 格子的寻路数据只取决于其水平相邻一格、垂直方向上有限范围内的方块，因此只有覆盖这一范围的section寻路图会在下次Update中被丢弃
+     */
+    void OnBlockChanged(const Vec3i &globalBlock);
+
+    /**
+     * @brief 由逻辑线程定期调用
+     *
+     * 重新生成被改变的快照，为被挂起的查询生成快照，并丢弃失效或所在区块已被卸载的快照和寻路图
+     */
+    void Update();
+
+    Statistics GetStatistics() const;
+
+private:
+
+    struct Query
+    {
+        PathQueryID id;
+        Vec3i startCell;
+        Vec3i goalCell;
+    };
+
+    struct ParkedQuery
+    {
+        Query query;
+        std::vector<Vec3i> missingSections;
+    };
+
+    // 抽象图中的节点，即某个section中的某个区域
+    struct RegionKey
+    {
+        Vec3i section;
+        int region;
+
+        bool operator==(const RegionKey &rhs) const noexcept
+        {
+            return section == rhs.section && region == rhs.region;
+        }
+    };
+
+    struct RegionKeyHash
+    {
+        size_t operator()(const RegionKey &key) const noexcept
+        {
+            return agz::misc::hash(key.section.x, key.section.y, key.section.z, key.region);
+        }
+    };
+
+    // 一次查询中用到的寻路图，查询期间持有其所有权，因此不受其他线程丢弃寻路图的影响
+    using GraphMap = std::unordered_map<Vec3i, std::shared_ptr<const SectionNavGraph>>;
+
+    // 每隔这么多次Update检查一次快照和寻路图所在的区块是否已被卸载
+    static constexpr int PRUNE_INTERVAL = 20;
+
+    void WorkerFunc();
+
+    /**
+     * @brief 执行一次查询，缺少阻挡快照且尚未找到路径时返回false，此时缺少的快照被记入missingSections
+     */
+    bool ExecuteQuery(const Query &query, PathQueryResult &result, std::unordered_set<Vec3i> &missingSections);
+
+    /**
+     * @brief 取得section寻路图，必要时由快照生成之
+     *
+     * 位于世界之外或缺少快照时返回nullptr，后者会将缺少的快照记入missingSections
+     */
+    const SectionNavGraph *GetGraph(const Vec3i &globalSection, GraphMap &graphs, std::unordered_set<Vec3i> &missingSections);
+
+    /**
+     * @brief 在抽象图上搜索从start到goal的区域走廊
+     */
+    bool FindCorridor(
+        const RegionKey &start, const RegionKey &goal, const Vec3i &goalCell,
+        GraphMap &graphs, std::unordered_set<Vec3i> &missingSections, std::vector<RegionKey> &corridor);
+
+    /**
+     * @brief 在走廊中的格子上搜索从startCell到goalCell的路径
+     */
+    static bool FindPathInCorridor(
+        const Vec3i &startCell, const Vec3i &goalCell,
+        const std::vector<RegionKey> &corridor, const GraphMap &graphs, std::vector<Vec3i> &path);
+
+    /**
+     * @brief 由区块数据生成指定section的快照，所在区块未加载时返回nullptr
+     */
+    std::shared_ptr<const SectionSolidity> BuildSnapshot(const Vec3i &globalSection) const;
+
+    NavigationServiceParams params_;
+    const ChunkManager *chunkManager_;
+
+    std::vector<std::thread> threads_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable queryCond_;
+    bool exit_;
+
+    // 以下成员由mutex_保护，其中snapshots_只由逻辑线程修改，因此逻辑线程读取它时无需加锁
+
+    PathQueryID nextQueryID_;
+    std::deque<Query> queries_;
+    std::vector<ParkedQuery> parkedQueries_;
+    size_t runningQueryCount_;
+
+    std::unordered_set<Vec3i> requestedSections_;
+    std::unordered_map<Vec3i, std::shared_ptr<const SectionSolidity>> snapshots_;
+    std::unordered_map<Vec3i, std::shared_ptr<const SectionNavGraph>> graphs_;
+
+    std::vector<PathQueryResult> finishedQueries_;
+    ScalarHistory queryTimeHistory_;
+
+    // 以下成员只由逻辑线程访问
+
+    std::unordered_set<Vec3i> dirtySnapshotSections_;
+    std::unordered_set<Vec3i> dirtyGraphSections_;
+    int updateCount_;
+};
+
+VRPG_GAME_END
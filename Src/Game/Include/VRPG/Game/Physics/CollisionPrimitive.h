@@ -17,6 +17,29 @@ namespace Collision
         float height = 1;
     };
 
+    /**
+     * @brief 轴对齐包围盒
+     */
+    struct AABB
+    {
+        Vec3 low;
+        Vec3 high;
+    };
+
+    /**
+     * @brief 一段连续存放的AABB，可用于range-based for
+     */
+    struct AABBSpan
+    {
+        const AABB *first = nullptr;
+        const AABB *last  = nullptr;
+
+        const AABB *begin() const noexcept { return first; }
+        const AABB *end()   const noexcept { return last; }
+
+        bool empty() const noexcept { return first == last; }
+    };
+
     /**
      * @brief 射线段
      */
@@ -40,6 +63,64 @@ namespace Collision
         }
     };
 
+    /**
+     * @brief 轴对齐圆柱体与AABB是否相交
+     */
+    bool HasCollision(const AABB &box, const AACylinder &cylinder) noexcept;
+
+    /**
+     * @brief 解除轴对齐圆柱体移动后与AABB的碰撞
+     *
+     * @param cylinder     移动前的圆柱体，应与box无碰撞
+     * @param newLowCentre 移动后的新圆柱体位置
+     * @param offset       offset[i]表示在第i轴上将移动后的圆柱体移动这么长即可解除碰撞
+     * @return             移动后是否与box发生了碰撞
+     */
+    bool ResolveCollision(const AABB &box, const AACylinder &cylinder, const Vec3 &newLowCentre, float offset[3]) noexcept;
+
+    /**
+     * @brief 计算轴对齐圆柱体沿axis轴移动至多delta的距离时，在与box接触前能移动的距离
+     *
+     * 与ResolveCollision只检查移动后的位置不同，这里考虑整个移动过程，因此移动距离超过box的厚度时也不会穿过box
+     *
+     * @return 移动过程中不与box接触时返回delta；移动前就与box重叠时，返回值可能与delta反号
+     */
+    float SweepAlongAxis(const AABB &box, const AACylinder &cylinder, int axis, float delta) noexcept;
+
+    /**
+     * @brief 计算轴对齐圆柱体移动到newLowCentre的过程中可能接触的方块范围[low, high]
+     *
+     * 范围向外扩展了一点，以包含恰好与圆柱体接触的方块
+     */
+    void GetSweptBlockRange(const AACylinder &cylinder, const Vec3 &newLowCentre, Vec3i &low, Vec3i &high) noexcept;
+
+    /**
+     * @brief 沿某个轴移动轴对齐圆柱体时，逐个加入可能接触的方块，求出遇到方块前实际能移动的距离
+     */
+    class AxisSweep
+    {
+    public:
+
+        AxisSweep(const AACylinder &cylinder, int axis, float delta) noexcept;
+
+        /**
+         * @brief 加入一个方块的碰撞AABB，aabbs位于以blockPosition为原点的坐标系中
+         */
+        void AddBlock(const Vec3 &blockPosition, AABBSpan aabbs) noexcept;
+
+        /**
+         * @brief 取得实际能移动的距离，不会向移动的反方向后退
+         */
+        float GetMovedDistance() const noexcept;
+
+    private:
+
+        AACylinder cylinder_;
+        int axis_;
+        float delta_;
+        float movedDistance_;
+    };
+
 } // namespace Collision
 
 VRPG_GAME_END
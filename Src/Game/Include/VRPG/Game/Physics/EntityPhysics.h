@@ -0,0 +1,165 @@
+﻿#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include <VRPG/Game/Misc/ParallelForPool.h>
+#include <VRPG/Game/Physics/CollisionPrimitive.h>
+#include <VRPG/Game/World/Chunk/ChunkManager.h>
+
+/*
+实体的物理模拟
+
+所有实体都以轴对齐圆柱体表示，其状态以struct-of-arrays的形式存放，每次Update分为两个阶段：
+    收集阶段（串行）：对每个醒着的实体，借助区块的碰撞位掩码，收集其本次移动可能扫过的所有方块的碰撞AABB
+    积分阶段（并行）：各实体只与自己收集到的AABB求交，互不干扰，因此可以被分摊到多个线程上
+
+静止在地面上一段时间的实体会进入睡眠，不再参与收集和积分，直到其速度被外部修改或附近的方块发生改变
+    EntityPhysics订阅ChunkManager的方块改变通知，因此任何途径（SetBlockID、SetBlocks、方块更新等）造成的方块改变都会唤醒附近的实体
+    睡眠中的实体按所在的section分桶，方块改变时只需检查附近的几个桶
+*/
+
+VRPG_GAME_BEGIN
+
+using PhysicsBodyID = uint32_t;
+
+struct EntityPhysicsParams
+{
+    float gravityAccel        = 20; // 重力加速度
+    float gravityMaxSpeed     = 40; // 最大下落速度
+    float groundFrictionAccel = 10; // 位于地面上时的水平阻力加速度
+};
+
+class EntityPhysics : public agz::misc::uncopyable_t
+{
+public:
+
+    /**
+     * @param workerPool 积分阶段使用的线程池，只在Update期间被使用
+     */
+    EntityPhysics(const EntityPhysicsParams &params, ChunkManager *chunkManager, ParallelForPool *workerPool);
+
+    ~EntityPhysics();
+
+    /**
+     * @brief 添加一个实体，返回其id
+     */
+    PhysicsBodyID AddBody(const Collision::AACylinder &cylinder, const Vec3 &velocity = Vec3());
+
+    void RemoveBody(PhysicsBodyID id);
+
+    size_t GetBodyCount() const noexcept;
+
+    Vec3 GetPosition(PhysicsBodyID id) const noexcept;
+
+    Vec3 GetVelocity(PhysicsBodyID id) const noexcept;
+
+    /**
+     * @brief 设置实体的速度，这会唤醒该实体
+     */
+    void SetVelocity(PhysicsBodyID id, const Vec3 &velocity) noexcept;
+
+    bool IsOnGround(PhysicsBodyID id) const noexcept;
+
+    bool IsSleeping(PhysicsBodyID id) const noexcept;
+
+    /**
+     * @brief 唤醒所有可能受globalBlock处方块改变影响的实体
+     *
+     * ChunkManager中的方块改变会自动调用该函数
+     */
+    void WakeBodiesNear(const Vec3i &globalBlock);
+
+    /**
+     * @brief 将所有醒着的实体的状态推进dt时间
+     *
+     * 只读取已加载的区块，移动范围涉及未加载区块的实体在本次Update中保持不动
+     */
+    void Update(float dt);
+
+private:
+
+    // 连续静止这么多次Update后进入睡眠
+    static constexpr int SLEEP_UPDATE_COUNT = 10;
+
+    // 速度分量的绝对值都低于该值时视为静止
+    static constexpr float REST_SPEED = 1e-2f;
+
+    // 碰撞体过大、可能受到相邻section以外的方块影响的睡眠实体都放在这个桶中，每次唤醒时都会被检查
+    static inline const Vec3i LARGE_BODY_BUCKET = Vec3i((std::numeric_limits<int>::min)());
+
+    // 实体在一次Update中需要考虑的方块，aabbs已按方块的orientation旋转
+    struct BlockContact
+    {
+        Vec3 blockPosition;
+        Collision::AABBSpan aabbs;
+    };
+
+    /**
+     * @brief 收集实体本次移动可能接触的方块，返回false表示移动范围涉及未加载的区块
+     */
+    bool GatherContacts(size_t bodyIndex, float dt);
+
+    /**
+     * @brief 在收集到的方块间移动activeBodies_[activeIndex]，只读写该实体自身的状态
+     */
+    void IntegrateBody(size_t activeIndex, float dt) noexcept;
+
+    /**
+     * @brief 计算activeBodies_[activeIndex]沿axis轴移动至多delta的距离时，在遇到方块前实际能移动的距离
+     */
+    float MoveAlongAxis(size_t activeIndex, int axis, float delta) const noexcept;
+
+    /**
+     * @brief globalBlock处的方块改变是否可能影响实体bodyIndex
+     */
+    bool IsAffectedByBlock(size_t bodyIndex, const Vec3i &globalBlock) const noexcept;
+
+    /**
+     * @brief 将刚进入睡眠的实体加入对应的桶
+     */
+    void AddToSleepBucket(size_t bodyIndex);
+
+    /**
+     * @brief 唤醒睡眠中的实体，并将其从桶中移除
+     */
+    void WakeBody(size_t bodyIndex);
+
+    void RemoveBodyAt(size_t bodyIndex);
+
+    EntityPhysicsParams params_;
+    ChunkManager *chunkManager_;
+    ParallelForPool *workerPool_;
+
+    BlockChangeSubscriberHandle blockChangeSubscriber_;
+
+    // 实体状态，以下数组的长度都等于实体数量
+
+    std::vector<Vec3>          positions_;
+    std::vector<Vec3>          velocities_;
+    std::vector<float>         radiuses_;
+    std::vector<float>         heights_;
+    std::vector<uint8_t>       onGround_;
+    std::vector<uint8_t>       sleeping_;
+    std::vector<int>           restUpdateCounts_;
+    std::vector<PhysicsBodyID> bodyIDs_;
+    std::vector<Vec3i>         sleepBuckets_; // 睡眠中的实体所在的桶，醒着的实体的值无意义
+
+    // 本次Update中参与积分的实体，及其在contacts_中的范围
+
+    std::vector<size_t> activeBodies_;
+    std::vector<size_t> contactBegins_;
+    std::vector<size_t> contactEnds_;
+    std::vector<BlockContact> contacts_;
+
+    // 从id到实体下标的映射，被移除的id会被复用
+
+    std::vector<uint32_t> idToIndex_;
+    std::vector<PhysicsBodyID> freeIDs_;
+
+    // 睡眠中的实体，按其lowCentre所在的section分桶
+
+    std::unordered_map<Vec3i, std::vector<PhysicsBodyID>> sleepingBodies_;
+};
+
+VRPG_GAME_END
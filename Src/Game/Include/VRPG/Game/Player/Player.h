@@ -119,6 +119,11 @@ private:
 
     void UpdatePosition(float dt);
 
+    /**
+     * @brief 沿axis轴移动碰撞体至多delta的距离，遇到方块时停在其表面，返回实际移动的距离
+     */
+    float MoveAlongAxis(int axis, float delta);
+
     static bool HasMoving(const UserInput &userInput) noexcept;
 
     enum class State
@@ -12,6 +12,8 @@ public:
 
     BoxBlockCollision(bool enableCollision = true);
 
+    void GetLocalAABBs(std::vector<Collision::AABB> &output) const override;
+
     bool HasCollisionWith(BlockOrientation blockOrientation, const Collision::AACylinder &cylinder) const noexcept override;
 
     bool ResolveCollisionWith(
@@ -11,6 +11,8 @@ class VoidBlockCollision : public BlockCollision
 {
 public:
 
+    bool HasCollisionVolume() const noexcept override { return false; }
+
     bool HasCollisionWith(BlockOrientation blockOrientation, const Collision::AACylinder &cylinder) const noexcept override;
 
     bool ResolveCollisionWith(
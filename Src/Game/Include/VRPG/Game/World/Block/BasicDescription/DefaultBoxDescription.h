@@ -4,11 +4,13 @@
 
 VRPG_GAME_BEGIN
 
+class BoxFaceTemplateTable;
 class DefaultBlockEffect;
 
 class DefaultBlockDescription : public BlockDescription
 {
     std::shared_ptr<const DefaultBlockEffect> effect_;
+    const BoxFaceTemplateTable *faceTemplates_;
 
 public:
 
@@ -5,6 +5,8 @@
 
 VRPG_GAME_BEGIN
 
+class BoxFaceTemplateTable;
+
 class DiffuseHollowBoxDescription : public BlockDescription
 {
 public:
@@ -34,6 +36,11 @@ public:
         const Vec3i &blockPosition,
         const BlockNeighborhood blocks) const override;
 
+    bool HasLODModel() const noexcept override;
+
+    void AddLODBoxFace(
+        ModelBuilderSet &modelBuilders, Direction normal, const Vec3 position[4], const Vec4 &brightness, int cellSize) const override;
+
     const BlockCollision *GetCollision() const noexcept override;
 
 private:
@@ -42,6 +49,7 @@ private:
 
     std::shared_ptr<const DiffuseHollowBlockEffect> effect_;
     int textureIndexInEffect_[6];
+    const BoxFaceTemplateTable *faceTemplates_;
 
     bool isLightSource_;
     BlockBrightness emission_;
@@ -5,6 +5,8 @@
 
 VRPG_GAME_BEGIN
 
+class BoxFaceTemplateTable;
+
 class TransparentBoxDescription : public BlockDescription
 {
 public:
@@ -41,6 +43,7 @@ private:
 
     std::shared_ptr<const TransparentBlockEffect> effect_;
     int textureIndexInEffect_[6];
+    const BoxFaceTemplateTable *faceTemplates_;
 
     BlockBrightness attenuation_;
 };
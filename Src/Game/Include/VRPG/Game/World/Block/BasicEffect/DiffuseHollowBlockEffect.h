@@ -3,7 +3,7 @@
 #include <agz/utility/texture.h>
 
 #include <VRPG/Game/Misc/CascadeShadowMapping.h>
-#include <VRPG/Game/World/Block/BasicEffect/NativePartialSectionModel.h>
+#include <VRPG/Game/World/Block/BasicEffect/GreedyBoxFaceModelBuilder.h>
 #include <VRPG/Game/World/Block/BlockEffect.h>
 
 VRPG_GAME_BEGIN
@@ -26,6 +26,12 @@ class DiffuseHollowBlockEffectCommon
         Mat4 VP;
     };
 
+    struct VS_Section
+    {
+        Vec3 origin;
+        float pad = 0;
+    };
+
     Shader<SS_VS, SS_PS>                  forwardShader_;
     UniformManager<SS_VS, SS_PS>          forwardUniforms_;
     InputLayout                           forwardInputLayout_;
@@ -42,6 +48,8 @@ class DiffuseHollowBlockEffectCommon
     ShaderResourceSlot<SS_PS>          *shadowDiffuseTextureSlot_;
     RasterizerState                     shadowRasterizerState_;
 
+    ConstantBuffer<VS_Section> vsSection_;
+
     void InitializeForward();
 
     void InitializeShadow();
@@ -54,6 +62,8 @@ public:
 
     void SetShadowRenderParams(const ShadowRenderParams &params);
 
+    void SetSectionOrigin(const Vec3 &origin);
+
     void StartForward(ID3D11ShaderResourceView *textureArray);
 
     void EndForward();
@@ -69,16 +79,9 @@ class DiffuseHollowBlockEffect : public BlockEffect
 
 public:
 
-    struct Vertex
-    {
-        Vec3 position;
-        Vec2 texCoord;
-        Vec3 normal;
-        Vec4 brightness;
-        uint32_t texIndex = 0;
-    };
+    using Vertex = PackedBoxVertex;
 
-    using Builder = NativePartialSectionModelBuilder<DiffuseHollowBlockEffect>;
+    using Builder = GreedyBoxFaceModelBuilder<DiffuseHollowBlockEffect>;
 
     const char *GetName() const override;
 
@@ -98,6 +101,11 @@ public:
 
     void SetShadowRenderParams(const ShadowRenderParams &params) const override;
 
+    /**
+     * @brief 设置接下来绘制的section在世界空间中的位置
+     */
+    void SetSectionOrigin(const Vec3 &origin) const;
+
 private:
 
     void Initialize(
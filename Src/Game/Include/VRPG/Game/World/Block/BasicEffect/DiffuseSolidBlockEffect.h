@@ -3,7 +3,7 @@
 #include <agz/utility/texture.h>
 
 #include <VRPG/Game/Misc/CascadeShadowMapping.h>
-#include <VRPG/Game/World/Block/BasicEffect/NativePartialSectionModel.h>
+#include <VRPG/Game/World/Block/BasicEffect/GreedyBoxFaceModelBuilder.h>
 #include <VRPG/Game/World/Block/BlockEffect.h>
 
 VRPG_GAME_BEGIN
@@ -29,6 +29,12 @@ class DiffuseSolidBlockEffectCommon
         Mat4 VP;
     };
 
+    struct VS_Section
+    {
+        Vec3 origin;
+        float pad = 0;
+    };
+
     Shader<SS_VS, SS_PS>                 forwardShader;
     UniformManager<SS_VS, SS_PS>         forwardUniforms;
     InputLayout                          forwardInputLayout;
@@ -44,6 +50,8 @@ class DiffuseSolidBlockEffectCommon
 
     std::unique_ptr<ForwardShadowMapping> forwardShadowMapping;
 
+    ConstantBuffer<VS_Section> vsSection;
+
 public:
 
     DiffuseSolidBlockEffectCommon();
@@ -52,6 +60,8 @@ public:
 
     void SetShadowRenderParams(const ShadowRenderParams &params);
 
+    void SetSectionOrigin(const Vec3 &origin);
+
     void StartForward(ID3D11ShaderResourceView *diffuseTextureArray) const;
 
     void EndForward() const;
@@ -67,16 +77,9 @@ class DiffuseSolidBlockEffect : public BlockEffect
 
 public:
 
-    struct Vertex
-    {
-        Vec3 position;
-        Vec2 texCoord;
-        Vec3 normal;
-        Vec4 brightness;
-        uint32_t texIndex = 0;
-    };
+    using Vertex = PackedBoxVertex;
 
-    using Builder = NativePartialSectionModelBuilder<DiffuseSolidBlockEffect>;
+    using Builder = GreedyBoxFaceModelBuilder<DiffuseSolidBlockEffect>;
 
     const char *GetName() const override;
 
@@ -88,6 +91,11 @@ public:
 
     void SetShadowRenderParams(const ShadowRenderParams &params) const override;
 
+    /**
+     * @brief 设置接下来绘制的section在世界空间中的位置
+     */
+    void SetSectionOrigin(const Vec3 &origin) const;
+
     void StartForward() const override;
 
     void EndForward() const override;
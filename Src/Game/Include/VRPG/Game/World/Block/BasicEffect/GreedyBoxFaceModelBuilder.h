@@ -0,0 +1,459 @@
+﻿#pragma once
+
+#include <algorithm>
+
+#include <VRPG/Game/Misc/BoxModel.h>
+#include <VRPG/Game/World/Block/BasicEffect/PackedBoxVertex.h>
+#include <VRPG/Game/World/Block/BlockEffect.h>
+#include <VRPG/Game/World/Chunk/ChunkModel.h>
+
+VRPG_GAME_BEGIN
+
+/**
+ * @brief 由PackedBoxVertex构成的partial section model
+ *
+ * 顶点坐标相对于section的最小角，绘制前通过Effect::SetSectionOrigin设置section在世界空间中的位置。
+ * 顶点数不超过65536时使用16位index buffer，否则使用32位index buffer
+ */
+template<typename Effect>
+class PackedBoxFacePartialSectionModel : public PartialSectionModel
+{
+public:
+
+    PackedBoxFacePartialSectionModel(
+        const Vec3i &globalSectionPosition, const Effect *effect,
+        VertexBuffer<PackedBoxVertex> vertexBuffer,
+        IndexBuffer<uint16_t> indexBuffer16,
+        IndexBuffer<uint32_t> indexBuffer32) noexcept
+        : PartialSectionModel(globalSectionPosition), effect_(effect),
+          vertexBuffer_(std::move(vertexBuffer)),
+          indexBuffer16_(std::move(indexBuffer16)),
+          indexBuffer32_(std::move(indexBuffer32))
+    {
+        sectionOrigin_ = (globalSectionPosition * Vec3i(CHUNK_SECTION_SIZE_X, CHUNK_SECTION_SIZE_Y, CHUNK_SECTION_SIZE_Z))
+                        .map([](int i) { return float(i); });
+    }
+
+    void Render(const Camera &camera) const override
+    {
+        this->RenderShadow();
+    }
+
+    void RenderShadow() const override
+    {
+        effect_->SetSectionOrigin(sectionOrigin_);
+
+        vertexBuffer_.Bind(0);
+        if(indexBuffer16_.IsAvailable())
+        {
+            indexBuffer16_.Bind();
+            RenderState::DrawIndexed(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, indexBuffer16_.GetIndexCount());
+            indexBuffer16_.Unbind();
+        }
+        else
+        {
+            indexBuffer32_.Bind();
+            RenderState::DrawIndexed(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, indexBuffer32_.GetIndexCount());
+            indexBuffer32_.Unbind();
+        }
+        vertexBuffer_.Unbind(0);
+    }
+
+    const BlockEffect *GetBlockEffect() const noexcept override
+    {
+        return effect_;
+    }
+
+    std::shared_ptr<const PartialSectionModel> CloneAt(const Vec3i &globalSectionPosition) const override
+    {
+        return std::make_shared<PackedBoxFacePartialSectionModel<Effect>>(
+            globalSectionPosition, effect_, vertexBuffer_, indexBuffer16_, indexBuffer32_);
+    }
+
+    size_t GetMemoryUsage() const noexcept override
+    {
+        return vertexBuffer_.GetVertexCount() * sizeof(PackedBoxVertex)
+             + indexBuffer16_.GetIndexCount() * sizeof(uint16_t)
+             + indexBuffer32_.GetIndexCount() * sizeof(uint32_t);
+    }
+
+    size_t GetVertexCount() const noexcept override
+    {
+        return vertexBuffer_.GetVertexCount();
+    }
+
+    size_t GetIndexCount() const noexcept override
+    {
+        return indexBuffer16_.GetIndexCount() + indexBuffer32_.GetIndexCount();
+    }
+
+private:
+
+    static_assert(std::is_base_of_v<BlockEffect, Effect>);
+
+    const Effect                 *effect_;
+    Vec3                          sectionOrigin_;
+    VertexBuffer<PackedBoxVertex> vertexBuffer_;
+    IndexBuffer<uint16_t>         indexBuffer16_;
+    IndexBuffer<uint32_t>         indexBuffer32_;
+};
+
+/**
+ * @brief 支持贪心合并共面box面片的model builder
+ *
+ * 每个面片以4个顶点、2个三角形表示，顶点以PackedBoxVertex格式存储。
+ * 开启合并时，四个顶点亮度相同的面片会被暂存，在Build时将同一平面上相邻、
+ * 且纹理、纹理朝向与亮度均一致的面片合并为一个矩形。
+ * 合并后的纹理坐标会超出[0, 1]，要求effect以wrap寻址模式进行采样。
+ *
+ * Effect需提供SetSectionOrigin(const Vec3&)
+ */
+template<typename Effect>
+class GreedyBoxFaceModelBuilder : public ModelBuilder
+{
+public:
+
+    GreedyBoxFaceModelBuilder(const Vec3i &globalSectionPosition, const Effect *effect, bool enableGreedyMeshing);
+
+    /**
+     * @brief 添加一个box面片
+     *
+     * @param blockPosition 面片所属方块的全局坐标
+     * @param normal        面片在世界空间中的法线方向
+     * @param position      面片四个顶点的世界坐标，其纹理坐标依次为BOX_FACE_TEXCOORD[0, 1, 2, 3]
+     * @param brightness    面片四个顶点的亮度
+     * @param textureIndex  面片所使用的纹理在effect中的下标
+     */
+    void AddBoxFace(
+        const Vec3i &blockPosition, Direction normal,
+        const Vec3 position[4], const Vec4 brightness[4], uint32_t textureIndex);
+
+    /**
+     * @brief 添加一个边长为scale个方块的box面片，用于LOD section model
+     *
+     * 该面片不参与合并，纹理在面片上重复scale次
+     *
+     * @param normal       面片在世界空间中的法线方向
+     * @param position     面片四个顶点的世界坐标，其纹理坐标依次为scale * BOX_FACE_TEXCOORD[0, 1, 2, 3]
+     * @param brightness   面片的亮度
+     * @param textureIndex 面片所使用的纹理在effect中的下标
+     */
+    void AddScaledBoxFace(
+        Direction normal, const Vec3 position[4], const Vec4 &brightness, uint32_t textureIndex, int scale);
+
+    size_t GetVertexCount() const noexcept { return vertices_.size(); }
+
+    void Reset(const Vec3i &globalSectionPosition) override;
+
+    std::shared_ptr<const PartialSectionModel> Build() override;
+
+private:
+
+    struct PendingFace
+    {
+        Vec3i blockPosition;
+        Vec3 position[4];
+        Direction normal;
+        Vec3 texAxisU;
+        Vec3 texAxisV;
+        Vec4 brightness;
+        uint32_t textureIndex;
+    };
+
+    static constexpr int SIZE = CHUNK_SECTION_SIZE_X;
+
+    static_assert(CHUNK_SECTION_SIZE_X == CHUNK_SECTION_SIZE_Y && CHUNK_SECTION_SIZE_X == CHUNK_SECTION_SIZE_Z);
+
+    static int GridIndex(Direction normal, int layer, int u, int v) noexcept
+    {
+        return ((int(normal) * SIZE + layer) * SIZE + u) * SIZE + v;
+    }
+
+    static bool CanMerge(const PendingFace &a, const PendingFace &b) noexcept;
+
+    void AddVertex(
+        const Vec3 &position, Direction normal, const Vec2 &texCoord, const Vec4 &brightness, uint32_t textureIndex);
+
+    void AddIndexedTriangle(VertexIndex indexA, VertexIndex indexB, VertexIndex indexC);
+
+    void AddQuadFace(Direction normal, const Vec3 position[4], const Vec4 brightness[4], uint32_t textureIndex);
+
+    void MergePendingFaces();
+
+    Vec3i globalSectionPosition_;
+    Vec3i sectionBase_;
+    const Effect *effect_;
+    bool enableGreedyMeshing_;
+
+    std::vector<PackedBoxVertex> vertices_;
+    std::vector<VertexIndex>     indices_;
+    std::vector<uint16_t>        indices16_;
+
+    std::vector<PendingFace> pendingFaces_;
+    std::vector<int> faceGrid_;
+};
+
+template<typename Effect>
+GreedyBoxFaceModelBuilder<Effect>::GreedyBoxFaceModelBuilder(
+    const Vec3i &globalSectionPosition, const Effect *effect, bool enableGreedyMeshing)
+    : globalSectionPosition_(globalSectionPosition),
+      sectionBase_(globalSectionPosition * Vec3i(CHUNK_SECTION_SIZE_X, CHUNK_SECTION_SIZE_Y, CHUNK_SECTION_SIZE_Z)),
+      effect_(effect), enableGreedyMeshing_(enableGreedyMeshing)
+{
+
+}
+
+template<typename Effect>
+void GreedyBoxFaceModelBuilder<Effect>::AddBoxFace(
+    const Vec3i &blockPosition, Direction normal,
+    const Vec3 position[4], const Vec4 brightness[4], uint32_t textureIndex)
+{
+    bool isUniform = brightness[0] == brightness[1] &&
+                     brightness[0] == brightness[2] &&
+                     brightness[0] == brightness[3];
+    if(!enableGreedyMeshing_ || !isUniform)
+    {
+        AddQuadFace(normal, position, brightness, textureIndex);
+        return;
+    }
+
+    if(faceGrid_.empty())
+    {
+        faceGrid_.resize(6 * SIZE * SIZE * SIZE, -1);
+    }
+
+    Vec3i local = blockPosition - sectionBase_;
+    int normalAxis = int(normal) / 2;
+    int sideAxis0 = (normalAxis + 1) % 3;
+    int sideAxis1 = (normalAxis + 2) % 3;
+    assert(0 <= local[normalAxis] && local[normalAxis] < SIZE);
+    assert(0 <= local[sideAxis0] && local[sideAxis0] < SIZE);
+    assert(0 <= local[sideAxis1] && local[sideAxis1] < SIZE);
+
+    PendingFace face;
+    face.blockPosition = blockPosition;
+    face.position[0]   = position[0];
+    face.position[1]   = position[1];
+    face.position[2]   = position[2];
+    face.position[3]   = position[3];
+    face.normal        = normal;
+    face.texAxisU      = position[2] - position[1];
+    face.texAxisV      = position[0] - position[1];
+    face.brightness    = brightness[0];
+    face.textureIndex  = textureIndex;
+
+    faceGrid_[GridIndex(normal, local[normalAxis], local[sideAxis0], local[sideAxis1])] = int(pendingFaces_.size());
+    pendingFaces_.push_back(face);
+}
+
+template<typename Effect>
+void GreedyBoxFaceModelBuilder<Effect>::AddScaledBoxFace(
+    Direction normal, const Vec3 position[4], const Vec4 &brightness, uint32_t textureIndex, int scale)
+{
+    VertexIndex vertexCount = VertexIndex(vertices_.size());
+
+    float texScale = float(scale);
+    AddVertex(position[0], normal, texScale * BOX_FACE_TEXCOORD[0], brightness, textureIndex);
+    AddVertex(position[1], normal, texScale * BOX_FACE_TEXCOORD[1], brightness, textureIndex);
+    AddVertex(position[2], normal, texScale * BOX_FACE_TEXCOORD[2], brightness, textureIndex);
+    AddVertex(position[3], normal, texScale * BOX_FACE_TEXCOORD[3], brightness, textureIndex);
+
+    AddIndexedTriangle(vertexCount + 0, vertexCount + 1, vertexCount + 2);
+    AddIndexedTriangle(vertexCount + 0, vertexCount + 2, vertexCount + 3);
+}
+
+template<typename Effect>
+void GreedyBoxFaceModelBuilder<Effect>::Reset(const Vec3i &globalSectionPosition)
+{
+    globalSectionPosition_ = globalSectionPosition;
+    sectionBase_ = globalSectionPosition * Vec3i(CHUNK_SECTION_SIZE_X, CHUNK_SECTION_SIZE_Y, CHUNK_SECTION_SIZE_Z);
+
+    vertices_.clear();
+    indices_.clear();
+
+    // Build会清空faceGrid_中所有被占用的格子，仅在未经Build就被重置时才需要整体清空
+
+    if(!pendingFaces_.empty())
+    {
+        std::fill(faceGrid_.begin(), faceGrid_.end(), -1);
+        pendingFaces_.clear();
+    }
+}
+
+template<typename Effect>
+std::shared_ptr<const PartialSectionModel> GreedyBoxFaceModelBuilder<Effect>::Build()
+{
+    MergePendingFaces();
+
+    if(vertices_.empty() || indices_.empty())
+    {
+        return nullptr;
+    }
+
+    VertexBuffer<PackedBoxVertex> vertexBuffer;
+    vertexBuffer.Initialize(UINT(vertices_.size()), false, vertices_.data());
+
+    IndexBuffer<uint16_t> indexBuffer16;
+    IndexBuffer<uint32_t> indexBuffer32;
+    if(vertices_.size() <= size_t((std::numeric_limits<uint16_t>::max)()) + 1)
+    {
+        indices16_.assign(indices_.begin(), indices_.end());
+        indexBuffer16.Initialize(UINT(indices16_.size()), false, indices16_.data());
+    }
+    else
+    {
+        indexBuffer32.Initialize(UINT(indices_.size()), false, indices_.data());
+    }
+
+    return std::make_shared<PackedBoxFacePartialSectionModel<Effect>>(
+        globalSectionPosition_, effect_, std::move(vertexBuffer), std::move(indexBuffer16), std::move(indexBuffer32));
+}
+
+template<typename Effect>
+bool GreedyBoxFaceModelBuilder<Effect>::CanMerge(const PendingFace &a, const PendingFace &b) noexcept
+{
+    return a.textureIndex == b.textureIndex &&
+           a.texAxisU     == b.texAxisU     &&
+           a.texAxisV     == b.texAxisV     &&
+           a.brightness   == b.brightness;
+}
+
+template<typename Effect>
+void GreedyBoxFaceModelBuilder<Effect>::AddVertex(
+    const Vec3 &position, Direction normal, const Vec2 &texCoord, const Vec4 &brightness, uint32_t textureIndex)
+{
+    Vec3 positionInSection = position - sectionBase_.map([](int i) { return float(i); });
+    vertices_.push_back(PackBoxVertex(positionInSection, normal, texCoord, textureIndex, brightness));
+}
+
+template<typename Effect>
+void GreedyBoxFaceModelBuilder<Effect>::AddIndexedTriangle(VertexIndex indexA, VertexIndex indexB, VertexIndex indexC)
+{
+    indices_.push_back(indexA);
+    indices_.push_back(indexB);
+    indices_.push_back(indexC);
+}
+
+template<typename Effect>
+void GreedyBoxFaceModelBuilder<Effect>::AddQuadFace(
+    Direction normal, const Vec3 position[4], const Vec4 brightness[4], uint32_t textureIndex)
+{
+    VertexIndex vertexCount = VertexIndex(vertices_.size());
+
+    AddVertex(position[0], normal, BOX_FACE_TEXCOORD[0], brightness[0], textureIndex);
+    AddVertex(position[1], normal, BOX_FACE_TEXCOORD[1], brightness[1], textureIndex);
+    AddVertex(position[2], normal, BOX_FACE_TEXCOORD[2], brightness[2], textureIndex);
+    AddVertex(position[3], normal, BOX_FACE_TEXCOORD[3], brightness[3], textureIndex);
+
+    const int *indices = BoxFaceQuadIndices(brightness[0], brightness[1], brightness[2], brightness[3]);
+    AddIndexedTriangle(vertexCount + indices[0], vertexCount + indices[1], vertexCount + indices[2]);
+    AddIndexedTriangle(vertexCount + indices[3], vertexCount + indices[4], vertexCount + indices[5]);
+}
+
+template<typename Effect>
+void GreedyBoxFaceModelBuilder<Effect>::MergePendingFaces()
+{
+    if(pendingFaces_.empty())
+    {
+        return;
+    }
+
+    auto canMergeInto = [&](const PendingFace &first, int gridIndex)
+    {
+        int faceIndex = faceGrid_[gridIndex];
+        return faceIndex >= 0 && CanMerge(first, pendingFaces_[faceIndex]);
+    };
+
+    for(int dir = 0; dir < 6; ++dir)
+    {
+        Direction normal = Direction(dir);
+        int normalAxis = dir / 2;
+        int sideAxis0 = (normalAxis + 1) % 3;
+        int sideAxis1 = (normalAxis + 2) % 3;
+
+        for(int layer = 0; layer < SIZE; ++layer)
+        {
+            for(int u = 0; u < SIZE; ++u)
+            {
+                for(int v = 0; v < SIZE; ++v)
+                {
+                    int firstIndex = faceGrid_[GridIndex(normal, layer, u, v)];
+                    if(firstIndex < 0)
+                    {
+                        continue;
+                    }
+                    const PendingFace &first = pendingFaces_[firstIndex];
+
+                    // 先沿sideAxis1延伸，再沿sideAxis0整行延伸
+
+                    int height = 1;
+                    while(v + height < SIZE && canMergeInto(first, GridIndex(normal, layer, u, v + height)))
+                    {
+                        ++height;
+                    }
+
+                    int width = 1;
+                    while(u + width < SIZE)
+                    {
+                        bool canExtend = true;
+                        for(int dv = 0; dv < height; ++dv)
+                        {
+                            if(!canMergeInto(first, GridIndex(normal, layer, u + width, v + dv)))
+                            {
+                                canExtend = false;
+                                break;
+                            }
+                        }
+                        if(!canExtend)
+                        {
+                            break;
+                        }
+                        ++width;
+                    }
+
+                    for(int du = 0; du < width; ++du)
+                    {
+                        for(int dv = 0; dv < height; ++dv)
+                        {
+                            faceGrid_[GridIndex(normal, layer, u + du, v + dv)] = -1;
+                        }
+                    }
+
+                    // 将首个面片的顶点沿两个切向轴扩展到整个矩形，纹理坐标由顶点到首个面片纹理原点的投影给出
+
+                    Vec3 position[4];
+                    Vec2 texCoord[4];
+                    for(int i = 0; i < 4; ++i)
+                    {
+                        position[i] = first.position[i];
+                        if(position[i][sideAxis0] > first.blockPosition[sideAxis0] + 0.5f)
+                        {
+                            position[i][sideAxis0] += float(width - 1);
+                        }
+                        if(position[i][sideAxis1] > first.blockPosition[sideAxis1] + 0.5f)
+                        {
+                            position[i][sideAxis1] += float(height - 1);
+                        }
+
+                        Vec3 offset = position[i] - first.position[1];
+                        texCoord[i] = Vec2(dot(offset, first.texAxisU), dot(offset, first.texAxisV));
+                    }
+
+                    VertexIndex vertexCount = VertexIndex(vertices_.size());
+
+                    AddVertex(position[0], first.normal, texCoord[0], first.brightness, first.textureIndex);
+                    AddVertex(position[1], first.normal, texCoord[1], first.brightness, first.textureIndex);
+                    AddVertex(position[2], first.normal, texCoord[2], first.brightness, first.textureIndex);
+                    AddVertex(position[3], first.normal, texCoord[3], first.brightness, first.textureIndex);
+
+                    AddIndexedTriangle(vertexCount + 0, vertexCount + 1, vertexCount + 2);
+                    AddIndexedTriangle(vertexCount + 0, vertexCount + 2, vertexCount + 3);
+                }
+            }
+        }
+    }
+
+    pendingFaces_.clear();
+}
+
+VRPG_GAME_END
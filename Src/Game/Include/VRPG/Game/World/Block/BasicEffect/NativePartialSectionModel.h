@@ -42,6 +42,22 @@ public:
         return effect_;
     }
 
+    size_t GetMemoryUsage() const noexcept override
+    {
+        return vertexBuffer_.GetVertexCount() * sizeof(typename Effect::Vertex)
+             + indexBuffer_.GetIndexCount() * sizeof(VertexIndex);
+    }
+
+    size_t GetVertexCount() const noexcept override
+    {
+        return vertexBuffer_.GetVertexCount();
+    }
+
+    size_t GetIndexCount() const noexcept override
+    {
+        return indexBuffer_.GetIndexCount();
+    }
+
 private:
 
     static_assert(std::is_base_of_v<BlockEffect, Effect>);
@@ -70,7 +86,7 @@ public:
         vertices_.push_back(vertex);
     }
 
-    void AddIndexedTriangle(uint16_t indexA, uint16_t indexB, uint16_t indexC)
+    void AddIndexedTriangle(VertexIndex indexA, VertexIndex indexB, VertexIndex indexC)
     {
         indices_.push_back(indexA);
         indices_.push_back(indexB);
@@ -79,6 +95,13 @@ public:
 
     size_t GetVertexCount() const noexcept { return vertices_.size(); }
 
+    void Reset(const Vec3i &globalSectionPosition) override
+    {
+        globalSectionPosition_ = globalSectionPosition;
+        vertices_.clear();
+        indices_.clear();
+    }
+
     std::shared_ptr<const PartialSectionModel> Build() override
     {
         if(vertices_.empty() || indices_.empty())
@@ -0,0 +1,124 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include <VRPG/Game/Common.h>
+
+VRPG_GAME_BEGIN
+
+/**
+ * @brief 压缩后的box面片顶点，共16字节
+ *
+ * position   : 相对于section最小角的定点坐标，单位为1/PACKED_BOX_VERTEX_POSITION_SCALE个方块
+ * normal     : 法线方向，即Direction枚举值，与position共同构成一个R16G16B16A16_UINT属性
+ * texCoord   : 整数纹理坐标，配合wrap寻址实现合并面片上的纹理重复
+ * texIndex   : 纹理在effect的纹理数组中的下标
+ * brightness : 以平方根曲线编码的顶点亮度，在shader中以x * x解码
+ */
+struct PackedBoxVertex
+{
+    uint16_t position[3];
+    uint16_t normal;
+    int8_t   texCoord[2];
+    uint16_t texIndex;
+    uint8_t  brightness[4];
+};
+
+static_assert(sizeof(PackedBoxVertex) == 16);
+
+constexpr float PACKED_BOX_VERTEX_POSITION_SCALE = 256;
+
+/**
+ * @brief PackedBoxVertex解码后的结果
+ */
+struct UnpackedBoxVertex
+{
+    Vec3 position;
+    Direction normal;
+    Vec2 texCoord;
+    uint32_t texIndex;
+    Vec4 brightness;
+};
+
+/**
+ * @brief 将顶点属性编码为PackedBoxVertex
+ *
+ * @param positionInSection 相对于section最小角的位置，应位于[0, 256)^3中
+ * @param texCoord          纹理坐标，应为[-128, 127]中的整数
+ * @param brightness        顶点亮度，应位于[0, 1]^4中
+ */
+inline PackedBoxVertex PackBoxVertex(
+    const Vec3 &positionInSection, Direction normal, const Vec2 &texCoord, uint32_t texIndex, const Vec4 &brightness) noexcept
+{
+    assert(texIndex <= (std::numeric_limits<uint16_t>::max)());
+
+    auto packPosition = [](float x)
+    {
+        float scaled = std::round(x * PACKED_BOX_VERTEX_POSITION_SCALE);
+        assert(0 <= scaled && scaled <= (std::numeric_limits<uint16_t>::max)());
+        return uint16_t(scaled);
+    };
+
+    auto packTexCoord = [](float x)
+    {
+        float rounded = std::round(x);
+        assert(-128 <= rounded && rounded <= 127);
+        return int8_t(rounded);
+    };
+
+    // 在编码值的两个相邻整数中选取解码后更接近原值的一个，
+    // 解码曲线相邻两级之差不超过(1 - (254 / 255)^2) < 2 / 255，因此误差总小于1 / 255
+
+    auto packBrightness = [](float x)
+    {
+        x = (std::clamp)(x, 0.0f, 1.0f);
+        const float low = (std::min)(std::floor(std::sqrt(x) * 255), 254.0f);
+        const float lowError  = std::abs(low * low / (255.0f * 255.0f) - x);
+        const float highError = std::abs((low + 1) * (low + 1) / (255.0f * 255.0f) - x);
+        return uint8_t(lowError <= highError ? low : low + 1);
+    };
+
+    PackedBoxVertex ret;
+    ret.position[0]   = packPosition(positionInSection.x);
+    ret.position[1]   = packPosition(positionInSection.y);
+    ret.position[2]   = packPosition(positionInSection.z);
+    ret.normal        = uint16_t(normal);
+    ret.texCoord[0]   = packTexCoord(texCoord.x);
+    ret.texCoord[1]   = packTexCoord(texCoord.y);
+    ret.texIndex      = uint16_t(texIndex);
+    ret.brightness[0] = packBrightness(brightness.x);
+    ret.brightness[1] = packBrightness(brightness.y);
+    ret.brightness[2] = packBrightness(brightness.z);
+    ret.brightness[3] = packBrightness(brightness.w);
+    return ret;
+}
+
+/**
+ * @brief 解码PackedBoxVertex，与shader中的解码方式一致
+ */
+inline UnpackedBoxVertex UnpackBoxVertex(const PackedBoxVertex &vertex) noexcept
+{
+    auto unpackBrightness = [](uint8_t x)
+    {
+        const float f = x / 255.0f;
+        return f * f;
+    };
+
+    UnpackedBoxVertex ret;
+    ret.position = Vec3(
+        vertex.position[0] / PACKED_BOX_VERTEX_POSITION_SCALE,
+        vertex.position[1] / PACKED_BOX_VERTEX_POSITION_SCALE,
+        vertex.position[2] / PACKED_BOX_VERTEX_POSITION_SCALE);
+    ret.normal     = Direction(vertex.normal);
+    ret.texCoord   = Vec2(float(vertex.texCoord[0]), float(vertex.texCoord[1]));
+    ret.texIndex   = vertex.texIndex;
+    ret.brightness = Vec4(
+        unpackBrightness(vertex.brightness[0]),
+        unpackBrightness(vertex.brightness[1]),
+        unpackBrightness(vertex.brightness[2]),
+        unpackBrightness(vertex.brightness[3]));
+    return ret;
+}
+
+VRPG_GAME_END
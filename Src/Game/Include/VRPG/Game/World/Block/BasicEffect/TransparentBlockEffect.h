@@ -39,6 +39,14 @@ public:
     {
     public:
 
+        /**
+         * @brief 每个面片由两个三角形构成，在index buffer中占据连续的6个下标
+         */
+        static constexpr VertexIndex FACE_INDEX_COUNT = 6;
+
+        /**
+         * @brief 一个面片的排序位置及其在index buffer中的起始下标
+         */
         struct FaceIndexRange
         {
             Vec3 position;
@@ -57,6 +65,8 @@ public:
 
         size_t GetIndexCount() const noexcept { return indices_.size(); }
 
+        void Reset(const Vec3i &globalSectionPosition) override;
+
         std::shared_ptr<const PartialSectionModel> Build() override;
 
     private:
@@ -1,6 +1,8 @@
 ﻿#pragma once
 
 #include <algorithm>
+#include <array>
+#include <cmath>
 
 #include <VRPG/Game/Common.h>
 
@@ -89,12 +91,42 @@ constexpr BlockBrightness BLOCK_BRIGHTNESS_MAX = { 255, 255, 255, 255 };
  */
 constexpr BlockBrightness BLOCK_BRIGHTNESS_SKY = { 0, 0, 0, 20 };
 
+/**
+ * @brief block brightness分量的有效上限，更大的分量值与之显示效果相同
+ */
+constexpr uint8_t BLOCK_BRIGHTNESS_COMPONENT_LIMIT = 20;
+
+/**
+ * @brief block brightness分量到[0, 1]的映射表，即pow(x / 20, 2.2)
+ *
+ * 网格生成时每个顶点需要转换多达16个分量，查表可避免反复调用std::pow
+ */
+inline const std::array<float, BLOCK_BRIGHTNESS_COMPONENT_LIMIT + 1> BLOCK_BRIGHTNESS_TO_FLOAT_LUT = []
+{
+    std::array<float, BLOCK_BRIGHTNESS_COMPONENT_LIMIT + 1> ret = {};
+    for(int i = 0; i <= BLOCK_BRIGHTNESS_COMPONENT_LIMIT; ++i)
+    {
+        ret[i] = std::pow(i / float(BLOCK_BRIGHTNESS_COMPONENT_LIMIT), 2.2f);
+    }
+    return ret;
+}();
+
+/**
+ * @brief 为true时BlockBrightnessToFloat不查表而是直接调用std::pow，仅供性能测试对比两种实现
+ */
+inline bool BLOCK_BRIGHTNESS_TO_FLOAT_USE_POW = false;
+
 /**
  * @brief 将block brightness的单个分量映射到[0, 1]的范围内
  */
 inline float BlockBrightnessToFloat(uint8_t brightness) noexcept
 {
-    return std::pow((std::min)(brightness, uint8_t(20)) / 20.0f, 2.2f);
+    const uint8_t clamped = (std::min)(brightness, BLOCK_BRIGHTNESS_COMPONENT_LIMIT);
+    if(BLOCK_BRIGHTNESS_TO_FLOAT_USE_POW)
+    {
+        return std::pow(clamped / float(BLOCK_BRIGHTNESS_COMPONENT_LIMIT), 2.2f);
+    }
+    return BLOCK_BRIGHTNESS_TO_FLOAT_LUT[clamped];
 }
 
 /**
@@ -1,5 +1,7 @@
 ﻿#pragma once
 
+#include <vector>
+
 #include <VRPG/Game/Physics/CollisionPrimitive.h>
 #include <VRPG/Game/World/Block/BlockOrientation.h>
 
@@ -16,6 +18,19 @@ public:
 
     virtual ~BlockCollision() = default;
 
+    /**
+     * @brief 是否具有碰撞体积，不具有时碰撞检测可以直接跳过该方块
+     */
+    virtual bool HasCollisionVolume() const noexcept { return true; }
+
+    /**
+     * @brief 未旋转时阻挡实体移动的AABB列表，均位于[0, 1]^3中
+     *
+     * BlockDescManager在注册方块时据此烘焙出各orientation下的AABB表，实体移动的碰撞检测只使用该表。
+     * 默认为空，即不阻挡实体移动
+     */
+    virtual void GetLocalAABBs(std::vector<Collision::AABB> &output) const { }
+
     /**
      * @brief 是否与给定轴对齐圆柱体发生了碰撞
      */
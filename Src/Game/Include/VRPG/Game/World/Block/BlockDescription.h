@@ -92,6 +92,21 @@ public:
     virtual void AddBlockModel(
         ModelBuilderSet &modelBuilders, const Vec3i &blockPosition, const BlockNeighborhood blocks) const = 0;
 
+    /**
+     * @brief 是否可以在LOD section model中被合并为粗粒度的box
+     *
+     * 不支持的方块在LOD section model中仍以原精度生成模型
+     */
+    virtual bool HasLODModel() const noexcept { return false; }
+
+    /**
+     * @brief 向LOD section model追加一个边长为cellSize个方块的box面片
+     *
+     * position为面片四个顶点的世界坐标，顺序与BoxFaceTemplate::position一致。仅当HasLODModel()为true时被调用
+     */
+    virtual void AddLODBoxFace(
+        ModelBuilderSet &modelBuilders, Direction normal, const Vec3 position[4], const Vec4 &brightness, int cellSize) const { }
+
     /**
      * @brief 是否需携带额外数据
      */
@@ -125,12 +140,44 @@ public:
     bool IsVoid() const noexcept { return blockID_ == BLOCK_ID_VOID; }
 };
 
+/**
+ * @brief 管理所有的block description
+ *
+ * 注册block description时，其在热点路径上被频繁查询的属性会被烘焙到以BlockID为下标的平坦数组中，
+ * 光照传播、网格生成和碰撞检测等处应优先使用这些查找表，以避免逐方块的虚函数调用
+ */
 class BlockDescManager : public Base::Singleton<BlockDescManager>
 {
+    static constexpr int FACE_VISIBILITY_STRIDE = BlockOrientation::RAW_VALUE_COUNT * 6;
+
     std::vector<std::shared_ptr<BlockDescription>> blockDescriptions_;
     std::map<std::string, std::shared_ptr<BlockDescription>, std::less<>> name2Desc_;
     std::vector<BlockDescription*> rawBlockDescriptions_;
 
+    // 以BlockID为下标的属性表
+
+    std::vector<uint8_t> isVisible_;
+    std::vector<uint8_t> isFullOpaque_;
+    std::vector<uint8_t> isSolidBox_;
+    std::vector<uint8_t> isLightSource_;
+    std::vector<uint8_t> hasExtraData_;
+    std::vector<uint8_t> isLiquid_;
+    std::vector<uint8_t> hasCollision_;
+    std::vector<uint8_t> hasLODModel_;
+    std::vector<BlockBrightness> lightAttenuation_;
+    std::vector<BlockBrightness> initialBrightness_;
+    std::vector<const BlockCollision*> collisions_;
+
+    // faceVisibility_[id * FACE_VISIBILITY_STRIDE + orientation * 6 + rotatedDirection]
+    std::vector<FaceVisibilityType> faceVisibility_;
+
+    // 各orientation下阻挡实体移动的AABB
+    // collisionAABBRanges_[id * RAW_VALUE_COUNT + orientation]为其在collisionAABBs_中的下标范围
+    std::vector<Collision::AABB> collisionAABBs_;
+    std::vector<std::pair<uint32_t, uint32_t>> collisionAABBRanges_;
+
+    void BakeProperties(const BlockDescription *desc);
+
 public:
 
     BlockDescManager();
@@ -155,6 +202,131 @@ public:
         auto it = name2Desc_.find(name);
         return it != name2Desc_.end() ? it->second.get() : nullptr;
     }
+
+    /**
+     * @brief 等价于GetBlockDescription(id)->IsVisible()
+     */
+    bool IsVisible(BlockID id) const noexcept
+    {
+        assert(id < BlockID(isVisible_.size()));
+        return isVisible_[id] != 0;
+    }
+
+    /**
+     * @brief 等价于GetBlockDescription(id)->IsFullOpaque()
+     */
+    bool IsFullOpaque(BlockID id) const noexcept
+    {
+        assert(id < BlockID(isFullOpaque_.size()));
+        return isFullOpaque_[id] != 0;
+    }
+
+    /**
+     * @brief 方块的六个面是否均为FaceVisibilityType::Solid
+     *
+     * 这样的方块与朝向无关地遮挡相邻box型方块的面，被其完全包围的同类方块不产生任何面片
+     */
+    bool IsSolidBox(BlockID id) const noexcept
+    {
+        assert(id < BlockID(isSolidBox_.size()));
+        return isSolidBox_[id] != 0;
+    }
+
+    /**
+     * @brief 等价于GetBlockDescription(id)->IsLightSource()
+     */
+    bool IsLightSource(BlockID id) const noexcept
+    {
+        assert(id < BlockID(isLightSource_.size()));
+        return isLightSource_[id] != 0;
+    }
+
+    /**
+     * @brief 等价于GetBlockDescription(id)->HasExtraData()
+     */
+    bool HasExtraData(BlockID id) const noexcept
+    {
+        assert(id < BlockID(hasExtraData_.size()));
+        return hasExtraData_[id] != 0;
+    }
+
+    /**
+     * @brief 等价于GetBlockDescription(id)->IsLiquid()
+     */
+    bool IsLiquid(BlockID id) const noexcept
+    {
+        assert(id < BlockID(isLiquid_.size()));
+        return isLiquid_[id] != 0;
+    }
+
+    /**
+     * @brief 等价于GetBlockDescription(id)->GetCollision()->HasCollisionVolume()
+     */
+    bool HasCollision(BlockID id) const noexcept
+    {
+        assert(id < BlockID(hasCollision_.size()));
+        return hasCollision_[id] != 0;
+    }
+
+    /**
+     * @brief 等价于GetBlockDescription(id)->HasLODModel()
+     */
+    bool HasLODModel(BlockID id) const noexcept
+    {
+        assert(id < BlockID(hasLODModel_.size()));
+        return hasLODModel_[id] != 0;
+    }
+
+    /**
+     * @brief 等价于GetBlockDescription(id)->LightAttenuation()
+     */
+    BlockBrightness LightAttenuation(BlockID id) const noexcept
+    {
+        assert(id < BlockID(lightAttenuation_.size()));
+        return lightAttenuation_[id];
+    }
+
+    /**
+     * @brief 等价于GetBlockDescription(id)->InitialBrightness()
+     */
+    BlockBrightness InitialBrightness(BlockID id) const noexcept
+    {
+        assert(id < BlockID(initialBrightness_.size()));
+        return initialBrightness_[id];
+    }
+
+    /**
+     * @brief 等价于GetBlockDescription(id)->GetCollision()
+     */
+    const BlockCollision *GetCollision(BlockID id) const noexcept
+    {
+        assert(id < BlockID(collisions_.size()));
+        return collisions_[id];
+    }
+
+    /**
+     * @brief 取得按orientation旋转后的方块阻挡实体移动的AABB列表
+     *
+     * 等价于将GetBlockDescription(id)->GetCollision()->GetLocalAABBs的结果绕方块中心按orientation旋转
+     */
+    Collision::AABBSpan GetCollisionAABBs(BlockID id, BlockOrientation orientation) const noexcept
+    {
+        assert(id < GetBlockDescriptionCount());
+        auto [begin, end] = collisionAABBRanges_[id * BlockOrientation::RAW_VALUE_COUNT + orientation.GetRawValue()];
+        return { collisionAABBs_.data() + begin, collisionAABBs_.data() + end };
+    }
+
+    /**
+     * @brief 取得按orientation旋转后的方块在rotatedDirection方向上的面的可见性类型
+     *
+     * 等价于GetBlockDescription(id)->GetFaceVisibility(orientation.RotatedToOrigin(rotatedDirection))
+     */
+    FaceVisibilityType GetFaceVisibility(BlockID id, BlockOrientation orientation, Direction rotatedDirection) const noexcept
+    {
+        assert(id < GetBlockDescriptionCount());
+        return faceVisibility_[
+            id * FACE_VISIBILITY_STRIDE + orientation.GetRawValue() * 6 + int(rotatedDirection)];
+    }
 };
 
 VRPG_GAME_END
@@ -138,47 +138,102 @@ public:
 /**
  * @brief 用于生成partial section model的辅助设施
  * 
- * 包含所有block effect对应的partial section model builder的实例
+ * 以block effect id为下标保存各effect对应的model builder。
+ * builder仅在section中首次用到对应的effect时才被取出，且会在多次Reset间保留并复用，
+ * 因此一个ModelBuilderSet实例宜长期持有（如thread_local），而非每次重建section时重新创建
  */
 class ModelBuilderSet
 {
-    std::vector<std::unique_ptr<ModelBuilder>> builders_;
+    struct Slot
+    {
+        const BlockEffect *effect = nullptr;
+        std::unique_ptr<ModelBuilder> builder;
+        bool isUsed = false;
+    };
+
+    Vec3i globalSectionPosition_;
+    std::vector<Slot> slots_;
+    std::vector<BlockEffectID> usedEffects_;
+
+    ModelBuilder *PrepareBuilder(const BlockEffect *effect)
+    {
+        BlockEffectID id = effect->GetBlockEffectID();
+        if(id >= slots_.size())
+        {
+            slots_.resize(BlockEffectManager::GetInstance().GetBlockEffectCount());
+        }
+        assert(id < slots_.size());
+
+        Slot &slot = slots_[id];
+        if(slot.effect != effect)
+        {
+            slot.effect = effect;
+            slot.builder = effect->CreateModelBuilder(globalSectionPosition_);
+        }
+        else
+        {
+            slot.builder->Reset(globalSectionPosition_);
+        }
+
+        slot.isUsed = true;
+        usedEffects_.push_back(id);
+        return slot.builder.get();
+    }
 
 public:
 
-    ModelBuilderSet(const Vec3i &globalSectionModel)
+    ModelBuilderSet() = default;
+
+    explicit ModelBuilderSet(const Vec3i &globalSectionPosition)
+        : globalSectionPosition_(globalSectionPosition)
     {
-        auto &effectMgr = BlockEffectManager::GetInstance();
-        BlockEffectID blockEffectCount = BlockEffectID(effectMgr.GetBlockEffectCount());
-        builders_.reserve(effectMgr.GetBlockEffectCount());
-        for(BlockEffectID i = 0; i < blockEffectCount; ++i)
+        
+    }
+
+    /**
+     * @brief 开始构建另一个section的模型，此前取得的所有builder都不再有效
+     */
+    void Reset(const Vec3i &globalSectionPosition)
+    {
+        globalSectionPosition_ = globalSectionPosition;
+        for(BlockEffectID id : usedEffects_)
         {
-            const BlockEffect *effect = effectMgr.GetSharedBlockEffect(i).get();
-            builders_.push_back(effect->CreateModelBuilder(globalSectionModel));
+            slots_[id].isUsed = false;
         }
+        usedEffects_.clear();
     }
 
+    /**
+     * @brief 取得effect对应的builder
+     *
+     * builder由effect->CreateModelBuilder创建，其类型必为Effect::Builder，故此处无需进行运行时类型检查
+     */
     template<typename Effect>
-    auto GetBuilderByEffect(const Effect *effect)
+    typename Effect::Builder *GetBuilderByEffect(const Effect *effect)
     {
         using Builder = typename Effect::Builder;
         static_assert(std::is_base_of_v<BlockEffect, Effect>);
         static_assert(std::is_base_of_v<ModelBuilder, Builder>);
 
         BlockEffectID id = effect->GetBlockEffectID();
-        assert(0 <= id && id < builders_.size());
+        ModelBuilder *rawBuilder = id < slots_.size() && slots_[id].isUsed ?
+                                   slots_[id].builder.get() : PrepareBuilder(effect);
 
-        ModelBuilder *rawBuilder = builders_[id].get();
-        Builder *builder = dynamic_cast<Builder*>(rawBuilder);
-        assert(builder);
-        return builder;
+        assert(dynamic_cast<Builder*>(rawBuilder));
+        return static_cast<Builder*>(rawBuilder);
     }
 
-    auto begin() { return builders_.begin(); }
-    auto end()   { return builders_.end();   }
-
-    auto begin() const { return builders_.begin(); }
-    auto end()   const { return builders_.end();   }
+    /**
+     * @brief 对当前section中用到的每个builder调用func(ModelBuilder&)
+     */
+    template<typename Func>
+    void ForEachUsedBuilder(Func &&func)
+    {
+        for(BlockEffectID id : usedEffects_)
+        {
+            func(*slots_[id].builder);
+        }
+    }
 };
 
 VRPG_GAME_END
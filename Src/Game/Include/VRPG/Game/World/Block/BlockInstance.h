@@ -1,8 +1,11 @@
 ﻿#pragma once
 
+#include <cassert>
+
 #include <VRPG/Game/World/Block/BlockBrightness.h>
 #include <VRPG/Game/World/Block/BlockExtraData.h>
 #include <VRPG/Game/World/Block/BlockOrientation.h>
+#include <VRPG/Game/World/Chunk/Common.h>
 
 VRPG_GAME_BEGIN
 
@@ -44,9 +47,110 @@ struct NewBlockInstance
     BlockOrientation orientation; // 方块朝向
 };
 
+/**
+ * @brief 构建section model时使用的紧凑方块记录
+ *
+ * 只保存方块的种类、朝向和亮度，方块的其他属性通过BlockDescManager中按ID存放的表查询
+ */
+struct CompactBlockInstance
+{
+    BlockID          id = BLOCK_ID_VOID;
+    BlockOrientation orientation;
+    BlockBrightness  brightness;
+};
+
 /**
  * @brief 某位置的方块及其周围的邻居方块
+ *
+ * 是对一块以[x][z][y]排列、尺寸为CHUNK_SECTION_PADDED_SIZE_X/Y/Z的连续方块数组的视图，
+ * 以blocks[x][y][z]访问（x, y, z ∈ {0, 1, 2}），目标方块本身位于blocks[1][1][1]
+ *
+ * 方块的extraData存放在另一块布局相同的指针数组中，只有携带额外数据的方块（见BlockDescManager::HasExtraData）的指针有效
  */
-using BlockNeighborhood = BlockInstance[3][3][3];
+class BlockNeighborhood
+{
+public:
+
+    static constexpr int STRIDE_Y = 1;
+    static constexpr int STRIDE_Z = CHUNK_SECTION_PADDED_SIZE_Y;
+    static constexpr int STRIDE_X = CHUNK_SECTION_PADDED_SIZE_Z * CHUNK_SECTION_PADDED_SIZE_Y;
+
+    class Row
+    {
+        const CompactBlockInstance *base_;
+
+    public:
+
+        explicit Row(const CompactBlockInstance *base) noexcept : base_(base) { }
+
+        const CompactBlockInstance &operator[](int z) const noexcept
+        {
+            assert(0 <= z && z <= 2);
+            return base_[(z - 1) * STRIDE_Z];
+        }
+    };
+
+    class Plane
+    {
+        const CompactBlockInstance *base_;
+
+    public:
+
+        explicit Plane(const CompactBlockInstance *base) noexcept : base_(base) { }
+
+        Row operator[](int y) const noexcept
+        {
+            assert(0 <= y && y <= 2);
+            return Row(base_ + (y - 1) * STRIDE_Y);
+        }
+    };
+
+    /**
+     * @param centre 目标方块在连续方块数组中的地址
+     * @param centreExtraData 目标方块在extraData指针数组中的地址
+     */
+    BlockNeighborhood(const CompactBlockInstance *centre, const BlockExtraData *const *centreExtraData) noexcept
+        : centre_(centre), centreExtraData_(centreExtraData)
+    {
+        
+    }
+
+    Plane operator[](int x) const noexcept
+    {
+        assert(0 <= x && x <= 2);
+        return Plane(centre_ + (x - 1) * STRIDE_X);
+    }
+
+    /**
+     * @brief blocks[x][y][z]相对于目标方块的偏移量，可预先计算后用于GetByOffset
+     */
+    static constexpr int Offset(int x, int y, int z) noexcept
+    {
+        return (x - 1) * STRIDE_X + (y - 1) * STRIDE_Y + (z - 1) * STRIDE_Z;
+    }
+
+    /**
+     * @brief 以Offset(x, y, z)的返回值访问blocks[x][y][z]
+     */
+    const CompactBlockInstance &GetByOffset(int offset) const noexcept
+    {
+        return centre_[offset];
+    }
+
+    /**
+     * @brief 取得blocks[x][y][z]的extraData，要求该方块携带额外数据
+     */
+    const BlockExtraData &GetExtraData(int x, int y, int z) const noexcept
+    {
+        const BlockExtraData *extraData = centreExtraData_[Offset(x, y, z)];
+        assert(extraData);
+        return *extraData;
+    }
+
+private:
+
+    const CompactBlockInstance *centre_;
+    const BlockExtraData *const *centreExtraData_;
+};
 
 VRPG_GAME_END
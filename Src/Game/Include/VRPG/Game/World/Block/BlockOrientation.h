@@ -16,6 +16,11 @@ class BlockOrientation
 
 public:
 
+    /**
+     * @brief 原始编码值的上界，可用于构造以orientation为下标的查找表
+     */
+    static constexpr int RAW_VALUE_COUNT = 6 << 4;
+
     BlockOrientation() noexcept;
 
     BlockOrientation(Direction posX, Direction posY) noexcept;
@@ -26,6 +31,11 @@ public:
 
     Direction Z() const noexcept;
 
+    /**
+     * @brief 取得原始编码值，位于[0, RAW_VALUE_COUNT)中
+     */
+    uint8_t GetRawValue() const noexcept { return xy_; }
+
     /**
      * @brief 这真的是一个合法的坐标系吗
      */
@@ -1,16 +1,26 @@
 ﻿#pragma once
 
 #include <memory>
-#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
-#include <VRPG/Game/Common.h>
+#include <VRPG/Game/Misc/ParallelForPool.h>
+#include <VRPG/Game/World/Chunk/Common.h>
 
 /*
 所有的方块更新任务都有一个对应的期望执行时刻，这些任务由一个BlockUpdaterManager管理
 
-每次调用BlockUpdaterManager，都会执行其中所有已经到了期望执行时刻的任务，按其期望时刻从早到晚的顺序进行
+每次调用BlockUpdaterManager，都会在给定的时间预算内执行已经到了期望执行时刻的任务，按其期望时刻从早到晚的顺序进行，
+因此预算不足时被推迟的总是较晚到期的任务，它们会在之后的调用中被优先执行
 
 在执行任务的过程中，可能会产生新的任务，它们将被插入到同一个BlockUpdaterManager实例中
+
+任务本身只由(方块位置, 任务类型, 执行时刻)构成，以值的形式存放在BlockUpdaterManager中；
+任务类型对应一个注册到BlockUpdaterManager中的BlockUpdater，由它实现任务的具体执行逻辑
+
+只有位于被模拟的区块（见ChunkManager::IsChunkSimulated）中的任务会被执行，其他任务按区块挂起，
+待区块重新被模拟时恢复，因此执行任务永远不会触发阻塞的区块加载。程序退出时尚未执行的任务被直接丢弃
 */
 
 VRPG_GAME_BEGIN
@@ -18,90 +28,211 @@ VRPG_GAME_BEGIN
 class ChunkManager;
 class BlockUpdaterManager;
 
+using BlockUpdaterID = uint16_t;
+
+/**
+ * @brief 方块更新任务的时间精度，期望执行时刻会被向上取整到该间隔的整数倍
+ */
+constexpr StdClock::duration BLOCK_UPDATE_TICK_INTERVAL =
+    std::chrono::duration_cast<StdClock::duration>(std::chrono::milliseconds(10));
+
+/**
+ * @brief 一类方块更新任务的执行逻辑
+ */
 class BlockUpdater
 {
-    StdClock::time_point expectedUpdatingTime_;
+    friend class BlockUpdaterManager;
 
-public:
+    BlockUpdaterID updaterID_ = 0;
 
-    explicit BlockUpdater(StdClock::time_point expectedUpdatingTime) noexcept
-        : expectedUpdatingTime_(expectedUpdatingTime)
-    {
-        
-    }
+public:
 
     virtual ~BlockUpdater() = default;
 
-    virtual void Execute(BlockUpdaterManager & updateManager, ChunkManager & chunkManager, StdClock::time_point now) = 0;
+    virtual void Execute(
+        BlockUpdaterManager &updaterManager, ChunkManager &chunkManager,
+        const Vec3i &blockPosition, StdClock::time_point now) = 0;
+
+    /**
+     * @brief 某个tick中的所有任务都执行完毕后被调用，可以将Execute中收集的任务留到此处批量处理
+     */
+    virtual void FinishTick(BlockUpdaterManager &updaterManager, ChunkManager &chunkManager, StdClock::time_point now) { }
 
-    StdClock::time_point GetExpectedUpdatingTime() const noexcept
+    BlockUpdaterID GetUpdaterID() const noexcept
     {
-        return expectedUpdatingTime_;
+        return updaterID_;
     }
 };
 
-class BlockUpdaterManager
+/**
+ * @brief 以分层时间轮管理所有的方块更新任务
+ *
+ * 同一tick中，同一位置的同一类任务只会保留一个
+ */
+class BlockUpdaterManager : public agz::misc::uncopyable_t
 {
-    struct BlockUpdateComp
+public:
+
+    /**
+     * @param workerThreadCount 供BlockUpdater并行处理任务的额外线程数
+     */
+    BlockUpdaterManager(ChunkManager *chunkManager, int workerThreadCount);
+
+    /**
+     * @brief 注册一类方块更新任务，返回注册的BlockUpdater
+     */
+    template<typename T, typename...Args>
+    T *RegisterUpdater(Args&&...args);
+
+    /**
+     * @brief 添加一个新的方块更新任务
+     */
+    void AddUpdater(BlockUpdaterID updaterID, const Vec3i &blockPosition, StdClock::time_point expectedUpdatingTime);
+
+    /**
+     * @brief 在给定的时间预算内执行已到时间的更新任务，最早到期的任务最先执行
+     */
+    void Execute(StdClock::duration timeBudget, StdClock::time_point now = StdClock::now());
+
+    /**
+     * @brief 尚未执行的任务数量，包括被挂起的任务
+     */
+    size_t GetPendingUpdaterCount() const noexcept;
+
+    /**
+     * @brief 最近一次Execute的执行情况
+     *
+     * 任务的延迟指其实际执行时刻与期望执行时刻之差
+     */
+    struct Statistics
     {
-        bool operator()(const BlockUpdater *lhs, const BlockUpdater *rhs) const noexcept
-        {
-            assert(lhs && rhs);
-            return lhs->GetExpectedUpdatingTime() > rhs->GetExpectedUpdatingTime();
-        }
+        size_t pendingCount   = 0; // Execute结束时尚未执行的任务数量，包括被挂起的任务
+        size_t suspendedCount = 0; // Execute结束时因所在区块未被模拟而挂起的任务数量
+        int    executedCount  = 0; // 本次Execute执行的任务数量
+        float  meanLateness   = 0; // 本次执行的任务的平均延迟，单位为毫秒
+        float  maxLateness    = 0; // 本次执行的任务的最大延迟，单位为毫秒
     };
 
-    std::priority_queue<BlockUpdater*, std::vector<BlockUpdater*>, BlockUpdateComp> updaterQueue_;
+    Statistics GetStatistics() const noexcept;
 
-    ChunkManager *chunkManager_;
+    /**
+     * @brief BlockUpdater可在FinishTick中借助该线程池并行处理互不相关的任务
+     *
+     * 世界刻中的其他并行工作（如EntityPhysics）也共用该线程池
+     */
+    ParallelForPool &GetWorkerPool() noexcept;
 
-public:
+private:
+
+    using Tick = uint64_t;
+
+    static constexpr uint32_t NIL_NODE = (std::numeric_limits<uint32_t>::max)();
+
+    static constexpr int  WHEEL_LEVEL_COUNT = 3;
+    static constexpr int  WHEEL_SLOT_BITS   = 8;
+    static constexpr int  WHEEL_SLOT_COUNT  = 1 << WHEEL_SLOT_BITS;
+    static constexpr Tick WHEEL_SLOT_MASK   = WHEEL_SLOT_COUNT - 1;
 
-    explicit BlockUpdaterManager(ChunkManager *chunkManager)
-        : chunkManager_(chunkManager)
+    // 存放于nodePool_中的任务，next为同一槽位中下一个任务的下标
+    struct PendingUpdater
     {
-        
-    }
+        Vec3i blockPosition;
+        BlockUpdaterID updaterID = 0;
+        Tick tick = 0;
+        uint32_t next = NIL_NODE;
+    };
 
-    ~BlockUpdaterManager()
+    struct PendingKey
     {
-        StdClock::time_point now = StdClock::now();
-        while(!updaterQueue_.empty())
+        Vec3i blockPosition;
+        BlockUpdaterID updaterID;
+        Tick tick;
+
+        bool operator==(const PendingKey &rhs) const noexcept
         {
-            auto updater = updaterQueue_.top();
-            updaterQueue_.pop();
-            updater->Execute(*this, *chunkManager_, now);
-            delete updater;
+            return blockPosition == rhs.blockPosition && updaterID == rhs.updaterID && tick == rhs.tick;
         }
-    }
+    };
 
-    /**
-     * @brief 添加一个新的方块更新任务
-     */
-    void AddUpdater(std::unique_ptr<BlockUpdater> updater)
+    struct PendingKeyHash
     {
-        updaterQueue_.push(updater.release());
-    }
+        size_t operator()(const PendingKey &key) const noexcept;
+    };
+
+    // 按插入顺序排列的任务链表
+    struct Slot
+    {
+        uint32_t head = NIL_NODE;
+        uint32_t tail = NIL_NODE;
+    };
+
+    Tick TimeToTick(StdClock::time_point time) const noexcept;
+
+    uint32_t AllocateNode();
+
+    void FreeNode(uint32_t node) noexcept;
+
+    static void PushBack(Slot &slot, std::vector<PendingUpdater> &nodes, uint32_t node) noexcept;
+
+    // 按任务的tick与currentTick_之差将其放入合适的时间轮槽位
+    void Schedule(uint32_t node) noexcept;
+
+    // 将某个槽位中的任务重新放入更低层的时间轮
+    void Cascade(Slot &slot) noexcept;
+
+    // currentTick_前进一个tick，并在低层时间轮转完一圈时从高层时间轮中取出任务
+    void AdvanceTick() noexcept;
+
+    // 挂起一个所在区块未被模拟的任务，任务仍保留在pendingKeys_中
+    void Suspend(const PendingUpdater &updater);
+
+    // 恢复所有重新被模拟的区块中挂起的任务
+    void ResumeSimulatedChunks();
 
     /**
-     * @brief 执行所有已到时间的更新任务
+     * @brief 执行tick不晚于lastTick的任务，直至超过deadline
      */
-    void Execute(int maxExecutedCount, StdClock::time_point now = StdClock::now())
-    {
-        int executed = 0;
-        while(!updaterQueue_.empty() && updaterQueue_.top()->GetExpectedUpdatingTime() <= now)
-        {
-            auto updater = updaterQueue_.top();
-            updaterQueue_.pop();
-            updater->Execute(*this, *chunkManager_, now);
-            delete updater;
-
-            if(++executed >= maxExecutedCount)
-            {
-                return;
-            }
-        }
-    }
+    void ExecuteImpl(StdClock::time_point deadline, Tick lastTick, StdClock::time_point now);
+
+    ChunkManager *chunkManager_;
+
+    std::vector<std::unique_ptr<BlockUpdater>> updaters_;
+
+    ParallelForPool workerPool_;
+
+    std::vector<PendingUpdater> nodePool_;
+    uint32_t freeNode_;
+
+    // wheel_[i]中每个槽位对应2^(i * WHEEL_SLOT_BITS)个tick，超出最高层时间轮范围的任务存放在overflow_中
+    Slot wheel_[WHEEL_LEVEL_COUNT][WHEEL_SLOT_COUNT];
+    Slot overflow_;
+
+    std::unordered_set<PendingKey, PendingKeyHash> pendingKeys_;
+
+    // 按区块挂起的任务
+    std::unordered_map<ChunkPosition, std::vector<PendingUpdater>> suspendedUpdaters_;
+    size_t suspendedCount_;
+
+    StdClock::time_point epoch_;
+    Tick currentTick_;
+
+    // currentTick_中是否有已执行的任务尚未经过FinishTick
+    bool isCurrentTickUnfinished_;
+
+    Statistics statistics_;
 };
 
+template<typename T, typename...Args>
+T *BlockUpdaterManager::RegisterUpdater(Args&&...args)
+{
+    static_assert(std::is_base_of_v<BlockUpdater, T>);
+    assert(updaters_.size() < (std::numeric_limits<BlockUpdaterID>::max)());
+
+    auto updater = std::make_unique<T>(std::forward<Args>(args)...);
+    T *ret = updater.get();
+    ret->updaterID_ = BlockUpdaterID(updaters_.size());
+    updaters_.push_back(std::move(updater));
+    return ret;
+}
+
 VRPG_GAME_END
@@ -0,0 +1,110 @@
+﻿#pragma once
+
+#include <functional>
+#include <unordered_map>
+
+#include <VRPG/Game/Misc/ParallelForPool.h>
+#include <VRPG/Game/World/Block/LiquidDescription.h>
+#include <VRPG/Game/World/Chunk/Common.h>
+
+VRPG_GAME_BEGIN
+
+/**
+ * @brief 液体元胞自动机的单步计算
+ *
+ * 计算只读写以section为单位稠密存放的方块状态，不访问区块数据。
+ * 所有读取都看到本步开始时的状态，本步产生的改变在所有方块计算完毕后才按方块的顺序一并输出，
+ * 因此计算结果与线程数量、分批方式及调度顺序都无关
+ */
+class LiquidSimulation : public agz::misc::uncopyable_t
+{
+public:
+
+    // 液体模拟所需的单个方块的状态，level仅对液体方块有意义
+    struct Cell
+    {
+        BlockID     id    = BLOCK_ID_VOID;
+        LiquidLevel level = 0;
+    };
+
+    static constexpr int SECTION_CELL_COUNT = CHUNK_SECTION_SIZE_X * CHUNK_SECTION_SIZE_Y * CHUNK_SECTION_SIZE_Z;
+
+    struct Section
+    {
+        Cell cells[SECTION_CELL_COUNT];
+    };
+
+    // 液体模拟产生的方块改变，调用者应在写回后于delay时间后更新其邻居
+    struct Change
+    {
+        Vec3i position;
+        NewBlockInstance block;
+        StdClock::duration delay;
+    };
+
+    // 填充某个section在本步开始时的状态
+    using SectionLoader = std::function<void(const Vec3i &globalSection, Section &section)>;
+
+    static int CellIndex(const Vec3i &blockInSection) noexcept;
+
+    /**
+     * @brief 由液体方块的附加信息得到其状态
+     */
+    static Cell MakeCell(BlockID id, const BlockExtraData &extraData);
+
+    /**
+     * @brief 对activeBlocks中的每个方块执行一步模拟，返回产生的改变
+     *
+     * activeBlocks会被排序并去重，其中每个方块至多产生一个改变，返回的改变按排序后的方块顺序排列。
+     * loadSection在调用线程上串行地被调用，每个被读取的section至多一次；随后的计算被分批分配到workerPool上
+     */
+    const std::vector<Change> &Step(
+        std::vector<Vec3i> &activeBlocks, const SectionLoader &loadSection, ParallelForPool &workerPool);
+
+private:
+
+    // 一批连续的被激活的方块及其产生的改变，只会被一个线程访问
+    struct Batch
+    {
+        size_t beginBlock = 0;
+        size_t endBlock   = 0;
+
+        std::vector<Change> changes;
+    };
+
+    static constexpr size_t BLOCK_BATCH_SIZE = 256;
+
+    void LoadSection(const SectionLoader &loadSection, const Vec3i &globalSection);
+
+    Cell GetCell(const Vec3i &globalBlock) const;
+
+    const BlockDescription *GetCellDesc(const Vec3i &globalBlock) const;
+
+    void UpdateBatch(Batch &batch) const;
+
+    /**
+     * @brief 处理某个方块与其周围的液体发生的反应
+     *
+     * 返回true当且仅当发生了反应
+     */
+    bool ReactWithNeighborhood(Batch &batch, const Vec3i &blockPos, const Cell &cell) const;
+
+    /**
+     * @brief 处理某个方块周围流到该方块处的结果
+     */
+    void FlowFromNeighborhood(Batch &batch, const Vec3i &blockPos, const Cell &cell) const;
+
+    // 本步中被激活的方块
+    const std::vector<Vec3i> *activeBlocks_ = nullptr;
+
+    // 本步开始时各section的稠密状态，在并行计算期间只读，本步结束后回收到sectionPool_中
+    std::unordered_map<Vec3i, std::unique_ptr<Section>> sections_;
+    std::vector<std::unique_ptr<Section>> sectionPool_;
+
+    // 前若干个为本步中的批次，其余保留下来以复用其中的内存
+    std::vector<Batch> batches_;
+
+    std::vector<Change> changes_;
+};
+
+VRPG_GAME_END
@@ -1,35 +1,53 @@
 ﻿#pragma once
 
 #include <VRPG/Game/World/BlockUpdater/BlockUpdater.h>
+#include <VRPG/Game/World/BlockUpdater/LiquidSimulation.h>
+#include <VRPG/Game/World/Chunk/Common.h>
 
 VRPG_GAME_BEGIN
 
+/**
+ * @brief 液体的流动与反应
+ *
+ * Execute只记录被激活的方块，同一tick中所有被激活的方块在FinishTick中由LiquidSimulation一并以元胞自动机的方式更新：
+ * 液体模拟所需的方块状态以section为单位稠密地存放，更新过程只读取本tick开始时的状态，
+ * 更新结束后才将所有改变一次性写回区块，并为改变了的方块的邻居发布后续的更新任务
+ *
+ * 更新在BlockUpdaterManager的线程池上并行计算。由于所有读取都看到本tick开始时的状态，
+ * 计算结果与线程数量及调度顺序无关，写回与后续任务的发布都在计算结束后串行完成
+ *
+ * 没有被激活方块的section不参与计算，已经稳定的液体不会产生新的更新任务，因而不再消耗任何时间
+ */
 class LiquidUpdater : public BlockUpdater
 {
-    Vec3i blockPos_;
+public:
+
+    void Execute(
+        BlockUpdaterManager &updaterManager, ChunkManager &chunkManager,
+        const Vec3i &blockPosition, StdClock::time_point now) override;
+
+    void FinishTick(BlockUpdaterManager &updaterManager, ChunkManager &chunkManager, StdClock::time_point now) override;
+
+    void AddUpdaterForNeighborhood(
+        const Vec3i &blockPosition, BlockUpdaterManager &updaterManager, ChunkManager &chunkManager, StdClock::time_point now);
+
+private:
 
     /**
-     * @brief 处理某个方块与其周围的液体发生的反应
-     *
-     * 返回true当且仅当发生了反应
+     * @brief 从区块数据中读取指定section的稠密状态
      */
-    bool ReactWithNeighborhood(
-        const BlockInstance &block, BlockUpdaterManager &updaterManager, ChunkManager &chunkManager, StdClock::time_point now);
+    static void LoadSection(ChunkManager &chunkManager, const Vec3i &globalSection, LiquidSimulation::Section &section);
 
     /**
-     * @brief 处理某个方块周围流到该方块处的结果
+     * @brief 为某个方块的6个相邻方块添加液体更新任务
      */
-    void FlowFromNeighborhood(
-        const BlockInstance &block, BlockUpdaterManager &updaterManager, ChunkManager &chunkManager, StdClock::time_point now);
-
-public:
+    void AddUpdaterForAdjacentBlocks(
+        const Vec3i &blockPos, BlockUpdaterManager &updaterManager, StdClock::time_point expectedUpdatingTime);
 
-    LiquidUpdater(StdClock::time_point expectedUpdatingTime, const Vec3i &blockPos) noexcept;
+    // 本tick中被激活的方块
+    std::vector<Vec3i> activeBlocks_;
 
-    void Execute(BlockUpdaterManager &updaterManager, ChunkManager &chunkManager, StdClock::time_point now) override;
-
-    static void AddUpdaterForNeighborhood(
-        const Vec3i &blockPosition, BlockUpdaterManager &updaterManager, ChunkManager &chunkManager, StdClock::time_point now);
+    LiquidSimulation simulation_;
 };
 
 VRPG_GAME_END
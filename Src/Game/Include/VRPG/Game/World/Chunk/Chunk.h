@@ -12,8 +12,14 @@ class ChunkBlockData
     BlockOrientation orientations_[CHUNK_SIZE_X][CHUNK_SIZE_Z][CHUNK_SIZE_Y];
     int              heightMap_   [CHUNK_SIZE_X][CHUNK_SIZE_Z] = { { 0 } };
 
+    // 具有碰撞体积的方块的位掩码，collisionMask_[x][z][i]的第j位对应y = 64 * i + j
+    // 每个section中的每一列恰好对应其中连续的16位，由SetID维护
+    uint64_t         collisionMask_[CHUNK_SIZE_X][CHUNK_SIZE_Z][CHUNK_SIZE_Y / 64] = { { { 0 } } };
+
     std::map<Vec3i, BlockExtraData> extraData_;
 
+    void UpdateCollisionMask(const Vec3i &blockInChunk, BlockID id) noexcept;
+
 public:
 
     ChunkBlockData() = default;
@@ -32,6 +38,16 @@ public:
 
     int GetHeight(int blockInChunkX, int blockInChunkZ) const noexcept;
 
+    /**
+     * @brief 等价于BlockDescManager::HasCollision(GetID(blockInChunk))
+     */
+    bool HasCollision(const Vec3i &blockInChunk) const noexcept;
+
+    /**
+     * @brief 取得(x, z)列中y位于[64 * wordIndex, 64 * wordIndex + 64)的方块的碰撞位掩码，第i位对应y = 64 * wordIndex + i
+     */
+    uint64_t GetCollisionMaskWord(int blockInChunkX, int blockInChunkZ, int wordIndex) const noexcept;
+
     const BlockExtraData *GetExtraData(const Vec3i &blockInChunk) const;
 
     BlockExtraData *GetExtraData(const Vec3i &blockInChunk);
@@ -80,6 +96,10 @@ public:
 
     int GetHeight(int blockInChunkX, int blockInChunkZ) const noexcept;
 
+    bool HasCollision(const Vec3i &blockInChunk) const noexcept;
+
+    uint64_t GetCollisionMaskWord(int blockInChunkX, int blockInChunkZ, int wordIndex) const noexcept;
+
     const BlockExtraData *GetExtraData(const Vec3i &blockInChunk) const;
 
     BlockExtraData *GetExtraData(const Vec3i &blockInChunk);
@@ -98,7 +118,12 @@ public:
 
     ChunkBlockData &GetBlockData() noexcept;
 
-    void RegenerateSectionModel(const Vec3i &sectionInChunk, const Chunk *neighboringChunks[3][3]);
+    /**
+     * @brief 重新生成指定section的模型
+     *
+     * lodLevel > 0时，支持LOD的方块被降采样为SectionLODCellSize(lodLevel)^3的粗粒度box，其他方块仍以原精度生成
+     */
+    void RegenerateSectionModel(const Vec3i &sectionInChunk, const Chunk *neighboringChunks[3][3], int lodLevel = 0);
 };
 
 VRPG_GAME_END
@@ -67,6 +67,23 @@ public:
      */
     void ModifyBlockIDInPool(const Vec3i &blockPosition, BlockID id, BlockOrientation orientation);
 
+    /**
+     * @brief 对池子中区块数据的单个方块修改
+     */
+    struct BlockModification
+    {
+        Vec3i blockInChunk;
+        BlockID id;
+        BlockOrientation orientation;
+    };
+
+    /**
+     * @brief 异步地试图修改池子中同一区块内的一批方块，每个被修改的列只重新计算一次高度
+     *
+     * 若池子中没有该区块，则此修改无效
+     */
+    void ModifyBlocksInPool(const ChunkPosition &chunkPosition, std::vector<BlockModification> modifications);
+
 private:
 
     void DataModifierFunc();
@@ -77,9 +94,8 @@ private:
 
     struct DataModifyTask
     {
-        Vec3i globalBlockPosition;
-        BlockID newBlockID;
-        BlockOrientation newBlockOrientation;
+        ChunkPosition chunkPosition;
+        std::vector<BlockModification> modifications;
     };
 
     std::thread dataModifierThread_;
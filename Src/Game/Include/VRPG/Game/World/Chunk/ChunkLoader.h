@@ -43,9 +43,9 @@ public:
     /**
      * @brief 添加加载指定位置的区块的任务
      *
-     * 加载得到的区块会被自动放置到GetALlLoadingResults的返回元素中
+     * 加载得到的区块会被自动放置到GetALlLoadingResults的返回元素中，其section model的细节层次为lodLevel
      */
-    void AddLoadingTask(const ChunkPosition &position);
+    void AddLoadingTask(const ChunkPosition &position, int lodLevel = 0);
 
     /**
      * @brief 添加卸载指定位置的区块的任务
@@ -63,6 +63,11 @@ public:
      * @brief 尝试设置缓存池中指定位置的方块的id，返回true当且仅当池子中包含该方块的数据
      */
     void SetChunkBlockDataInPool(int blockX, int blockY, int blockZ, BlockID id, BlockOrientation orientation);
+
+    /**
+     * @brief 尝试设置缓存池中同一区块内的一批方块，整批修改只产生一条消息
+     */
+    void SetChunkBlocksInPool(const ChunkPosition &chunkPosition, std::vector<ChunkBlockDataPool::BlockModification> modifications);
     
 private:
 
@@ -76,7 +81,7 @@ private:
      *
      * 注意返回的数据绝不会是从池子里拷贝得到的，池子里的数据只能用来计算光照
      */
-    std::unique_ptr<Chunk> LoadChunk(const ChunkPosition &position);
+    std::unique_ptr<Chunk> LoadChunk(const ChunkPosition &position, int lodLevel);
 
     void LoadChunkBlockData(const ChunkPosition &position, ChunkBlockData *blockData);
     
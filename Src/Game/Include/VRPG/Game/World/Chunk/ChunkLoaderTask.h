@@ -14,6 +14,7 @@ VRPG_GAME_BEGIN
 struct ChunkLoaderTask_Load
 {
     ChunkPosition position;
+    int lodLevel = 0;
     std::unique_ptr<Chunk> chunk;
 };
 
@@ -50,7 +51,7 @@ class ChunkLoaderTaskQueue
 {
 public:
 
-    void AddLoadingTask(const ChunkPosition &position)
+    void AddLoadingTask(const ChunkPosition &position, int lodLevel)
     {
         AGZ_SCOPE_GUARD({ condVar_.notify_one(); });
         std::lock_guard lk(mutex_);
@@ -59,11 +60,11 @@ public:
         if(it == map_.end())
         {
             queue_.push(position);
-            map_[position] = ChunkLoaderTask(ChunkLoaderTask_Load{ position, nullptr });
+            map_[position] = ChunkLoaderTask(ChunkLoaderTask_Load{ position, lodLevel, nullptr });
             return;
         }
 
-        it->second = MergeTasks(std::move(it->second), ChunkLoaderTask(ChunkLoaderTask_Load{ position, nullptr }));
+        it->second = MergeTasks(std::move(it->second), ChunkLoaderTask(ChunkLoaderTask_Load{ position, lodLevel, nullptr }));
     }
 
     void AddUnloadingTask(std::unique_ptr<Chunk> chunk)
@@ -133,14 +134,14 @@ private:
 
             // 加载-卸载，此时把卸载内容bypass给加载
             auto rhs_unload = &rhs.as<ChunkLoaderTask_Unload>();
-            return ChunkLoaderTask(ChunkLoaderTask_Load{ lhs_load->position, std::move(rhs_unload->chunk) });
+            return ChunkLoaderTask(ChunkLoaderTask_Load{ lhs_load->position, lhs_load->lodLevel, std::move(rhs_unload->chunk) });
         }
 
         auto lhs_unload = &lhs.as<ChunkLoaderTask_Unload>();
         if(auto rhs_load = rhs.as_if<ChunkLoaderTask_Load>())
         {
             // 卸载-加载，此时把卸载内容bypass给加载
-            return ChunkLoaderTask(ChunkLoaderTask_Load{ rhs_load->position, std::move(lhs_unload->chunk) });
+            return ChunkLoaderTask(ChunkLoaderTask_Load{ rhs_load->position, rhs_load->lodLevel, std::move(lhs_unload->chunk) });
         }
 
         // 卸载-卸载，此时取消前一个卸载
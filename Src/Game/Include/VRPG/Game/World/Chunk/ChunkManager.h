@@ -1,10 +1,12 @@
 ﻿#pragma once
 
+#include <functional>
 #include <unordered_map>
 #include <unordered_set>
 
 #include <agz/utility/misc.h>
 
+#include <VRPG/Game/Misc/BitScan.h>
 #include <VRPG/Game/World/Chunk/Chunk.h>
 #include <VRPG/Game/World/Chunk/ChunkLoader.h>
 
@@ -37,12 +39,39 @@ struct ChunkManagerParams
     int loadDistance   = 3;
     int unloadDistance = 4;
 
+    // simulationDistance < loadDistance
+    // <= simulationDistance -> 执行方块更新
+
+    int simulationDistance = 2;
+
+    // renderDistance内的区块按距离选择section model的细节层次
+    // <= fullDetailDistance -> 原精度
+    // <= halfDetailDistance -> 2倍降采样
+    // 其余                  -> 4倍降采样
+
+    int fullDetailDistance = 2;
+    int halfDetailDistance = 2;
+
     // 后台负责区块加载/卸载线程的数量
     int backgroundThreadCount = 1;
     // 后台区块数据池的大小
     int backgroundPoolSize = 30;
 };
 
+/**
+ * @brief 批量修改方块时的一项修改
+ */
+struct BlockEdit
+{
+    Vec3i globalBlock;
+    NewBlockInstance block; // block.extraData仅在该方块有extra data时有意义
+};
+
+/**
+ * @brief 方块改变回调的handle，用于移除该回调
+ */
+using BlockChangeSubscriberHandle = uint64_t;
+
 /**
  * @brief 区块管理设施
  *
@@ -61,6 +90,20 @@ public:
      */
     void SetCentreChunk(const ChunkPosition &chunkPosition);
 
+    /**
+     * @brief 添加一个方块改变时的回调函数，返回用于移除该回调的handle
+     *
+     * 每个通过SetBlockID或SetBlocks被设置的方块都会以其位置依次调用所有回调，调用顺序与添加顺序相同
+     */
+    BlockChangeSubscriberHandle AddBlockChangeSubscriber(std::function<void(const Vec3i &)> callback);
+
+    /**
+     * @brief 移除一个方块改变时的回调函数
+     *
+     * 不能在回调函数中调用
+     */
+    void RemoveBlockChangeSubscriber(BlockChangeSubscriberHandle handle);
+
     /**
      * @brief 设置某个位置的block id
      *
@@ -83,6 +126,23 @@ public:
     void SetBlockID(
         const Vec3i &globalBlock, BlockID id, BlockOrientation orientation, BlockExtraData extraData);
 
+    /**
+     * @brief 批量设置一组方块
+     *
+     * 与逐个调用SetBlockID的结果相同（光照在之后的UpdateLight中收敛到相同的结果），但开销被分摊到整批修改上：
+     * 修改按区块分组，每个被修改的列只更新一次height map，每个区块只向后台pool发送一条消息，
+     * 只有位于修改区域边界上的方块、天光改变的方块，以及新旧方块自发光、原本有亮度或光照衰减改变的方块会被加入光照更新队列，
+     * 每个受影响的section只被标记一次
+     *
+     * 对同一方块的多次修改以最后一次为准。必要时会阻塞地加载被修改的区块
+     */
+    void SetBlocks(std::vector<BlockEdit> edits);
+
+    /**
+     * @brief 将[low, high]范围内的所有方块设置为指定的方块，有extra data的方块使用默认的extra data
+     */
+    void SetBlocks(const Vec3i &low, const Vec3i &high, BlockID id, BlockOrientation orientation);
+
     /**
      * @brief 取得某个位置的block id
      *
@@ -134,6 +194,32 @@ public:
      */
     BlockInstance GetBlock(const Vec3i &globalBlock);
 
+    /**
+     * @brief 取得指定位置的区块，该区块尚未加载时返回nullptr
+     *
+     * 不会触发区块加载
+     */
+    const Chunk *FindChunk(const ChunkPosition &position) const;
+
+    /**
+     * @brief 查询指定位置的区块是否应执行方块更新
+     *
+     * 该区块须在simulationDistance之内，且它与它的4个水平相邻区块都已加载，
+     * 这保证了方块更新读写该区块中的方块及其相邻方块时不会触发区块加载
+     */
+    bool IsChunkSimulated(const ChunkPosition &position) const;
+
+    /**
+     * @brief 对[low, high]范围内具有碰撞体积的方块依次调用func(globalBlock, id, orientation)
+     *
+     * 借助区块中的碰撞位掩码逐列做位扫描，不会访问不具有碰撞体积的方块。y坐标超出[0, CHUNK_SIZE_Y)的部分被忽略
+     *
+     * @param loadMissingChunks 为true时阻塞地加载范围内尚未加载的区块；
+     *                          为false时若范围内有区块尚未加载，则不调用func并返回false
+     */
+    template<typename Func>
+    bool ForEachCollidableBlock(const Vec3i &low, const Vec3i &high, bool loadMissingChunks, Func &&func);
+
     /**
      * @brief 射线与方块求交测试
      *
@@ -171,8 +257,11 @@ public:
 
     /**
      * @brief 生成新的区块渲染队列
+     *
+     * 从摄像机所在的section出发，沿section之间的面连通关系（见SectionConnectivity）搜索，
+     * 只有能被视线到达的section会参与前向渲染，其余section仅作为阴影投射者加入渲染队列
      */
-    void FillRenderer(ChunkRenderer &renderer);
+    void FillRenderer(ChunkRenderer &renderer, const Vec3 &cameraPosition);
 
 private:
 
@@ -193,6 +282,18 @@ private:
      */
     bool ShouldRender(const ChunkPosition &position) const noexcept;
 
+    /**
+     * @brief 取得给定位置的区块应使用的section model细节层次
+     *
+     * renderDistance之外的区块不会被渲染，取最低的细节层次以减少生成模型的开销
+     */
+    int GetSectionLODLevel(const ChunkPosition &position) const noexcept;
+
+    /**
+     * @brief 将renderDistance内细节层次与当前位置不符的section model标记为dirty
+     */
+    void MakeStaleLODSectionsDirty();
+
     /**
      * @brief 更新blocksQueue中所有方块的光照
      *
@@ -236,14 +337,83 @@ private:
     // 单位是section
     std::unordered_set<Vec3i> sectionsWithDirtyModel_;
 
+    // 中心区块改变或有新区块加入后，需要检查section model的细节层次
+    bool isSectionLODDirty_ = false;
+
     // 哪些方块的光照需要更新
     std::queue<Vec3i> blocksWithDirtyLight_;
 
     // 目前的中心区块位置
     ChunkPosition centreChunkPosition_;
 
+    // 方块改变时的回调函数
+    BlockChangeSubscriberHandle nextBlockChangeSubscriberHandle_;
+    std::vector<std::pair<BlockChangeSubscriberHandle, std::function<void(const Vec3i &)>>> blockChangeSubscribers_;
+
     // 日志
     std::shared_ptr<spdlog::logger> log_;
 };
 
+template<typename Func>
+bool ChunkManager::ForEachCollidableBlock(const Vec3i &low, const Vec3i &high, bool loadMissingChunks, Func &&func)
+{
+    const ChunkPosition lowChunk  = GlobalBlockToChunk(low.x, low.z);
+    const ChunkPosition highChunk = GlobalBlockToChunk(high.x, high.z);
+
+    if(!loadMissingChunks)
+    {
+        for(int ckX = lowChunk.x; ckX <= highChunk.x; ++ckX)
+        {
+            for(int ckZ = lowChunk.z; ckZ <= highChunk.z; ++ckZ)
+            {
+                if(!chunks_.count({ ckX, ckZ }))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    const int lowY  = (std::max)(low.y, 0);
+    const int highY = (std::min)(high.y, CHUNK_SIZE_Y - 1);
+    if(lowY > highY)
+    {
+        return true;
+    }
+
+    for(int ckX = lowChunk.x; ckX <= highChunk.x; ++ckX)
+    {
+        for(int ckZ = lowChunk.z; ckZ <= highChunk.z; ++ckZ)
+        {
+            const Chunk *chunk = EnsureChunkExists(ckX, ckZ);
+
+            const int xBase = ckX * CHUNK_SIZE_X, zBase = ckZ * CHUNK_SIZE_Z;
+            const int lowX  = (std::max)(low.x - xBase, 0), highX = (std::min)(high.x - xBase, CHUNK_SIZE_X - 1);
+            const int lowZ  = (std::max)(low.z - zBase, 0), highZ = (std::min)(high.z - zBase, CHUNK_SIZE_Z - 1);
+
+            for(int x = lowX; x <= highX; ++x)
+            {
+                for(int z = lowZ; z <= highZ; ++z)
+                {
+                    for(int word = lowY / 64; word <= highY / 64; ++word)
+                    {
+                        const int wordBaseY = 64 * word;
+                        const uint64_t rangeMask = MakeBitRangeMask(
+                            (std::max)(lowY - wordBaseY, 0), (std::min)(highY - wordBaseY, 63));
+
+                        ForEachSetBit(chunk->GetCollisionMaskWord(x, z, word) & rangeMask, [&](int bit)
+                        {
+                            const Vec3i blockInChunk = { x, wordBaseY + bit, z };
+                            func(Vec3i(xBase + x, blockInChunk.y, zBase + z),
+                                 chunk->GetID(blockInChunk), chunk->GetOrientation(blockInChunk));
+                        });
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
 VRPG_GAME_END
@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include <algorithm>
 #include <memory>
 
 #include <VRPG/Game/Player/Camera/Camera.h>
@@ -10,7 +11,7 @@ VRPG_GAME_BEGIN
 /*
     每种BlockEffect对应一种对应的ChunkDataBuilder
     Build一个Chunk的RenderingData前先把每种ChunkDataBuilder准备好
-    BlockDescription自己根据BlockEffectID拿到对应的ChunkDataBuilder，这里需要dynamic_cast
+    BlockDescription自己根据BlockEffectID拿到对应的ChunkDataBuilder
 */
 
 /*
@@ -48,6 +49,40 @@ public:
     virtual void RenderShadow() const = 0;
 
     virtual const BlockEffect *GetBlockEffect() const noexcept = 0;
+
+    /**
+     * @brief 创建一份位于另一section处、共享同一份顶点数据的model
+     *
+     * 仅当顶点数据与section的位置无关时可以实现，默认返回nullptr表示不支持
+     */
+    virtual std::shared_ptr<const PartialSectionModel> CloneAt(const Vec3i &globalSectionPosition) const
+    {
+        return nullptr;
+    }
+
+    /**
+     * @brief 顶点和下标缓冲区占用的显存字节数，仅用于统计
+     */
+    virtual size_t GetMemoryUsage() const noexcept
+    {
+        return 0;
+    }
+
+    /**
+     * @brief 顶点数量，仅用于统计
+     */
+    virtual size_t GetVertexCount() const noexcept
+    {
+        return 0;
+    }
+
+    /**
+     * @brief 下标数量，仅用于统计
+     */
+    virtual size_t GetIndexCount() const noexcept
+    {
+        return 0;
+    }
 };
 
 class ModelBuilder
@@ -56,14 +91,94 @@ public:
 
     virtual ~ModelBuilder() = default;
 
+    /**
+     * @brief 丢弃已添加的数据，开始构建另一个section的模型
+     *
+     * 实现应保留内部缓冲区的容量，以便builder在多次section重建间复用
+     */
+    virtual void Reset(const Vec3i &globalSectionPosition) = 0;
+
     virtual std::shared_ptr<const PartialSectionModel> Build() = 0;
 };
 
+/**
+ * @brief section的六个面之间经由非完全遮光方块的连通关系
+ *
+ * 六个面两两组合共15种，每种占一位。视线只能从一个面穿过section到达与之连通的面，
+ * 据此可以在渲染前剔除被完全遮挡的section（如封闭的地下区域）
+ */
+class SectionConnectivity
+{
+    uint16_t bits_ = 0;
+
+    static int PairBit(Direction a, Direction b) noexcept
+    {
+        int lo = (std::min)(int(a), int(b));
+        int hi = (std::max)(int(a), int(b));
+        assert(lo != hi);
+        return 5 * lo - lo * (lo - 1) / 2 + (hi - lo - 1);
+    }
+
+public:
+
+    static constexpr uint16_t ALL_CONNECTED_BITS = (1 << 15) - 1;
+
+    static SectionConnectivity AllConnected() noexcept
+    {
+        SectionConnectivity ret;
+        ret.bits_ = ALL_CONNECTED_BITS;
+        return ret;
+    }
+
+    void Connect(Direction a, Direction b) noexcept
+    {
+        if(a != b)
+        {
+            bits_ |= uint16_t(1 << PairBit(a, b));
+        }
+    }
+
+    bool IsConnected(Direction a, Direction b) const noexcept
+    {
+        return a == b || (bits_ & (1 << PairBit(a, b))) != 0;
+    }
+
+    bool IsAllConnected() const noexcept
+    {
+        return bits_ == ALL_CONNECTED_BITS;
+    }
+
+    uint16_t GetBits() const noexcept
+    {
+        return bits_;
+    }
+};
+
+/**
+ * @brief section model的细节层次数量
+ *
+ * 第lodLevel层中，每SectionLODCellSize(lodLevel)^3个方块被合并为一个粗粒度的box，第0层即原精度
+ */
+constexpr int SECTION_LOD_LEVEL_COUNT = 3;
+
+constexpr int SectionLODCellSize(int lodLevel) noexcept
+{
+    return 1 << lodLevel;
+}
+
+static_assert(CHUNK_SECTION_SIZE_X % SectionLODCellSize(SECTION_LOD_LEVEL_COUNT - 1) == 0);
+static_assert(CHUNK_SECTION_SIZE_Y % SectionLODCellSize(SECTION_LOD_LEVEL_COUNT - 1) == 0);
+static_assert(CHUNK_SECTION_SIZE_Z % SectionLODCellSize(SECTION_LOD_LEVEL_COUNT - 1) == 0);
+
 class SectionModel
 {
 public:
 
     std::vector<std::shared_ptr<const PartialSectionModel>> partialModels;
+
+    int lodLevel = 0;
+
+    SectionConnectivity connectivity = SectionConnectivity::AllConnected();
 };
 
 class ChunkModel
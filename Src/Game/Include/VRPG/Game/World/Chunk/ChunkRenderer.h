@@ -1,5 +1,10 @@
 ﻿#pragma once
 
+#include <optional>
+#include <unordered_map>
+
+#include <VRPG/Game/Misc/BackToFrontSorter.h>
+#include <VRPG/Game/Misc/FrustumCuller.h>
 #include <VRPG/Game/World/Block/BlockEffect.h>
 
 VRPG_GAME_BEGIN
@@ -10,24 +15,112 @@ public:
 
     ChunkRenderer();
 
-    void AddPartialSectionModel(std::shared_ptr<const PartialSectionModel> model);
+    /**
+     * @brief 添加一个section model
+     *
+     * isCameraReachable为false表示摄像机的视线无法到达该section（见ChunkManager::FillRenderer），
+     * 这样的模型不参与前向渲染，但仍可以向摄像机能看到的区域投射阴影；半透明模型不投射阴影，因此直接被丢弃
+     */
+    void AddPartialSectionModel(std::shared_ptr<const PartialSectionModel> model, bool isCameraReachable = true);
+
+    /**
+     * @brief 设置区块中最高方块的y坐标，用于收紧该区块中section的包围盒
+     *
+     * 未设置的区块使用完整的section包围盒
+     */
+    void SetChunkMaxHeight(const ChunkPosition &position, int maxHeight);
 
     void Done();
 
+    /**
+     * @brief 计算当前摄像机下各section的可见性，供本帧的各个前向渲染pass共用
+     *
+     * 需在RenderForwardOpaque和RenderForwardTransparent之前调用
+     */
+    void UpdateCameraVisibility(const Camera &camera);
+
+    /**
+     * @brief 最近一次UpdateCameraVisibility的结果
+     */
+    struct CameraVisibilityStatistics
+    {
+        int frustumSectionCount = 0; // 位于视锥内的section数量
+        int visibleSectionCount = 0; // 位于视锥内且摄像机视线可达的section数量
+    };
+
+    CameraVisibilityStatistics GetCameraVisibilityStatistics() const noexcept;
+
     void RenderForwardOpaque(const ForwardRenderParams &params) const;
 
     void RenderForwardTransparent(const ForwardRenderParams &params) const;
 
+    /**
+     * @brief 渲染params.cascadeIndex所指定的shadow map
+     *
+     * 每个shadow map的阴影投射者列表按params.casterCullingViewProj挑选并缓存，
+     * 在params.casterCullingRevision不变且渲染队列未重新生成时直接复用
+     */
     void RenderShadow(const ShadowRenderParams &params) const;
 
     void Clear();
 
 private:
 
-    using ChunkModelSet = std::vector<std::shared_ptr<const PartialSectionModel>>;
+    struct ModelRecord
+    {
+        std::shared_ptr<const PartialSectionModel> model;
+        uint32_t sectionIndex = 0;
+        bool isCameraReachable = true;
+    };
+
+    // 一个区块中所有section的包围盒之并，及其section在sectionBoundingBoxes_中的下标范围
+    struct ChunkColumn
+    {
+        CullingBoundingBox boundingBox;
+        uint32_t firstSection = 0;
+        uint32_t endSection   = 0;
+    };
+
+    using ChunkModelSet = std::vector<ModelRecord>;
+
+    static constexpr int SHADOW_CASCADE_COUNT = 3;
+
+    // 某个shadow map的阴影投射者，casters[i]为modelSets_[i]中被选中的模型
+    struct ShadowCasterSet
+    {
+        bool isValid = false;
+        uint64_t cullingRevision = 0;
+        std::vector<std::vector<const PartialSectionModel*>> casters;
+    };
+
+    void UpdateShadowCasters(const ShadowRenderParams &params) const;
+
+    void ComputeVisibility(const FrustumCuller &culler, std::vector<uint64_t> &visibility) const;
+
+    static bool IsVisible(const std::vector<uint64_t> &visibility, uint32_t sectionIndex) noexcept;
+
+    static int CountVisibleSections(const std::vector<uint64_t> &visibility) noexcept;
 
     std::vector<ChunkModelSet> modelSets_;
     mutable ChunkModelSet transparentModelSet_;
+
+    std::unordered_map<ChunkPosition, int> chunkMaxHeights_;
+
+    std::vector<ChunkColumn> chunkColumns_;
+    CullingBoundingBoxArray sectionBoundingBoxes_;
+
+    // 摄像机视线可达的section，前向渲染只考虑这些section；阴影投射者则从所有section中挑选
+    std::vector<uint64_t> reachableSections_;
+
+    std::vector<uint64_t> cameraVisibility_;
+    CameraVisibilityStatistics cameraVisibilityStatistics_;
+    mutable std::vector<uint64_t> shadowVisibility_;
+    mutable ShadowCasterSet shadowCasterSets_[SHADOW_CASCADE_COUNT];
+
+    // 半透明section按由远到近排序，只在摄像机跨越方块边界或渲染队列重新生成后重新排序
+    mutable std::optional<Vec3i> transparentSortedEyeBlock_;
+    mutable std::vector<uint16_t> transparentSortKeys_;
+    mutable BackToFrontSorter<ModelRecord> transparentSorter_;
 };
 
 VRPG_GAME_END
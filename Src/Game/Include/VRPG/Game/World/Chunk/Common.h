@@ -28,6 +28,12 @@ constexpr int CHUNK_SIZE_X = CHUNK_SECTION_SIZE_X * CHUNK_SECTION_COUNT_X;
 constexpr int CHUNK_SIZE_Y = CHUNK_SECTION_SIZE_Y * CHUNK_SECTION_COUNT_Y;
 constexpr int CHUNK_SIZE_Z = CHUNK_SECTION_SIZE_Z * CHUNK_SECTION_COUNT_Z;
 
+// section向外扩展一圈方块后的尺寸，用于构建section model时的邻居查询
+
+constexpr int CHUNK_SECTION_PADDED_SIZE_X = CHUNK_SECTION_SIZE_X + 2;
+constexpr int CHUNK_SECTION_PADDED_SIZE_Y = CHUNK_SECTION_SIZE_Y + 2;
+constexpr int CHUNK_SECTION_PADDED_SIZE_Z = CHUNK_SECTION_SIZE_Z + 2;
+
 struct ChunkPosition
 {
     int x = 0;
@@ -7,6 +7,7 @@ inline ChunkBlockData::ChunkBlockData(const ChunkBlockData &copyFrom)
     std::memcpy(blockID_, copyFrom.blockID_, sizeof(blockID_));
     std::memcpy(orientations_, copyFrom.orientations_, sizeof(orientations_));
     std::memcpy(heightMap_, copyFrom.heightMap_, sizeof(heightMap_));
+    std::memcpy(collisionMask_, copyFrom.collisionMask_, sizeof(collisionMask_));
     extraData_ = copyFrom.extraData_;
 }
 
@@ -15,6 +16,7 @@ inline ChunkBlockData &ChunkBlockData::operator=(const ChunkBlockData &copyFrom)
     std::memcpy(blockID_, copyFrom.blockID_, sizeof(blockID_));
     std::memcpy(orientations_, copyFrom.orientations_, sizeof(orientations_));
     std::memcpy(heightMap_, copyFrom.heightMap_, sizeof(heightMap_));
+    std::memcpy(collisionMask_, copyFrom.collisionMask_, sizeof(collisionMask_));
     extraData_ = copyFrom.extraData_;
     return *this;
 }
@@ -24,6 +26,7 @@ inline ChunkBlockData::ChunkBlockData(ChunkBlockData &&moveFrom) noexcept
     std::memcpy(blockID_, moveFrom.blockID_, sizeof(blockID_));
     std::memcpy(orientations_, moveFrom.orientations_, sizeof(orientations_));
     std::memcpy(heightMap_, moveFrom.heightMap_, sizeof(heightMap_));
+    std::memcpy(collisionMask_, moveFrom.collisionMask_, sizeof(collisionMask_));
     extraData_ = std::move(moveFrom.extraData_);
 }
 
@@ -32,6 +35,7 @@ inline ChunkBlockData &ChunkBlockData::operator=(ChunkBlockData &&moveFrom) noex
     std::memcpy(blockID_, moveFrom.blockID_, sizeof(blockID_));
     std::memcpy(orientations_, moveFrom.orientations_, sizeof(orientations_));
     std::memcpy(heightMap_, moveFrom.heightMap_, sizeof(heightMap_));
+    std::memcpy(collisionMask_, moveFrom.collisionMask_, sizeof(collisionMask_));
     extraData_ = std::move(moveFrom.extraData_);
     return *this;
 }
@@ -59,6 +63,22 @@ inline int ChunkBlockData::GetHeight(int blockInChunkX, int blockInChunkZ) const
     return heightMap_[blockInChunkX][blockInChunkZ];
 }
 
+inline bool ChunkBlockData::HasCollision(const Vec3i &blockInChunk) const noexcept
+{
+    assert(0 <= blockInChunk.x && blockInChunk.x < CHUNK_SIZE_X);
+    assert(0 <= blockInChunk.y && blockInChunk.y < CHUNK_SIZE_Y);
+    assert(0 <= blockInChunk.z && blockInChunk.z < CHUNK_SIZE_Z);
+    return (collisionMask_[blockInChunk.x][blockInChunk.z][blockInChunk.y / 64] >> (blockInChunk.y % 64)) & 1;
+}
+
+inline uint64_t ChunkBlockData::GetCollisionMaskWord(int blockInChunkX, int blockInChunkZ, int wordIndex) const noexcept
+{
+    assert(0 <= blockInChunkX && blockInChunkX < CHUNK_SIZE_X);
+    assert(0 <= blockInChunkZ && blockInChunkZ < CHUNK_SIZE_Z);
+    assert(0 <= wordIndex && wordIndex < CHUNK_SIZE_Y / 64);
+    return collisionMask_[blockInChunkX][blockInChunkZ][wordIndex];
+}
+
 inline const BlockExtraData *ChunkBlockData::GetExtraData(const Vec3i &blockInChunk) const
 {
     assert(0 <= blockInChunk.x && blockInChunk.x < CHUNK_SIZE_X);
@@ -95,6 +115,7 @@ inline void ChunkBlockData::SetID(const Vec3i &blockInChunk, BlockID id, BlockOr
 
     blockID_[blockInChunk.x][blockInChunk.z][blockInChunk.y] = id;
     orientations_[blockInChunk.x][blockInChunk.z][blockInChunk.y] = orientation;
+    UpdateCollisionMask(blockInChunk, id);
 }
 
 inline void ChunkBlockData::SetID(const Vec3i &blockInChunk, BlockID id, BlockOrientation orientation, BlockExtraData extraData) noexcept
@@ -115,6 +136,21 @@ inline void ChunkBlockData::SetID(const Vec3i &blockInChunk, BlockID id, BlockOr
 
     blockID_[blockInChunk.x][blockInChunk.z][blockInChunk.y] = id;
     orientations_[blockInChunk.x][blockInChunk.z][blockInChunk.y] = orientation;
+    UpdateCollisionMask(blockInChunk, id);
+}
+
+inline void ChunkBlockData::UpdateCollisionMask(const Vec3i &blockInChunk, BlockID id) noexcept
+{
+    uint64_t &word = collisionMask_[blockInChunk.x][blockInChunk.z][blockInChunk.y / 64];
+    uint64_t bit = uint64_t(1) << (blockInChunk.y % 64);
+    if(BlockDescManager::GetInstance().HasCollision(id))
+    {
+        word |= bit;
+    }
+    else
+    {
+        word &= ~bit;
+    }
 }
 
 inline void ChunkBlockData::SetHeight(int blockInChunkX, int blockInChunkZ, int height) noexcept
@@ -176,6 +212,16 @@ inline int Chunk::GetHeight(int blockInChunkX, int blockInChunkZ) const noexcept
     return block_.GetHeight(blockInChunkX, blockInChunkZ);
 }
 
+inline bool Chunk::HasCollision(const Vec3i &blockInChunk) const noexcept
+{
+    return block_.HasCollision(blockInChunk);
+}
+
+inline uint64_t Chunk::GetCollisionMaskWord(int blockInChunkX, int blockInChunkZ, int wordIndex) const noexcept
+{
+    return block_.GetCollisionMaskWord(blockInChunkX, blockInChunkZ, wordIndex);
+}
+
 inline const BlockExtraData *Chunk::GetExtraData(const Vec3i &blockInChunk) const
 {
     return block_.GetExtraData(blockInChunk);
@@ -86,7 +86,13 @@ bool ChunkBlockDataPool::ForGivenChunkPosition(const ChunkPosition &position, Fu
 
 inline void ChunkBlockDataPool::ModifyBlockIDInPool(const Vec3i &blockPosition, BlockID id, BlockOrientation orientation)
 {
-    dataModifyTaskQueue_.push({ blockPosition, id, orientation });
+    auto [ckPos, blkPos] = DecomposeGlobalBlockByChunk(blockPosition);
+    ModifyBlocksInPool(ckPos, { { blkPos, id, orientation } });
+}
+
+inline void ChunkBlockDataPool::ModifyBlocksInPool(const ChunkPosition &chunkPosition, std::vector<BlockModification> modifications)
+{
+    dataModifyTaskQueue_.push({ chunkPosition, std::move(modifications) });
 }
 
 inline void ChunkBlockDataPool::DataModifierFunc()
@@ -100,25 +106,36 @@ inline void ChunkBlockDataPool::DataModifierFunc()
         }
 
         auto &task = *optTask;
-        auto [ckPos, blkPos] = DecomposeGlobalBlockByChunk(task.globalBlockPosition);
-
-        ForGivenChunkPosition({ ckPos.x, ckPos.z }, [&](ChunkBlockData &blockData)
+        ForGivenChunkPosition(task.chunkPosition, [&](ChunkBlockData &blockData)
         {
-            blockData.SetID(blkPos, task.newBlockID, task.newBlockOrientation);
+            // 记录每一列中被修改的最高位置，所有修改完成后再逐列更新高度
+
+            int maxModifiedY[CHUNK_SIZE_X][CHUNK_SIZE_Z];
+            std::fill(&maxModifiedY[0][0], &maxModifiedY[0][0] + CHUNK_SIZE_X * CHUNK_SIZE_Z, -1);
 
-            int oldHeight = blockData.GetHeight(blkPos.x, blkPos.z);
-            if(blkPos.y > oldHeight &&task.newBlockID != BLOCK_ID_VOID)
+            for(auto &modification : task.modifications)
             {
-                blockData.SetHeight(blkPos.x, blkPos.z, blkPos.y);
+                auto &blkPos = modification.blockInChunk;
+                blockData.SetID(blkPos, modification.id, modification.orientation);
+                maxModifiedY[blkPos.x][blkPos.z] = (std::max)(maxModifiedY[blkPos.x][blkPos.z], blkPos.y);
             }
-            else if(blkPos.y == oldHeight && task.newBlockID == BLOCK_ID_VOID)
+
+            for(int x = 0; x < CHUNK_SIZE_X; ++x)
             {
-                int newHeight = blkPos.y;
-                while(newHeight >= 0 && blockData.GetID(blkPos))
+                for(int z = 0; z < CHUNK_SIZE_Z; ++z)
                 {
-                    --newHeight;
+                    if(maxModifiedY[x][z] < 0)
+                    {
+                        continue;
+                    }
+
+                    int newHeight = (std::max)(blockData.GetHeight(x, z), maxModifiedY[x][z]);
+                    while(newHeight >= 0 && blockData.GetID({ x, newHeight, z }) == BLOCK_ID_VOID)
+                    {
+                        --newHeight;
+                    }
+                    blockData.SetHeight(x, z, newHeight);
                 }
-                blockData.SetHeight(blkPos.x, blkPos.z, newHeight);
             }
         });
     }
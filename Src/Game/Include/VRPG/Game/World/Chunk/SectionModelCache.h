@@ -0,0 +1,89 @@
+﻿#pragma once
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include <VRPG/Game/World/Chunk/ChunkModel.h>
+
+VRPG_GAME_BEGIN
+
+/**
+ * @brief section输入内容的哈希值，由两个以不同方式计算的64位哈希组成
+ *
+ * key用于在缓存中查找，check在命中时与缓存项记录的值比较，只有二者同时冲突时才会误用其他section的模型
+ */
+struct SectionContentHash
+{
+    uint64_t key   = 0;
+    uint64_t check = 0;
+};
+
+/**
+ * @brief 以section内容哈希为键的section model缓存
+ *
+ * 区块卸载后重新加载、方块被改回原样等情况下，section的输入往往与不久前生成过的某个section完全相同，
+ * 此时可直接复用已有的模型。顶点数据与section位置无关的partial model（见PartialSectionModel::CloneAt）
+ * 还可以被不同位置上内容相同的section共享，如平坦世界中同一高度的所有section。
+ *
+ * 缓存的是已上传到显存的模型而非CPU侧的网格数据，命中时可省去网格生成和上传两部分开销，
+ * 代价是缓存占用显存，其用量见Statistics::memoryUsage。
+ *
+ * 缓存按最近最少使用的顺序淘汰，所有公开接口均为线程安全
+ */
+class SectionModelCache : public Base::Singleton<SectionModelCache>
+{
+public:
+
+    struct Statistics
+    {
+        uint64_t hitCount    = 0;
+        uint64_t missCount   = 0;
+        size_t   entryCount  = 0;
+        size_t   memoryUsage = 0; // 被缓存的模型占用的显存字节数
+    };
+
+    /**
+     * @brief 设置最多缓存的section model数量，为0时禁用缓存
+     */
+    void SetCapacity(size_t capacity);
+
+    /**
+     * @brief 查找内容哈希为contentHash的section model
+     *
+     * 命中时返回位于globalSectionPosition处的model。
+     * 缓存项的contentHash.check与查询不同（即key发生了冲突），或缓存的model位于其他位置且无法被复用时视为未命中
+     */
+    std::unique_ptr<SectionModel> Find(const SectionContentHash &contentHash, const Vec3i &globalSectionPosition);
+
+    /**
+     * @brief 记录位于globalSectionPosition处、内容哈希为contentHash的section model
+     */
+    void Insert(const SectionContentHash &contentHash, const Vec3i &globalSectionPosition, const SectionModel &model);
+
+    Statistics GetStatistics() const;
+
+private:
+
+    struct Entry
+    {
+        SectionContentHash contentHash;
+        Vec3i globalSectionPosition;
+        SectionModel model;
+        size_t memoryUsage = 0;
+    };
+
+    void EvictUntil(size_t maxEntryCount);
+
+    mutable std::mutex mutex_;
+
+    size_t capacity_ = 0;
+
+    // 越靠前的项越近被使用
+    std::list<Entry> entries_;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> hash2Entry_;
+
+    Statistics statistics_;
+};
+
+VRPG_GAME_END
@@ -0,0 +1,124 @@
+﻿#pragma once
+
+#include <optional>
+
+#include <VRPG/Game/World/Chunk/Chunk.h>
+#include <VRPG/Game/World/Chunk/SectionModelCache.h>
+
+VRPG_GAME_BEGIN
+
+/**
+ * @brief 构建section model时使用的临时方块数组
+ *
+ * 将section及其外围一圈方块的种类、朝向和亮度一次性拷贝到连续的
+ * CHUNK_SECTION_PADDED_SIZE_X * CHUNK_SECTION_PADDED_SIZE_Z * CHUNK_SECTION_PADDED_SIZE_Y数组中（以[x][z][y]排列），
+ * 此后对任意方块邻居的查询都只是固定步长的数组访问。
+ * 每个方块只占8字节，方块的其他属性通过BlockDescManager中按ID存放的表查询；
+ * extraData的指针存放在另一个布局相同的数组中，只为携带额外数据的方块写入
+ *
+ * 填充时还会为每一列方块构建实体方块（见BlockDescManager::IsSolidBox）的位掩码，
+ * 据此以移位和按位与批量求出被实体方块完全包围、因而不可能产生任何可见面的实体方块
+ */
+class SectionScratchVolume
+{
+public:
+
+    SectionScratchVolume();
+
+    /**
+     * @brief 用neighboringChunks[1][1]中指定section及其外围的方块填充此数组
+     *
+     * 超出世界高度范围的方块被视为亮度为零的空方块
+     */
+    void Fill(const Vec3i &sectionInChunk, const Chunk *neighboringChunks[3][3]);
+
+    /**
+     * @brief 取得section中的某个方块，blockInSection的各分量可以取-1或section尺寸以访问外围方块
+     */
+    const CompactBlockInstance &GetBlock(const Vec3i &blockInSection) const noexcept
+    {
+        return blocks_[Index(blockInSection)];
+    }
+
+    /**
+     * @brief 计算section及其外围方块的种类、朝向和亮度的哈希值，与lodLevel一同作为模型缓存的键
+     *
+     * 携带额外数据的方块无法参与哈希，包含这类方块时返回std::nullopt
+     */
+    std::optional<SectionContentHash> ComputeContentHash(int lodLevel) const noexcept;
+
+    /**
+     * @brief 计算section的六个面之间经由非完全遮光方块的连通关系
+     */
+    SectionConnectivity ComputeConnectivity();
+
+    /**
+     * @brief 生成section的LOD模型中粗粒度的box面片
+     *
+     * section被划分为cellSize^3的格子，每个格子取其中数量最多的、支持LOD的方块（见BlockDescription::HasLODModel），
+     * 这类方块不足半数时格子为空。
+     * section边界上的面片依据原精度的方块数据生成：只要边界处有支持LOD的方块暴露在外，即使其所在格子为空也会生成面片，
+     * 因此无论相邻section处于哪个细节层次，二者之间都不会出现裂缝
+     */
+    void AddLODModel(ModelBuilderSet &modelBuilders, const Vec3i &globalSectionPosition, int cellSize);
+
+    /**
+     * @brief 取得section中(x, z)列上需要生成模型的方块
+     *
+     * 返回值的第y位为1表示blockInSection = (x, y, z)的方块可能存在可见面，需要进一步生成模型；
+     * 为0表示该方块为实体方块，且六个方向上的邻居也都是实体方块
+     */
+    uint32_t GetExposedMask(int x, int z) const noexcept
+    {
+        assert(0 <= x && x < CHUNK_SECTION_SIZE_X);
+        assert(0 <= z && z < CHUNK_SECTION_SIZE_Z);
+        return exposedMask_[x][z];
+    }
+
+    /**
+     * @brief 取得section中某个方块及其邻居，要求blockInSection位于section内部
+     */
+    BlockNeighborhood GetNeighborhood(const Vec3i &blockInSection) const noexcept
+    {
+        assert(0 <= blockInSection.x && blockInSection.x < CHUNK_SECTION_SIZE_X);
+        assert(0 <= blockInSection.y && blockInSection.y < CHUNK_SECTION_SIZE_Y);
+        assert(0 <= blockInSection.z && blockInSection.z < CHUNK_SECTION_SIZE_Z);
+        const int index = Index(blockInSection);
+        return BlockNeighborhood(&blocks_[index], &extraData_[index]);
+    }
+
+private:
+
+    static int Index(const Vec3i &blockInSection) noexcept
+    {
+        assert(-1 <= blockInSection.x && blockInSection.x <= CHUNK_SECTION_SIZE_X);
+        assert(-1 <= blockInSection.y && blockInSection.y <= CHUNK_SECTION_SIZE_Y);
+        assert(-1 <= blockInSection.z && blockInSection.z <= CHUNK_SECTION_SIZE_Z);
+        return (blockInSection.x + 1) * BlockNeighborhood::STRIDE_X
+             + (blockInSection.z + 1) * BlockNeighborhood::STRIDE_Z
+             + (blockInSection.y + 1) * BlockNeighborhood::STRIDE_Y;
+    }
+
+    void ComputeExposedMasks() noexcept;
+
+    std::vector<CompactBlockInstance> blocks_;
+
+    // 与blocks_布局相同，只有携带额外数据的方块对应的元素有效
+    std::vector<const BlockExtraData*> extraData_;
+
+    // 第y + 1位表示blockInSection = (x - 1, y, z - 1)处是否为实体方块
+    uint32_t solidMask_[CHUNK_SECTION_PADDED_SIZE_X][CHUNK_SECTION_PADDED_SIZE_Z] = {};
+
+    uint32_t exposedMask_[CHUNK_SECTION_SIZE_X][CHUNK_SECTION_SIZE_Z] = {};
+
+    // AddLODModel中每个格子的多数方块
+    std::vector<BlockID> lodCells_;
+
+    // ComputeConnectivity中flood fill使用的临时数据
+    std::vector<uint8_t> floodVisited_;
+    std::vector<Vec3i> floodStack_;
+
+    static_assert(CHUNK_SECTION_PADDED_SIZE_Y <= 32);
+};
+
+VRPG_GAME_END
@@ -29,18 +29,33 @@ void ShadowMapConfig::Load(const libconfig::Setting &setting)
     setting.lookupValue("DepthSlope",     depthSlope);
 
     setting.lookupValue("Distance", distance);
+
+    setting.lookupValue("FarCasterMargin", farCasterMargin);
 }
 
 void ShadowMapConfig::Print()
 {
-    PrintItem("ShadowMap::Enable",         enable);
-    PrintItem("ShadowMap::Resolution[0]",  resolution[0]);
-    PrintItem("ShadowMap::Resolution[1]",  resolution[1]);
-    PrintItem("ShadowMap::Resolution[2]",  resolution[2]);
-    PrintItem("ShadowMap::DepthBias",      depthBias);
-    PrintItem("ShadowMap::DepthBiasClamp", depthBiasClamp);
-    PrintItem("ShadowMap::DepthSlope",     depthSlope);
-    PrintItem("ShadowMap::Distance",       distance);
+    PrintItem("ShadowMap::Enable",          enable);
+    PrintItem("ShadowMap::Resolution[0]",   resolution[0]);
+    PrintItem("ShadowMap::Resolution[1]",   resolution[1]);
+    PrintItem("ShadowMap::Resolution[2]",   resolution[2]);
+    PrintItem("ShadowMap::DepthBias",       depthBias);
+    PrintItem("ShadowMap::DepthBiasClamp",  depthBiasClamp);
+    PrintItem("ShadowMap::DepthSlope",      depthSlope);
+    PrintItem("ShadowMap::Distance",        distance);
+    PrintItem("ShadowMap::FarCasterMargin", farCasterMargin);
+}
+
+void BlockUpdaterConfig::Load(const libconfig::Setting &setting)
+{
+    setting.lookupValue("ThreadCount", threadCount);
+    setting.lookupValue("TimeBudget",  timeBudget);
+}
+
+void BlockUpdaterConfig::Print()
+{
+    PrintItem("BlockUpdater::ThreadCount", threadCount);
+    PrintItem("BlockUpdater::TimeBudget",  timeBudget);
 }
 
 void ChunkManagerConfig::Load(const libconfig::Setting &setting)
@@ -49,8 +64,17 @@ void ChunkManagerConfig::Load(const libconfig::Setting &setting)
     setting.lookupValue("LoadDistance",   loadDistance);
     setting.lookupValue("UnloadDistance", unloadDistance);
 
+    setting.lookupValue("SimulationDistance", simulationDistance);
+
+    setting.lookupValue("FullDetailDistance", fullDetailDistance);
+    setting.lookupValue("HalfDetailDistance", halfDetailDistance);
+
     setting.lookupValue("BackgroundPoolSize",    backgroundPoolSize);
     setting.lookupValue("BackgroundThreadCount", backgroundThreadCount);
+
+    setting.lookupValue("EnableGreedyMeshing", enableGreedyMeshing);
+
+    setting.lookupValue("SectionModelCacheSize", sectionModelCacheSize);
 }
 
 void ChunkManagerConfig::Print()
@@ -58,8 +82,13 @@ void ChunkManagerConfig::Print()
     PrintItem("ChunkManager::RenderDistance",        renderDistance);
     PrintItem("ChunkManager::LoadDistance",          loadDistance);
     PrintItem("ChunkManager::UnloadDistance",        unloadDistance);
+    PrintItem("ChunkManager::SimulationDistance",    simulationDistance);
+    PrintItem("ChunkManager::FullDetailDistance",    fullDetailDistance);
+    PrintItem("ChunkManager::HalfDetailDistance",    halfDetailDistance);
     PrintItem("ChunkManager::BackgroundPoolSize",    backgroundPoolSize);
     PrintItem("ChunkManager::BackgroundThreadCount", backgroundThreadCount);
+    PrintItem("ChunkManager::EnableGreedyMeshing",   enableGreedyMeshing);
+    PrintItem("ChunkManager::SectionModelCacheSize", sectionModelCacheSize);
 }
 
 void PlayerConfig::Load(const libconfig::Setting &setting)
@@ -150,8 +179,22 @@ void MiscConfig::Print()
     PrintItem("Misc::EnableChosenBlockWireframe", enableChoseBlockWireframe);
 }
 
+void NavigationConfig::Load(const libconfig::Setting &setting)
+{
+    setting.lookupValue("ThreadCount",      threadCount);
+    setting.lookupValue("MaxSearchRegions", maxSearchRegions);
+    setting.lookupValue("SnapshotBudget",   snapshotBudget);
+}
+
+void NavigationConfig::Print()
+{
+    PrintItem("Navigation::ThreadCount",      threadCount);
+    PrintItem("Navigation::MaxSearchRegions", maxSearchRegions);
+    PrintItem("Navigation::SnapshotBudget",   snapshotBudget);
+}
+
 GlobalConfig::GlobalConfig()
-    : CHUNK_MANAGER(chunkManager_), MISC(misc_), PLAYER(player_), SHADOW_MAP(shadowMap_), WINDOW(window_)
+    : BLOCK_UPDATER(blockUpdater_), CHUNK_MANAGER(chunkManager_), MISC(misc_), NAVIGATION(navigation_), PLAYER(player_), SHADOW_MAP(shadowMap_), WINDOW(window_)
 {
     
 }
@@ -161,6 +204,11 @@ void GlobalConfig::LoadFromFile(const char *configFilename)
     libconfig::Config config;
     config.readFile(configFilename);
 
+    if(config.exists("BlockUpdater"))
+    {
+        blockUpdater_.Load(config.lookup("BlockUpdater"));
+    }
+
     if(config.exists("ChunkManager"))
     {
         chunkManager_.Load(config.lookup("ChunkManager"));
@@ -171,6 +219,11 @@ void GlobalConfig::LoadFromFile(const char *configFilename)
         misc_.Load(config.lookup("Misc"));
     }
 
+    if(config.exists("Navigation"))
+    {
+        navigation_.Load(config.lookup("Navigation"));
+    }
+
     if(config.exists("Player"))
     {
         player_.Load(config.lookup("Player"));
@@ -186,8 +239,10 @@ void GlobalConfig::LoadFromFile(const char *configFilename)
         window_.Load(config.lookup("Window"));
     }
 
+    blockUpdater_.Print();
     chunkManager_.Print();
     misc_        .Print();
+    navigation_  .Print();
     player_      .Print();
     shadowMap_   .Print();
     window_      .Print();
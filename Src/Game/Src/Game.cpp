@@ -4,7 +4,7 @@
 #include <VRPG/Game/Game.h>
 #include <VRPG/Game/World/Block/BuiltinBlock.h>
 #include <VRPG/Game/World/Land/FlatLandGenerator.h>
-#include <VRPG/Game/World/BlockUpdater/LiquidUpdater.h>
+#include <VRPG/Game/World/Chunk/SectionModelCache.h>
 
 VRPG_GAME_BEGIN
 
@@ -83,16 +83,30 @@ void Game::Initialize()
 
     spdlog::info("initialize chunk manager");
 
+    SectionModelCache::GetInstance().SetCapacity(size_t((std::max)(0, GLOBAL_CONFIG.CHUNK_MANAGER.sectionModelCacheSize)));
+
     ChunkManagerParams chunkMgrParams;
     chunkMgrParams.unloadDistance        = GLOBAL_CONFIG.CHUNK_MANAGER.unloadDistance;
     chunkMgrParams.loadDistance          = GLOBAL_CONFIG.CHUNK_MANAGER.loadDistance;
     chunkMgrParams.renderDistance        = GLOBAL_CONFIG.CHUNK_MANAGER.renderDistance;
+    chunkMgrParams.simulationDistance    = GLOBAL_CONFIG.CHUNK_MANAGER.simulationDistance;
+    chunkMgrParams.fullDetailDistance    = GLOBAL_CONFIG.CHUNK_MANAGER.fullDetailDistance;
+    chunkMgrParams.halfDetailDistance    = GLOBAL_CONFIG.CHUNK_MANAGER.halfDetailDistance;
     chunkMgrParams.backgroundPoolSize    = GLOBAL_CONFIG.CHUNK_MANAGER.backgroundPoolSize;
     chunkMgrParams.backgroundThreadCount = GLOBAL_CONFIG.CHUNK_MANAGER.backgroundThreadCount;
     chunkManager_ = std::make_unique<ChunkManager>(chunkMgrParams, std::make_unique<FlatLandGenerator>(20));
 
     spdlog::info("initialize block updater");
-    blockUpdaterManager_ = std::make_unique<BlockUpdaterManager>(chunkManager_.get());
+    blockUpdaterManager_ = std::make_unique<BlockUpdaterManager>(
+        chunkManager_.get(), GLOBAL_CONFIG.BLOCK_UPDATER.threadCount);
+    liquidUpdater_       = blockUpdaterManager_->RegisterUpdater<LiquidUpdater>();
+
+    spdlog::info("initialize entity physics");
+    EntityPhysicsParams entityPhysicsParams;
+    entityPhysicsParams.gravityAccel    = GLOBAL_CONFIG.PLAYER.gravityAccel;
+    entityPhysicsParams.gravityMaxSpeed = GLOBAL_CONFIG.PLAYER.gravityMaxSpeed;
+    entityPhysics_ = std::make_unique<EntityPhysics>(
+        entityPhysicsParams, chunkManager_.get(), &blockUpdaterManager_->GetWorkerPool());
 
     spdlog::info("initialize chosen block wireframe renderer");
     chosenBlockWireframeRenderer_ = std::make_unique<ChosenWireframeRenderer>();
@@ -146,6 +160,18 @@ void Game::Initialize()
 
     player_ = std::make_unique<Player>(playerParams, *chunkManager_, Vec3{ 0, 40, 0 }, camera);
 
+    spdlog::info("initialize navigation service");
+    NavigationServiceParams navigationParams;
+    navigationParams.agent            = NavigationAgentParams::FromCylinder(playerParams.collisionRadius, playerParams.collisionHeight);
+    navigationParams.threadCount      = (std::max)(1, GLOBAL_CONFIG.NAVIGATION.threadCount);
+    navigationParams.maxSearchRegions = GLOBAL_CONFIG.NAVIGATION.maxSearchRegions;
+    navigationParams.snapshotBudget   = GLOBAL_CONFIG.NAVIGATION.snapshotBudget;
+    navigationService_ = std::make_unique<NavigationService>(navigationParams, chunkManager_.get());
+    navigationSubscriber_ = chunkManager_->AddBlockChangeSubscriber([this](const Vec3i &globalBlock)
+    {
+        navigationService_->OnBlockChanged(globalBlock);
+    });
+
     spdlog::info("hide cursor");
 
     HideCursor();
@@ -154,8 +180,16 @@ void Game::Initialize()
 
 void Game::Destroy()
 {
+    spdlog::info("destroy navigation service");
+    chunkManager_->RemoveBlockChangeSubscriber(navigationSubscriber_);
+    navigationService_.reset();
+
+    spdlog::info("destroy entity physics");
+    entityPhysics_.reset();
+
     spdlog::info("destroy block updater manager");
     blockUpdaterManager_.reset();
+    liquidUpdater_ = nullptr;
 
     spdlog::info("destroy immediate2D && crosshairPainter");
     imm2D_.reset();
@@ -190,7 +224,7 @@ void Game::PlayerTick(float deltaT)
         {
             chunkManager_->SetBlockID(pickedBlockPosition, BLOCK_ID_VOID, {});
 
-            LiquidUpdater::AddUpdaterForNeighborhood(
+            liquidUpdater_->AddUpdaterForNeighborhood(
                 pickedBlockPosition, *blockUpdaterManager_, *chunkManager_, StdClock::now());
         }
         else if(mouse_->IsMouseButtonDown(Base::MouseButton::Right))
@@ -213,7 +247,7 @@ void Game::PlayerTick(float deltaT)
                 auto extraData = MakeLiquidExtraData(waterDesc->GetLiquid()->sourceLevel);
                 chunkManager_->SetBlockID(
                     newBlockPosition, waterID, {}, std::move(extraData));
-                LiquidUpdater::AddUpdaterForNeighborhood(
+                liquidUpdater_->AddUpdaterForNeighborhood(
                     newBlockPosition, *blockUpdaterManager_, *chunkManager_, StdClock::now());
 
                 /*auto stoneDesc = BuiltinBlockTypeManager::GetInstance().GetDesc(BuiltinBlockType::Stone);
@@ -236,7 +270,12 @@ void Game::PlayerTick(float deltaT)
 
 void Game::WorldTick()
 {
-    blockUpdaterManager_->Execute(20, StdClock::now());
+    auto timeBudget = std::chrono::duration<float, std::milli>((std::max)(0.0f, GLOBAL_CONFIG.BLOCK_UPDATER.timeBudget));
+    blockUpdaterManager_->Execute(std::chrono::duration_cast<StdClock::duration>(timeBudget), StdClock::now());
+
+    entityPhysics_->Update(std::chrono::duration<float>(WORLD_TICK_INTERVAL).count());
+
+    navigationService_->Update();
 }
 
 void Game::ChunkTick()
@@ -251,10 +290,21 @@ void Game::ChunkTick()
     chunkManager_->UpdateLight();
     needToGenerateRenderer |= chunkManager_->UpdateChunkModels();
 
+    Vec3i cameraSection = GlobalBlockToGlobalSection({
+        int(std::floor(camera.GetPosition().x)),
+        int(std::floor(camera.GetPosition().y)),
+        int(std::floor(camera.GetPosition().z))
+    });
+    if(lastCameraSection_ != cameraSection)
+    {
+        lastCameraSection_ = cameraSection;
+        needToGenerateRenderer = true;
+    }
+
     if(needToGenerateRenderer)
     {
         chunkRenderer_->Clear();
-        chunkManager_->FillRenderer(*chunkRenderer_);
+        chunkManager_->FillRenderer(*chunkRenderer_, camera.GetPosition());
         chunkRenderer_->Done();
     }
 }
@@ -282,6 +332,28 @@ void Game::Render(int fps)
 
         Vec3 direction = camera.GetDirection();
         ImGui::Text("direction: (%f, %f, %f)", direction.x, direction.y, direction.z);
+
+        auto visibilityStatistics = chunkRenderer_->GetCameraVisibilityStatistics();
+        ImGui::Text("sections: %i visible / %i in frustum",
+            visibilityStatistics.visibleSectionCount, visibilityStatistics.frustumSectionCount);
+
+        auto cacheStatistics = SectionModelCache::GetInstance().GetStatistics();
+        uint64_t cacheQueryCount = cacheStatistics.hitCount + cacheStatistics.missCount;
+        ImGui::Text("section model cache: %.1f%% hit, %zu entries, %.1f MB",
+            cacheQueryCount ? 100.0 * cacheStatistics.hitCount / cacheQueryCount : 0.0,
+            cacheStatistics.entryCount, cacheStatistics.memoryUsage / (1024.0 * 1024.0));
+
+        auto updaterStatistics = blockUpdaterManager_->GetStatistics();
+        ImGui::Text("block updates: %zu pending (%zu suspended), %i per tick, lateness %.1f ms mean / %.1f ms max",
+            updaterStatistics.pendingCount, updaterStatistics.suspendedCount, updaterStatistics.executedCount,
+            updaterStatistics.meanLateness, updaterStatistics.maxLateness);
+
+        ImGui::Text("entity bodies: %zu", entityPhysics_->GetBodyCount());
+
+        auto navigationStatistics = navigationService_->GetStatistics();
+        ImGui::Text("navigation: %zu pending queries, %zu graphs, %zu snapshots, %.2f ms per query",
+            navigationStatistics.pendingQueryCount, navigationStatistics.cachedGraphCount,
+            navigationStatistics.cachedSnapshotCount, navigationStatistics.meanQueryTime);
     }
     ImGui::End();
 
@@ -290,7 +362,6 @@ void Game::Render(int fps)
     ShadowRenderParams shadowParams;
 
     CSM_->StartNear();
-    chunkRenderer_->RenderShadow(shadowParams);
     CSM_->FillNearShadowParams(shadowParams);
     chunkRenderer_->RenderShadow(shadowParams);
     player_->RenderShadow(shadowParams);
@@ -319,6 +390,7 @@ void Game::Render(int fps)
         params.skyLight = Vec3(1);
         CSM_->FillForwardParams(params);
 
+        chunkRenderer_->UpdateCameraVisibility(camera);
         chunkRenderer_->RenderForwardOpaque(params);
 
         player_->RenderForward(params);
@@ -22,13 +22,23 @@ public:
 
     void EndFar() override { }
 
-    void FillNearShadowParams(ShadowRenderParams &params) const noexcept override { params.shadowViewProj = Mat4::identity(); }
+    void FillNearShadowParams(ShadowRenderParams &params) const noexcept override { FillIdentityParams(params, 0); }
 
-    void FillMiddleShadowParams(ShadowRenderParams &params) const noexcept override { params.shadowViewProj = Mat4::identity(); }
+    void FillMiddleShadowParams(ShadowRenderParams &params) const noexcept override { FillIdentityParams(params, 1); }
 
-    void FillFarShadowParams(ShadowRenderParams &params) const noexcept override { params.shadowViewProj = Mat4::identity(); }
+    void FillFarShadowParams(ShadowRenderParams &params) const noexcept override { FillIdentityParams(params, 2); }
 
     void FillForwardParams(ForwardRenderParams &params) override { }
+
+private:
+
+    static void FillIdentityParams(ShadowRenderParams &params, int cascadeIndex) noexcept
+    {
+        params.shadowViewProj        = Mat4::identity();
+        params.cascadeIndex          = cascadeIndex;
+        params.casterCullingViewProj = Mat4::identity();
+        params.casterCullingRevision = 0;
+    }
 };
 
 class EnableCascadeShadowMapping : public CascadeShadowMapping
@@ -61,11 +71,24 @@ public:
 
 private:
 
-    static void UpdateViewProj(const Camera &camera, Mat4 viewProj[3], float cascadeZLimit[3]);
+    static void UpdateViewProj(
+        const Camera &camera, Mat4 viewProj[3], Mat4 casterCullingViewProj[2],
+        float cascadeZLimit[3], Vec3 &shadowDst, Vec4 &farShadowRect);
+
+    void UpdateFarCasterCulling(const Vec3 &shadowDst, const Vec4 &farShadowRect);
 
     Mat4 viewProj_[3];
     float cascadeZLimit_[3];
 
+    // near/middle SM的阴影投射者挑选视锥：xy范围与对应SM相同，沿光线方向一直延伸到光源处
+    Mat4 casterCullingViewProj_[2];
+
+    // far SM的阴影投射者挑选范围：光源空间中的(minX, minY, maxX, maxY)及其对应的视锥
+    Vec3 farCasterShadowDst_;
+    Vec4 farCasterRect_;
+    Mat4 farCasterCullingViewProj_;
+    uint64_t farCasterCullingRevision_;
+
     std::unique_ptr<Base::ShadowMap> nearSM_;
     std::unique_ptr<Base::ShadowMap> middleSM_;
     std::unique_ptr<Base::ShadowMap> farSM_;
@@ -146,7 +169,7 @@ std::unique_ptr<CascadeShadowMapping> CreateCascadeShadowMapping()
 }
 
 EnableCascadeShadowMapping::EnableCascadeShadowMapping()
-    : cascadeZLimit_{ 1, 1, 1 }
+    : cascadeZLimit_{ 1, 1, 1 }, farCasterCullingRevision_(0)
 {
     nearSM_ = std::make_unique<Base::ShadowMap>(
         GLOBAL_CONFIG.SHADOW_MAP.resolution[0], GLOBAL_CONFIG.SHADOW_MAP.resolution[0]);
@@ -158,7 +181,10 @@ EnableCascadeShadowMapping::EnableCascadeShadowMapping()
 
 void EnableCascadeShadowMapping::UpdateCSMParams(const Camera &camera)
 {
-    UpdateViewProj(camera, viewProj_, cascadeZLimit_);
+    Vec3 shadowDst;
+    Vec4 farShadowRect;
+    UpdateViewProj(camera, viewProj_, casterCullingViewProj_, cascadeZLimit_, shadowDst, farShadowRect);
+    UpdateFarCasterCulling(shadowDst, farShadowRect);
 }
 
 void EnableCascadeShadowMapping::StartNear()
@@ -193,17 +219,26 @@ void EnableCascadeShadowMapping::EndFar()
 
 void EnableCascadeShadowMapping::FillNearShadowParams(ShadowRenderParams &params) const noexcept
 {
-    params.shadowViewProj = viewProj_[0];
+    params.shadowViewProj        = viewProj_[0];
+    params.cascadeIndex          = 0;
+    params.casterCullingViewProj = casterCullingViewProj_[0];
+    params.casterCullingRevision = 0;
 }
 
 void EnableCascadeShadowMapping::FillMiddleShadowParams(ShadowRenderParams &params) const noexcept
 {
-    params.shadowViewProj = viewProj_[1];
+    params.shadowViewProj        = viewProj_[1];
+    params.cascadeIndex          = 1;
+    params.casterCullingViewProj = casterCullingViewProj_[1];
+    params.casterCullingRevision = 0;
 }
 
 void EnableCascadeShadowMapping::FillFarShadowParams(ShadowRenderParams &params) const noexcept
 {
-    params.shadowViewProj = viewProj_[2];
+    params.shadowViewProj        = viewProj_[2];
+    params.cascadeIndex          = 2;
+    params.casterCullingViewProj = farCasterCullingViewProj_;
+    params.casterCullingRevision = farCasterCullingRevision_;
 }
 
 namespace
@@ -233,12 +268,43 @@ void EnableCascadeShadowMapping::FillForwardParams(ForwardRenderParams &params)
     params.cascadeShadowMaps[2].homZLimit = cascadeZLimit_[2];
 }
 
-void EnableCascadeShadowMapping::UpdateViewProj(const Camera &camera, Mat4 viewProj[3], float cascadeZLimit[3])
+void EnableCascadeShadowMapping::UpdateFarCasterCulling(const Vec3 &shadowDst, const Vec4 &farShadowRect)
+{
+    // 光源视锥只在xy方向上限制投射者，沿光线方向不做剔除，因此位于far SM与太阳之间的投射者总会被选中
+    // 只要far SM仍位于上次挑选时外扩过的范围内，就沿用上次的挑选结果
+
+    bool reusable =
+        farCasterCullingRevision_ && shadowDst == farCasterShadowDst_ &&
+        farShadowRect.x >= farCasterRect_.x && farShadowRect.y >= farCasterRect_.y &&
+        farShadowRect.z <= farCasterRect_.z && farShadowRect.w <= farCasterRect_.w;
+    if(reusable)
+    {
+        return;
+    }
+
+    const float margin = GLOBAL_CONFIG.SHADOW_MAP.farCasterMargin;
+    farCasterShadowDst_ = shadowDst;
+    farCasterRect_ = {
+        farShadowRect.x - margin, farShadowRect.y - margin,
+        farShadowRect.z + margin, farShadowRect.w + margin
+    };
+
+    Mat4 shadowView = Trans4::look_at(shadowDst + 600.0f * SUN_DIR, shadowDst, Vec3(0, 1, 0));
+    Mat4 shadowProj = Trans4::orthographic(
+        farCasterRect_.x, farCasterRect_.z, farCasterRect_.w, farCasterRect_.y, 1, 1200);
+    farCasterCullingViewProj_ = shadowView * shadowProj;
+
+    ++farCasterCullingRevision_;
+}
+
+void EnableCascadeShadowMapping::UpdateViewProj(
+    const Camera &camera, Mat4 viewProj[3], Mat4 casterCullingViewProj[2],
+    float cascadeZLimit[3], Vec3 &shadowDst, Vec4 &farShadowRect)
 {
     float FOVy   = camera.GetFOVy();
     float wOverH = camera.GetWOverH();
 
-    Vec3 shadowDst = camera.GetPosition();
+    shadowDst = camera.GetPosition();
     shadowDst.x = std::floor(shadowDst.x / 50) * 50;
     shadowDst.y = std::floor(shadowDst.y / 50) * 50;
     shadowDst.z = std::floor(shadowDst.z / 50) * 50;
@@ -247,7 +313,8 @@ void EnableCascadeShadowMapping::UpdateViewProj(const Camera &camera, Mat4 viewP
         shadowDst + 600.0f * SUN_DIR, shadowDst, Vec3(0, 1, 0));
     Mat4 viewToShadow = camera.GetViewMatrix().inv() * shadowView;
 
-    auto constructSingleShadowMapVP = [&](float nearD, float farD, int shadowMapResolution)
+    auto constructSingleShadowMapVP = [&](
+        float nearD, float farD, int shadowMapResolution, Vec4 *shadowRect, Mat4 *cullingViewProj)
     {
         float nearYOri = nearD * std::tan(FOVy / 2);
         float nearXOri = wOverH * nearYOri;
@@ -322,9 +389,23 @@ void EnableCascadeShadowMapping::UpdateViewProj(const Camera &camera, Mat4 viewP
         minY = std::floor(minY / unitsPerPixelY) * unitsPerPixelY;
         maxY = std::floor(maxY / unitsPerPixelY) * unitsPerPixelY;
 
+        if(shadowRect)
+        {
+            *shadowRect = { minX, minY, maxX, maxY };
+        }
+
         Mat4 shadowProj = Trans4::orthographic(
             minX, maxX, maxY, minY, 300, maxZ + 5);
 
+        // 视锥外、位于SM与太阳之间的方块也可能向SM覆盖的区域投下阴影，
+        // 因此挑选投射者时把近平面拉到光源处，与far SM的挑选视锥保持一致
+        if(cullingViewProj)
+        {
+            Mat4 cullingProj = Trans4::orthographic(
+                minX, maxX, maxY, minY, 1, maxZ + 5);
+            *cullingViewProj = shadowView * cullingProj;
+        }
+
         return shadowView * shadowProj;
     };
 
@@ -339,9 +420,12 @@ void EnableCascadeShadowMapping::UpdateViewProj(const Camera &camera, Mat4 viewP
         return clipV.z;
     };
 
-    viewProj[0] = constructSingleShadowMapVP(distance0, distance1, GLOBAL_CONFIG.SHADOW_MAP.resolution[0]);
-    viewProj[1] = constructSingleShadowMapVP(distance1, distance2, GLOBAL_CONFIG.SHADOW_MAP.resolution[1]);
-    viewProj[2] = constructSingleShadowMapVP(distance2, distance3, GLOBAL_CONFIG.SHADOW_MAP.resolution[2]);
+    viewProj[0] = constructSingleShadowMapVP(
+        distance0, distance1, GLOBAL_CONFIG.SHADOW_MAP.resolution[0], nullptr, &casterCullingViewProj[0]);
+    viewProj[1] = constructSingleShadowMapVP(
+        distance1, distance2, GLOBAL_CONFIG.SHADOW_MAP.resolution[1], nullptr, &casterCullingViewProj[1]);
+    viewProj[2] = constructSingleShadowMapVP(
+        distance2, distance3, GLOBAL_CONFIG.SHADOW_MAP.resolution[2], &farShadowRect, nullptr);
 
     cascadeZLimit[0] = computeHomZLimit(distance1);
     cascadeZLimit[1] = computeHomZLimit(distance2);
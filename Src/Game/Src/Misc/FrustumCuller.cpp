@@ -0,0 +1,84 @@
+﻿#include <VRPG/Game/Misc/FrustumCuller.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VRPG_FRUSTUM_CULLER_SSE
+#include <emmintrin.h>
+#endif
+
+VRPG_GAME_BEGIN
+
+void FrustumCuller::ComputeVisibility(
+    const CullingBoundingBoxArray &boxes, size_t begin, size_t end, uint64_t *visibility) const noexcept
+{
+    assert(end <= boxes.GetSize());
+
+    // 裁剪面法线各分量的符号决定了p-vertex取包围盒的哪一侧，因此可以对每个裁剪面预先选好坐标数组
+
+    const float *px[CULLING_FACE_COUNT], *py[CULLING_FACE_COUNT], *pz[CULLING_FACE_COUNT];
+    for(int i = 0; i < CULLING_FACE_COUNT; ++i)
+    {
+        px[i] = cullingFaces_[i].x > 0 ? boxes.highX.data() : boxes.lowX.data();
+        py[i] = cullingFaces_[i].y > 0 ? boxes.highY.data() : boxes.lowY.data();
+        pz[i] = cullingFaces_[i].z > 0 ? boxes.highZ.data() : boxes.lowZ.data();
+    }
+
+    auto setVisible = [&](size_t index)
+    {
+        visibility[index / 64] |= uint64_t(1) << (index % 64);
+    };
+
+#ifdef VRPG_FRUSTUM_CULLER_SSE
+
+    static_assert(CullingBoundingBoxArray::BATCH_SIZE == 4);
+
+    __m128 fx[CULLING_FACE_COUNT], fy[CULLING_FACE_COUNT], fz[CULLING_FACE_COUNT], fw[CULLING_FACE_COUNT];
+    for(int i = 0; i < CULLING_FACE_COUNT; ++i)
+    {
+        fx[i] = _mm_set1_ps(cullingFaces_[i].x);
+        fy[i] = _mm_set1_ps(cullingFaces_[i].y);
+        fz[i] = _mm_set1_ps(cullingFaces_[i].z);
+        fw[i] = _mm_set1_ps(cullingFaces_[i].w);
+    }
+    const __m128 negEps = _mm_set1_ps(-CULLING_EPSILON);
+
+    for(size_t base = begin; base < end; base += CullingBoundingBoxArray::BATCH_SIZE)
+    {
+        __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for(int i = 0; i < CULLING_FACE_COUNT; ++i)
+        {
+            __m128 d = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(fx[i], _mm_loadu_ps(px[i] + base)), _mm_mul_ps(fy[i], _mm_loadu_ps(py[i] + base))),
+                _mm_add_ps(_mm_mul_ps(fz[i], _mm_loadu_ps(pz[i] + base)), fw[i]));
+            visible = _mm_and_ps(visible, _mm_cmpge_ps(d, negEps));
+        }
+
+        int mask = _mm_movemask_ps(visible);
+        for(size_t j = 0; j < CullingBoundingBoxArray::BATCH_SIZE && base + j < end; ++j)
+        {
+            if(mask & (1 << j))
+            {
+                setVisible(base + j);
+            }
+        }
+    }
+
+#else
+
+    for(size_t index = begin; index < end; ++index)
+    {
+        bool visible = true;
+        for(int i = 0; i < CULLING_FACE_COUNT && visible; ++i)
+        {
+            const Vec4 &f = cullingFaces_[i];
+            visible = f.x * px[i][index] + f.y * py[i][index] + f.z * pz[i][index] + f.w >= -CULLING_EPSILON;
+        }
+        if(visible)
+        {
+            setVisible(index);
+        }
+    }
+
+#endif
+}
+
+VRPG_GAME_END
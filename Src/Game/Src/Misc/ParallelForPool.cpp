@@ -0,0 +1,104 @@
+﻿#include <VRPG/Game/Misc/ParallelForPool.h>
+
+VRPG_GAME_BEGIN
+
+ParallelForPool::ParallelForPool(int workerCount)
+    : func_(nullptr), taskCount_(0), nextTask_(0), runningWorkerCount_(0), generation_(0), exit_(false)
+{
+    for(int i = 0; i < workerCount; ++i)
+    {
+        workers_.emplace_back(&ParallelForPool::WorkerFunc, this);
+    }
+}
+
+ParallelForPool::~ParallelForPool()
+{
+    {
+        std::lock_guard lk(mutex_);
+        exit_ = true;
+    }
+    startCond_.notify_all();
+
+    for(auto &worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+int ParallelForPool::GetWorkerCount() const noexcept
+{
+    return int(workers_.size());
+}
+
+void ParallelForPool::Run(int taskCount, const std::function<void(int)> &func)
+{
+    if(taskCount <= 0)
+    {
+        return;
+    }
+
+    if(workers_.empty() || taskCount == 1)
+    {
+        for(int i = 0; i < taskCount; ++i)
+        {
+            func(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard lk(mutex_);
+        func_ = &func;
+        taskCount_ = taskCount;
+        nextTask_ = 0;
+        runningWorkerCount_ = int(workers_.size());
+        ++generation_;
+    }
+    startCond_.notify_all();
+
+    RunTasks();
+
+    std::unique_lock lk(mutex_);
+    finishCond_.wait(lk, [&] { return runningWorkerCount_ == 0; });
+    func_ = nullptr;
+}
+
+void ParallelForPool::RunTasks()
+{
+    for(;;)
+    {
+        int task = nextTask_.fetch_add(1);
+        if(task >= taskCount_)
+        {
+            return;
+        }
+        (*func_)(task);
+    }
+}
+
+void ParallelForPool::WorkerFunc()
+{
+    uint64_t lastGeneration = 0;
+    for(;;)
+    {
+        {
+            std::unique_lock lk(mutex_);
+            startCond_.wait(lk, [&] { return exit_ || generation_ != lastGeneration; });
+            if(exit_)
+            {
+                return;
+            }
+            lastGeneration = generation_;
+        }
+
+        RunTasks();
+
+        {
+            std::lock_guard lk(mutex_);
+            --runningWorkerCount_;
+        }
+        finishCond_.notify_one();
+    }
+}
+
+VRPG_GAME_END
@@ -0,0 +1,331 @@
+﻿#include <cmath>
+#include <queue>
+
+#include <VRPG/Game/Misc/BitScan.h>
+#include <VRPG/Game/Navigation/NavigationGraph.h>
+#include <VRPG/Game/World/Chunk/Chunk.h>
+
+VRPG_GAME_BEGIN
+
+namespace
+{
+    constexpr uint16_t NO_REGION_16 = 0xffff;
+
+    int FloorDivide(int a, int b) noexcept
+    {
+        return a >= 0 ? a / b : -((-a + b - 1) / b);
+    }
+
+    /**
+     * @brief 以section为中心的3x3x3个阻挡快照，提供以全局坐标查询的接口
+     */
+    class SolidityNeighborhood
+    {
+        Vec3i lowBlock_;
+        const SectionSolidity *const *sections_;
+
+    public:
+
+        SolidityNeighborhood(const Vec3i &lowBlock, const SectionSolidity *const sections[27]) noexcept
+            : lowBlock_(lowBlock), sections_(sections)
+        {
+
+        }
+
+        bool IsSolid(const Vec3i &globalBlock) const noexcept
+        {
+            const Vec3i local = globalBlock - lowBlock_;
+            const int dx = FloorDivide(local.x, CHUNK_SECTION_SIZE_X);
+            const int dy = FloorDivide(local.y, CHUNK_SECTION_SIZE_Y);
+            const int dz = FloorDivide(local.z, CHUNK_SECTION_SIZE_Z);
+            assert(-1 <= dx && dx <= 1 && -1 <= dy && dy <= 1 && -1 <= dz && dz <= 1);
+
+            const SectionSolidity *section = sections_[(dx + 1) * 9 + (dy + 1) * 3 + (dz + 1)];
+            return section && section->IsSolid({
+                local.x - dx * CHUNK_SECTION_SIZE_X,
+                local.y - dy * CHUNK_SECTION_SIZE_Y,
+                local.z - dz * CHUNK_SECTION_SIZE_Z
+            });
+        }
+    };
+}
+
+NavigationAgentParams NavigationAgentParams::FromCylinder(float radius, float height) noexcept
+{
+    NavigationAgentParams ret;
+    ret.clearanceHeight = (std::max)(1, static_cast<int>(std::ceil(height - 1e-3f)));
+    return ret;
+}
+
+std::shared_ptr<const SectionSolidity> SectionSolidity::Build(const Chunk &chunk, const Vec3i &sectionInChunk)
+{
+    static_assert(CHUNK_SECTION_SIZE_Y == 16 && 64 % CHUNK_SECTION_SIZE_Y == 0);
+
+    static const auto EMPTY = std::make_shared<const SectionSolidity>();
+
+    auto &blockDescMgr = BlockDescManager::GetInstance();
+
+    const int lowX = sectionInChunk.x * CHUNK_SECTION_SIZE_X;
+    const int lowY = sectionInChunk.y * CHUNK_SECTION_SIZE_Y;
+    const int lowZ = sectionInChunk.z * CHUNK_SECTION_SIZE_Z;
+
+    auto ret = std::make_shared<SectionSolidity>();
+    bool isEmpty = true;
+
+    for(int x = 0; x < CHUNK_SECTION_SIZE_X; ++x)
+    {
+        for(int z = 0; z < CHUNK_SECTION_SIZE_Z; ++z)
+        {
+            // 只有具有碰撞体积的方块可能阻挡移动，再由其碰撞AABB表确定
+
+            uint64_t word = chunk.GetCollisionMaskWord(lowX + x, lowZ + z, lowY / 64);
+            ForEachSetBit((word >> (lowY % 64)) & 0xffff, [&](int y)
+            {
+                const Vec3i blockInChunk = { lowX + x, lowY + y, lowZ + z };
+                if(!blockDescMgr.GetCollisionAABBs(chunk.GetID(blockInChunk), chunk.GetOrientation(blockInChunk)).empty())
+                {
+                    ret->columns_[x][z] |= uint16_t(1u << y);
+                    isEmpty = false;
+                }
+            });
+        }
+    }
+
+    if(isEmpty)
+    {
+        return EMPTY;
+    }
+    return ret;
+}
+
+SectionNavGraph::SectionNavGraph(
+    const Vec3i &globalSection, const NavigationAgentParams &agent, const SectionSolidity *const neighborhood[27])
+    : globalSection_(globalSection),
+      lowCell_(globalSection * Vec3i(CHUNK_SECTION_SIZE_X, CHUNK_SECTION_SIZE_Y, CHUNK_SECTION_SIZE_Z))
+{
+    assert(agent.clearanceHeight >= 1);
+    assert(0 <= agent.maxStepHeight && agent.maxStepHeight + MOVE_DELTA_Y_BIAS < (1 << MOVE_BITS));
+    assert(0 <= agent.maxDropHeight && agent.maxDropHeight < MOVE_DELTA_Y_BIAS);
+    assert(agent.clearanceHeight + agent.maxStepHeight <= CHUNK_SECTION_SIZE_Y);
+
+    const SolidityNeighborhood solidity(lowCell_, neighborhood);
+
+    auto isClear = [&](const Vec3i &cell, int height)
+    {
+        for(int i = 0; i < height; ++i)
+        {
+            if(solidity.IsSolid({ cell.x, cell.y + i, cell.z }))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    auto isStandable = [&](const Vec3i &cell)
+    {
+        return 0 <= cell.y && cell.y < CHUNK_SIZE_Y &&
+               solidity.IsSolid({ cell.x, cell.y - 1, cell.z }) && isClear(cell, agent.clearanceHeight);
+    };
+
+    // 找出所有可站立的格子，并计算从每个格子出发的移动
+
+    std::vector<Vec3i> cellPositions;
+
+    for(int x = 0; x < CHUNK_SECTION_SIZE_X; ++x)
+    {
+        for(int z = 0; z < CHUNK_SECTION_SIZE_Z; ++z)
+        {
+            columnBegin_[x * CHUNK_SECTION_SIZE_Z + z] = uint16_t(cellY_.size());
+
+            for(int y = 0; y < CHUNK_SECTION_SIZE_Y; ++y)
+            {
+                const Vec3i cell = lowCell_ + Vec3i(x, y, z);
+                if(!isStandable(cell))
+                {
+                    continue;
+                }
+
+                uint16_t moves = 0;
+                for(int direction = 0; direction < MOVE_DIRECTION_COUNT; ++direction)
+                {
+                    const Vec3i neighbor = cell + Vec3i(MOVE_DIRECTION_X[direction], 0, MOVE_DIRECTION_Z[direction]);
+
+                    int deltaY = 0;
+                    bool canMove = false;
+
+                    if(isStandable(neighbor))
+                    {
+                        canMove = true;
+                    }
+                    else if(isClear(neighbor, agent.clearanceHeight))
+                    {
+                        // 下落到第一个可站立的格子
+
+                        for(int drop = 1; drop <= agent.maxDropHeight; ++drop)
+                        {
+                            const Vec3i target = { neighbor.x, neighbor.y - drop, neighbor.z };
+                            if(solidity.IsSolid(target))
+                            {
+                                break;
+                            }
+                            if(isStandable(target))
+                            {
+                                deltaY = -drop;
+                                canMove = true;
+                                break;
+                            }
+                        }
+                    }
+                    else
+                    {
+                        // 上台阶，要求当前格子上方留有足够的空间
+
+                        for(int step = 1; step <= agent.maxStepHeight; ++step)
+                        {
+                            if(solidity.IsSolid({ cell.x, cell.y + agent.clearanceHeight + step - 1, cell.z }))
+                            {
+                                break;
+                            }
+                            if(isStandable({ neighbor.x, neighbor.y + step, neighbor.z }))
+                            {
+                                deltaY = step;
+                                canMove = true;
+                                break;
+                            }
+                        }
+                    }
+
+                    if(canMove)
+                    {
+                        moves |= uint16_t((deltaY + MOVE_DELTA_Y_BIAS) << (direction * MOVE_BITS));
+                    }
+                }
+
+                cellPositions.push_back(cell);
+                cellY_.push_back(uint8_t(y));
+                cellMoves_.push_back(moves);
+            }
+        }
+    }
+    columnBegin_[CHUNK_SECTION_SIZE_X * CHUNK_SECTION_SIZE_Z] = uint16_t(cellY_.size());
+
+    const int cellCount = int(cellY_.size());
+    cellRegions_.assign(cellCount, NO_REGION_16);
+
+    auto getMoveCode = [&](int cellIndex, int direction)
+    {
+        return (cellMoves_[cellIndex] >> (direction * MOVE_BITS)) & ((1 << MOVE_BITS) - 1);
+    };
+
+    // 沿section内可双向通行的移动划分区域
+
+    std::queue<int> cellQueue;
+    for(int seed = 0; seed < cellCount; ++seed)
+    {
+        if(cellRegions_[seed] != NO_REGION_16)
+        {
+            continue;
+        }
+
+        const uint16_t region = uint16_t(regions_.size());
+        Vec3 positionSum(0.0f);
+        int regionCellCount = 0;
+
+        cellRegions_[seed] = region;
+        cellQueue.push(seed);
+
+        while(!cellQueue.empty())
+        {
+            const int cellIndex = cellQueue.front();
+            cellQueue.pop();
+
+            const Vec3i &cell = cellPositions[cellIndex];
+            positionSum += cell.map([](int i) { return static_cast<float>(i); });
+            ++regionCellCount;
+
+            for(int direction = 0; direction < MOVE_DIRECTION_COUNT; ++direction)
+            {
+                const int code = getMoveCode(cellIndex, direction);
+                if(!code)
+                {
+                    continue;
+                }
+
+                const int deltaY = code - MOVE_DELTA_Y_BIAS;
+                const Vec3i target = cell + Vec3i(MOVE_DIRECTION_X[direction], deltaY, MOVE_DIRECTION_Z[direction]);
+                const int targetIndex = FindCell(target - lowCell_);
+                if(targetIndex < 0 || cellRegions_[targetIndex] != NO_REGION_16)
+                {
+                    continue;
+                }
+
+                // 相反方向的移动为direction ^ 1
+
+                if(getMoveCode(targetIndex, direction ^ 1) == MOVE_DELTA_Y_BIAS - deltaY)
+                {
+                    cellRegions_[targetIndex] = region;
+                    cellQueue.push(targetIndex);
+                }
+            }
+        }
+
+        Region newRegion;
+        newRegion.centre = (1.0f / regionCellCount) * positionSum;
+        regions_.push_back(std::move(newRegion));
+    }
+
+    // 收集离开各区域的移动
+
+    for(int cellIndex = 0; cellIndex < cellCount; ++cellIndex)
+    {
+        const Vec3i &cell = cellPositions[cellIndex];
+        const uint16_t region = cellRegions_[cellIndex];
+
+        for(int direction = 0; direction < MOVE_DIRECTION_COUNT; ++direction)
+        {
+            const int code = getMoveCode(cellIndex, direction);
+            if(!code)
+            {
+                continue;
+            }
+
+            const Vec3i target = cell + Vec3i(
+                MOVE_DIRECTION_X[direction], code - MOVE_DELTA_Y_BIAS, MOVE_DIRECTION_Z[direction]);
+            const int targetIndex = FindCell(target - lowCell_);
+            if(targetIndex < 0 || cellRegions_[targetIndex] != region)
+            {
+                regions_[region].portals.push_back({ cell, target });
+            }
+        }
+    }
+}
+
+int SectionNavGraph::GetRegion(const Vec3i &globalCell) const noexcept
+{
+    assert(GlobalBlockToGlobalSection(globalCell) == globalSection_);
+    const int cellIndex = FindCell(globalCell - lowCell_);
+    return cellIndex >= 0 ? cellRegions_[cellIndex] : NO_REGION;
+}
+
+int SectionNavGraph::FindCell(const Vec3i &cellInSection) const noexcept
+{
+    if(cellInSection.x < 0 || cellInSection.x >= CHUNK_SECTION_SIZE_X ||
+       cellInSection.y < 0 || cellInSection.y >= CHUNK_SECTION_SIZE_Y ||
+       cellInSection.z < 0 || cellInSection.z >= CHUNK_SECTION_SIZE_Z)
+    {
+        return -1;
+    }
+
+    const int column = cellInSection.x * CHUNK_SECTION_SIZE_Z + cellInSection.z;
+    for(int i = columnBegin_[column]; i < columnBegin_[column + 1]; ++i)
+    {
+        if(cellY_[i] == cellInSection.y)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+VRPG_GAME_END
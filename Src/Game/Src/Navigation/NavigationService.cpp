@@ -0,0 +1,596 @@
+﻿#include <algorithm>
+#include <queue>
+
+#include <VRPG/Game/Navigation/NavigationService.h>
+#include <VRPG/Game/World/Chunk/ChunkManager.h>
+
+VRPG_GAME_BEGIN
+
+namespace
+{
+    // 格子间距离的估计值，与FindPathInCorridor中的移动代价一致：水平移动每格代价为1，高度每变化一格额外代价为0.5
+    float EstimateCost(const Vec3 &a, const Vec3 &b) noexcept
+    {
+        return std::abs(a.x - b.x) + std::abs(a.z - b.z) + 0.5f * std::abs(a.y - b.y);
+    }
+
+    Vec3 CellToVec3(const Vec3i &cell) noexcept
+    {
+        return cell.map([](int i) { return static_cast<float>(i); });
+    }
+
+    template<typename Node>
+    struct OpenNode
+    {
+        float f;
+        Node node;
+
+        bool operator>(const OpenNode &rhs) const noexcept
+        {
+            return f > rhs.f;
+        }
+    };
+
+    template<typename Node>
+    using OpenQueue = std::priority_queue<OpenNode<Node>, std::vector<OpenNode<Node>>, std::greater<OpenNode<Node>>>;
+}
+
+NavigationService::NavigationService(const NavigationServiceParams &params, const ChunkManager *chunkManager)
+    : params_(params), chunkManager_(chunkManager), exit_(false),
+      nextQueryID_(1), runningQueryCount_(0), queryTimeHistory_(64), updateCount_(0)
+{
+    assert(chunkManager && params.threadCount > 0);
+
+    threads_.reserve(params.threadCount);
+    for(int i = 0; i < params.threadCount; ++i)
+    {
+        threads_.emplace_back(&NavigationService::WorkerFunc, this);
+    }
+}
+
+NavigationService::~NavigationService()
+{
+    {
+        std::lock_guard lk(mutex_);
+        exit_ = true;
+    }
+    queryCond_.notify_all();
+
+    for(auto &t : threads_)
+    {
+        t.join();
+    }
+}
+
+PathQueryID NavigationService::AddQuery(const Vec3i &startCell, const Vec3i &goalCell)
+{
+    PathQueryID id;
+    {
+        std::lock_guard lk(mutex_);
+        id = nextQueryID_++;
+        queries_.push_back({ id, startCell, goalCell });
+    }
+    queryCond_.notify_one();
+    return id;
+}
+
+std::vector<PathQueryResult> NavigationService::TakeFinishedQueries()
+{
+    std::lock_guard lk(mutex_);
+    return std::move(finishedQueries_);
+}
+
+void NavigationService::OnBlockChanged(const Vec3i &globalBlock)
+{
+    dirtySnapshotSections_.insert(GlobalBlockToGlobalSection(globalBlock));
+
+    // 格子c的寻路数据取决于水平相邻一格、y坐标位于[c.y - maxDropHeight - 1, c.y + clearanceHeight + maxStepHeight - 1]中的方块，
+    // 反过来即得受globalBlock影响的格子的范围
+
+    const NavigationAgentParams &agent = params_.agent;
+    const Vec3i lowSection = GlobalBlockToGlobalSection(
+        globalBlock - Vec3i(1, agent.clearanceHeight + agent.maxStepHeight - 1, 1));
+    const Vec3i highSection = GlobalBlockToGlobalSection(
+        globalBlock + Vec3i(1, agent.maxDropHeight + 1, 1));
+
+    for(int x = lowSection.x; x <= highSection.x; ++x)
+    {
+        for(int y = lowSection.y; y <= highSection.y; ++y)
+        {
+            for(int z = lowSection.z; z <= highSection.z; ++z)
+            {
+                dirtyGraphSections_.insert({ x, y, z });
+            }
+        }
+    }
+}
+
+void NavigationService::Update()
+{
+    std::vector<std::pair<Vec3i, std::shared_ptr<const SectionSolidity>>> newSnapshots;
+    std::unordered_set<Vec3i> unloadedSections;
+
+    // 重新生成被改变的快照
+
+    for(auto &section : dirtySnapshotSections_)
+    {
+        if(snapshots_.count(section))
+        {
+            newSnapshots.push_back({ section, BuildSnapshot(section) });
+        }
+    }
+    dirtySnapshotSections_.clear();
+
+    // 为被挂起的查询生成快照
+
+    std::vector<Vec3i> requestedSections;
+    {
+        std::lock_guard lk(mutex_);
+        auto it = requestedSections_.begin();
+        while(it != requestedSections_.end() && int(requestedSections.size()) < params_.snapshotBudget)
+        {
+            requestedSections.push_back(*it);
+            it = requestedSections_.erase(it);
+        }
+    }
+
+    for(auto &section : requestedSections)
+    {
+        if(auto snapshot = BuildSnapshot(section))
+        {
+            newSnapshots.push_back({ section, std::move(snapshot) });
+        }
+        else
+        {
+            unloadedSections.insert(section);
+        }
+    }
+
+    // 所在区块已被卸载的快照
+
+    std::vector<Vec3i> prunedSections;
+    if(++updateCount_ % PRUNE_INTERVAL == 0)
+    {
+        for(auto &[section, snapshot] : snapshots_)
+        {
+            if(!chunkManager_->FindChunk(DecomposeGlobalSectionByChunk(section).first))
+            {
+                prunedSections.push_back(section);
+            }
+        }
+    }
+
+    bool hasRequeuedQuery = false;
+    {
+        std::lock_guard lk(mutex_);
+
+        for(auto &[section, snapshot] : newSnapshots)
+        {
+            if(snapshot)
+            {
+                snapshots_[section] = std::move(snapshot);
+            }
+            else
+            {
+                snapshots_.erase(section);
+            }
+        }
+
+        for(auto &section : prunedSections)
+        {
+            snapshots_.erase(section);
+        }
+
+        // 丢弃受方块改变影响的寻路图，以及生成时用到的快照已被丢弃的寻路图
+
+        for(auto &section : dirtyGraphSections_)
+        {
+            graphs_.erase(section);
+        }
+
+        if(!prunedSections.empty())
+        {
+            for(auto it = graphs_.begin(); it != graphs_.end();)
+            {
+                bool isComplete = true;
+                for(int dx = -1; dx <= 1 && isComplete; ++dx)
+                {
+                    for(int dz = -1; dz <= 1 && isComplete; ++dz)
+                    {
+                        isComplete = snapshots_.count(it->first + Vec3i(dx, 0, dz)) != 0;
+                    }
+                }
+                it = isComplete ? std::next(it) : graphs_.erase(it);
+            }
+        }
+
+        // 所需快照均已就绪的查询重新进入队列，涉及未加载区块的查询直接失败
+
+        std::vector<ParkedQuery> stillParkedQueries;
+        for(auto &parked : parkedQueries_)
+        {
+            bool isUnloaded = false, isReady = true;
+            for(auto &section : parked.missingSections)
+            {
+                if(unloadedSections.count(section))
+                {
+                    isUnloaded = true;
+                    break;
+                }
+                if(!snapshots_.count(section))
+                {
+                    isReady = false;
+                    requestedSections_.insert(section);
+                }
+            }
+
+            if(isUnloaded)
+            {
+                PathQueryResult result;
+                result.id     = parked.query.id;
+                result.status = PathQueryResult::Status::Unloaded;
+                finishedQueries_.push_back(std::move(result));
+            }
+            else if(isReady)
+            {
+                queries_.push_back(parked.query);
+                hasRequeuedQuery = true;
+            }
+            else
+            {
+                stillParkedQueries.push_back(std::move(parked));
+            }
+        }
+        parkedQueries_.swap(stillParkedQueries);
+    }
+    dirtyGraphSections_.clear();
+
+    if(hasRequeuedQuery)
+    {
+        queryCond_.notify_all();
+    }
+}
+
+NavigationService::Statistics NavigationService::GetStatistics() const
+{
+    std::lock_guard lk(mutex_);
+    Statistics ret;
+    ret.pendingQueryCount   = queries_.size() + parkedQueries_.size() + runningQueryCount_;
+    ret.cachedGraphCount    = graphs_.size();
+    ret.cachedSnapshotCount = snapshots_.size();
+    ret.meanQueryTime       = queryTimeHistory_.MeanValue();
+    return ret;
+}
+
+void NavigationService::WorkerFunc()
+{
+    for(;;)
+    {
+        Query query;
+        {
+            std::unique_lock lk(mutex_);
+            queryCond_.wait(lk, [&] { return exit_ || !queries_.empty(); });
+            if(exit_)
+            {
+                return;
+            }
+            query = queries_.front();
+            queries_.pop_front();
+            ++runningQueryCount_;
+        }
+
+        auto startTime = StdClock::now();
+
+        PathQueryResult result;
+        result.id = query.id;
+        std::unordered_set<Vec3i> missingSections;
+        const bool isFinished = ExecuteQuery(query, result, missingSections);
+
+        const float queryTime = std::chrono::duration<float, std::milli>(StdClock::now() - startTime).count();
+
+        std::lock_guard lk(mutex_);
+        --runningQueryCount_;
+        if(isFinished)
+        {
+            finishedQueries_.push_back(std::move(result));
+            queryTimeHistory_.Update(queryTime);
+        }
+        else
+        {
+            for(auto &section : missingSections)
+            {
+                if(!snapshots_.count(section))
+                {
+                    requestedSections_.insert(section);
+                }
+            }
+            parkedQueries_.push_back({ query, std::vector<Vec3i>(missingSections.begin(), missingSections.end()) });
+        }
+    }
+}
+
+bool NavigationService::ExecuteQuery(
+    const Query &query, PathQueryResult &result, std::unordered_set<Vec3i> &missingSections)
+{
+    GraphMap graphs;
+
+    const Vec3i startSection = GlobalBlockToGlobalSection(query.startCell);
+    const Vec3i goalSection  = GlobalBlockToGlobalSection(query.goalCell);
+    const SectionNavGraph *startGraph = GetGraph(startSection, graphs, missingSections);
+    const SectionNavGraph *goalGraph  = GetGraph(goalSection,  graphs, missingSections);
+    if(!missingSections.empty())
+    {
+        return false;
+    }
+
+    const int startRegion = startGraph ? startGraph->GetRegion(query.startCell) : SectionNavGraph::NO_REGION;
+    const int goalRegion  = goalGraph  ? goalGraph ->GetRegion(query.goalCell)  : SectionNavGraph::NO_REGION;
+    if(startRegion == SectionNavGraph::NO_REGION || goalRegion == SectionNavGraph::NO_REGION)
+    {
+        result.status = PathQueryResult::Status::InvalidEndpoint;
+        return true;
+    }
+
+    std::vector<RegionKey> corridor;
+    if(!FindCorridor(
+        { startSection, startRegion }, { goalSection, goalRegion }, query.goalCell, graphs, missingSections, corridor))
+    {
+        if(!missingSections.empty())
+        {
+            return false;
+        }
+        result.status = PathQueryResult::Status::NoPath;
+        return true;
+    }
+
+    // 同一区域内的格子互相可达，因此走廊中一定存在路径
+
+    const bool isFound = FindPathInCorridor(query.startCell, query.goalCell, corridor, graphs, result.path);
+    assert(isFound);
+    result.status = isFound ? PathQueryResult::Status::Found : PathQueryResult::Status::NoPath;
+    return true;
+}
+
+const SectionNavGraph *NavigationService::GetGraph(
+    const Vec3i &globalSection, GraphMap &graphs, std::unordered_set<Vec3i> &missingSections)
+{
+    if(globalSection.y < 0 || globalSection.y >= CHUNK_SECTION_COUNT_Y)
+    {
+        return nullptr;
+    }
+
+    if(auto it = graphs.find(globalSection); it != graphs.end())
+    {
+        return it->second.get();
+    }
+
+    // 取得以globalSection为中心的3x3x3个快照，世界之外的section不含阻挡方块
+
+    std::shared_ptr<const SectionSolidity> neighborhood[27];
+    {
+        std::lock_guard lk(mutex_);
+
+        if(auto it = graphs_.find(globalSection); it != graphs_.end())
+        {
+            return graphs.insert({ globalSection, it->second }).first->second.get();
+        }
+
+        bool isComplete = true;
+        for(int i = 0; i < 27; ++i)
+        {
+            const Vec3i section = globalSection + Vec3i(i / 9 - 1, i / 3 % 3 - 1, i % 3 - 1);
+            if(section.y < 0 || section.y >= CHUNK_SECTION_COUNT_Y)
+            {
+                continue;
+            }
+
+            auto it = snapshots_.find(section);
+            if(it == snapshots_.end())
+            {
+                missingSections.insert(section);
+                isComplete = false;
+            }
+            else
+            {
+                neighborhood[i] = it->second;
+            }
+        }
+
+        if(!isComplete)
+        {
+            return nullptr;
+        }
+    }
+
+    const SectionSolidity *rawNeighborhood[27];
+    for(int i = 0; i < 27; ++i)
+    {
+        rawNeighborhood[i] = neighborhood[i].get();
+    }
+    auto graph = std::make_shared<const SectionNavGraph>(globalSection, params_.agent, rawNeighborhood);
+
+    // 生成期间用到的快照可能已被替换，此时生成的寻路图只在本次查询中使用
+
+    {
+        std::lock_guard lk(mutex_);
+
+        bool isUpToDate = true;
+        for(int i = 0; i < 27 && isUpToDate; ++i)
+        {
+            if(neighborhood[i])
+            {
+                const Vec3i section = globalSection + Vec3i(i / 9 - 1, i / 3 % 3 - 1, i % 3 - 1);
+                auto it = snapshots_.find(section);
+                isUpToDate = it != snapshots_.end() && it->second == neighborhood[i];
+            }
+        }
+
+        if(isUpToDate)
+        {
+            graphs_.insert({ globalSection, graph });
+        }
+    }
+
+    return graphs.insert({ globalSection, std::move(graph) }).first->second.get();
+}
+
+bool NavigationService::FindCorridor(
+    const RegionKey &start, const RegionKey &goal, const Vec3i &goalCell,
+    GraphMap &graphs, std::unordered_set<Vec3i> &missingSections, std::vector<RegionKey> &corridor)
+{
+    // 区域间的代价以区域中心间的距离估计
+
+    auto getCentre = [&](const RegionKey &key)
+    {
+        return graphs.at(key.section)->GetRegions()[key.region].centre;
+    };
+
+    const Vec3 goalPosition = CellToVec3(goalCell);
+
+    std::unordered_map<RegionKey, float, RegionKeyHash> gScores;
+    std::unordered_map<RegionKey, RegionKey, RegionKeyHash> parents;
+    std::unordered_set<RegionKey, RegionKeyHash> closed;
+    OpenQueue<RegionKey> open;
+
+    gScores[start] = 0;
+    open.push({ EstimateCost(getCentre(start), goalPosition), start });
+
+    int expandedCount = 0;
+    while(!open.empty())
+    {
+        const RegionKey key = open.top().node;
+        open.pop();
+
+        if(!closed.insert(key).second)
+        {
+            continue;
+        }
+
+        if(key == goal)
+        {
+            corridor.push_back(key);
+            for(auto it = parents.find(key); it != parents.end(); it = parents.find(it->second))
+            {
+                corridor.push_back(it->second);
+            }
+            std::reverse(corridor.begin(), corridor.end());
+            return true;
+        }
+
+        if(++expandedCount > params_.maxSearchRegions)
+        {
+            break;
+        }
+
+        const float g = gScores.at(key);
+        const SectionNavGraph::Region &region = graphs.at(key.section)->GetRegions()[key.region];
+
+        for(auto &portal : region.portals)
+        {
+            const Vec3i toSection = GlobalBlockToGlobalSection(portal.toCell);
+            const SectionNavGraph *toGraph = GetGraph(toSection, graphs, missingSections);
+            if(!toGraph)
+            {
+                continue;
+            }
+
+            const RegionKey next = { toSection, toGraph->GetRegion(portal.toCell) };
+            if(next.region == SectionNavGraph::NO_REGION || closed.count(next))
+            {
+                continue;
+            }
+
+            const Vec3 &nextCentre = toGraph->GetRegions()[next.region].centre;
+            const float nextG = g + (std::max)(1.0f, EstimateCost(region.centre, nextCentre));
+
+            auto it = gScores.find(next);
+            if(it != gScores.end() && it->second <= nextG)
+            {
+                continue;
+            }
+
+            gScores[next] = nextG;
+            parents[next] = key;
+            open.push({ nextG + EstimateCost(nextCentre, goalPosition), next });
+        }
+    }
+
+    return false;
+}
+
+bool NavigationService::FindPathInCorridor(
+    const Vec3i &startCell, const Vec3i &goalCell,
+    const std::vector<RegionKey> &corridor, const GraphMap &graphs, std::vector<Vec3i> &path)
+{
+    const std::unordered_set<RegionKey, RegionKeyHash> allowedRegions(corridor.begin(), corridor.end());
+    const Vec3 goalPosition = CellToVec3(goalCell);
+
+    std::unordered_map<Vec3i, float> gScores;
+    std::unordered_map<Vec3i, Vec3i> parents;
+    std::unordered_set<Vec3i> closed;
+    OpenQueue<Vec3i> open;
+
+    gScores[startCell] = 0;
+    open.push({ EstimateCost(CellToVec3(startCell), goalPosition), startCell });
+
+    while(!open.empty())
+    {
+        const Vec3i cell = open.top().node;
+        open.pop();
+
+        if(!closed.insert(cell).second)
+        {
+            continue;
+        }
+
+        if(cell == goalCell)
+        {
+            path.push_back(cell);
+            for(auto it = parents.find(cell); it != parents.end(); it = parents.find(it->second))
+            {
+                path.push_back(it->second);
+            }
+            std::reverse(path.begin(), path.end());
+            return true;
+        }
+
+        const float g = gScores.at(cell);
+        graphs.at(GlobalBlockToGlobalSection(cell))->ForEachMove(cell, [&](const Vec3i &toCell, int deltaY)
+        {
+            const Vec3i toSection = GlobalBlockToGlobalSection(toCell);
+            auto graphIt = graphs.find(toSection);
+            if(graphIt == graphs.end() || closed.count(toCell))
+            {
+                return;
+            }
+
+            const int toRegion = graphIt->second->GetRegion(toCell);
+            if(toRegion == SectionNavGraph::NO_REGION || !allowedRegions.count({ toSection, toRegion }))
+            {
+                return;
+            }
+
+            const float toG = g + 1 + 0.5f * std::abs(deltaY);
+            auto it = gScores.find(toCell);
+            if(it != gScores.end() && it->second <= toG)
+            {
+                return;
+            }
+
+            gScores[toCell] = toG;
+            parents[toCell] = cell;
+            open.push({ toG + EstimateCost(CellToVec3(toCell), goalPosition), toCell });
+        });
+    }
+
+    return false;
+}
+
+std::shared_ptr<const SectionSolidity> NavigationService::BuildSnapshot(const Vec3i &globalSection) const
+{
+    auto [chunkPosition, sectionInChunk] = DecomposeGlobalSectionByChunk(globalSection);
+    const Chunk *chunk = chunkManager_->FindChunk(chunkPosition);
+    return chunk ? SectionSolidity::Build(*chunk, sectionInChunk) : nullptr;
+}
+
+VRPG_GAME_END
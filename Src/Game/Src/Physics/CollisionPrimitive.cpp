@@ -0,0 +1,198 @@
+﻿#include <algorithm>
+#include <cmath>
+
+#include <VRPG/Game/Physics/CollisionPrimitive.h>
+
+VRPG_GAME_BEGIN
+
+namespace Collision
+{
+
+    namespace
+    {
+        constexpr float EPS = 1e-3f;
+
+        Vec2 ClosestPointInRectangle(const AABB &box, const Vec2 &xz) noexcept
+        {
+            return {
+                (std::clamp)(xz.x, box.low.x, box.high.x),
+                (std::clamp)(xz.y, box.low.z, box.high.z)
+            };
+        }
+    }
+
+    bool HasCollision(const AABB &box, const AACylinder &cylinder) noexcept
+    {
+        if(cylinder.lowCentre.y >= box.high.y || cylinder.lowCentre.y + cylinder.height <= box.low.y)
+        {
+            return false;
+        }
+
+        Vec2 p = cylinder.lowCentre.xz();
+        Vec2 o = ClosestPointInRectangle(box, p);
+        return (p - o).length_square() < cylinder.radius * cylinder.radius;
+    }
+
+    bool ResolveCollision(const AABB &box, const AACylinder &cylinder, const Vec3 &newLowCentre, float offset[3]) noexcept
+    {
+        // +/-y
+
+        float lowY = newLowCentre.y, highY = lowY + cylinder.height;
+        if(lowY >= box.high.y || highY <= box.low.y)
+        {
+            return false;
+        }
+
+        if(cylinder.lowCentre.y < newLowCentre.y)
+        {
+            offset[1] = box.low.y - highY - EPS;
+        }
+        else
+        {
+            offset[1] = box.high.y - lowY + EPS;
+        }
+
+        Vec2 p = newLowCentre.xz();
+        Vec2 o = ClosestPointInRectangle(box, p);
+        float r2 = cylinder.radius * cylinder.radius;
+        if((p - o).length_square() >= r2)
+        {
+            return false;
+        }
+
+        // +/-x
+
+        float deltaZ = p.y - o.y;
+        float extentX = std::sqrt((std::max)(0.0f, r2 - deltaZ * deltaZ));
+        if(cylinder.lowCentre.x < p.x)
+        {
+            offset[0] = box.low.x - extentX - p.x;
+        }
+        else
+        {
+            offset[0] = box.high.x + extentX - p.x;
+        }
+
+        // +/-z
+
+        float deltaX = p.x - o.x;
+        float extentZ = std::sqrt((std::max)(0.0f, r2 - deltaX * deltaX));
+        if(cylinder.lowCentre.z < p.y)
+        {
+            offset[2] = box.low.z - extentZ - p.y;
+        }
+        else
+        {
+            offset[2] = box.high.z + extentZ - p.y;
+        }
+
+        return true;
+    }
+
+    float SweepAlongAxis(const AABB &box, const AACylinder &cylinder, int axis, float delta) noexcept
+    {
+        // 求出圆柱体在axis轴上位于哪个开区间(enter, exit)内时与box重叠，再检查移动经过的区间是否与之相交
+        // 与ResolveCollision一致，只在y轴上与box保持EPS的间隔
+
+        const Vec3 &p = cylinder.lowCentre;
+        const float r2 = cylinder.radius * cylinder.radius;
+
+        float enter, exit, gap;
+        if(axis == 1)
+        {
+            Vec2 xz = p.xz();
+            Vec2 o = ClosestPointInRectangle(box, xz);
+            if((xz - o).length_square() >= r2)
+            {
+                return delta;
+            }
+
+            enter = box.low.y - cylinder.height;
+            exit  = box.high.y;
+            gap   = EPS;
+        }
+        else
+        {
+            if(p.y >= box.high.y || p.y + cylinder.height <= box.low.y)
+            {
+                return delta;
+            }
+
+            // 另一水平轴上圆心到box的距离决定了圆柱体在axis轴上的半宽
+
+            const int side = 2 - axis;
+            const float distance = p[side] - (std::clamp)(p[side], box.low[side], box.high[side]);
+            const float extent2 = r2 - distance * distance;
+            if(extent2 <= 0)
+            {
+                return delta;
+            }
+
+            const float extent = std::sqrt(extent2);
+            enter = box.low[axis] - extent;
+            exit  = box.high[axis] + extent;
+            gap   = 0;
+        }
+
+        const float c = p[axis];
+        if(delta > 0)
+        {
+            if(exit <= c || enter >= c + delta)
+            {
+                return delta;
+            }
+            return enter - c - gap;
+        }
+
+        if(enter >= c || exit <= c + delta)
+        {
+            return delta;
+        }
+        return exit - c + gap;
+    }
+
+    void GetSweptBlockRange(const AACylinder &cylinder, const Vec3 &newLowCentre, Vec3i &low, Vec3i &high) noexcept
+    {
+        const Vec3 &p = cylinder.lowCentre;
+        const Vec3 lowf = Vec3(
+            (std::min)(p.x, newLowCentre.x),
+            (std::min)(p.y, newLowCentre.y),
+            (std::min)(p.z, newLowCentre.z))
+            - Vec3(cylinder.radius, 0, cylinder.radius) - Vec3(0.2f);
+        const Vec3 highf = Vec3(
+            (std::max)(p.x, newLowCentre.x),
+            (std::max)(p.y, newLowCentre.y),
+            (std::max)(p.z, newLowCentre.z))
+            + Vec3(cylinder.radius, cylinder.height, cylinder.radius) + Vec3(0.2f);
+        low  = lowf .map([](float f) { return static_cast<int>(std::floor(f)); });
+        high = highf.map([](float f) { return static_cast<int>(std::ceil(f)); });
+    }
+
+    AxisSweep::AxisSweep(const AACylinder &cylinder, int axis, float delta) noexcept
+        : cylinder_(cylinder), axis_(axis), delta_(delta), movedDistance_(delta)
+    {
+
+    }
+
+    void AxisSweep::AddBlock(const Vec3 &blockPosition, AABBSpan aabbs) noexcept
+    {
+        const AACylinder localCylinder{ cylinder_.lowCentre - blockPosition, cylinder_.radius, cylinder_.height };
+
+        // 每个AABB给出沿该轴移动时不与之接触的最大位移，取其中最小者
+
+        for(auto &aabb : aabbs)
+        {
+            const float distance = SweepAlongAxis(aabb, localCylinder, axis_, delta_);
+            movedDistance_ = delta_ > 0 ? (std::min)(movedDistance_, distance)
+                                        : (std::max)(movedDistance_, distance);
+        }
+    }
+
+    float AxisSweep::GetMovedDistance() const noexcept
+    {
+        return delta_ > 0 ? (std::max)(movedDistance_, 0.0f) : (std::min)(movedDistance_, 0.0f);
+    }
+
+} // namespace Collision
+
+VRPG_GAME_END
@@ -0,0 +1,386 @@
+﻿#include <VRPG/Game/Physics/EntityPhysics.h>
+#include <VRPG/Game/World/Block/BlockDescription.h>
+#include <VRPG/Game/World/Chunk/ChunkManager.h>
+
+VRPG_GAME_BEGIN
+
+EntityPhysics::EntityPhysics(const EntityPhysicsParams &params, ChunkManager *chunkManager, ParallelForPool *workerPool)
+    : params_(params), chunkManager_(chunkManager), workerPool_(workerPool)
+{
+    assert(chunkManager && workerPool);
+
+    blockChangeSubscriber_ = chunkManager_->AddBlockChangeSubscriber([this](const Vec3i &globalBlock)
+    {
+        WakeBodiesNear(globalBlock);
+    });
+}
+
+EntityPhysics::~EntityPhysics()
+{
+    chunkManager_->RemoveBlockChangeSubscriber(blockChangeSubscriber_);
+}
+
+PhysicsBodyID EntityPhysics::AddBody(const Collision::AACylinder &cylinder, const Vec3 &velocity)
+{
+    PhysicsBodyID id;
+    if(!freeIDs_.empty())
+    {
+        id = freeIDs_.back();
+        freeIDs_.pop_back();
+    }
+    else
+    {
+        id = PhysicsBodyID(idToIndex_.size());
+        idToIndex_.push_back(0);
+    }
+
+    idToIndex_[id] = uint32_t(positions_.size());
+
+    positions_       .push_back(cylinder.lowCentre);
+    velocities_      .push_back(velocity);
+    radiuses_        .push_back(cylinder.radius);
+    heights_         .push_back(cylinder.height);
+    onGround_        .push_back(0);
+    sleeping_        .push_back(0);
+    restUpdateCounts_.push_back(0);
+    bodyIDs_         .push_back(id);
+    sleepBuckets_    .push_back(Vec3i());
+
+    return id;
+}
+
+void EntityPhysics::RemoveBody(PhysicsBodyID id)
+{
+    assert(id < idToIndex_.size());
+    const size_t index = idToIndex_[id];
+    if(sleeping_[index])
+    {
+        WakeBody(index);
+    }
+    RemoveBodyAt(index);
+    freeIDs_.push_back(id);
+}
+
+size_t EntityPhysics::GetBodyCount() const noexcept
+{
+    return positions_.size();
+}
+
+Vec3 EntityPhysics::GetPosition(PhysicsBodyID id) const noexcept
+{
+    return positions_[idToIndex_[id]];
+}
+
+Vec3 EntityPhysics::GetVelocity(PhysicsBodyID id) const noexcept
+{
+    return velocities_[idToIndex_[id]];
+}
+
+void EntityPhysics::SetVelocity(PhysicsBodyID id, const Vec3 &velocity) noexcept
+{
+    size_t index = idToIndex_[id];
+    if(sleeping_[index])
+    {
+        WakeBody(index);
+    }
+    velocities_[index]       = velocity;
+    restUpdateCounts_[index] = 0;
+}
+
+bool EntityPhysics::IsOnGround(PhysicsBodyID id) const noexcept
+{
+    return onGround_[idToIndex_[id]] != 0;
+}
+
+bool EntityPhysics::IsSleeping(PhysicsBodyID id) const noexcept
+{
+    return sleeping_[idToIndex_[id]] != 0;
+}
+
+void EntityPhysics::WakeBodiesNear(const Vec3i &globalBlock)
+{
+    // 桶中的实体只受其lowCentre所在section及相邻section中的方块影响，
+    // 因此只需检查globalBlock所在section周围的27个桶以及存放大实体的桶
+
+    if(sleepingBodies_.empty())
+    {
+        return;
+    }
+
+    const Vec3i section = GlobalBlockToGlobalSection(globalBlock);
+
+    auto wakeBucket = [&](const Vec3i &bucket)
+    {
+        auto it = sleepingBodies_.find(bucket);
+        if(it == sleepingBodies_.end())
+        {
+            return;
+        }
+
+        // WakeBody会从该桶中移除实体，因此先复制一份
+
+        const std::vector<PhysicsBodyID> bodies = it->second;
+        for(PhysicsBodyID id : bodies)
+        {
+            const size_t bodyIndex = idToIndex_[id];
+            if(IsAffectedByBlock(bodyIndex, globalBlock))
+            {
+                WakeBody(bodyIndex);
+            }
+        }
+    };
+
+    for(int dx = -1; dx <= 1; ++dx)
+    {
+        for(int dy = -1; dy <= 1; ++dy)
+        {
+            for(int dz = -1; dz <= 1; ++dz)
+            {
+                wakeBucket(section + Vec3i(dx, dy, dz));
+            }
+        }
+    }
+    wakeBucket(LARGE_BODY_BUCKET);
+}
+
+void EntityPhysics::Update(float dt)
+{
+    activeBodies_ .clear();
+    contactBegins_.clear();
+    contactEnds_  .clear();
+    contacts_     .clear();
+
+    // 施加重力并收集各实体可能接触的方块
+
+    for(size_t i = 0; i < positions_.size(); ++i)
+    {
+        if(sleeping_[i])
+        {
+            continue;
+        }
+
+        Vec3 &velocity = velocities_[i];
+        if(velocity.y > -params_.gravityMaxSpeed)
+        {
+            velocity.y = (std::max)(velocity.y - dt * params_.gravityAccel, -params_.gravityMaxSpeed);
+        }
+
+        size_t contactBegin = contacts_.size();
+        if(!GatherContacts(i, dt))
+        {
+            contacts_.resize(contactBegin);
+            continue;
+        }
+
+        activeBodies_ .push_back(i);
+        contactBegins_.push_back(contactBegin);
+        contactEnds_  .push_back(contacts_.size());
+    }
+
+    // 各实体的积分互不相关，按批分配到线程池中
+
+    constexpr size_t BODY_BATCH_SIZE = 64;
+    const int batchCount = int((activeBodies_.size() + BODY_BATCH_SIZE - 1) / BODY_BATCH_SIZE);
+
+    workerPool_->Run(batchCount, [&](int batchIndex)
+    {
+        size_t begin = batchIndex * BODY_BATCH_SIZE;
+        size_t end = (std::min)(begin + BODY_BATCH_SIZE, activeBodies_.size());
+        for(size_t activeIndex = begin; activeIndex < end; ++activeIndex)
+        {
+            IntegrateBody(activeIndex, dt);
+        }
+    });
+
+    // 积分阶段只修改各实体自身的状态，刚进入睡眠的实体在这里串行地加入桶中
+
+    for(size_t bodyIndex : activeBodies_)
+    {
+        if(sleeping_[bodyIndex])
+        {
+            AddToSleepBucket(bodyIndex);
+        }
+    }
+}
+
+bool EntityPhysics::GatherContacts(size_t bodyIndex, float dt)
+{
+    const Vec3 &position = positions_[bodyIndex];
+    const Vec3 newPosition = position + dt * velocities_[bodyIndex];
+    const float radius = radiuses_[bodyIndex];
+    const float height = heights_[bodyIndex];
+
+    Vec3i lowi, highi;
+    Collision::GetSweptBlockRange({ position, radius, height }, newPosition, lowi, highi);
+
+    auto &blockDescMgr = BlockDescManager::GetInstance();
+
+    return chunkManager_->ForEachCollidableBlock(lowi, highi, false,
+        [&](const Vec3i &globalBlock, BlockID id, BlockOrientation orientation)
+    {
+        Collision::AABBSpan aabbs = blockDescMgr.GetCollisionAABBs(id, orientation);
+        if(!aabbs.empty())
+        {
+            contacts_.push_back({ globalBlock.map([](int i) { return static_cast<float>(i); }), aabbs });
+        }
+    });
+}
+
+void EntityPhysics::IntegrateBody(size_t activeIndex, float dt) noexcept
+{
+    const size_t bodyIndex = activeBodies_[activeIndex];
+    Vec3 &position = positions_[bodyIndex];
+    Vec3 &velocity = velocities_[bodyIndex];
+
+    // 与Player一致，依次沿y、x、z轴移动
+
+    const Vec3 deltaPosition = dt * velocity;
+    bool onGround = false;
+
+    for(int axis : { 1, 0, 2 })
+    {
+        if(deltaPosition[axis] == 0)
+        {
+            continue;
+        }
+
+        float movedDistance = MoveAlongAxis(activeIndex, axis, deltaPosition[axis]);
+        position[axis] += movedDistance;
+
+        if(movedDistance != deltaPosition[axis])
+        {
+            if(axis == 1 && deltaPosition[axis] < 0)
+            {
+                onGround = true;
+            }
+            velocity[axis] = 0;
+        }
+    }
+
+    onGround_[bodyIndex] = onGround;
+
+    // 地面阻力
+
+    if(onGround)
+    {
+        Vec2 horizontalVelocity = { velocity.x, velocity.z };
+        float horizontalSpeed = horizontalVelocity.length();
+        if(horizontalSpeed > 0)
+        {
+            float newSpeed = (std::max)(0.0f, horizontalSpeed - dt * params_.groundFrictionAccel);
+            velocity.x *= newSpeed / horizontalSpeed;
+            velocity.z *= newSpeed / horizontalSpeed;
+        }
+    }
+
+    // 连续静止在地面上一段时间后进入睡眠
+
+    if(onGround && std::abs(velocity.x) < REST_SPEED && std::abs(velocity.z) < REST_SPEED)
+    {
+        if(++restUpdateCounts_[bodyIndex] >= SLEEP_UPDATE_COUNT)
+        {
+            sleeping_[bodyIndex] = 1;
+            velocity = Vec3();
+        }
+    }
+    else
+    {
+        restUpdateCounts_[bodyIndex] = 0;
+    }
+}
+
+float EntityPhysics::MoveAlongAxis(size_t activeIndex, int axis, float delta) const noexcept
+{
+    const size_t bodyIndex = activeBodies_[activeIndex];
+
+    Collision::AxisSweep sweep({ positions_[bodyIndex], radiuses_[bodyIndex], heights_[bodyIndex] }, axis, delta);
+    for(size_t i = contactBegins_[activeIndex]; i < contactEnds_[activeIndex]; ++i)
+    {
+        sweep.AddBlock(contacts_[i].blockPosition, contacts_[i].aabbs);
+    }
+
+    return sweep.GetMovedDistance();
+}
+
+bool EntityPhysics::IsAffectedByBlock(size_t bodyIndex, const Vec3i &globalBlock) const noexcept
+{
+    // 方块与实体的包围盒相交或相邻时，实体都可能受到影响
+
+    const Vec3 low  = globalBlock.map([](int i) { return static_cast<float>(i); }) - Vec3(1);
+    const Vec3 high = low + Vec3(3);
+
+    const Vec3 &p = positions_[bodyIndex];
+    const float r = radiuses_[bodyIndex];
+    return p.x + r >= low.x && p.x - r <= high.x &&
+           p.y + heights_[bodyIndex] >= low.y && p.y <= high.y &&
+           p.z + r >= low.z && p.z - r <= high.z;
+}
+
+void EntityPhysics::AddToSleepBucket(size_t bodyIndex)
+{
+    // 影响实体的方块距lowCentre不超过reach，reach小于section的大小时只可能位于相邻的section中
+
+    const Vec3 &p = positions_[bodyIndex];
+    const float reach = (std::max)(radiuses_[bodyIndex], heights_[bodyIndex]) + 2;
+
+    Vec3i bucket = LARGE_BODY_BUCKET;
+    if(reach < (std::min)({ CHUNK_SECTION_SIZE_X, CHUNK_SECTION_SIZE_Y, CHUNK_SECTION_SIZE_Z }))
+    {
+        bucket = GlobalBlockToGlobalSection(p.map([](float f) { return static_cast<int>(std::floor(f)); }));
+    }
+
+    sleepBuckets_[bodyIndex] = bucket;
+    sleepingBodies_[bucket].push_back(bodyIDs_[bodyIndex]);
+}
+
+void EntityPhysics::WakeBody(size_t bodyIndex)
+{
+    assert(sleeping_[bodyIndex]);
+    sleeping_[bodyIndex]         = 0;
+    restUpdateCounts_[bodyIndex] = 0;
+
+    auto it = sleepingBodies_.find(sleepBuckets_[bodyIndex]);
+    assert(it != sleepingBodies_.end());
+
+    auto &bodies = it->second;
+    auto bodyIt = std::find(bodies.begin(), bodies.end(), bodyIDs_[bodyIndex]);
+    assert(bodyIt != bodies.end());
+    *bodyIt = bodies.back();
+    bodies.pop_back();
+
+    if(bodies.empty())
+    {
+        sleepingBodies_.erase(it);
+    }
+}
+
+void EntityPhysics::RemoveBodyAt(size_t bodyIndex)
+{
+    const size_t lastIndex = positions_.size() - 1;
+    if(bodyIndex != lastIndex)
+    {
+        positions_       [bodyIndex] = positions_       [lastIndex];
+        velocities_      [bodyIndex] = velocities_      [lastIndex];
+        radiuses_        [bodyIndex] = radiuses_        [lastIndex];
+        heights_         [bodyIndex] = heights_         [lastIndex];
+        onGround_        [bodyIndex] = onGround_        [lastIndex];
+        sleeping_        [bodyIndex] = sleeping_        [lastIndex];
+        restUpdateCounts_[bodyIndex] = restUpdateCounts_[lastIndex];
+        bodyIDs_         [bodyIndex] = bodyIDs_         [lastIndex];
+        sleepBuckets_    [bodyIndex] = sleepBuckets_    [lastIndex];
+
+        idToIndex_[bodyIDs_[bodyIndex]] = uint32_t(bodyIndex);
+    }
+
+    positions_       .pop_back();
+    velocities_      .pop_back();
+    radiuses_        .pop_back();
+    heights_         .pop_back();
+    onGround_        .pop_back();
+    sleeping_        .pop_back();
+    restUpdateCounts_.pop_back();
+    bodyIDs_         .pop_back();
+    sleepBuckets_    .pop_back();
+}
+
+VRPG_GAME_END
@@ -2,21 +2,6 @@
 
 VRPG_GAME_BEGIN
 
-namespace
-{
-    bool IsNegativeForAllVertices(const Vec4 &f, const CullingBoundingBox &bbox) noexcept
-    {
-        return dot(f, { bbox.low.x,  bbox.low.y,  bbox.low.z,  1 }) < -0.01f &&
-               dot(f, { bbox.low.x,  bbox.low.y,  bbox.high.z, 1 }) < -0.01f &&
-               dot(f, { bbox.low.x,  bbox.high.y, bbox.low.z,  1 }) < -0.01f &&
-               dot(f, { bbox.low.x,  bbox.high.y, bbox.high.z, 1 }) < -0.01f &&
-               dot(f, { bbox.high.x, bbox.low.y,  bbox.low.z,  1 }) < -0.01f &&
-               dot(f, { bbox.high.x, bbox.low.y,  bbox.high.z, 1 }) < -0.01f &&
-               dot(f, { bbox.high.x, bbox.high.y, bbox.low.z,  1 }) < -0.01f &&
-               dot(f, { bbox.high.x, bbox.high.y, bbox.high.z, 1 }) < -0.01f;
-    }
-}
-
 void DefaultCamera::Update() noexcept
 {
     direction_ = {
@@ -1,6 +1,7 @@
 ﻿#include <VRPG/Game/Config/GlobalConfig.h>
 #include <VRPG/Game/Player/Player.h>
 #include <VRPG/Game/World/Block/BlockCollision.h>
+#include <VRPG/Game/World/Block/BlockDescription.h>
 #include <VRPG/Game/World/Chunk/ChunkManager.h>
 
 VRPG_GAME_BEGIN
@@ -48,90 +49,6 @@ namespace
                      - static_cast<float>(left)  * Vec3(playerDirection.z, 0, -playerDirection.x);
         return horMove.normalize();
     }
-    
-    struct ResolveSolutionEnumerator
-    {
-        std::vector<BlockCollision::ResolveCollisionResult> *resolveSolutions = nullptr;
-        float bestSolutionLenSqr = (std::numeric_limits<float>::max)();
-        Vec3 bestSolution;
-
-        Vec3 solution;
-        void enumerate(size_t i)
-        {
-            if(i == resolveSolutions->size())
-            {
-                float sqr = solution.length_square();
-                if(sqr < bestSolutionLenSqr)
-                {
-                    bestSolution = solution;
-                    bestSolutionLenSqr = sqr;
-                }
-                return;
-            }
-
-            auto &thisSln = (*resolveSolutions)[i].axisAlignedOffset;
-
-            // +x
-
-            if(thisSln[0] > 0 && solution[0] >= 0)
-            {
-                float sol = solution[0];
-                solution[0] = (std::max)(solution[0], thisSln[0]);
-                enumerate(i + 1);
-                solution[0] = sol;
-            }
-
-            // -x
-
-            if(thisSln[0] < 0 && solution[0] <= 0)
-            {
-                float sol = solution[0];
-                solution[0] = (std::min)(solution[0], thisSln[0]);
-                enumerate(i + 1);
-                solution[0] = sol;
-            }
-
-            // +y
-
-            if(thisSln[1] > 0 && solution[1] >= 0)
-            {
-                float sol = solution[1];
-                solution[1] = (std::max)(solution[1], thisSln[1]);
-                enumerate(i + 1);
-                solution[1] = sol;
-            }
-
-            // -y
-
-            if(thisSln[1] < 0 && solution[1] <= 0)
-            {
-                float sol = solution[1];
-                solution[1] = (std::min)(solution[1], thisSln[1]);
-                enumerate(i + 1);
-                solution[1] = sol;
-            }
-
-            // +z
-
-            if(thisSln[2] > 0 && solution[2] >= 0)
-            {
-                float sol = solution[2];
-                solution[2] = (std::max)(solution[2], thisSln[2]);
-                enumerate(i + 1);
-                solution[2] = sol;
-            }
-
-            // -z
-
-            if(thisSln[2] < 0 && solution[2] <= 0)
-            {
-                float sol = solution[2];
-                solution[2] = (std::min)(solution[2], thisSln[2]);
-                enumerate(i + 1);
-                solution[2] = sol;
-            }
-        }
-    };
 }
 
 bool Player::PlayerParams::IsValid() const noexcept
@@ -475,111 +392,62 @@ void Player::UpdateState(const UserInput &userInput, float dt)
 void Player::UpdatePosition(float dt)
 {
     Vec3 deltaPosition = dt * velocity_;
-    Vec3 newPosition = position_ + deltaPosition;
 
     if(!enableCollision_)
     {
-        position_ = newPosition;
+        position_ += deltaPosition;
         return;
     }
 
-    Vec3 lowf  = newPosition - Vec3(params_.collisionRadius, 0, params_.collisionRadius)
-                             - Vec3(0.2f);
-    Vec3 highf = newPosition + Vec3(params_.collisionRadius,
-                                    params_.collisionHeight,
-                                    params_.collisionRadius)
-                             + Vec3(0.2f);
-    Vec3i lowi  = lowf .map([](float f) { return static_cast<int>(std::floor(f)); });
-    Vec3i highi = highf.map([](float f) { return static_cast<int>(std::ceil(f)); });
+    // 依次沿y、x、z轴移动碰撞体，每次只求解该轴上的最大可行位移
+    // 总开销与移动扫过的方块数量成线性关系
 
-    static std::vector<BlockCollision::ResolveCollisionResult> resolveSolutions;
-    resolveSolutions.clear();
-
-    for(int x = lowi.x; x <= highi.x; ++x)
+    onGround_ = false;
+    for(int axis : { 1, 0, 2 })
     {
-        for(int z = lowi.z; z <= highi.z; ++z)
+        if(deltaPosition[axis] == 0)
         {
-            for(int y = lowi.y; y <= highi.y; ++y)
+            continue;
+        }
+
+        float movedDistance = MoveAlongAxis(axis, deltaPosition[axis]);
+        if(movedDistance != deltaPosition[axis])
+        {
+            if(axis == 1 && deltaPosition[axis] < 0)
             {
-                auto collision   = chunkManager_->GetBlockDesc({ x, y, z })->GetCollision();
-                auto orientation = chunkManager_->GetBlockOrientation({ x, y, z });
-
-                Vec3 localPosition = {
-                    position_.x - static_cast<float>(x),
-                    position_.y - static_cast<float>(y),
-                    position_.z - static_cast<float>(z)
-                };
-                Vec3 localNewPosition = {
-                    newPosition.x - static_cast<float>(x),
-                    newPosition.y - static_cast<float>(y),
-                    newPosition.z - static_cast<float>(z),
-                };
-
-                Collision::AACylinder cylinder{
-                    localPosition,
-                    params_.collisionRadius,
-                    params_.collisionHeight
-                };
-
-                BlockCollision::ResolveCollisionResult result;
-                if(collision->ResolveCollisionWith(orientation, cylinder, localNewPosition, &result))
-                {
-                    resolveSolutions.push_back(result);
-                }
+                onGround_ = true;
             }
+            velocity_[axis] = 0;
         }
     }
+}
 
-    onGround_ = false;
-    if(resolveSolutions.empty())
-    {
-        position_ = newPosition;
-        return;
-    }
-
-    ResolveSolutionEnumerator enumerator;
-    enumerator.resolveSolutions = &resolveSolutions;
-    enumerator.enumerate(0);
-
-    if(enumerator.bestSolutionLenSqr == (std::numeric_limits<float>::max)())
-    {
-        velocity_ = Vec3();
-        return;
-    }
+float Player::MoveAlongAxis(int axis, float delta)
+{
+    Vec3 newPosition = position_;
+    newPosition[axis] += delta;
 
-    if(enumerator.bestSolution.x != 0)
-    {
-        velocity_.x = 0;
-    }
+    const Collision::AACylinder cylinder{ position_, params_.collisionRadius, params_.collisionHeight };
 
-    if(enumerator.bestSolution.y != 0)
-    {
-        velocity_.y = 0;
-    }
+    Vec3i lowi, highi;
+    Collision::GetSweptBlockRange(cylinder, newPosition, lowi, highi);
 
-    if(enumerator.bestSolution.z != 0)
-    {
-        velocity_.z = 0;
-    }
+    // 每个方块的AABB都沿该轴做扫掠测试，因此单次移动距离超过方块厚度时也不会穿过方块
 
-    if(enumerator.bestSolution.y > 0)
-    {
-        onGround_ = true;
-    }
+    auto &blockDescMgr = BlockDescManager::GetInstance();
+    Collision::AxisSweep sweep(cylinder, axis, delta);
 
-    Vec3 resolvedNewPosition       = newPosition + enumerator.bestSolution;
-    Vec3 resolvedDeltaPosition     = resolvedNewPosition - position_;
-    float resolvedDeltaPositionLen = resolvedDeltaPosition.length();
-    if(resolvedDeltaPositionLen < 1e-2f)
+    chunkManager_->ForEachCollidableBlock(lowi, highi, true,
+        [&](const Vec3i &globalBlock, BlockID id, BlockOrientation orientation)
     {
-        return;
-    }
-
-    Vec3 resolvedDeltaDir         = resolvedDeltaPosition / resolvedDeltaPositionLen;
-    float maxResolvedDeltaLen     = (std::max)(0.0f, dot(deltaPosition, resolvedDeltaDir));
-    float clampedResolvedDeltaLen = (std::min)(resolvedDeltaPositionLen, maxResolvedDeltaLen);
+        sweep.AddBlock(
+            globalBlock.map([](int i) { return static_cast<float>(i); }),
+            blockDescMgr.GetCollisionAABBs(id, orientation));
+    });
 
-    position_ += clampedResolvedDeltaLen * resolvedDeltaDir;
+    const float movedDistance = sweep.GetMovedDistance();
+    position_[axis] += movedDistance;
+    return movedDistance;
 }
 
 bool Player::HasMoving(const UserInput &userInput) noexcept
@@ -6,7 +6,7 @@
 VRPG_GAME_BEGIN
 
 DefaultBlockDescription::DefaultBlockDescription(std::shared_ptr<const DefaultBlockEffect> effect) noexcept
-    : effect_(std::move(effect))
+    : effect_(std::move(effect)), faceTemplates_(&BoxFaceTemplateTable::GetInstance())
 {
     
 }
@@ -46,35 +46,28 @@ void DefaultBlockDescription::AddBlockModel(
     const Vec3i &blockPosition,
     const BlockNeighborhood neighborhood) const
 {
+    auto &blockDescMgr = BlockDescManager::GetInstance();
     auto builder = modelBuilders.GetBuilderByEffect(effect_.get());
     Vec3 positionBase = blockPosition.map([](int i) { return float(i); });
 
-    auto addFace = [&](
-        const Vec3 &posA, const Vec3 &posB, const Vec3 &posC, const Vec3 &posD,
-        const Vec4 &lhtA, const Vec4 &lhtB, const Vec4 &lhtC, const Vec4 &lhtD)
+    auto addFace = [&](const Vec3 position[4], const Vec4 light[4], const Vec3 &normal)
     {
-        Vec3 posE = 0.25f * (posA + posB + posC + posD);
-        Vec4 lhtE = 0.25f * (lhtA + lhtB+  lhtC + lhtD);
-
         VertexIndex vertexCount = VertexIndex(builder->GetVertexCount());
-        Vec3 normal = cross(posB - posA, posC - posB).normalize();
-
-        builder->AddVertex({ posA, lhtA, normal });
-        builder->AddVertex({ posB, lhtB, normal });
-        builder->AddVertex({ posC, lhtC, normal });
-        builder->AddVertex({ posD, lhtD, normal });
-        builder->AddVertex({ posE, lhtE, normal });
-
-        builder->AddIndexedTriangle(vertexCount + 0, vertexCount + 1, vertexCount + 4);
-        builder->AddIndexedTriangle(vertexCount + 1, vertexCount + 2, vertexCount + 4);
-        builder->AddIndexedTriangle(vertexCount + 2, vertexCount + 3, vertexCount + 4);
-        builder->AddIndexedTriangle(vertexCount + 3, vertexCount + 0, vertexCount + 4);
+
+        builder->AddVertex({ position[0], light[0], normal });
+        builder->AddVertex({ position[1], light[1], normal });
+        builder->AddVertex({ position[2], light[2], normal });
+        builder->AddVertex({ position[3], light[3], normal });
+
+        const int *indices = BoxFaceQuadIndices(light[0], light[1], light[2], light[3]);
+        builder->AddIndexedTriangle(vertexCount + indices[0], vertexCount + indices[1], vertexCount + indices[2]);
+        builder->AddIndexedTriangle(vertexCount + indices[3], vertexCount + indices[4], vertexCount + indices[5]);
     };
 
-    auto isFaceVisible = [&](int neiX, int neiY, int neiZ, Direction neiDir)
+    auto isFaceVisible = [&](int neiOffset, Direction neiDir)
     {
-        neiDir = neighborhood[neiX][neiY][neiZ].orientation.RotatedToOrigin(neiDir);
-        FaceVisibilityType neiVis = neighborhood[neiX][neiY][neiZ].desc->GetFaceVisibility(neiDir);
+        auto &nei = neighborhood.GetByOffset(neiOffset);
+        FaceVisibilityType neiVis = blockDescMgr.GetFaceVisibility(nei.id, nei.orientation, neiDir);
         FaceVisibility visibility = TestFaceVisibility(FaceVisibilityType::Solid, neiVis);
         return visibility == FaceVisibility::Yes;
     };
@@ -83,36 +76,21 @@ void DefaultBlockDescription::AddBlockModel(
 
     auto generateFace = [&](Direction normalDirection)
     {
-        Direction rotDir = orientation.OriginToRotated(normalDirection);;
-        static const Vec3i ROT_DIR_TO_NEI_INDEX[6] =
-        {
-            { 2, 1, 1 }, { 0, 1, 1 },
-            { 1, 2, 1 }, { 1, 0, 1 },
-            { 1, 1, 2 }, { 1, 1, 0 }
-        };
-        Vec3i neiIndex = ROT_DIR_TO_NEI_INDEX[int(rotDir)];
-        if(!isFaceVisible(neiIndex.x, neiIndex.y, neiIndex.z, -rotDir))
+        const BoxFaceTemplate &face = faceTemplates_->GetTemplate(orientation, normalDirection);
+        if(!isFaceVisible(face.neighborOffset, -face.rotatedNormal))
         {
             return;
         }
 
         Vec3 position[4];
-        GenerateBoxFaceDynamic(normalDirection, position);
-        position[0] = RotateLocalPosition(orientation, position[0]);
-        position[1] = RotateLocalPosition(orientation, position[1]);
-        position[2] = RotateLocalPosition(orientation, position[2]);
-        position[3] = RotateLocalPosition(orientation, position[3]);
-
-        Vec4 light0 = BoxVertexBrightness(neighborhood, rotDir, position[0]);
-        Vec4 light1 = BoxVertexBrightness(neighborhood, rotDir, position[1]);
-        Vec4 light2 = BoxVertexBrightness(neighborhood, rotDir, position[2]);
-        Vec4 light3 = BoxVertexBrightness(neighborhood, rotDir, position[3]);
-
-        addFace(positionBase + position[0],
-                positionBase + position[1],
-                positionBase + position[2],
-                positionBase + position[3],
-                light0, light1, light2, light3);
+        Vec4 light[4];
+        for(int i = 0; i < 4; ++i)
+        {
+            position[i] = positionBase + face.position[i];
+            light[i]    = BoxVertexBrightness(neighborhood, face.lightSamples[i]);
+        }
+
+        addFace(position, light, face.normal);
     };
 
     generateFace(PositiveX);
@@ -13,6 +13,7 @@ DiffuseSolidBoxDescription::DiffuseSolidBoxDescription(
         textureIndexInEffect[0], textureIndexInEffect[1], textureIndexInEffect[2],
         textureIndexInEffect[3], textureIndexInEffect[4], textureIndexInEffect[5]
       },
+      faceTemplates_(&BoxFaceTemplateTable::GetInstance()),
       isLightSource_(emission != BLOCK_BRIGHTNESS_MIN), emission_(emission)
 {
 
@@ -58,74 +59,37 @@ void DiffuseSolidBoxDescription::AddBlockModel(
     const Vec3i &blockPosition,
     const BlockNeighborhood blocks) const
 {
+    auto &blockDescMgr = BlockDescManager::GetInstance();
     auto builder = modelBuilders.GetBuilderByEffect(effect_.get());
     Vec3 positionBase = blockPosition.map([](int i) { return float(i); });
 
-    auto isFaceVisible = [&](int neiX, int neiY, int neiZ, Direction neiDir)
+    auto isFaceVisible = [&](int neiOffset, Direction neiDir)
     {
-        neiDir = blocks[neiX][neiY][neiZ].orientation.RotatedToOrigin(neiDir);
-        FaceVisibilityType neiVis = blocks[neiX][neiY][neiZ].desc->GetFaceVisibility(neiDir);
+        auto &nei = blocks.GetByOffset(neiOffset);
+        FaceVisibilityType neiVis = blockDescMgr.GetFaceVisibility(nei.id, nei.orientation, neiDir);
         FaceVisibility visibility = TestFaceVisibility(FaceVisibilityType::Solid, neiVis);
         return visibility == FaceVisibility::Yes;
     };
     
-    auto addFace = [&](
-        const Vec3 &posA, const Vec3 &posB, const Vec3 &posC, const Vec3 &posD,
-        const Vec4 &lhtA, const Vec4 &lhtB, const Vec4 &lhtC, const Vec4 &lhtD,
-        uint32_t textureIndexInEffect)
-    {
-        Vec3 posE = 0.25f * (posA + posB + posC + posD);
-        Vec4 lhtE = 0.25f * (lhtA + lhtB + lhtC + lhtD);
-
-        VertexIndex vertexCount = VertexIndex(builder->GetVertexCount());
-        Vec3 normal = cross(posB - posA, posC - posB).normalize();
-
-        builder->AddVertex({ posA, BOX_FACE_TEXCOORD[0], normal, lhtA, textureIndexInEffect });
-        builder->AddVertex({ posB, BOX_FACE_TEXCOORD[1], normal, lhtB, textureIndexInEffect });
-        builder->AddVertex({ posC, BOX_FACE_TEXCOORD[2], normal, lhtC, textureIndexInEffect });
-        builder->AddVertex({ posD, BOX_FACE_TEXCOORD[3], normal, lhtD, textureIndexInEffect });
-        builder->AddVertex({ posE, Vec2(0.5f, 0.5f), normal, lhtE, textureIndexInEffect });
-
-        builder->AddIndexedTriangle(vertexCount + 0, vertexCount + 1, vertexCount + 4);
-        builder->AddIndexedTriangle(vertexCount + 1, vertexCount + 2, vertexCount + 4);
-        builder->AddIndexedTriangle(vertexCount + 2, vertexCount + 3, vertexCount + 4);
-        builder->AddIndexedTriangle(vertexCount + 3, vertexCount + 0, vertexCount + 4);
-    };
-
     BlockOrientation orientation = blocks[1][1][1].orientation;
 
     auto generateFace = [&](Direction normalDirection)
     {
-        Direction rotDir = orientation.OriginToRotated(normalDirection);;
-        static const Vec3i ROT_DIR_TO_NEI_INDEX[6] =
-        {
-            { 2, 1, 1 }, { 0, 1, 1 },
-            { 1, 2, 1 }, { 1, 0, 1 },
-            { 1, 1, 2 }, { 1, 1, 0 }
-        };
-        Vec3i neiIndex = ROT_DIR_TO_NEI_INDEX[int(rotDir)];
-        if(!isFaceVisible(neiIndex.x, neiIndex.y, neiIndex.z, -rotDir))
+        const BoxFaceTemplate &face = faceTemplates_->GetTemplate(orientation, normalDirection);
+        if(!isFaceVisible(face.neighborOffset, -face.rotatedNormal))
         {
             return;
         }
 
         Vec3 position[4];
-        GenerateBoxFaceDynamic(normalDirection, position);
-        position[0] = RotateLocalPosition(orientation, position[0]);
-        position[1] = RotateLocalPosition(orientation, position[1]);
-        position[2] = RotateLocalPosition(orientation, position[2]);
-        position[3] = RotateLocalPosition(orientation, position[3]);
-
-        Vec4 light0 = BoxVertexBrightness(blocks, rotDir, position[0]);
-        Vec4 light1 = BoxVertexBrightness(blocks, rotDir, position[1]);
-        Vec4 light2 = BoxVertexBrightness(blocks, rotDir, position[2]);
-        Vec4 light3 = BoxVertexBrightness(blocks, rotDir, position[3]);
-        
-        addFace(positionBase + position[0],
-                positionBase + position[1],
-                positionBase + position[2],
-                positionBase + position[3],
-                light0, light1, light2, light3, textureIndexInEffect_[int(normalDirection)]);
+        Vec4 light[4];
+        for(int i = 0; i < 4; ++i)
+        {
+            position[i] = positionBase + face.position[i];
+            light[i]    = BoxVertexBrightness(blocks, face.lightSamples[i]);
+        }
+
+        builder->AddBoxFace(blockPosition, face.rotatedNormal, position, light, textureIndexInEffect_[int(normalDirection)]);
     };
 
     generateFace(PositiveX);
@@ -136,6 +100,18 @@ void DiffuseSolidBoxDescription::AddBlockModel(
     generateFace(NegativeZ);
 }
 
+bool DiffuseSolidBoxDescription::HasLODModel() const noexcept
+{
+    return true;
+}
+
+void DiffuseSolidBoxDescription::AddLODBoxFace(
+    ModelBuilderSet &modelBuilders, Direction normal, const Vec3 position[4], const Vec4 &brightness, int cellSize) const
+{
+    auto builder = modelBuilders.GetBuilderByEffect(effect_.get());
+    builder->AddScaledBoxFace(normal, position, brightness, textureIndexInEffect_[int(normal)], cellSize);
+}
+
 const BlockCollision *DiffuseSolidBoxDescription::GetCollision() const noexcept
 {
     static const BoxBlockCollision ret;
@@ -13,6 +13,7 @@ TransparentBoxDescription::TransparentBoxDescription(
           textureIndexInEffect[0], textureIndexInEffect[1], textureIndexInEffect[2],
           textureIndexInEffect[3], textureIndexInEffect[4], textureIndexInEffect[5]
       },
+      faceTemplates_(&BoxFaceTemplateTable::GetInstance()),
       attenuation_(attenuation)
 {
 
@@ -58,39 +59,33 @@ void TransparentBoxDescription::AddBlockModel(
     const Vec3i &blockPosition,
     const BlockNeighborhood blocks) const
 {
+    auto &blockDescMgr = BlockDescManager::GetInstance();
     auto builder = modelBuilders.GetBuilderByEffect(effect_.get());
     Vec3 positionBase = blockPosition.map([](int i) { return float(i); });
 
-    auto isFaceVisible = [&](int neiX, int neiY, int neiZ, Direction neiDir)
+    auto isFaceVisible = [&](int neiOffset, Direction neiDir)
     {
-        auto neiDesc = blocks[neiX][neiY][neiZ].desc;
-        neiDir = blocks[neiX][neiY][neiZ].orientation.RotatedToOrigin(neiDir);
-        FaceVisibilityType neiVis = neiDesc->GetFaceVisibility(neiDir);
+        auto &nei = blocks.GetByOffset(neiOffset);
+        FaceVisibilityType neiVis = blockDescMgr.GetFaceVisibility(nei.id, nei.orientation, neiDir);
         FaceVisibility vis = TestFaceVisibility(FaceVisibilityType::Transparent, neiVis);
-        return vis == FaceVisibility::Yes || (vis == FaceVisibility::Diff && neiDesc != this);
+        return vis == FaceVisibility::Yes || (vis == FaceVisibility::Diff && nei.id != GetBlockID());
     };
     
-    auto addFace = [&](
-        const Vec3 &posA, const Vec3 &posB, const Vec3 &posC, const Vec3 &posD,
-        const Vec4 &lhtA, const Vec4 &lhtB, const Vec4 &lhtC, const Vec4 &lhtD,
-        uint32_t textureIndexInEffect)
+    auto addFace = [&](const Vec3 position[4], const Vec2 texCoord[4], const Vec4 light[4], uint32_t textureIndexInEffect)
     {
-        Vec3 posE = 0.25f * (posA + posB + posC + posD);
-        Vec4 lhtE = 0.25f * (lhtA + lhtB + lhtC + lhtD);
+        Vec3 posE = 0.25f * (position[0] + position[1] + position[2] + position[3]);
 
         VertexIndex vertexCount = VertexIndex(builder->GetVertexCount());
         VertexIndex startIndex = VertexIndex(builder->GetIndexCount());
 
-        builder->AddVertex({ posA, BOX_FACE_TEXCOORD[0], textureIndexInEffect, lhtA });
-        builder->AddVertex({ posB, BOX_FACE_TEXCOORD[1], textureIndexInEffect, lhtB });
-        builder->AddVertex({ posC, BOX_FACE_TEXCOORD[2], textureIndexInEffect, lhtC });
-        builder->AddVertex({ posD, BOX_FACE_TEXCOORD[3], textureIndexInEffect, lhtD });
-        builder->AddVertex({ posE, Vec2(0.5f, 0.5f), textureIndexInEffect, lhtE });
+        builder->AddVertex({ position[0], texCoord[0], textureIndexInEffect, light[0] });
+        builder->AddVertex({ position[1], texCoord[1], textureIndexInEffect, light[1] });
+        builder->AddVertex({ position[2], texCoord[2], textureIndexInEffect, light[2] });
+        builder->AddVertex({ position[3], texCoord[3], textureIndexInEffect, light[3] });
 
-        builder->AddIndexedTriangle(vertexCount + 0, vertexCount + 1, vertexCount + 4);
-        builder->AddIndexedTriangle(vertexCount + 1, vertexCount + 2, vertexCount + 4);
-        builder->AddIndexedTriangle(vertexCount + 2, vertexCount + 3, vertexCount + 4);
-        builder->AddIndexedTriangle(vertexCount + 3, vertexCount + 0, vertexCount + 4);
+        const int *indices = BoxFaceQuadIndices(light[0], light[1], light[2], light[3]);
+        builder->AddIndexedTriangle(vertexCount + indices[0], vertexCount + indices[1], vertexCount + indices[2]);
+        builder->AddIndexedTriangle(vertexCount + indices[3], vertexCount + indices[4], vertexCount + indices[5]);
 
         builder->AddFaceIndexRange(posE, startIndex);
     };
@@ -99,36 +94,21 @@ void TransparentBoxDescription::AddBlockModel(
 
     auto generateFace = [&](Direction normalDirection)
     {
-        Direction rotDir = orientation.OriginToRotated(normalDirection);;
-        static const Vec3i ROT_DIR_TO_NEI_INDEX[6] =
-        {
-            { 2, 1, 1 }, { 0, 1, 1 },
-            { 1, 2, 1 }, { 1, 0, 1 },
-            { 1, 1, 2 }, { 1, 1, 0 }
-        };
-        Vec3i neiIndex = ROT_DIR_TO_NEI_INDEX[int(rotDir)];
-        if(!isFaceVisible(neiIndex.x, neiIndex.y, neiIndex.z, -rotDir))
+        const BoxFaceTemplate &face = faceTemplates_->GetTemplate(orientation, normalDirection);
+        if(!isFaceVisible(face.neighborOffset, -face.rotatedNormal))
         {
             return;
         }
 
         Vec3 position[4];
-        GenerateBoxFaceDynamic(normalDirection, position);
-        position[0] = RotateLocalPosition(orientation, position[0]);
-        position[1] = RotateLocalPosition(orientation, position[1]);
-        position[2] = RotateLocalPosition(orientation, position[2]);
-        position[3] = RotateLocalPosition(orientation, position[3]);
-
-        Vec4 light0 = BoxVertexBrightness(blocks, rotDir, position[0]);
-        Vec4 light1 = BoxVertexBrightness(blocks, rotDir, position[1]);
-        Vec4 light2 = BoxVertexBrightness(blocks, rotDir, position[2]);
-        Vec4 light3 = BoxVertexBrightness(blocks, rotDir, position[3]);
-        
-        addFace(positionBase + position[0],
-                positionBase + position[1],
-                positionBase + position[2],
-                positionBase + position[3],
-                light0, light1, light2, light3, textureIndexInEffect_[int(normalDirection)]);
+        Vec4 light[4];
+        for(int i = 0; i < 4; ++i)
+        {
+            position[i] = positionBase + face.position[i];
+            light[i]    = BoxVertexBrightness(blocks, face.lightSamples[i]);
+        }
+
+        addFace(position, face.texCoord, light, textureIndexInEffect_[int(normalDirection)]);
     };
 
     generateFace(PositiveX);
@@ -60,17 +60,18 @@ void TransparentLiquidDescription::AddBlockModel(
     const Vec3i &blockPosition,
     const BlockNeighborhood blocks) const
 {
+    auto &blockDescMgr = BlockDescManager::GetInstance();
     auto builder = modelBuilders.GetBuilderByEffect(effect_.get());
     Vec3 positionBase = blockPosition.map([](int i) { return float(i); });
+    const BlockID thisID = GetBlockID();
 
     auto isFaceVisible = [&](Direction dirToNei)
     {
         auto [x, y, z] = DirectionToVectori(dirToNei) + Vec3i(1);
-        auto neiDesc = blocks[x][y][z].desc;
-        Direction neiDir = blocks[x][y][z].orientation.RotatedToOrigin(-dirToNei);
-        FaceVisibilityType neiVis = neiDesc->GetFaceVisibility(neiDir);
+        auto &nei = blocks[x][y][z];
+        FaceVisibilityType neiVis = blockDescMgr.GetFaceVisibility(nei.id, nei.orientation, -dirToNei);
         FaceVisibility vis = TestFaceVisibility(FaceVisibilityType::Transparent, neiVis);
-        return vis == FaceVisibility::Yes || (vis == FaceVisibility::Diff && this != neiDesc);
+        return vis == FaceVisibility::Yes || (vis == FaceVisibility::Diff && thisID != nei.id);
     };
 
     auto addFace = [&](
@@ -78,9 +79,6 @@ void TransparentLiquidDescription::AddBlockModel(
         const Vec4 &lhtA, const Vec4 &lhtB, const Vec4 &lhtC, const Vec4 &lhtD,
         const Vec3 &sortCentre)
     {
-        Vec3 posE = 0.25f * (posA + posB + posC + posD);
-        Vec4 lhtE = 0.25f * (lhtA + lhtB + lhtC + lhtD);
-
         VertexIndex vertexCount = VertexIndex(builder->GetVertexCount());
         VertexIndex startIndex = VertexIndex(builder->GetIndexCount());
 
@@ -88,41 +86,40 @@ void TransparentLiquidDescription::AddBlockModel(
         builder->AddVertex({ positionBase + posB, Vec2(0.5f), uint32_t(textureIndexInEffect_), lhtB });
         builder->AddVertex({ positionBase + posC, Vec2(0.5f), uint32_t(textureIndexInEffect_), lhtC });
         builder->AddVertex({ positionBase + posD, Vec2(0.5f), uint32_t(textureIndexInEffect_), lhtD });
-        builder->AddVertex({ positionBase + posE, Vec2(0.5f), uint32_t(textureIndexInEffect_), lhtE });
 
-        builder->AddIndexedTriangle(vertexCount + 0, vertexCount + 1, vertexCount + 4);
-        builder->AddIndexedTriangle(vertexCount + 1, vertexCount + 2, vertexCount + 4);
-        builder->AddIndexedTriangle(vertexCount + 2, vertexCount + 3, vertexCount + 4);
-        builder->AddIndexedTriangle(vertexCount + 3, vertexCount + 0, vertexCount + 4);
+        const int *indices = BoxFaceQuadIndices(lhtA, lhtB, lhtC, lhtD);
+        builder->AddIndexedTriangle(vertexCount + indices[0], vertexCount + indices[1], vertexCount + indices[2]);
+        builder->AddIndexedTriangle(vertexCount + indices[3], vertexCount + indices[4], vertexCount + indices[5]);
 
         builder->AddFaceIndexRange(positionBase + sortCentre, startIndex);
     };
 
-    bool isThisSource = blocks[1][1][1].desc->GetLiquid()->IsSource(*blocks[1][1][1].extraData);
-    bool isUpSame = blocks[1][2][1].desc == this;
+    bool isThisSource = GetLiquid()->IsSource(blocks.GetExtraData(1, 1, 1));
+    bool isUpSame = blocks[1][2][1].id == thisID;
 
     // 计算四个xz角点处的液面高度
     float vertexHeights[2][2];
     {
         auto vertexHeight = [&](int x, int z) -> float
         {
-            auto &block = blocks[x][1][z];
-            if(!block.desc->IsLiquid())
+            BlockID id = blocks[x][1][z].id;
+            if(!blockDescMgr.IsLiquid(id))
             {
                 return 0;
             }
 
-            auto liquid = block.desc->GetLiquid();
-            if(liquid->IsSource(*block.extraData))
+            auto liquid = blockDescMgr.GetBlockDescription(id)->GetLiquid();
+            auto &extraData = blocks.GetExtraData(x, 1, z);
+            if(liquid->IsSource(extraData))
             {
-                if(blocks[x][2][z].desc != block.desc)
+                if(blocks[x][2][z].id != id)
                 {
                     return liquid->TopSourceHeight();
                 }
                 return 1;
             }
             
-            return liquid->LevelToVertexHeight(ExtraDataToLiquidLevel(*block.extraData));
+            return liquid->LevelToVertexHeight(ExtraDataToLiquidLevel(extraData));
         };
 
         float blockHeights[3][3];
@@ -136,7 +133,7 @@ void TransparentLiquidDescription::AddBlockModel(
 
         auto synthesisVertexHeight = [&](int dx, int dz) -> float
         {
-            if(!isThisSource && !isUpSame && blocks[1 + dx][1][1].desc->IsVoid() && blocks[1][1][1 + dz].desc->IsVoid())
+            if(!isThisSource && !isUpSame && blocks[1 + dx][1][1].id == BLOCK_ID_VOID && blocks[1][1][1 + dz].id == BLOCK_ID_VOID)
             {
                 return 0;
             }
@@ -165,17 +162,17 @@ void TransparentLiquidDescription::AddBlockModel(
 
             int count = 1;
             Vec4 sum = BlockBrightnessToFloat(blocks[1][1][1].brightness);
-            if(blocks[1 + dx][1][1].desc == this)
+            if(blocks[1 + dx][1][1].id == thisID)
             {
                 ++count;
                 sum += BlockBrightnessToFloat(blocks[1 + dx][1][1].brightness);
             }
-            if(blocks[1][1][1 + dz].desc == this)
+            if(blocks[1][1][1 + dz].id == thisID)
             {
                 ++count;
                 sum += BlockBrightnessToFloat(blocks[1][1][1 + dz].brightness);
             }
-            if(count > 1 && blocks[1 + dx][1][1 + dz].desc == this)
+            if(count > 1 && blocks[1 + dx][1][1 + dz].id == thisID)
             {
                 ++count;
                 sum += BlockBrightnessToFloat(blocks[1 + dx][1][1 + dz].brightness);
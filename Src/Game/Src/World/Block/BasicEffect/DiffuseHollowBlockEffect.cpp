@@ -21,21 +21,23 @@ void DiffuseHollowBlockEffectCommon::InitializeForward()
     forwardUniforms_ = forwardShader_.CreateUniformManager();
 
     forwardInputLayout_ = InputLayoutBuilder
-        ("POSITION",   0, DXGI_FORMAT_R32G32B32_FLOAT,    offsetof(DiffuseHollowBlockEffect::Vertex, position))
-        ("TEXCOORD",   0, DXGI_FORMAT_R32G32_FLOAT,       offsetof(DiffuseHollowBlockEffect::Vertex, texCoord))
-        ("NORMAL",     0, DXGI_FORMAT_R32G32B32_FLOAT,    offsetof(DiffuseHollowBlockEffect::Vertex, normal))
-        ("TEXINDEX",   0, DXGI_FORMAT_R32_UINT,           offsetof(DiffuseHollowBlockEffect::Vertex, texIndex))
-        ("BRIGHTNESS", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, offsetof(DiffuseHollowBlockEffect::Vertex, brightness))
+        ("POSITION",   0, DXGI_FORMAT_R16G16B16A16_UINT, offsetof(DiffuseHollowBlockEffect::Vertex, position))
+        ("TEXCOORD",   0, DXGI_FORMAT_R8G8_SINT,         offsetof(DiffuseHollowBlockEffect::Vertex, texCoord))
+        ("TEXINDEX",   0, DXGI_FORMAT_R16_UINT,          offsetof(DiffuseHollowBlockEffect::Vertex, texIndex))
+        ("BRIGHTNESS", 0, DXGI_FORMAT_R8G8B8A8_UNORM,    offsetof(DiffuseHollowBlockEffect::Vertex, brightness))
         .Build(forwardShader_.GetVertexShaderByteCode());
 
     forwardVSTransform_.Initialize(true, nullptr);
     forwardPSPerFrame_.Initialize(true, nullptr);
+    vsSection_.Initialize(true, nullptr);
 
     forwardUniforms_.GetConstantBufferSlot<SS_VS>("Transform")->SetBuffer(forwardVSTransform_);
+    forwardUniforms_.GetConstantBufferSlot<SS_VS>("Section")->SetBuffer(vsSection_);
     forwardUniforms_.GetConstantBufferSlot<SS_PS>("PerFrame")->SetBuffer(forwardPSPerFrame_);
 
     Sampler diffuseSampler;
-    diffuseSampler.Initialize(D3D11_FILTER_MIN_LINEAR_MAG_POINT_MIP_LINEAR);
+    diffuseSampler.Initialize(
+        D3D11_FILTER_MIN_LINEAR_MAG_POINT_MIP_LINEAR, D3D11_TEXTURE_ADDRESS_WRAP, D3D11_TEXTURE_ADDRESS_WRAP);
     forwardUniforms_.GetSamplerSlot<SS_PS>("DiffuseSampler")->SetSampler(diffuseSampler);
 
     forwardDiffuseTextureSlot_ = forwardUniforms_.GetShaderResourceSlot<SS_PS>("DiffuseTexture");
@@ -49,13 +51,10 @@ void DiffuseHollowBlockEffectCommon::InitializeForward()
 
 void DiffuseHollowBlockEffectCommon::InitializeShadow()
 {
-    std::string vertexShaderSource = agz::file::read_txt_file(
+    shadowShader_.InitializeStageFromFile<SS_VS>(
         GLOBAL_CONFIG.ASSET_PATH["BlockEffect"]["DiffuseHollow"]["ShadowVertexShader"]);
-    std::string pixelShaderSource  = agz::file::read_txt_file(
+    shadowShader_.InitializeStageFromFile<SS_PS>(
         GLOBAL_CONFIG.ASSET_PATH["BlockEffect"]["DiffuseHollow"]["ShadowPixelShader"]);
-
-    shadowShader_.InitializeStage<SS_VS>(vertexShaderSource);
-    shadowShader_.InitializeStage<SS_PS>(pixelShaderSource);
     if(!shadowShader_.IsAllStagesAvailable())
     {
         throw VRPGGameException("failed to initialize shadow shader for diffuse hollow block effect");
@@ -65,17 +64,19 @@ void DiffuseHollowBlockEffectCommon::InitializeShadow()
 
     shadowVSTransform_.Initialize(true, nullptr);
     shadowUniforms_.GetConstantBufferSlot<SS_VS>("Transform")->SetBuffer(shadowVSTransform_);
+    shadowUniforms_.GetConstantBufferSlot<SS_VS>("Section")->SetBuffer(vsSection_);
 
     Sampler sampler;
-    sampler.Initialize(D3D11_FILTER_MIN_LINEAR_MAG_POINT_MIP_LINEAR);
+    sampler.Initialize(
+        D3D11_FILTER_MIN_LINEAR_MAG_POINT_MIP_LINEAR, D3D11_TEXTURE_ADDRESS_WRAP, D3D11_TEXTURE_ADDRESS_WRAP);
     shadowUniforms_.GetSamplerSlot<SS_PS>("DiffuseSampler")->SetSampler(sampler);
 
     shadowDiffuseTextureSlot_ = shadowUniforms_.GetShaderResourceSlot<SS_PS>("DiffuseTexture");
 
     shadowInputLayout_ = InputLayoutBuilder
-        ("POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, offsetof(DiffuseHollowBlockEffect::Vertex, position))
-        ("TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,    offsetof(DiffuseHollowBlockEffect::Vertex, texCoord))
-        ("TEXINDEX", 0, DXGI_FORMAT_R32_UINT,        offsetof(DiffuseHollowBlockEffect::Vertex, texIndex))
+        ("POSITION", 0, DXGI_FORMAT_R16G16B16A16_UINT, offsetof(DiffuseHollowBlockEffect::Vertex, position))
+        ("TEXCOORD", 0, DXGI_FORMAT_R8G8_SINT,         offsetof(DiffuseHollowBlockEffect::Vertex, texCoord))
+        ("TEXINDEX", 0, DXGI_FORMAT_R16_UINT,          offsetof(DiffuseHollowBlockEffect::Vertex, texIndex))
         .Build(shadowShader_.GetVertexShaderByteCode());
 
     shadowRasterizerState_ = CreateRasterizerStateForShadowMapping(false);
@@ -102,6 +103,11 @@ void DiffuseHollowBlockEffectCommon::SetShadowRenderParams(const ShadowRenderPar
     shadowVSTransform_.SetValue({ params.shadowViewProj });
 }
 
+void DiffuseHollowBlockEffectCommon::SetSectionOrigin(const Vec3 &origin)
+{
+    vsSection_.SetValue({ origin, 0 });
+}
+
 void DiffuseHollowBlockEffectCommon::StartForward(ID3D11ShaderResourceView *textureArray)
 {
     forwardDiffuseTextureSlot_->SetShaderResourceView(textureArray);
@@ -170,7 +176,7 @@ void DiffuseHollowBlockEffect::EndShadow() const
 
 std::unique_ptr<ModelBuilder> DiffuseHollowBlockEffect::CreateModelBuilder(const Vec3i &globalSectionPosition) const
 {
-    return std::make_unique<Builder>(globalSectionPosition, this);
+    return std::make_unique<Builder>(globalSectionPosition, this, GLOBAL_CONFIG.CHUNK_MANAGER.enableGreedyMeshing);
 }
 
 void DiffuseHollowBlockEffect::SetForwardRenderParams(const ForwardRenderParams &params) const
@@ -183,6 +189,11 @@ void DiffuseHollowBlockEffect::SetShadowRenderParams(const ShadowRenderParams &p
     common_->SetShadowRenderParams(params);
 }
 
+void DiffuseHollowBlockEffect::SetSectionOrigin(const Vec3 &origin) const
+{
+    common_->SetSectionOrigin(origin);
+}
+
 void DiffuseHollowBlockEffect::Initialize(
     std::shared_ptr<DiffuseHollowBlockEffectCommon> commonProperties,
     ShaderResourceView textureArray, std::string name)
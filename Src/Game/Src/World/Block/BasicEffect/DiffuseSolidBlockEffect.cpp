@@ -21,21 +21,23 @@ void DiffuseSolidBlockEffectCommon::InitializeForward()
     forwardUniforms = forwardShader.CreateUniformManager();
 
     forwardInputLayout = InputLayoutBuilder
-        ("POSITION",   0, DXGI_FORMAT_R32G32B32_FLOAT,    offsetof(DiffuseSolidBlockEffect::Vertex, position))
-        ("NORMAL",     0, DXGI_FORMAT_R32G32B32_FLOAT,    offsetof(DiffuseSolidBlockEffect::Vertex, normal))
-        ("TEXCOORD",   0, DXGI_FORMAT_R32G32_FLOAT,       offsetof(DiffuseSolidBlockEffect::Vertex, texCoord))
-        ("TEXINDEX",   0, DXGI_FORMAT_R32_UINT,           offsetof(DiffuseSolidBlockEffect::Vertex, texIndex))
-        ("BRIGHTNESS", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, offsetof(DiffuseSolidBlockEffect::Vertex, brightness))
+        ("POSITION",   0, DXGI_FORMAT_R16G16B16A16_UINT, offsetof(DiffuseSolidBlockEffect::Vertex, position))
+        ("TEXCOORD",   0, DXGI_FORMAT_R8G8_SINT,         offsetof(DiffuseSolidBlockEffect::Vertex, texCoord))
+        ("TEXINDEX",   0, DXGI_FORMAT_R16_UINT,          offsetof(DiffuseSolidBlockEffect::Vertex, texIndex))
+        ("BRIGHTNESS", 0, DXGI_FORMAT_R8G8B8A8_UNORM,    offsetof(DiffuseSolidBlockEffect::Vertex, brightness))
         .Build(forwardShader.GetVertexShaderByteCode());
 
     forwardVSTransform.Initialize(true, nullptr);
     forwardPSPerFrame.Initialize(true, nullptr);
+    vsSection.Initialize(true, nullptr);
 
     forwardUniforms.GetConstantBufferSlot<SS_VS>("Transform")->SetBuffer(forwardVSTransform);
+    forwardUniforms.GetConstantBufferSlot<SS_VS>("Section")->SetBuffer(vsSection);
     forwardUniforms.GetConstantBufferSlot<SS_PS>("PerFrame")->SetBuffer(forwardPSPerFrame);
 
     Sampler diffuseSampler;
-    diffuseSampler.Initialize(D3D11_FILTER_MIN_LINEAR_MAG_POINT_MIP_LINEAR);
+    diffuseSampler.Initialize(
+        D3D11_FILTER_MIN_LINEAR_MAG_POINT_MIP_LINEAR, D3D11_TEXTURE_ADDRESS_WRAP, D3D11_TEXTURE_ADDRESS_WRAP);
     forwardUniforms.GetSamplerSlot<SS_PS>("DiffuseSampler")->SetSampler(diffuseSampler);
 
     forwardDiffuseTextureSlot = forwardUniforms.GetShaderResourceSlot<SS_PS>("DiffuseTexture");
@@ -47,13 +49,10 @@ void DiffuseSolidBlockEffectCommon::InitializeForward()
 
 void DiffuseSolidBlockEffectCommon::InitializeShadow()
 {
-    std::string vertexShaderSource = agz::file::read_txt_file(
+    shadowShader.InitializeStageFromFile<SS_VS>(
         GLOBAL_CONFIG.ASSET_PATH["BlockEffect"]["DiffuseSolid"]["ShadowVertexShader"]);
-    std::string pixelShaderSource  = agz::file::read_txt_file(
+    shadowShader.InitializeStageFromFile<SS_PS>(
         GLOBAL_CONFIG.ASSET_PATH["BlockEffect"]["DiffuseSolid"]["ShadowPixelShader"]);
-
-    shadowShader.InitializeStage<SS_VS>(vertexShaderSource);
-    shadowShader.InitializeStage<SS_PS>(pixelShaderSource);
     if(!shadowShader.IsAllStagesAvailable())
     {
         throw VRPGGameException("failed to initialize shadow shader for diffuse solid block effect");
@@ -63,9 +62,10 @@ void DiffuseSolidBlockEffectCommon::InitializeShadow()
 
     shadowVSTransform.Initialize(true, nullptr);
     shadowUniforms.GetConstantBufferSlot<SS_VS>("Transform")->SetBuffer(shadowVSTransform);
+    shadowUniforms.GetConstantBufferSlot<SS_VS>("Section")->SetBuffer(vsSection);
 
     shadowInputLayout = InputLayoutBuilder
-        ("POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, offsetof(DiffuseSolidBlockEffect::Vertex, position))
+        ("POSITION", 0, DXGI_FORMAT_R16G16B16A16_UINT, offsetof(DiffuseSolidBlockEffect::Vertex, position))
         .Build(shadowShader.GetVertexShaderByteCode());
 
     shadowRasterizerState = CreateRasterizerStateForShadowMapping();
@@ -92,6 +92,11 @@ void DiffuseSolidBlockEffectCommon::SetShadowRenderParams(const ShadowRenderPara
     shadowVSTransform.SetValue({ params.shadowViewProj });
 }
 
+void DiffuseSolidBlockEffectCommon::SetSectionOrigin(const Vec3 &origin)
+{
+    vsSection.SetValue({ origin, 0 });
+}
+
 void DiffuseSolidBlockEffectCommon::StartForward(ID3D11ShaderResourceView *diffuseTextureArray) const
 {
     forwardShadowMapping->StartForward();
@@ -139,7 +144,7 @@ bool DiffuseSolidBlockEffect::IsTransparent() const noexcept
 
 std::unique_ptr<ModelBuilder> DiffuseSolidBlockEffect::CreateModelBuilder(const Vec3i &globalSectionPosition) const
 {
-    return std::make_unique<Builder>(globalSectionPosition, this);
+    return std::make_unique<Builder>(globalSectionPosition, this, GLOBAL_CONFIG.CHUNK_MANAGER.enableGreedyMeshing);
 }
 
 void DiffuseSolidBlockEffect::SetForwardRenderParams(const ForwardRenderParams &params) const
@@ -152,6 +157,11 @@ void DiffuseSolidBlockEffect::SetShadowRenderParams(const ShadowRenderParams &pa
     common_->SetShadowRenderParams(params);
 }
 
+void DiffuseSolidBlockEffect::SetSectionOrigin(const Vec3 &origin) const
+{
+    common_->SetSectionOrigin(origin);
+}
+
 void DiffuseSolidBlockEffect::StartForward() const
 {
     common_->StartForward(textureArray_.Get());
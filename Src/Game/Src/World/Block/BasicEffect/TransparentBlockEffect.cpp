@@ -1,12 +1,24 @@
 ﻿#include <agz/utility/file.h>
 
 #include <VRPG/Game/Config/GlobalConfig.h>
+#include <VRPG/Game/Misc/BackToFrontSorter.h>
 #include <VRPG/Game/World/Block/BasicEffect/TransparentBlockEffect.h>
 
 VRPG_GAME_BEGIN
 
 namespace
 {
+    using FaceIndexRange = TransparentBlockEffect::Builder::FaceIndexRange;
+
+    /**
+     * @brief 所有section共用的面片排序器，只在渲染线程上使用
+     */
+    BackToFrontSorter<FaceIndexRange> &GetFaceSorter()
+    {
+        static BackToFrontSorter<FaceIndexRange> sorter;
+        return sorter;
+    }
+
     class Model : public PartialSectionModel
     {
         const TransparentBlockEffect *effect_;
@@ -14,10 +26,56 @@ namespace
         VertexBuffer<TransparentBlockEffect::Vertex> vertexBuffer_;
 
         std::vector<VertexIndex> originalIndices_;
-        mutable std::vector<TransparentBlockEffect::Builder::FaceIndexRange> blocks_;
+        mutable std::vector<FaceIndexRange> blocks_;
+        mutable std::vector<uint16_t> sortKeys_;
         mutable IndexBuffer<VertexIndex> indexBuffer_;
         mutable std::vector<VertexIndex> tempIndices_;
 
+        // 上次排序时摄像机所在的方块，摄像机未跨越方块边界时沿用已有的面片顺序
+        mutable bool isSorted_ = false;
+        mutable Vec3i sortedEyeBlock_;
+
+        void SortFaces(const Vec3 &eye) const
+        {
+            Vec3i eyeBlock = eye.map([](float f) { return int(std::floor(f)); });
+            if(isSorted_ && eyeBlock == sortedEyeBlock_)
+            {
+                return;
+            }
+
+            // 摄像机只移动了一格时，面片顺序基本不变，先尝试增量的插入排序
+
+            bool isNearlySorted = isSorted_ &&
+                std::abs(eyeBlock.x - sortedEyeBlock_.x) <= 1 &&
+                std::abs(eyeBlock.y - sortedEyeBlock_.y) <= 1 &&
+                std::abs(eyeBlock.z - sortedEyeBlock_.z) <= 1;
+
+            for(size_t i = 0; i < blocks_.size(); ++i)
+            {
+                sortKeys_[i] = BackToFrontSortKey((blocks_[i].position - eye).length_square());
+            }
+
+            auto &sorter = GetFaceSorter();
+            if(!isNearlySorted || !sorter.InsertionSort(blocks_, sortKeys_, 2 * blocks_.size()))
+            {
+                sorter.RadixSort(blocks_, sortKeys_);
+            }
+
+            VertexIndex indexCount = 0;
+            for(auto &block : blocks_)
+            {
+                VertexIndex startIndex = block.startIndex;
+                for(VertexIndex i = 0; i < TransparentBlockEffect::Builder::FACE_INDEX_COUNT; ++i)
+                {
+                    tempIndices_[indexCount++] = originalIndices_[startIndex++];
+                }
+            }
+            indexBuffer_.SetValue(tempIndices_.data());
+
+            isSorted_ = true;
+            sortedEyeBlock_ = eyeBlock;
+        }
+
     public:
 
         Model(
@@ -25,32 +83,18 @@ namespace
             VertexBuffer<TransparentBlockEffect::Vertex> vertexBuffer,
             IndexBuffer<VertexIndex> indexBuffer,
             std::vector<VertexIndex> originalIndices,
-            std::vector<TransparentBlockEffect::Builder::FaceIndexRange> blocks)
+            std::vector<FaceIndexRange> blocks)
             : PartialSectionModel(globalSectionPosition), effect_(effect),
               vertexBuffer_(std::move(vertexBuffer)), originalIndices_(std::move(originalIndices)),
               blocks_(std::move(blocks)), indexBuffer_(std::move(indexBuffer))
         {
+            sortKeys_.resize(blocks_.size());
             tempIndices_.resize(originalIndices_.size());
         }
 
         void Render(const Camera &camera) const override
         {
-            std::sort(blocks_.begin(), blocks_.end(),
-                [eye = camera.GetPosition()](auto &lhs, auto &rhs)
-            {
-                return (lhs.position - eye).length_square() > (rhs.position - eye).length_square();
-            });
-
-            VertexIndex indexCount = 0;
-            for(auto &block : blocks_)
-            {
-                VertexIndex startIndex = block.startIndex;
-                for(int i = 0; i < 12; ++i)
-                {
-                    tempIndices_[indexCount++] = originalIndices_[startIndex++];
-                }
-            }
-            indexBuffer_.SetValue(tempIndices_.data());
+            SortFaces(camera.GetPosition());
 
             vertexBuffer_.Bind(0);
             indexBuffer_.Bind();
@@ -61,7 +105,7 @@ namespace
 
         void RenderShadow() const override
         {
-            indexBuffer_.SetValue(originalIndices_.data());
+            // 阴影与面片顺序无关，直接使用index buffer中现有的顺序，以免破坏缓存的排序结果
 
             vertexBuffer_.Bind(0);
             indexBuffer_.Bind();
@@ -74,6 +118,22 @@ namespace
         {
             return effect_;
         }
+
+        size_t GetMemoryUsage() const noexcept override
+        {
+            return vertexBuffer_.GetVertexCount() * sizeof(TransparentBlockEffect::Vertex)
+                 + indexBuffer_.GetIndexCount() * sizeof(VertexIndex);
+        }
+
+        size_t GetVertexCount() const noexcept override
+        {
+            return vertexBuffer_.GetVertexCount();
+        }
+
+        size_t GetIndexCount() const noexcept override
+        {
+            return indexBuffer_.GetIndexCount();
+        }
     };
 }
 
@@ -100,6 +160,14 @@ void TransparentBlockEffect::Builder::AddFaceIndexRange(const Vec3 &blockInSecti
     faces_.push_back({ blockInSection, startIndex });
 }
 
+void TransparentBlockEffect::Builder::Reset(const Vec3i &globalSectionPosition)
+{
+    globalSectionPosition_ = globalSectionPosition;
+    vertices_.clear();
+    indices_.clear();
+    faces_.clear();
+}
+
 std::shared_ptr<const PartialSectionModel> TransparentBlockEffect::Builder::Build()
 {
     if(indices_.empty())
@@ -111,7 +179,7 @@ std::shared_ptr<const PartialSectionModel> TransparentBlockEffect::Builder::Buil
     vertexBuffer.Initialize(UINT(vertices_.size()), false, vertices_.data());
 
     IndexBuffer<VertexIndex> indexBuffer;
-    indexBuffer.Initialize(UINT(indices_.size()), true, nullptr);
+    indexBuffer.Initialize(UINT(indices_.size()), true, indices_.data());
 
     return std::make_shared<Model>(
         globalSectionPosition_, effect_, std::move(vertexBuffer), std::move(indexBuffer), std::move(indices_), std::move(faces_));
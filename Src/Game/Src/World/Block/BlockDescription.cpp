@@ -1,4 +1,6 @@
-﻿#include <VRPG/Game/World/Block/BasicCollision/VoidCollision.h>
+﻿#include <algorithm>
+
+#include <VRPG/Game/World/Block/BasicCollision/VoidCollision.h>
 #include <VRPG/Game/World/Block/BasicDescription/DefaultBoxDescription.h>
 #include <VRPG/Game/World/Block/BasicEffect/DefaultBlockEffect.h>
 #include <VRPG/Game/World/Block/BlockDescription.h>
@@ -133,6 +135,7 @@ BlockID BlockDescManager::RegisterBlockDescription(std::shared_ptr<BlockDescript
     spdlog::info("register block description (name = {}, id = {})", desc->GetName(), id);
 
     rawBlockDescriptions_.push_back(desc.get());
+    BakeProperties(desc.get());
     name2Desc_[std::string(desc->GetName())] = desc;
     blockDescriptions_.push_back(std::move(desc));
     return id;
@@ -143,6 +146,102 @@ void BlockDescManager::Clear()
     blockDescriptions_.clear();
     name2Desc_.clear();
     rawBlockDescriptions_.clear();
+
+    isVisible_.clear();
+    isFullOpaque_.clear();
+    isSolidBox_.clear();
+    isLightSource_.clear();
+    hasExtraData_.clear();
+    isLiquid_.clear();
+    hasCollision_.clear();
+    hasLODModel_.clear();
+    lightAttenuation_.clear();
+    initialBrightness_.clear();
+    collisions_.clear();
+    faceVisibility_.clear();
+    collisionAABBs_.clear();
+    collisionAABBRanges_.clear();
+}
+
+void BlockDescManager::BakeProperties(const BlockDescription *desc)
+{
+    assert(desc->GetBlockID() == BlockID(isVisible_.size()));
+
+    const BlockCollision *collision = desc->GetCollision();
+
+    isVisible_        .push_back(desc->IsVisible());
+    isFullOpaque_     .push_back(desc->IsFullOpaque());
+    isLightSource_    .push_back(desc->IsLightSource());
+    hasExtraData_     .push_back(desc->HasExtraData());
+    isLiquid_         .push_back(desc->IsLiquid());
+    hasCollision_     .push_back(collision->HasCollisionVolume());
+    hasLODModel_      .push_back(desc->HasLODModel());
+    lightAttenuation_ .push_back(desc->LightAttenuation());
+    initialBrightness_.push_back(desc->InitialBrightness());
+    collisions_       .push_back(collision);
+
+    // 对每种合法的orientation预先完成方向的逆旋转，非法的编码值按未旋转处理
+
+    FaceVisibilityType originFaceVisibility[6];
+    bool isSolidBox = true;
+    for(int i = 0; i < 6; ++i)
+    {
+        originFaceVisibility[i] = desc->GetFaceVisibility(Direction(i));
+        isSolidBox &= originFaceVisibility[i] == FaceVisibilityType::Solid;
+    }
+    isSolidBox_.push_back(isSolidBox);
+
+    size_t base = faceVisibility_.size();
+    faceVisibility_.resize(base + FACE_VISIBILITY_STRIDE);
+    for(int raw = 0; raw < BlockOrientation::RAW_VALUE_COUNT; ++raw)
+    {
+        std::copy(originFaceVisibility, originFaceVisibility + 6, &faceVisibility_[base + raw * 6]);
+    }
+
+    for(int x = 0; x < 6; ++x)
+    {
+        for(int y = 0; y < 6; ++y)
+        {
+            if(x / 2 == y / 2)
+            {
+                continue;
+            }
+
+            const BlockOrientation orientation{ Direction(x), Direction(y) };
+            FaceVisibilityType *dst = &faceVisibility_[base + orientation.GetRawValue() * 6];
+            for(int rotated = 0; rotated < 6; ++rotated)
+            {
+                dst[rotated] = originFaceVisibility[int(orientation.RotatedToOrigin(Direction(rotated)))];
+            }
+        }
+    }
+
+    // 同样预先将碰撞AABB绕方块中心旋转到每种orientation下，非法的编码值按未旋转处理
+
+    std::vector<Collision::AABB> localAABBs;
+    collision->GetLocalAABBs(localAABBs);
+
+    for(int raw = 0; raw < BlockOrientation::RAW_VALUE_COUNT; ++raw)
+    {
+        int x = raw >> 4, y = raw & 0x0f;
+        BlockOrientation orientation;
+        if(x < 6 && y < 6 && x / 2 != y / 2)
+        {
+            orientation = BlockOrientation(Direction(x), Direction(y));
+        }
+
+        uint32_t begin = uint32_t(collisionAABBs_.size());
+        for(auto &aabb : localAABBs)
+        {
+            Vec3 a = RotateLocalPosition(orientation, aabb.low  - Vec3(0.5f)) + Vec3(0.5f);
+            Vec3 b = RotateLocalPosition(orientation, aabb.high - Vec3(0.5f)) + Vec3(0.5f);
+            collisionAABBs_.push_back({
+                Vec3((std::min)(a.x, b.x), (std::min)(a.y, b.y), (std::min)(a.z, b.z)),
+                Vec3((std::max)(a.x, b.x), (std::max)(a.y, b.y), (std::max)(a.z, b.z))
+            });
+        }
+        collisionAABBRanges_.push_back({ begin, uint32_t(collisionAABBs_.size()) });
+    }
 }
 
 VRPG_GAME_END
@@ -0,0 +1,311 @@
+﻿#include <VRPG/Game/World/BlockUpdater/BlockUpdater.h>
+#include <VRPG/Game/World/Chunk/ChunkManager.h>
+
+VRPG_GAME_BEGIN
+
+size_t BlockUpdaterManager::PendingKeyHash::operator()(const PendingKey &key) const noexcept
+{
+    uint64_t h = uint64_t(uint32_t(key.blockPosition.x)) * 0x9e3779b97f4a7c15ull;
+    h ^= uint64_t(uint32_t(key.blockPosition.y)) * 0xc2b2ae3d27d4eb4full + (h << 6) + (h >> 2);
+    h ^= uint64_t(uint32_t(key.blockPosition.z)) * 0x165667b19e3779f9ull + (h << 6) + (h >> 2);
+    h ^= (key.tick << 16 | key.updaterID) * 0x27d4eb2f165667c5ull + (h << 6) + (h >> 2);
+    return size_t(h);
+}
+
+BlockUpdaterManager::BlockUpdaterManager(ChunkManager *chunkManager, int workerThreadCount)
+    : chunkManager_(chunkManager), workerPool_(workerThreadCount), freeNode_(NIL_NODE), suspendedCount_(0), epoch_(StdClock::now()), currentTick_(0),
+      isCurrentTickUnfinished_(false)
+{
+    assert(chunkManager);
+}
+
+void BlockUpdaterManager::AddUpdater(
+    BlockUpdaterID updaterID, const Vec3i &blockPosition, StdClock::time_point expectedUpdatingTime)
+{
+    assert(updaterID < updaters_.size());
+
+    Tick tick = (std::max)(TimeToTick(expectedUpdatingTime), currentTick_);
+    if(!pendingKeys_.insert({ blockPosition, updaterID, tick }).second)
+    {
+        return;
+    }
+
+    if(!chunkManager_->IsChunkSimulated(GlobalBlockToChunk(blockPosition)))
+    {
+        Suspend({ blockPosition, updaterID, tick });
+        return;
+    }
+
+    uint32_t node = AllocateNode();
+    nodePool_[node].blockPosition = blockPosition;
+    nodePool_[node].updaterID     = updaterID;
+    nodePool_[node].tick          = tick;
+    Schedule(node);
+}
+
+void BlockUpdaterManager::Execute(StdClock::duration timeBudget, StdClock::time_point now)
+{
+    if(now < epoch_)
+    {
+        statistics_ = Statistics();
+        statistics_.pendingCount   = pendingKeys_.size();
+        statistics_.suspendedCount = suspendedCount_;
+        return;
+    }
+    ExecuteImpl(StdClock::now() + timeBudget, Tick((now - epoch_) / BLOCK_UPDATE_TICK_INTERVAL), now);
+}
+
+size_t BlockUpdaterManager::GetPendingUpdaterCount() const noexcept
+{
+    return pendingKeys_.size();
+}
+
+BlockUpdaterManager::Statistics BlockUpdaterManager::GetStatistics() const noexcept
+{
+    return statistics_;
+}
+
+ParallelForPool &BlockUpdaterManager::GetWorkerPool() noexcept
+{
+    return workerPool_;
+}
+
+BlockUpdaterManager::Tick BlockUpdaterManager::TimeToTick(StdClock::time_point time) const noexcept
+{
+    if(time <= epoch_)
+    {
+        return 0;
+    }
+    auto interval = BLOCK_UPDATE_TICK_INTERVAL.count();
+    return Tick(((time - epoch_).count() + interval - 1) / interval);
+}
+
+uint32_t BlockUpdaterManager::AllocateNode()
+{
+    if(freeNode_ != NIL_NODE)
+    {
+        uint32_t ret = freeNode_;
+        freeNode_ = nodePool_[ret].next;
+        nodePool_[ret].next = NIL_NODE;
+        return ret;
+    }
+
+    assert(nodePool_.size() < NIL_NODE);
+    nodePool_.emplace_back();
+    return uint32_t(nodePool_.size() - 1);
+}
+
+void BlockUpdaterManager::FreeNode(uint32_t node) noexcept
+{
+    nodePool_[node].next = freeNode_;
+    freeNode_ = node;
+}
+
+void BlockUpdaterManager::PushBack(Slot &slot, std::vector<PendingUpdater> &nodes, uint32_t node) noexcept
+{
+    nodes[node].next = NIL_NODE;
+    if(slot.tail == NIL_NODE)
+    {
+        slot.head = node;
+    }
+    else
+    {
+        nodes[slot.tail].next = node;
+    }
+    slot.tail = node;
+}
+
+void BlockUpdaterManager::Schedule(uint32_t node) noexcept
+{
+    Tick tick  = nodePool_[node].tick;
+    Tick delta = tick - currentTick_;
+
+    for(int level = 0; level < WHEEL_LEVEL_COUNT; ++level)
+    {
+        if(delta < (Tick(1) << ((level + 1) * WHEEL_SLOT_BITS)))
+        {
+            Tick slotIndex = (tick >> (level * WHEEL_SLOT_BITS)) & WHEEL_SLOT_MASK;
+            PushBack(wheel_[level][slotIndex], nodePool_, node);
+            return;
+        }
+    }
+
+    PushBack(overflow_, nodePool_, node);
+}
+
+void BlockUpdaterManager::Cascade(Slot &slot) noexcept
+{
+    uint32_t node = slot.head;
+    slot = Slot();
+    while(node != NIL_NODE)
+    {
+        uint32_t next = nodePool_[node].next;
+        Schedule(node);
+        node = next;
+    }
+}
+
+void BlockUpdaterManager::AdvanceTick() noexcept
+{
+    ++currentTick_;
+
+    // 从高到低依次处理，使得高层下放的任务能够继续被下放到第0层
+
+    if(!(currentTick_ & ((Tick(1) << (WHEEL_LEVEL_COUNT * WHEEL_SLOT_BITS)) - 1)))
+    {
+        Cascade(overflow_);
+    }
+
+    for(int level = WHEEL_LEVEL_COUNT - 1; level > 0; --level)
+    {
+        if(!(currentTick_ & ((Tick(1) << (level * WHEEL_SLOT_BITS)) - 1)))
+        {
+            Tick slotIndex = (currentTick_ >> (level * WHEEL_SLOT_BITS)) & WHEEL_SLOT_MASK;
+            Cascade(wheel_[level][slotIndex]);
+        }
+    }
+}
+
+void BlockUpdaterManager::Suspend(const PendingUpdater &updater)
+{
+    suspendedUpdaters_[GlobalBlockToChunk(updater.blockPosition)].push_back(updater);
+    ++suspendedCount_;
+}
+
+void BlockUpdaterManager::ResumeSimulatedChunks()
+{
+    for(auto it = suspendedUpdaters_.begin(); it != suspendedUpdaters_.end();)
+    {
+        if(!chunkManager_->IsChunkSimulated(it->first))
+        {
+            ++it;
+            continue;
+        }
+
+        // 已经过期的任务都会被放入当前tick，按原本的期望时刻排序以使最早到期的任务最先执行
+
+        auto &updaters = it->second;
+        std::stable_sort(updaters.begin(), updaters.end(), [](const PendingUpdater &lhs, const PendingUpdater &rhs)
+        {
+            return lhs.tick < rhs.tick;
+        });
+
+        for(auto &updater : updaters)
+        {
+            Tick tick = (std::max)(updater.tick, currentTick_);
+            if(tick != updater.tick)
+            {
+                pendingKeys_.erase({ updater.blockPosition, updater.updaterID, updater.tick });
+                if(!pendingKeys_.insert({ updater.blockPosition, updater.updaterID, tick }).second)
+                {
+                    continue;
+                }
+            }
+
+            uint32_t node = AllocateNode();
+            nodePool_[node].blockPosition = updater.blockPosition;
+            nodePool_[node].updaterID     = updater.updaterID;
+            nodePool_[node].tick          = tick;
+            Schedule(node);
+        }
+
+        suspendedCount_ -= updaters.size();
+        it = suspendedUpdaters_.erase(it);
+    }
+}
+
+void BlockUpdaterManager::ExecuteImpl(StdClock::time_point deadline, Tick lastTick, StdClock::time_point now)
+{
+    // 读取时钟有一定开销，因此每执行DEADLINE_CHECK_INTERVAL个任务才检查一次是否超时
+    constexpr int DEADLINE_CHECK_INTERVAL = 32;
+
+    int executed = 0;
+    StdClock::duration totalLateness(0), maxLateness(0);
+
+    auto finishExecution = [&]
+    {
+        using FloatMS = std::chrono::duration<float, std::milli>;
+
+        statistics_.pendingCount   = pendingKeys_.size();
+        statistics_.suspendedCount = suspendedCount_;
+        statistics_.executedCount  = executed;
+        statistics_.meanLateness   = executed ? std::chrono::duration_cast<FloatMS>(totalLateness).count() / executed : 0.0f;
+        statistics_.maxLateness    = std::chrono::duration_cast<FloatMS>(maxLateness).count();
+    };
+
+    ResumeSimulatedChunks();
+
+    for(;;)
+    {
+        // 执行过程中新产生的、期望在当前tick内执行的任务会被追加到当前槽位的末尾，在本轮中一并执行
+
+        Slot &slot = wheel_[0][currentTick_ & WHEEL_SLOT_MASK];
+        while(slot.head != NIL_NODE)
+        {
+            if(executed % DEADLINE_CHECK_INTERVAL == DEADLINE_CHECK_INTERVAL - 1 && StdClock::now() >= deadline)
+            {
+                finishExecution();
+                return;
+            }
+
+            uint32_t node = slot.head;
+            slot.head = nodePool_[node].next;
+            if(slot.head == NIL_NODE)
+            {
+                slot.tail = NIL_NODE;
+            }
+
+            PendingUpdater updater = nodePool_[node];
+            FreeNode(node);
+
+            // 任务所在的区块可能在任务被添加之后离开了模拟范围
+
+            if(!chunkManager_->IsChunkSimulated(GlobalBlockToChunk(updater.blockPosition)))
+            {
+                Suspend(updater);
+                continue;
+            }
+
+            pendingKeys_.erase({ updater.blockPosition, updater.updaterID, updater.tick });
+
+            StdClock::duration lateness = (std::max)(
+                now - epoch_ - BLOCK_UPDATE_TICK_INTERVAL * int64_t(updater.tick), StdClock::duration(0));
+            totalLateness += lateness;
+            maxLateness = (std::max)(maxLateness, lateness);
+
+            updaters_[updater.updaterID]->Execute(*this, *chunkManager_, updater.blockPosition, now);
+            isCurrentTickUnfinished_ = true;
+            ++executed;
+        }
+
+        // FinishTick中可能产生新的当前tick的任务，此时需要回到上面继续执行
+
+        if(isCurrentTickUnfinished_)
+        {
+            isCurrentTickUnfinished_ = false;
+            for(auto &u : updaters_)
+            {
+                u->FinishTick(*this, *chunkManager_, now);
+            }
+            continue;
+        }
+
+        if(currentTick_ >= lastTick || StdClock::now() >= deadline)
+        {
+            finishExecution();
+            return;
+        }
+
+        if(pendingKeys_.size() == suspendedCount_)
+        {
+            // 时间轮为空，可以直接跳到目标tick
+            currentTick_ = lastTick;
+            finishExecution();
+            return;
+        }
+
+        AdvanceTick();
+    }
+}
+
+VRPG_GAME_END
@@ -0,0 +1,353 @@
+﻿#include <tuple>
+
+#include <VRPG/Game/World/Block/BlockDescription.h>
+#include <VRPG/Game/World/BlockUpdater/LiquidSimulation.h>
+
+VRPG_GAME_BEGIN
+
+namespace
+{
+    /**
+     * @brief 依次按所属区块、所属section以及section内的位置比较两个方块
+     */
+    bool BlockLessByChunk(const Vec3i &lhs, const Vec3i &rhs) noexcept
+    {
+        ChunkPosition lhsChunk = GlobalBlockToChunk(lhs);
+        ChunkPosition rhsChunk = GlobalBlockToChunk(rhs);
+        Vec3i lhsSection = GlobalBlockToGlobalSection(lhs);
+        Vec3i rhsSection = GlobalBlockToGlobalSection(rhs);
+        return std::make_tuple(lhsChunk.x, lhsChunk.z, lhsSection.x, lhsSection.z, lhsSection.y, lhs.x, lhs.z, lhs.y) <
+               std::make_tuple(rhsChunk.x, rhsChunk.z, rhsSection.x, rhsSection.z, rhsSection.y, rhs.x, rhs.z, rhs.y);
+    }
+
+    // 更新一个方块时需要读取的相对位置：自身、水平与上方的邻居，以及水平邻居的下方
+    const Vec3i READ_OFFSETS[] = {
+        {  0,  0,  0 },
+        {  1,  0,  0 }, { -1,  0,  0 }, { 0,  0,  1 }, { 0,  0, -1 },
+        {  0,  1,  0 },
+        {  1, -1,  0 }, { -1, -1,  0 }, { 0, -1,  1 }, { 0, -1, -1 }
+    };
+}
+
+int LiquidSimulation::CellIndex(const Vec3i &blockInSection) noexcept
+{
+    return (blockInSection.x * CHUNK_SECTION_SIZE_Z + blockInSection.z) * CHUNK_SECTION_SIZE_Y + blockInSection.y;
+}
+
+LiquidSimulation::Cell LiquidSimulation::MakeCell(BlockID id, const BlockExtraData &extraData)
+{
+    auto &blockDescMgr = BlockDescManager::GetInstance();
+
+    Cell cell;
+    cell.id = id;
+    if(blockDescMgr.GetBlockDescription(id)->IsLiquid() && blockDescMgr.HasExtraData(id))
+    {
+        cell.level = ExtraDataToLiquidLevel(extraData);
+    }
+    return cell;
+}
+
+const std::vector<LiquidSimulation::Change> &LiquidSimulation::Step(
+    std::vector<Vec3i> &activeBlocks, const SectionLoader &loadSection, ParallelForPool &workerPool)
+{
+    changes_.clear();
+    if(activeBlocks.empty())
+    {
+        return changes_;
+    }
+
+    // 按区块排序，使得计算结果与方块的激活顺序无关，同时提高稠密状态的访问局部性
+
+    std::sort(activeBlocks.begin(), activeBlocks.end(), BlockLessByChunk);
+    activeBlocks.erase(std::unique(activeBlocks.begin(), activeBlocks.end()), activeBlocks.end());
+    activeBlocks_ = &activeBlocks;
+
+    // 串行地读入计算中可能访问的所有section，此后的并行计算不再调用loadSection
+
+    for(auto &blockPos : activeBlocks)
+    {
+        for(auto &offset : READ_OFFSETS)
+        {
+            Vec3i readPos = blockPos + offset;
+            if(0 <= readPos.y && readPos.y < CHUNK_SIZE_Y)
+            {
+                LoadSection(loadSection, GlobalBlockToGlobalSection(readPos));
+            }
+        }
+    }
+
+    // 所有读取都来自本步开始时的状态，因此各批次可以任意划分并行计算
+
+    const size_t batchCount = (activeBlocks.size() + BLOCK_BATCH_SIZE - 1) / BLOCK_BATCH_SIZE;
+    if(batches_.size() < batchCount)
+    {
+        batches_.resize(batchCount);
+    }
+    for(size_t i = 0; i < batchCount; ++i)
+    {
+        batches_[i].beginBlock = i * BLOCK_BATCH_SIZE;
+        batches_[i].endBlock   = (std::min)(batches_[i].beginBlock + BLOCK_BATCH_SIZE, activeBlocks.size());
+    }
+
+    workerPool.Run(int(batchCount), [&](int batchIndex)
+    {
+        UpdateBatch(batches_[batchIndex]);
+    });
+
+    // 按批次的顺序汇总改变，并回收稠密状态，下一步重新读取以反映其他途径对方块的修改
+
+    for(size_t i = 0; i < batchCount; ++i)
+    {
+        for(auto &change : batches_[i].changes)
+        {
+            changes_.push_back(std::move(change));
+        }
+        batches_[i].changes.clear();
+    }
+
+    for(auto &pair : sections_)
+    {
+        sectionPool_.push_back(std::move(pair.second));
+    }
+    sections_.clear();
+    activeBlocks_ = nullptr;
+
+    return changes_;
+}
+
+void LiquidSimulation::LoadSection(const SectionLoader &loadSection, const Vec3i &globalSection)
+{
+    if(sections_.find(globalSection) != sections_.end())
+    {
+        return;
+    }
+
+    std::unique_ptr<Section> section;
+    if(!sectionPool_.empty())
+    {
+        section = std::move(sectionPool_.back());
+        sectionPool_.pop_back();
+    }
+    else
+    {
+        section = std::make_unique<Section>();
+    }
+
+    loadSection(globalSection, *section);
+    sections_.insert({ globalSection, std::move(section) });
+}
+
+LiquidSimulation::Cell LiquidSimulation::GetCell(const Vec3i &globalBlock) const
+{
+    if(globalBlock.y < 0 || globalBlock.y >= CHUNK_SIZE_Y)
+    {
+        return Cell();
+    }
+
+    auto it = sections_.find(GlobalBlockToGlobalSection(globalBlock));
+    assert(it != sections_.end());
+    return it->second->cells[CellIndex(GlobalBlockToBlockInSection(globalBlock))];
+}
+
+const BlockDescription *LiquidSimulation::GetCellDesc(const Vec3i &globalBlock) const
+{
+    return BlockDescManager::GetInstance().GetBlockDescription(GetCell(globalBlock).id);
+}
+
+void LiquidSimulation::UpdateBatch(Batch &batch) const
+{
+    auto &blockDescMgr = BlockDescManager::GetInstance();
+
+    for(size_t i = batch.beginBlock; i < batch.endBlock; ++i)
+    {
+        const Vec3i &blockPos = (*activeBlocks_)[i];
+
+        Cell cell = GetCell(blockPos);
+        if(!blockDescMgr.GetBlockDescription(cell.id)->IsReplacableByLiquid())
+        {
+            continue;
+        }
+
+        // 处理该方块与周围的液体间发生的反应
+        if(ReactWithNeighborhood(batch, blockPos, cell))
+        {
+            continue;
+        }
+
+        // 处理周围液体流动到该方块处的结果，注意这里也可能发生反应
+        FlowFromNeighborhood(batch, blockPos, cell);
+    }
+}
+
+bool LiquidSimulation::ReactWithNeighborhood(Batch &batch, const Vec3i &blockPos, const Cell &cell) const
+{
+    const BlockDescription *desc = BlockDescManager::GetInstance().GetBlockDescription(cell.id);
+    if(!desc->IsLiquid())
+    {
+        return false;
+    }
+
+    // 遍历此方块+/-x, +/-z, +y方向的方块，若它是其他类型的液体，
+    // 就应当与此方块发生反应。当有多个这样的邻居方块时，取其ID最小的一个进行反应
+
+    const BlockDescription *neiDiffLiquidDesc = nullptr;
+
+    auto updateNeiDiffLiquidDesc = [&](Direction direction)
+    {
+        const BlockDescription *neiDesc = GetCellDesc(blockPos + DirectionToVectori(direction));
+        if(neiDesc->IsLiquid() && neiDesc != desc)
+        {
+            if(!neiDiffLiquidDesc || neiDesc->GetBlockID() < neiDiffLiquidDesc->GetBlockID())
+            {
+                neiDiffLiquidDesc = neiDesc;
+            }
+        }
+    };
+
+    updateNeiDiffLiquidDesc(PositiveX);
+    updateNeiDiffLiquidDesc(NegativeX);
+    updateNeiDiffLiquidDesc(PositiveZ);
+    updateNeiDiffLiquidDesc(NegativeZ);
+    updateNeiDiffLiquidDesc(PositiveY);
+
+    if(!neiDiffLiquidDesc)
+    {
+        return false;
+    }
+
+    // 计算反应生成的新方块
+
+    const LiquidDescription *liquidDesc = desc->GetLiquid();
+    bool isThisSource = cell.level == liquidDesc->sourceLevel;
+    auto newBlock = liquidDesc->ReactWith(neiDiffLiquidDesc, isThisSource, false);
+
+    batch.changes.push_back({ blockPos, std::move(newBlock), liquidDesc->spreadDelay });
+
+    return true;
+}
+
+void LiquidSimulation::FlowFromNeighborhood(Batch &batch, const Vec3i &blockPos, const Cell &cell) const
+{
+    const BlockDescription *desc = BlockDescManager::GetInstance().GetBlockDescription(cell.id);
+
+    // 排除此方块自身是液体源的情况
+
+    if(desc->IsLiquid() && cell.level == desc->GetLiquid()->sourceLevel)
+    {
+        return;
+    }
+
+    // 计算各邻居方块流到此处的结果
+
+    struct FlowResult
+    {
+        const BlockDescription *desc = nullptr;
+        LiquidLevel level            = 0;
+
+        bool operator<(const FlowResult &rhs) const noexcept
+        {
+            if(!desc)                                       return false;
+            if(!rhs.desc)                                   return true;
+            if(desc->GetBlockID() < rhs.desc->GetBlockID()) return true;
+            if(desc->GetBlockID() > rhs.desc->GetBlockID()) return false;
+            return level > rhs.level;
+        }
+    };
+
+    FlowResult flowResult[6];
+
+    auto flowFromHorizontalDirection = [&](Direction direction)
+    {
+        Vec3i neiPos = blockPos + DirectionToVectori(direction);
+        Cell nei = GetCell(neiPos);
+        const BlockDescription *neiDesc = BlockDescManager::GetInstance().GetBlockDescription(nei.id);
+        if(!neiDesc->IsLiquid())
+        {
+            return;
+        }
+
+        LiquidLevel neiLevel = nei.level;
+        if(neiLevel <= 1)
+        {
+            return;
+        }
+
+        bool isSource = neiLevel == neiDesc->GetLiquid()->sourceLevel;
+        if(!isSource && GetCellDesc(neiPos + Vec3i(0, -1, 0))->IsReplacableByLiquid())
+        {
+            return;
+        }
+
+        flowResult[int(direction)].desc = neiDesc;
+        flowResult[int(direction)].level = isSource ? (neiLevel - 2) : (neiLevel - 1);
+    };
+    flowFromHorizontalDirection(PositiveX);
+    flowFromHorizontalDirection(NegativeX);
+    flowFromHorizontalDirection(PositiveZ);
+    flowFromHorizontalDirection(NegativeZ);
+
+    if(auto upDesc = GetCellDesc(blockPos + Vec3i(0, 1, 0)); upDesc->IsLiquid())
+    {
+        flowResult[int(PositiveY)].desc = upDesc;
+        flowResult[int(PositiveY)].level = upDesc->GetLiquid()->sourceLevel - 1;
+    }
+
+    // 按(id<, level>)对flowResult进行排序，取至多两个不同的id的结果，在具有相同id的result中取level最高的
+
+    std::sort(std::begin(flowResult), std::end(flowResult));
+    for(int i = 1, j = 0; i < 6; ++i)
+    {
+        if(flowResult[i].desc == flowResult[j].desc)
+        {
+            flowResult[j].level = (std::max)(flowResult[i].level, flowResult[j].level);
+        }
+        else
+        {
+            flowResult[++j] = flowResult[i];
+        }
+    }
+
+    int resultCount = 0;
+    if(flowResult[0].desc)
+    {
+        if(flowResult[1].desc && flowResult[1].desc != flowResult[0].desc)
+        {
+            resultCount = 2;
+        }
+        else
+        {
+            resultCount = 1;
+        }
+    }
+
+    if(resultCount > 1)
+    {
+        // 有多种液体流到此处时，取id最小的两类发生反应
+
+        auto newBlock = flowResult[0].desc->GetLiquid()->ReactWith(flowResult[1].desc, false, false);
+        batch.changes.push_back({ blockPos, std::move(newBlock), flowResult[0].desc->GetLiquid()->spreadDelay });
+    }
+    else if(resultCount == 1)
+    {
+        // 有一种液体流到此处
+
+        if(flowResult[0].desc != desc || flowResult[0].level != cell.level)
+        {
+            batch.changes.push_back({
+                blockPos,
+                { flowResult[0].desc->GetBlockID(), MakeLiquidExtraData(flowResult[0].level), {} },
+                flowResult[0].desc->GetLiquid()->spreadDelay });
+        }
+    }
+    else
+    {
+        // 此处应为void
+
+        if(cell.id != BLOCK_ID_VOID)
+        {
+            batch.changes.push_back({ blockPos, { BLOCK_ID_VOID, BlockExtraData(), {} }, StdClock::duration(0) });
+        }
+    }
+}
+
+VRPG_GAME_END
@@ -1,256 +1,130 @@
 ﻿#include <VRPG/Game/World/Block/BlockDescription.h>
-#include <VRPG/Game/World/Block/LiquidDescription.h>
 #include <VRPG/Game/World/BlockUpdater/LiquidUpdater.h>
 #include <VRPG/Game/World/Chunk/ChunkManager.h>
 
 VRPG_GAME_BEGIN
 
-bool LiquidUpdater::ReactWithNeighborhood(
-    const BlockInstance &block, BlockUpdaterManager &updaterManager, ChunkManager &chunkManager, StdClock::time_point now)
+void LiquidUpdater::Execute(
+    BlockUpdaterManager &updaterManager, ChunkManager &chunkManager,
+    const Vec3i &blockPosition, StdClock::time_point now)
 {
-    if(!block.desc->IsLiquid())
+    if(blockPosition.y < 0 || blockPosition.y >= CHUNK_SIZE_Y)
     {
-        return false;
-    }
-
-    // 遍历此方块+/-x, +/-z, +y方向的方块，若它是其他类型的液体，
-    // 就应当与此方块发生反应。当有多个这样的邻居方块时，取其ID最小的一个进行反应
-
-    const BlockDescription *neiDiffLiquidDesc = nullptr;
-
-    auto updateNeiDiffLiquidDesc = [&](Direction direction)
-    {
-        Vec3i neiPos = blockPos_ + DirectionToVectori(direction);
-        const BlockDescription *neiDesc = chunkManager.GetBlockDesc(neiPos);
-        if(neiDesc->IsLiquid() && neiDesc != block.desc)
-        {
-            if(!neiDiffLiquidDesc || neiDesc->GetBlockID() < neiDiffLiquidDesc->GetBlockID())
-            {
-                neiDiffLiquidDesc = neiDesc;
-            }
-        }
-    };
-
-    updateNeiDiffLiquidDesc(PositiveX);
-    updateNeiDiffLiquidDesc(NegativeX);
-    updateNeiDiffLiquidDesc(PositiveZ);
-    updateNeiDiffLiquidDesc(NegativeZ);
-    updateNeiDiffLiquidDesc(PositiveY);
-
-    if(!neiDiffLiquidDesc)
-    {
-        return false;
+        return;
     }
-
-    // 计算反应生成的新方块
-
-    const LiquidDescription *liquidDesc = block.desc->GetLiquid();
-    bool isThisSource = liquidDesc->IsSource(*block.extraData);
-    auto newBlock = block.desc->GetLiquid()->ReactWith(neiDiffLiquidDesc, isThisSource, false);
-
-    chunkManager.SetBlockID(blockPos_, newBlock.id, newBlock.orientation, std::move(newBlock.extraData));
-
-    // 发布周围方块的更新任务
-
-    StdClock::time_point newUpdatingTime = now + liquidDesc->spreadDelay;
-    updaterManager.AddUpdater(std::make_unique<LiquidUpdater>(newUpdatingTime, blockPos_ + Vec3i(+1, 0, 0)));
-    updaterManager.AddUpdater(std::make_unique<LiquidUpdater>(newUpdatingTime, blockPos_ + Vec3i(-1, 0, 0)));
-    updaterManager.AddUpdater(std::make_unique<LiquidUpdater>(newUpdatingTime, blockPos_ + Vec3i(0, 0, +1)));
-    updaterManager.AddUpdater(std::make_unique<LiquidUpdater>(newUpdatingTime, blockPos_ + Vec3i(0, 0, -1)));
-    updaterManager.AddUpdater(std::make_unique<LiquidUpdater>(newUpdatingTime, blockPos_ + Vec3i(0, +1, 0)));
-    updaterManager.AddUpdater(std::make_unique<LiquidUpdater>(newUpdatingTime, blockPos_ + Vec3i(0, -1, 0)));
-
-    return true;
+    activeBlocks_.push_back(blockPosition);
 }
 
-void LiquidUpdater::FlowFromNeighborhood(
-    const BlockInstance &block, BlockUpdaterManager &updaterManager, ChunkManager &chunkManager, StdClock::time_point now)
+void LiquidUpdater::FinishTick(BlockUpdaterManager &updaterManager, ChunkManager &chunkManager, StdClock::time_point now)
 {
-    // 排除此方块自身是液体源的情况
-
-    if(block.desc->IsLiquid() && block.desc->GetLiquid()->IsSource(*block.extraData))
+    if(activeBlocks_.empty())
     {
         return;
     }
 
-    // 计算各邻居方块流到此处的结果
+    // 执行预算用尽时，被激活的方块会留到下一次FinishTick，期间其所在区块可能已不再被模拟。
+    // 将这些方块重新交给updaterManager，由它挂起到区块重新被模拟时
 
-    struct FlowResult
+    activeBlocks_.erase(std::remove_if(activeBlocks_.begin(), activeBlocks_.end(), [&](const Vec3i &blockPos)
     {
-        const BlockDescription *desc = nullptr;
-        LiquidLevel level            = 0;
-
-        bool operator<(const FlowResult &rhs) const noexcept
+        if(chunkManager.IsChunkSimulated(GlobalBlockToChunk(blockPos)))
         {
-            if(!desc)                                       return false;
-            if(!rhs.desc)                                   return true;
-            if(desc->GetBlockID() < rhs.desc->GetBlockID()) return true;
-            if(desc->GetBlockID() > rhs.desc->GetBlockID()) return false;
-            return level > rhs.level;
+            return false;
         }
-    };
+        updaterManager.AddUpdater(GetUpdaterID(), blockPos, now);
+        return true;
+    }), activeBlocks_.end());
 
-    FlowResult flowResult[6];
+    // 被模拟的区块及其水平相邻区块都已加载，因此读取section不会触发区块加载
 
-    auto flowFromHorizontalDirection = [&](Direction direction)
+    auto &changes = simulation_.Step(activeBlocks_, [&](const Vec3i &globalSection, LiquidSimulation::Section &section)
     {
-        Vec3i neiPos = blockPos_ + DirectionToVectori(direction);
-        BlockInstance nei = chunkManager.GetBlock(neiPos);
-        if(!nei.desc->IsLiquid())
-        {
-            return;
-        }
-
-        LiquidLevel neiLevel = ExtraDataToLiquidLevel(*nei.extraData);
-        if(neiLevel <= 1)
-        {
-            return;
-        }
-
-        bool isSource = neiLevel == nei.desc->GetLiquid()->sourceLevel;
-        if(!isSource && chunkManager.GetBlock(neiPos + Vec3i(0, -1, 0)).desc->IsReplacableByLiquid())
-        {
-            return;
-        }
+        LoadSection(chunkManager, globalSection, section);
+    }, updaterManager.GetWorkerPool());
+    activeBlocks_.clear();
 
-        flowResult[int(direction)].desc = nei.desc;
-        flowResult[int(direction)].level = isSource ? (neiLevel - 2) : (neiLevel - 1);
-    };
-    flowFromHorizontalDirection(PositiveX);
-    flowFromHorizontalDirection(NegativeX);
-    flowFromHorizontalDirection(PositiveZ);
-    flowFromHorizontalDirection(NegativeZ);
+    // 将改变一次性写回区块。每个方块在一次FinishTick中至多被更新一次，因此改变之间没有冲突
 
-    if(auto upDesc = chunkManager.GetBlockDesc(blockPos_ + Vec3i(0, 1, 0)); upDesc->IsLiquid())
+    std::vector<BlockEdit> edits;
+    edits.reserve(changes.size());
+    for(auto &change : changes)
     {
-        flowResult[int(PositiveY)].desc = upDesc;
-        flowResult[int(PositiveY)].level = upDesc->GetLiquid()->sourceLevel - 1;
+        edits.push_back({ change.position, change.block });
     }
+    chunkManager.SetBlocks(std::move(edits));
 
-    // 按(id<, level>)对flowResult进行排序，取至多两个不同的id的结果，在具有相同id的result中取level最高的
+    // 发布周围方块的更新任务
 
-    std::sort(std::begin(flowResult), std::end(flowResult));
-    for(int i = 1, j = 0; i < 6; ++i)
+    for(auto &change : changes)
     {
-        if(flowResult[i].desc == flowResult[j].desc)
-        {
-            flowResult[j].level = (std::max)(flowResult[i].level, flowResult[j].level);
-        }
-        else
-        {
-            flowResult[++j] = flowResult[i];
-        }
+        AddUpdaterForAdjacentBlocks(change.position, updaterManager, now + change.delay);
     }
+}
 
-    int resultCount = 0;
-    if(flowResult[0].desc)
-    {
-        if(flowResult[1].desc && flowResult[1].desc != flowResult[0].desc)
-        {
-            resultCount = 2;
-        }
-        else
-        {
-            resultCount = 1;
-        }
-    }
-
-    bool updated = false;
-    StdClock::duration updateDelay(0);
-
-    if(resultCount > 1)
-    {
-        // 有多种液体流到此处时，取id最小的两类发生反应
-
-        updated = true;
-        updateDelay = flowResult[0].desc->GetLiquid()->spreadDelay;
-        auto newBlock = flowResult[0].desc->GetLiquid()->ReactWith(flowResult[1].desc, false, false);
-        if(BlockDescManager::GetInstance().GetBlockDescription(newBlock.id)->HasExtraData())
-        {
-            chunkManager.SetBlockID(blockPos_, newBlock.id, newBlock.orientation, std::move(newBlock.extraData));
-        }
-        else
-        {
-            chunkManager.SetBlockID(blockPos_, newBlock.id, newBlock.orientation);
-        }
-    }
-    else if(resultCount == 1)
-    {
-        // 有一种液体流到此处
+void LiquidUpdater::LoadSection(ChunkManager &chunkManager, const Vec3i &globalSection, LiquidSimulation::Section &section)
+{
+    auto &blockDescMgr = BlockDescManager::GetInstance();
+    auto [chunkPosition, sectionInChunk] = DecomposeGlobalSectionByChunk(globalSection);
+    const Chunk *chunk = chunkManager.FindChunk(chunkPosition);
+    assert(chunk);
+
+    const Vec3i sectionBase = {
+        sectionInChunk.x * CHUNK_SECTION_SIZE_X,
+        sectionInChunk.y * CHUNK_SECTION_SIZE_Y,
+        sectionInChunk.z * CHUNK_SECTION_SIZE_Z
+    };
 
-        if(flowResult[0].desc != block.desc || flowResult[0].level != ExtraDataToLiquidLevel(*block.extraData))
-        {
-            updated = true;
-            updateDelay = flowResult[0].desc->GetLiquid()->spreadDelay;
-            chunkManager.SetBlockID(blockPos_, flowResult[0].desc->GetBlockID(), {}, MakeLiquidExtraData(flowResult[0].level));
-        }
-    }
-    else
+    for(int x = 0; x < CHUNK_SECTION_SIZE_X; ++x)
     {
-        // 此处应为void
-
-        if(block.desc->GetBlockID() != BLOCK_ID_VOID)
+        for(int z = 0; z < CHUNK_SECTION_SIZE_Z; ++z)
         {
-            updated = true;
-            chunkManager.SetBlockID(blockPos_, BLOCK_ID_VOID, {});
+            for(int y = 0; y < CHUNK_SECTION_SIZE_Y; ++y)
+            {
+                Vec3i blockInChunk = sectionBase + Vec3i(x, y, z);
+                BlockID id = chunk->GetID(blockInChunk);
+                section.cells[LiquidSimulation::CellIndex({ x, y, z })] = blockDescMgr.HasExtraData(id) ?
+                    LiquidSimulation::MakeCell(id, *chunk->GetExtraData(blockInChunk)) : LiquidSimulation::Cell{ id, 0 };
+            }
         }
     }
-
-    // 发布周围方块的更新任务
-
-    if(updated)
-    {
-        StdClock::time_point newUpdatingTime = now + updateDelay;
-        updaterManager.AddUpdater(std::make_unique<LiquidUpdater>(newUpdatingTime, blockPos_ + Vec3i(+1, 0, 0)));
-        updaterManager.AddUpdater(std::make_unique<LiquidUpdater>(newUpdatingTime, blockPos_ + Vec3i(-1, 0, 0)));
-        updaterManager.AddUpdater(std::make_unique<LiquidUpdater>(newUpdatingTime, blockPos_ + Vec3i(0, 0, +1)));
-        updaterManager.AddUpdater(std::make_unique<LiquidUpdater>(newUpdatingTime, blockPos_ + Vec3i(0, 0, -1)));
-        updaterManager.AddUpdater(std::make_unique<LiquidUpdater>(newUpdatingTime, blockPos_ + Vec3i(0, +1, 0)));
-        updaterManager.AddUpdater(std::make_unique<LiquidUpdater>(newUpdatingTime, blockPos_ + Vec3i(0, -1, 0)));
-    }
-}
-
-LiquidUpdater::LiquidUpdater(StdClock::time_point expectedUpdatingTime, const Vec3i &blockPos) noexcept
-    : BlockUpdater(expectedUpdatingTime), blockPos_(blockPos)
-{
-    
 }
 
-void LiquidUpdater::Execute(BlockUpdaterManager &updaterManager, ChunkManager &chunkManager, StdClock::time_point now)
+void LiquidUpdater::AddUpdaterForAdjacentBlocks(
+    const Vec3i &blockPos, BlockUpdaterManager &updaterManager, StdClock::time_point expectedUpdatingTime)
 {
-    if(blockPos_.y < 0 || blockPos_.y >= CHUNK_SIZE_Y)
-    {
-        return;
-    }
-
-    BlockInstance block = chunkManager.GetBlock(blockPos_);
-
-    if(!block.desc->IsReplacableByLiquid())
+    for(Direction direction : { PositiveX, NegativeX, PositiveZ, NegativeZ, PositiveY, NegativeY })
     {
-        return;
+        updaterManager.AddUpdater(GetUpdaterID(), blockPos + DirectionToVectori(direction), expectedUpdatingTime);
     }
-
-    // 处理该方块与周围的液体间发生的反应
-    if(ReactWithNeighborhood(block, updaterManager, chunkManager, now))
-    {
-        return;
-    }
-
-    // 处理周围液体流动到该方块处的结果，注意这里也可能发生反应
-    FlowFromNeighborhood(block, updaterManager, chunkManager, now);
 }
 
 void LiquidUpdater::AddUpdaterForNeighborhood(
     const Vec3i &blockPosition, BlockUpdaterManager &updaterManager, ChunkManager &chunkManager, StdClock::time_point now)
 {
+    // 只读取已加载的区块，未加载的位置视为void
+
+    auto getBlockDesc = [&](const Vec3i &position)
+    {
+        BlockID id = BLOCK_ID_VOID;
+        if(0 <= position.y && position.y < CHUNK_SIZE_Y)
+        {
+            auto [chunkPosition, blockInChunk] = DecomposeGlobalBlockByChunk(position);
+            if(const Chunk *chunk = chunkManager.FindChunk(chunkPosition))
+            {
+                id = chunk->GetID(blockInChunk);
+            }
+        }
+        return BlockDescManager::GetInstance().GetBlockDescription(id);
+    };
+
     auto getUpdaterDelay = [&](const Vec3i &position)
     {
-        auto desc0 = chunkManager.GetBlockDesc({ position.x + 1, position.y, position.z });
-        auto desc1 = chunkManager.GetBlockDesc({ position.x - 1, position.y, position.z });
-        auto desc2 = chunkManager.GetBlockDesc({ position.x, position.y + 1, position.z });
-        auto desc3 = chunkManager.GetBlockDesc({ position.x, position.y, position.z + 1 });
-        auto desc4 = chunkManager.GetBlockDesc({ position.x, position.y, position.z - 1 });
-        auto desc5 = chunkManager.GetBlockDesc(position);
+        auto desc0 = getBlockDesc({ position.x + 1, position.y, position.z });
+        auto desc1 = getBlockDesc({ position.x - 1, position.y, position.z });
+        auto desc2 = getBlockDesc({ position.x, position.y + 1, position.z });
+        auto desc3 = getBlockDesc({ position.x, position.y, position.z + 1 });
+        auto desc4 = getBlockDesc({ position.x, position.y, position.z - 1 });
+        auto desc5 = getBlockDesc(position);
 
         StdClock::duration minDelay = std::chrono::duration_cast<StdClock::duration>(std::chrono::milliseconds(1000000));
         if(desc0->IsLiquid()) minDelay = (std::min)(minDelay, desc0->GetLiquid()->spreadDelay);
@@ -270,7 +144,7 @@ void LiquidUpdater::AddUpdaterForNeighborhood(
         {
             return;
         }
-        updaterManager.AddUpdater(std::make_unique<LiquidUpdater>(now + delay, position));
+        updaterManager.AddUpdater(GetUpdaterID(), position, now + delay);
     };
 
     for(int dx = -1; dx <= 1; ++dx)
@@ -1,17 +1,18 @@
 ﻿#include <VRPG/Game/World/Block/BlockEffect.h>
 #include <VRPG/Game/World/Chunk/Chunk.h>
+#include <VRPG/Game/World/Chunk/SectionModelCache.h>
+#include <VRPG/Game/World/Chunk/SectionScratchVolume.h>
 
 VRPG_GAME_BEGIN
 
-void Chunk::RegenerateSectionModel(const Vec3i &sectionInChunk, const Chunk *neighboringChunks[3][3])
+void Chunk::RegenerateSectionModel(const Vec3i &sectionInChunk, const Chunk *neighboringChunks[3][3], int lodLevel)
 {
+    assert(0 <= lodLevel && lodLevel < SECTION_LOD_LEVEL_COUNT);
     assert(0 <= sectionInChunk.x && sectionInChunk.x < CHUNK_SECTION_COUNT_X);
     assert(0 <= sectionInChunk.y && sectionInChunk.y < CHUNK_SECTION_COUNT_Y);
     assert(0 <= sectionInChunk.z && sectionInChunk.z < CHUNK_SECTION_COUNT_Z);
     assert(neighboringChunks[1][1] == this);
 
-    auto &blockDescMgr = BlockDescManager::GetInstance();
-
     // 准备modelBuilders
 
     Vec3i globalSectionPosition = {
@@ -19,71 +20,86 @@ void Chunk::RegenerateSectionModel(const Vec3i &sectionInChunk, const Chunk *nei
         sectionInChunk.y,
         chunkPosition_.z * CHUNK_SECTION_COUNT_Z + sectionInChunk.z
     };
-    ModelBuilderSet modelBuilders(globalSectionPosition);
+    thread_local ModelBuilderSet modelBuilders;
+    modelBuilders.Reset(globalSectionPosition);
 
-    // 遍历每个block，将其model数据追加到各自的model builder中
+    // 将section及其外围方块拷贝到连续的临时数组中，此后的邻居查询均为固定步长的数组访问
 
-    Vec3i lowBlockInChunk = sectionInChunk * Vec3i(CHUNK_SECTION_SIZE_X, CHUNK_SECTION_SIZE_Y, CHUNK_SECTION_SIZE_Z);
-    Vec3i highBlockInChunk = lowBlockInChunk + Vec3i(CHUNK_SECTION_SIZE_X, CHUNK_SECTION_SIZE_Y, CHUNK_SECTION_SIZE_Z);
+    auto &blockDescMgr = BlockDescManager::GetInstance();
 
-    auto voidDesc = blockDescMgr.GetBlockDescription(BLOCK_ID_VOID);
-    auto getBlock = [&](int x, int y, int z)
-    {
-        if(y < 0 || y >= CHUNK_SIZE_Y)
-        {
-            return BlockInstance{ voidDesc, nullptr, BLOCK_BRIGHTNESS_MIN, BlockOrientation() };
-        }
-        auto [ckPos, blkPos] = DecomposeGlobalBlockByChunk({ x, y, z });
-        return neighboringChunks[ckPos.x][ckPos.z]->GetBlock(blkPos);
-    };
+    thread_local SectionScratchVolume volume;
+    volume.Fill(sectionInChunk, neighboringChunks);
+
+    // 输入与缓存中的某个section完全相同时直接复用其模型
 
-    // 给定方块坐标，找出它周围3*3*3的方块的信息，方块本身存放在[1][1][1]中
-    auto fillNeighbors = [&](
-        int x, int y, int z,
-        BlockNeighborhood neighborhood)
+    auto &modelCache = SectionModelCache::GetInstance();
+    std::optional<SectionContentHash> contentHash = volume.ComputeContentHash(lodLevel);
+    if(contentHash)
     {
-        --x, --y, --z;
-        for(int lx = 0; lx <= 2; ++lx)
+        if(auto cachedModel = modelCache.Find(*contentHash, globalSectionPosition))
         {
-            for(int ly = 0; ly <= 2; ++ly)
-            {
-                for(int lz = 0; lz <= 2; ++lz)
-                {
-                    neighborhood[lx][ly][lz] = getBlock(x + lx, y + ly, z + lz);
-                }
-            }
+            model_.sectionModel(sectionInChunk) = std::move(cachedModel);
+            return;
         }
-    };
+    }
 
-    int xBase = chunkPosition_.x * CHUNK_SIZE_X;
-    int zBase = chunkPosition_.z * CHUNK_SIZE_Z;
+    // 遍历每个block，将其model数据追加到各自的model builder中
+
+    Vec3i lowBlockInChunk = sectionInChunk * Vec3i(CHUNK_SECTION_SIZE_X, CHUNK_SECTION_SIZE_Y, CHUNK_SECTION_SIZE_Z);
 
-    BlockNeighborhood neighborhood;
+    int xBase = chunkPosition_.x * CHUNK_SIZE_X + lowBlockInChunk.x;
+    int yBase = lowBlockInChunk.y;
+    int zBase = chunkPosition_.z * CHUNK_SIZE_Z + lowBlockInChunk.z;
 
-    for(int x = lowBlockInChunk.x; x < highBlockInChunk.x; ++x)
+    for(int x = 0; x < CHUNK_SECTION_SIZE_X; ++x)
     {
-        for(int z = lowBlockInChunk.z; z < highBlockInChunk.z; ++z)
+        for(int z = 0; z < CHUNK_SECTION_SIZE_Z; ++z)
         {
-            for(int y = lowBlockInChunk.y; y < highBlockInChunk.y; ++y)
+            // 被实体方块完全包围的实体方块不会产生任何面片，整列都是这样的方块时可以直接跳过
+
+            uint32_t exposedMask = volume.GetExposedMask(x, z);
+            if(!exposedMask)
             {
-                if(!blockDescMgr.GetBlockDescription(GetID({ x, y, z }))->IsVisible())
+                continue;
+            }
+
+            for(int y = 0; y < CHUNK_SECTION_SIZE_Y; ++y)
+            {
+                if(!(exposedMask & (1u << y)))
                 {
                     continue;
                 }
 
-                fillNeighbors(x + CHUNK_SIZE_X, y, z + CHUNK_SIZE_Z, neighborhood);
-                neighborhood[1][1][1].desc->AddBlockModel(modelBuilders, { xBase + x, y, zBase + z }, neighborhood);
+                BlockID id = volume.GetBlock({ x, y, z }).id;
+                if(!blockDescMgr.IsVisible(id) || (lodLevel > 0 && blockDescMgr.HasLODModel(id)))
+                {
+                    continue;
+                }
+
+                blockDescMgr.GetBlockDescription(id)->AddBlockModel(
+                    modelBuilders, { xBase + x, yBase + y, zBase + z }, volume.GetNeighborhood({ x, y, z }));
             }
         }
     }
 
+    if(lodLevel > 0)
+    {
+        volume.AddLODModel(modelBuilders, globalSectionPosition, SectionLODCellSize(lodLevel));
+    }
+
     // 用modelBuilders创建新的sectionModel，取代原来的
 
     auto newSectionModel = std::make_unique<SectionModel>();
-    for(auto &builder : modelBuilders)
+    newSectionModel->lodLevel = lodLevel;
+    newSectionModel->connectivity = volume.ComputeConnectivity();
+    modelBuilders.ForEachUsedBuilder([&](ModelBuilder &builder)
     {
-        if(auto model = builder->Build())
+        if(auto model = builder.Build())
             newSectionModel->partialModels.push_back(std::move(model));
+    });
+    if(contentHash)
+    {
+        modelCache.Insert(*contentHash, globalSectionPosition, *newSectionModel);
     }
     model_.sectionModel(sectionInChunk) = std::move(newSectionModel);
 }
@@ -92,7 +92,6 @@ void PropagateLightForCentreChunk(Chunk *(&chunks)[3][3])
     {
         assert(!OutOfBound(pos.x, pos.y, pos.z));
         BlockID id = GetID(chunks, pos.x, pos.y, pos.z);
-        auto desc = blockDescMgr.GetBlockDescription(id);
         BlockBrightness original = GetLight(chunks, pos.x, pos.y, pos.z);
 
         BlockBrightness posX = GetLight(chunks, pos.x + 1, pos.y, pos.z);
@@ -112,8 +111,8 @@ void PropagateLightForCentreChunk(Chunk *(&chunks)[3][3])
             directSkyLight = BLOCK_BRIGHTNESS_SKY;
         }
 
-        BlockBrightness emission = desc->InitialBrightness();
-        BlockBrightness attenuation = desc->LightAttenuation();
+        BlockBrightness emission = blockDescMgr.InitialBrightness(id);
+        BlockBrightness attenuation = blockDescMgr.LightAttenuation(id);
 
         BlockBrightness propagated = Max(emission, Max(maxNeighborLight - attenuation, directSkyLight));
 
@@ -143,10 +142,9 @@ void PropagateLightForCentreChunk(Chunk *(&chunks)[3][3])
             for(int y = 0; y <= height; ++y)
             {
                 BlockID id = GetID(chunks, x, y, z);
-                auto desc = blockDescMgr.GetBlockDescription(id);
-                if(desc->IsLightSource())
+                if(blockDescMgr.IsLightSource(id))
                 {
-                    SetLight(chunks, x, y, z, desc->InitialBrightness());
+                    SetLight(chunks, x, y, z, blockDescMgr.InitialBrightness(id));
                     addNeighborToQueue(x, y, z);
                 }
             }
@@ -17,7 +17,11 @@ namespace
 ChunkLoader::ChunkLoader()
 {
     skipLoading_ = false;
-    log_ = spdlog::stdout_color_mt("ChunkLoader");
+    log_ = spdlog::get("ChunkLoader");
+    if(!log_)
+    {
+        log_ = spdlog::stdout_color_mt("ChunkLoader");
+    }
 }
 
 ChunkLoader::~ChunkLoader()
@@ -75,11 +79,11 @@ void ChunkLoader::Destroy()
     loadingResults_.reset();
 }
 
-void ChunkLoader::AddLoadingTask(const ChunkPosition &position)
+void ChunkLoader::AddLoadingTask(const ChunkPosition &position, int lodLevel)
 {
     assert(IsAvailable());
     size_t threadIndex = PositionToThreadIndex(position, threads_.size());
-    perThreadData_[threadIndex].taskQueue.AddLoadingTask(position);
+    perThreadData_[threadIndex].taskQueue.AddLoadingTask(position, lodLevel);
 }
 
 void ChunkLoader::AddUnloadingTask(std::unique_ptr<Chunk> &&chunk)
@@ -116,7 +120,13 @@ void ChunkLoader::SetChunkBlockDataInPool(int globalBlockX, int globalBlockY, in
     blockDataPool_->ModifyBlockIDInPool({ globalBlockX, globalBlockY, globalBlockZ }, id, orientation);
 }
 
-std::unique_ptr<Chunk> ChunkLoader::LoadChunk(const ChunkPosition &position)
+void ChunkLoader::SetChunkBlocksInPool(
+    const ChunkPosition &chunkPosition, std::vector<ChunkBlockDataPool::BlockModification> modifications)
+{
+    blockDataPool_->ModifyBlocksInPool(chunkPosition, std::move(modifications));
+}
+
+std::unique_ptr<Chunk> ChunkLoader::LoadChunk(const ChunkPosition &position, int lodLevel)
 {
     // 生成/加载方块数据
     // 池子中的数据可能是过时的，因此这里强制重新生成
@@ -168,7 +178,7 @@ std::unique_ptr<Chunk> ChunkLoader::LoadChunk(const ChunkPosition &position)
         {
             for(int sy = 0; sy < CHUNK_SECTION_COUNT_Y; ++sy)
             {
-                chunk->RegenerateSectionModel({ sx, sy, sz }, constNeighboringChunks);
+                chunk->RegenerateSectionModel({ sx, sy, sz }, constNeighboringChunks, lodLevel);
             }
         }
     }
@@ -215,7 +225,7 @@ void ChunkLoader::ExecuteTask(ChunkLoaderTask &&task)
     }
     if(!load.chunk)
     {
-        load.chunk = LoadChunk(load.position);
+        load.chunk = LoadChunk(load.position, load.lodLevel);
     }
     AddLoadingResult(std::move(load.chunk));
 }
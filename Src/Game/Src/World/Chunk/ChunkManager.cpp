@@ -3,10 +3,56 @@
 
 VRPG_GAME_BEGIN
 
+namespace
+{
+    /**
+     * @brief 修改某个方块后需要重新生成的section相对于该方块所在section的偏移，
+     *        偏移(dx, dy, dz)对应第(dx + 1) * 9 + (dy + 1) * 3 + (dz + 1)位
+     */
+    uint32_t NeighborSectionMask(int sectionY, const Vec3i &blockInSection) noexcept
+    {
+        const bool lower[3] = {
+            blockInSection.x == 0,
+            blockInSection.y == 0 && sectionY > 0,
+            blockInSection.z == 0
+        };
+        const bool higher[3] = {
+            blockInSection.x == CHUNK_SECTION_SIZE_X - 1,
+            blockInSection.y == CHUNK_SECTION_SIZE_Y - 1 && sectionY < CHUNK_SECTION_COUNT_Y - 1,
+            blockInSection.z == CHUNK_SECTION_SIZE_Z - 1
+        };
+
+        auto isValidOffset = [&](int axis, int offset)
+        {
+            return offset == 0 || (offset < 0 ? lower[axis] : higher[axis]);
+        };
+
+        uint32_t mask = 0;
+        for(int dx = -1; dx <= 1; ++dx)
+        {
+            for(int dy = -1; dy <= 1; ++dy)
+            {
+                for(int dz = -1; dz <= 1; ++dz)
+                {
+                    if(isValidOffset(0, dx) && isValidOffset(1, dy) && isValidOffset(2, dz))
+                    {
+                        mask |= 1u << ((dx + 1) * 9 + (dy + 1) * 3 + (dz + 1));
+                    }
+                }
+            }
+        }
+        return mask;
+    }
+}
+
 ChunkManager::ChunkManager(const ChunkManagerParams &params, std::unique_ptr<LandGenerator> landGenerator)
     : params_(params)
 {
-    log_ = spdlog::stdout_color_mt("ChunkManager");
+    log_ = spdlog::get("ChunkManager");
+    if(!log_)
+    {
+        log_ = spdlog::stdout_color_mt("ChunkManager");
+    }
 
     loader_ = std::make_unique<ChunkLoader>();
     loader_->Initialize(
@@ -14,6 +60,8 @@ ChunkManager::ChunkManager(const ChunkManagerParams &params, std::unique_ptr<Lan
 
     centreChunkPosition_.x = (std::numeric_limits<int>::max)() - 5;
     centreChunkPosition_.z = (std::numeric_limits<int>::max)() - 5;
+
+    nextBlockChangeSubscriberHandle_ = 0;
 }
 
 ChunkManager::~ChunkManager()
@@ -33,6 +81,7 @@ void ChunkManager::SetCentreChunk(const ChunkPosition &chunkPosition)
     }
     centreChunkPosition_.x = chunkPosition.x;
     centreChunkPosition_.z = chunkPosition.z;
+    isSectionLODDirty_ = true;
 
     // 有哪些需要加载的区块
 
@@ -65,7 +114,7 @@ void ChunkManager::SetCentreChunk(const ChunkPosition &chunkPosition)
 
     for(auto &position : chunksShouldBeLoad)
     {
-        loader_->AddLoadingTask(position);
+        loader_->AddLoadingTask(position, GetSectionLODLevel(position));
         log_->trace("add loading task({}, {})", position.x, position.z);
     }
 
@@ -98,6 +147,19 @@ void ChunkManager::SetCentreChunk(const ChunkPosition &chunkPosition)
     }
 }
 
+BlockChangeSubscriberHandle ChunkManager::AddBlockChangeSubscriber(std::function<void(const Vec3i &)> callback)
+{
+    const BlockChangeSubscriberHandle handle = nextBlockChangeSubscriberHandle_++;
+    blockChangeSubscribers_.emplace_back(handle, std::move(callback));
+    return handle;
+}
+
+void ChunkManager::RemoveBlockChangeSubscriber(BlockChangeSubscriberHandle handle)
+{
+    blockChangeSubscribers_.erase(std::remove_if(blockChangeSubscribers_.begin(), blockChangeSubscribers_.end(),
+        [&](const auto &subscriber) { return subscriber.first == handle; }), blockChangeSubscribers_.end());
+}
+
 void ChunkManager::SetBlockID(const Vec3i &globalBlock, BlockID id, BlockOrientation orientation)
 {
     // 分下面几步：
@@ -157,6 +219,11 @@ void ChunkManager::SetBlockID(const Vec3i &globalBlock, BlockID id, BlockOrienta
 
     blocksWithDirtyLight_.push(globalBlock);
     MakeNeighborSectionsDirty(globalBlock);
+
+    for(auto &subscriber : blockChangeSubscribers_)
+    {
+        subscriber.second(globalBlock);
+    }
 }
 
 void ChunkManager::SetBlockID(const Vec3i &globalBlock, uint16_t id, BlockOrientation orientation, BlockExtraData extraData)
@@ -169,6 +236,216 @@ void ChunkManager::SetBlockID(const Vec3i &globalBlock, uint16_t id, BlockOrient
     *GetExtraData(globalBlock) = std::move(extraData);
 }
 
+void ChunkManager::SetBlocks(std::vector<BlockEdit> edits)
+{
+    // 分下面几步：
+    // 1. 按区块对修改分组，同一区块中的修改保持原有顺序，使对同一方块的多次修改以最后一次为准
+    // 2. 逐区块设置id，每个被修改的列只更新一次height map，并向后台pool发送一条消息
+    // 3. 只将修改区域边界上的方块、天光改变的方块，以及新旧方块自发光、原本有亮度或光照衰减改变的方块加入光照更新队列，
+    //    其余区域内部的方块会在光照传播到它们时被更新
+    // 4. 汇总所有被修改的方块涉及的section，每个section只标记一次dirty
+
+    edits.erase(std::remove_if(edits.begin(), edits.end(), [](const BlockEdit &edit)
+    {
+        return edit.globalBlock.y < 0 || edit.globalBlock.y >= CHUNK_SIZE_Y;
+    }), edits.end());
+
+    if(edits.empty())
+    {
+        return;
+    }
+
+    std::stable_sort(edits.begin(), edits.end(), [](const BlockEdit &lhs, const BlockEdit &rhs)
+    {
+        return GlobalBlockToChunk(lhs.globalBlock) < GlobalBlockToChunk(rhs.globalBlock);
+    });
+
+    std::unordered_set<Vec3i> editedBlocks;
+    editedBlocks.reserve(edits.size());
+    for(auto &edit : edits)
+    {
+        editedBlocks.insert(edit.globalBlock);
+    }
+
+    auto isOnBoundary = [&](const Vec3i &globalBlock)
+    {
+        for(Direction direction : { PositiveX, NegativeX, PositiveY, NegativeY, PositiveZ, NegativeZ })
+        {
+            if(!editedBlocks.count(globalBlock + DirectionToVectori(direction)))
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    auto &blockDescMgr = BlockDescManager::GetInstance();
+
+    std::unordered_map<Vec3i, uint32_t> dirtySectionMasks;
+    Vec3i lastSection;
+    uint32_t *lastSectionMask = nullptr;
+
+    for(size_t chunkBegin = 0; chunkBegin < edits.size();)
+    {
+        const ChunkPosition ckPos = GlobalBlockToChunk(edits[chunkBegin].globalBlock);
+        size_t chunkEnd = chunkBegin + 1;
+        while(chunkEnd < edits.size() && GlobalBlockToChunk(edits[chunkEnd].globalBlock) == ckPos)
+        {
+            ++chunkEnd;
+        }
+
+        Chunk *chunk = EnsureChunkExists(ckPos.x, ckPos.z);
+
+        // 设置方块id，记录每一列中被修改的最高位置
+
+        int maxModifiedY[CHUNK_SIZE_X][CHUNK_SIZE_Z];
+        std::fill(&maxModifiedY[0][0], &maxModifiedY[0][0] + CHUNK_SIZE_X * CHUNK_SIZE_Z, -1);
+
+        std::vector<ChunkBlockDataPool::BlockModification> poolModifications;
+        poolModifications.reserve(chunkEnd - chunkBegin);
+
+        for(size_t i = chunkBegin; i < chunkEnd; ++i)
+        {
+            auto &edit = edits[i];
+            auto blkPos = DecomposeGlobalBlockByChunk(edit.globalBlock).second;
+
+            const BlockID oldID = chunk->GetID(blkPos);
+            const BlockBrightness oldBrightness = chunk->GetBrightness(blkPos);
+
+            if(blockDescMgr.HasExtraData(edit.block.id))
+            {
+                chunk->SetID(blkPos, edit.block.id, edit.block.orientation, std::move(edit.block.extraData));
+            }
+            else
+            {
+                chunk->SetID(blkPos, edit.block.id, edit.block.orientation);
+            }
+
+            maxModifiedY[blkPos.x][blkPos.z] = (std::max)(maxModifiedY[blkPos.x][blkPos.z], blkPos.y);
+            poolModifications.push_back({ blkPos, edit.block.id, edit.block.orientation });
+
+            // 区域内部的方块只有在其光照可能与周围不一致时才需要加入队列：
+            // 新旧方块自发光、原本有亮度（可能是被移除的光源留下的残余光照），或光照衰减发生了改变
+
+            const bool needLightUpdate =
+                isOnBoundary(edit.globalBlock) ||
+                blockDescMgr.InitialBrightness(edit.block.id) != BLOCK_BRIGHTNESS_MIN ||
+                blockDescMgr.InitialBrightness(oldID)         != BLOCK_BRIGHTNESS_MIN ||
+                oldBrightness                                 != BLOCK_BRIGHTNESS_MIN ||
+                blockDescMgr.LightAttenuation(edit.block.id)  != blockDescMgr.LightAttenuation(oldID);
+            if(needLightUpdate)
+            {
+                blocksWithDirtyLight_.push(edit.globalBlock);
+            }
+
+            Vec3i section = GlobalBlockToGlobalSection(edit.globalBlock);
+            if(!lastSectionMask || lastSection != section)
+            {
+                lastSection = section;
+                lastSectionMask = &dirtySectionMasks[section];
+            }
+            *lastSectionMask |= NeighborSectionMask(section.y, GlobalBlockToBlockInSection(edit.globalBlock));
+        }
+
+        // 更新height map，最大高度改变的列中，新旧高度之间的方块的天光都可能发生变化
+
+        for(int x = 0; x < CHUNK_SIZE_X; ++x)
+        {
+            for(int z = 0; z < CHUNK_SIZE_Z; ++z)
+            {
+                if(maxModifiedY[x][z] < 0)
+                {
+                    continue;
+                }
+
+                int oldHeight = chunk->GetHeight(x, z);
+                int newHeight = (std::max)(oldHeight, maxModifiedY[x][z]);
+                while(newHeight >= 0 && chunk->GetID({ x, newHeight, z }) == BLOCK_ID_VOID)
+                {
+                    --newHeight;
+                }
+
+                if(newHeight != oldHeight)
+                {
+                    chunk->SetHeight(x, z, newHeight);
+
+                    int globalX = ckPos.x * CHUNK_SIZE_X + x;
+                    int globalZ = ckPos.z * CHUNK_SIZE_Z + z;
+                    for(int y = (std::max)(0, (std::min)(oldHeight, newHeight)); y <= (std::max)(oldHeight, newHeight); ++y)
+                    {
+                        blocksWithDirtyLight_.push({ globalX, y, globalZ });
+                    }
+                }
+            }
+        }
+
+        // 将整个区块的修改作为一条消息告知loader pool
+
+        loader_->SetChunkBlocksInPool(ckPos, std::move(poolModifications));
+
+        chunkBegin = chunkEnd;
+    }
+
+    // 标记dirty section
+
+    for(auto &[section, mask] : dirtySectionMasks)
+    {
+        for(int bit = 0; bit < 27; ++bit)
+        {
+            if(mask & (1u << bit))
+            {
+                sectionsWithDirtyModel_.insert({ section.x + bit / 9 - 1, section.y + bit / 3 % 3 - 1, section.z + bit % 3 - 1 });
+            }
+        }
+    }
+
+    for(auto &globalBlock : editedBlocks)
+    {
+        for(auto &subscriber : blockChangeSubscribers_)
+        {
+            subscriber.second(globalBlock);
+        }
+    }
+}
+
+void ChunkManager::SetBlocks(const Vec3i &low, const Vec3i &high, BlockID id, BlockOrientation orientation)
+{
+    const Vec3i clampedLow  = { low.x,  (std::max)(low.y, 0),                 low.z  };
+    const Vec3i clampedHigh = { high.x, (std::min)(high.y, CHUNK_SIZE_Y - 1), high.z };
+    if(clampedLow.x > clampedHigh.x || clampedLow.y > clampedHigh.y || clampedLow.z > clampedHigh.z)
+    {
+        return;
+    }
+
+    auto desc = BlockDescManager::GetInstance().GetBlockDescription(id);
+
+    std::vector<BlockEdit> edits;
+    edits.reserve(size_t(clampedHigh.x - clampedLow.x + 1) *
+                  size_t(clampedHigh.y - clampedLow.y + 1) *
+                  size_t(clampedHigh.z - clampedLow.z + 1));
+
+    for(int x = clampedLow.x; x <= clampedHigh.x; ++x)
+    {
+        for(int z = clampedLow.z; z <= clampedHigh.z; ++z)
+        {
+            for(int y = clampedLow.y; y <= clampedHigh.y; ++y)
+            {
+                BlockEdit edit;
+                edit.globalBlock       = { x, y, z };
+                edit.block.id          = id;
+                edit.block.orientation = orientation;
+                if(desc->HasExtraData())
+                {
+                    edit.block.extraData = desc->CreateExtraData();
+                }
+                edits.push_back(std::move(edit));
+            }
+        }
+    }
+
+    SetBlocks(std::move(edits));
+}
+
 BlockID ChunkManager::GetBlockID(const Vec3i &globalBlock)
 {
     if(globalBlock.y < 0 || globalBlock.y >= CHUNK_SIZE_Y)
@@ -241,6 +518,26 @@ BlockInstance ChunkManager::GetBlock(const Vec3i &globalBlock)
     return chunk->GetBlock(blkPos);
 }
 
+const Chunk *ChunkManager::FindChunk(const ChunkPosition &position) const
+{
+    auto it = chunks_.find(position);
+    return it != chunks_.end() ? it->second.get() : nullptr;
+}
+
+bool ChunkManager::IsChunkSimulated(const ChunkPosition &position) const
+{
+    int deltaX = position.x - centreChunkPosition_.x;
+    int deltaZ = position.z - centreChunkPosition_.z;
+    if(std::abs(deltaX) > params_.simulationDistance || std::abs(deltaZ) > params_.simulationDistance)
+    {
+        return false;
+    }
+
+    return chunks_.count(position) &&
+           chunks_.count({ position.x + 1, position.z }) && chunks_.count({ position.x - 1, position.z }) &&
+           chunks_.count({ position.x, position.z + 1 }) && chunks_.count({ position.x, position.z - 1 });
+}
+
 bool ChunkManager::FindClosestIntersectedBlock(
     const Vec3 &o, const Vec3 &d, float maxDistance, Vec3i *pickedBlock, Direction *pickedFace,
     const std::function<bool(const BlockDescription*)> &blockFilter)
@@ -262,11 +559,20 @@ bool ChunkManager::FindClosestIntersectedBlock(
         }
         lastBlockPosition = blockPosition;
 
-        auto [id, orien] = GetBlockIDAndOrientation(blockPosition);
-        if(id == BLOCK_ID_VOID)
+        // 借助碰撞位掩码跳过不具有碰撞体积的方块
+
+        if(blockPosition.y < 0 || blockPosition.y >= CHUNK_SIZE_Y)
         {
             continue;
         }
+        auto [ckPos, blkPos] = DecomposeGlobalBlockByChunk(blockPosition);
+        const Chunk *chunk = EnsureChunkExists(ckPos.x, ckPos.z);
+        if(!chunk->HasCollision(blkPos))
+        {
+            continue;
+        }
+        BlockID id = chunk->GetID(blkPos);
+        BlockOrientation orien = chunk->GetOrientation(blkPos);
 
         Vec3 localStart = {
             o.x - blockPosition.x,
@@ -277,7 +583,7 @@ bool ChunkManager::FindClosestIntersectedBlock(
         Vec3 rotatedLocalDirection = RotateLocalPosition(orien, d);
 
         const BlockDescription *desc      = blockDescMgr.GetBlockDescription(id);
-        const BlockCollision   *collision = desc->GetCollision();
+        const BlockCollision   *collision = blockDescMgr.GetCollision(id);
         Collision::Ray ray{ rotatedLocalStart, rotatedLocalDirection, 0, maxDistance };
         if(collision->IntersectWith(ray, pickedFace) && blockFilter(desc))
         {
@@ -308,6 +614,7 @@ bool ChunkManager::UpdateChunkData()
         if(it == chunks_.end() && !ShouldDestroy(position))
         {
             chunks_[position] = std::move(chunk);
+            isSectionLODDirty_ = true;
         }
         else
         {
@@ -325,6 +632,15 @@ void ChunkManager::UpdateLight()
 
 bool ChunkManager::UpdateChunkModels()
 {
+    // 遍历sectionsWithDirtyModel_的过程中可能因EnsureChunkExists而有新区块加入，
+    // 因此只在遍历开始前检查细节层次，之后加入的区块留待下一次调用处理
+
+    if(isSectionLODDirty_)
+    {
+        MakeStaleLODSectionsDirty();
+        isSectionLODDirty_ = false;
+    }
+
     if(sectionsWithDirtyModel_.empty())
     {
         return false;
@@ -354,20 +670,100 @@ bool ChunkManager::UpdateChunkModels()
         neighboringChunks[2][1] = EnsureChunkExists(ckPos.x + 1, ckPos.z);
         neighboringChunks[2][2] = EnsureChunkExists(ckPos.x + 1, ckPos.z + 1);
 
-        chunk->RegenerateSectionModel({ secInCk.x, secInCk.y, secInCk.z }, neighboringChunks);
+        chunk->RegenerateSectionModel({ secInCk.x, secInCk.y, secInCk.z }, neighboringChunks, GetSectionLODLevel(ckPos));
     }
 
     sectionsWithDirtyModel_.clear();
     return true;
 }
 
-void ChunkManager::FillRenderer(ChunkRenderer &renderer)
+void ChunkManager::FillRenderer(ChunkRenderer &renderer, const Vec3 &cameraPosition)
 {
+    // 将renderDistance内的区块排布到一个二维网格中，便于按section坐标直接查找
+
+    const int chunkGridSize = 2 * params_.renderDistance + 1;
+    const ChunkPosition minChunk = {
+        centreChunkPosition_.x - params_.renderDistance,
+        centreChunkPosition_.z - params_.renderDistance
+    };
+
+    std::vector<const Chunk *> chunkGrid(chunkGridSize * chunkGridSize, nullptr);
     for(auto &pair : chunks_)
     {
-        auto &chunk = pair.second;
-        if(ShouldRender(chunk->GetPosition()))
+        if(ShouldRender(pair.first))
+        {
+            chunkGrid[(pair.first.x - minChunk.x) * chunkGridSize + (pair.first.z - minChunk.z)] = pair.second.get();
+
+            int maxHeight = 0;
+            for(int x = 0; x < CHUNK_SIZE_X; ++x)
+            {
+                for(int z = 0; z < CHUNK_SIZE_Z; ++z)
+                {
+                    maxHeight = (std::max)(maxHeight, pair.second->GetHeight(x, z));
+                }
+            }
+            renderer.SetChunkMaxHeight(pair.first, maxHeight);
+        }
+    }
+
+    const int sectionGridX = chunkGridSize * CHUNK_SECTION_COUNT_X;
+    const int sectionGridZ = chunkGridSize * CHUNK_SECTION_COUNT_Z;
+    const Vec3i minSection = { minChunk.x * CHUNK_SECTION_COUNT_X, 0, minChunk.z * CHUNK_SECTION_COUNT_Z };
+
+    auto sectionIndex = [&](const Vec3i &globalSection)
+    {
+        Vec3i local = globalSection - minSection;
+        if(local.x < 0 || local.x >= sectionGridX ||
+           local.y < 0 || local.y >= CHUNK_SECTION_COUNT_Y ||
+           local.z < 0 || local.z >= sectionGridZ)
+        {
+            return -1;
+        }
+        return (local.x * sectionGridZ + local.z) * CHUNK_SECTION_COUNT_Y + local.y;
+    };
+
+    auto getSectionModel = [&](const Vec3i &globalSection) -> const SectionModel *
+    {
+        Vec3i local = globalSection - minSection;
+        auto chunk = chunkGrid[(local.x / CHUNK_SECTION_COUNT_X) * chunkGridSize + local.z / CHUNK_SECTION_COUNT_Z];
+        if(!chunk)
         {
+            return nullptr;
+        }
+        return chunk->GetChunkModel().sectionModel(
+            local.x % CHUNK_SECTION_COUNT_X, local.y, local.z % CHUNK_SECTION_COUNT_Z).get();
+    };
+
+    auto addSectionModel = [&](const SectionModel &sectionModel, bool isCameraReachable)
+    {
+        for(auto &m : sectionModel.partialModels)
+        {
+            renderer.AddPartialSectionModel(m, isCameraReachable);
+        }
+    };
+
+    // 摄像机所在的section，竖直方向上超出世界范围时取最近的section
+
+    Vec3i cameraSection = GlobalBlockToGlobalSection({
+        int(std::floor(cameraPosition.x)),
+        int(std::floor(cameraPosition.y)),
+        int(std::floor(cameraPosition.z))
+    });
+    cameraSection.y = (std::clamp)(cameraSection.y, 0, CHUNK_SECTION_COUNT_Y - 1);
+
+    const int cameraSectionIndex = sectionIndex(cameraSection);
+    const SectionModel *cameraSectionModel = cameraSectionIndex >= 0 ? getSectionModel(cameraSection) : nullptr;
+
+    if(!cameraSectionModel)
+    {
+        // 摄像机所在的section尚未加载，无法进行可见性搜索，退化为渲染全部section
+
+        for(auto chunk : chunkGrid)
+        {
+            if(!chunk)
+            {
+                continue;
+            }
             auto &model = chunk->GetChunkModel();
             for(int x = 0; x < CHUNK_SECTION_COUNT_X; ++x)
             {
@@ -375,10 +771,98 @@ void ChunkManager::FillRenderer(ChunkRenderer &renderer)
                 {
                     for(int y = 0; y < CHUNK_SECTION_COUNT_Y; ++y)
                     {
-                        auto &sectionModels = model.sectionModel(x, y, z);
-                        for(auto &m : sectionModels->partialModels)
+                        if(auto &sectionModel = model.sectionModel(x, y, z))
                         {
-                            renderer.AddPartialSectionModel(m);
+                            addSectionModel(*sectionModel, true);
+                        }
+                    }
+                }
+            }
+        }
+        return;
+    }
+
+    // 从摄像机所在的section出发，沿section的面连通关系进行广度优先搜索
+    // 视线从entryFace进入section后，只能从与entryFace连通的面离开；
+    // 同时不允许沿已经走过的方向的反方向前进，以免视线绕回而高估可见集合
+
+    struct SearchNode
+    {
+        Vec3i globalSection;
+        const SectionModel *model;
+        int entryFace;
+        uint8_t traversedDirections;
+    };
+
+    std::vector<uint8_t> visited(sectionGridX * sectionGridZ * CHUNK_SECTION_COUNT_Y, 0);
+    std::queue<SearchNode> searchQueue;
+
+    visited[cameraSectionIndex] = 1;
+    searchQueue.push({ cameraSection, cameraSectionModel, -1, 0 });
+
+    while(!searchQueue.empty())
+    {
+        SearchNode node = searchQueue.front();
+        searchQueue.pop();
+
+        addSectionModel(*node.model, true);
+
+        for(int d = 0; d < 6; ++d)
+        {
+            Direction dir = Direction(d);
+            if(node.traversedDirections & (1 << int(-dir)))
+            {
+                continue;
+            }
+
+            if(node.entryFace >= 0 && !node.model->connectivity.IsConnected(Direction(node.entryFace), dir))
+            {
+                continue;
+            }
+
+            Vec3i neighbor = node.globalSection + DirectionToVectori(dir);
+            int neighborIndex = sectionIndex(neighbor);
+            if(neighborIndex < 0 || visited[neighborIndex])
+            {
+                continue;
+            }
+
+            const SectionModel *neighborModel = getSectionModel(neighbor);
+            if(!neighborModel)
+            {
+                continue;
+            }
+
+            visited[neighborIndex] = 1;
+            searchQueue.push({ neighbor, neighborModel, int(-dir), uint8_t(node.traversedDirections | (1 << d)) });
+        }
+    }
+
+    // 视线无法到达的section仍可能向可见区域投射阴影（如山体背面、地下空洞上方的地表），
+    // 因此将它们作为仅投射阴影的模型加入渲染队列
+
+    for(int cx = 0; cx < chunkGridSize; ++cx)
+    {
+        for(int cz = 0; cz < chunkGridSize; ++cz)
+        {
+            auto chunk = chunkGrid[cx * chunkGridSize + cz];
+            if(!chunk)
+            {
+                continue;
+            }
+
+            auto &model = chunk->GetChunkModel();
+            for(int x = 0; x < CHUNK_SECTION_COUNT_X; ++x)
+            {
+                for(int z = 0; z < CHUNK_SECTION_COUNT_Z; ++z)
+                {
+                    for(int y = 0; y < CHUNK_SECTION_COUNT_Y; ++y)
+                    {
+                        Vec3i globalSection = minSection + Vec3i(cx * CHUNK_SECTION_COUNT_X + x, y, cz * CHUNK_SECTION_COUNT_Z + z);
+                        auto &sectionModel = model.sectionModel(x, y, z);
+                        if(sectionModel && !visited[sectionIndex(globalSection)])
+                        {
+                            addSectionModel(*sectionModel, false);
                         }
                     }
                 }
@@ -394,7 +878,7 @@ Chunk *ChunkManager::EnsureChunkExists(int chunkX, int chunkZ)
         return it->second.get();
     }
 
-    loader_->AddLoadingTask({ chunkX, chunkZ });
+    loader_->AddLoadingTask({ chunkX, chunkZ }, GetSectionLODLevel({ chunkX, chunkZ }));
     for(;;)
     {
         std::this_thread::sleep_for(std::chrono::milliseconds(5));
@@ -422,6 +906,52 @@ bool ChunkManager::ShouldRender(const ChunkPosition &position) const noexcept
     return std::abs(deltaX) <= params_.renderDistance && std::abs(deltaZ) <= params_.renderDistance;
 }
 
+int ChunkManager::GetSectionLODLevel(const ChunkPosition &position) const noexcept
+{
+    int distance = (std::max)(std::abs(position.x - centreChunkPosition_.x), std::abs(position.z - centreChunkPosition_.z));
+    if(distance <= params_.fullDetailDistance)
+    {
+        return 0;
+    }
+    if(distance <= params_.halfDetailDistance)
+    {
+        return 1;
+    }
+    return SECTION_LOD_LEVEL_COUNT - 1;
+}
+
+void ChunkManager::MakeStaleLODSectionsDirty()
+{
+    for(auto &pair : chunks_)
+    {
+        if(!ShouldRender(pair.first))
+        {
+            continue;
+        }
+
+        int lodLevel = GetSectionLODLevel(pair.first);
+        auto &model = pair.second->GetChunkModel();
+        for(int x = 0; x < CHUNK_SECTION_COUNT_X; ++x)
+        {
+            for(int z = 0; z < CHUNK_SECTION_COUNT_Z; ++z)
+            {
+                for(int y = 0; y < CHUNK_SECTION_COUNT_Y; ++y)
+                {
+                    auto &sectionModel = model.sectionModel(x, y, z);
+                    if(sectionModel && sectionModel->lodLevel != lodLevel)
+                    {
+                        sectionsWithDirtyModel_.insert({
+                            pair.first.x * CHUNK_SECTION_COUNT_X + x,
+                            y,
+                            pair.first.z * CHUNK_SECTION_COUNT_Z + z
+                        });
+                    }
+                }
+            }
+        }
+    }
+}
+
 void ChunkManager::UpdateLight(std::queue<Vec3i> &blocksQueue)
 {
     auto &blockDescMgr = BlockDescManager::GetInstance();
@@ -447,7 +977,7 @@ void ChunkManager::UpdateLight(std::queue<Vec3i> &blocksQueue)
             continue;
         }
 
-        auto desc = blockDescMgr.GetBlockDescription(GetBlockID(pos));
+        BlockID id = GetBlockID(pos);
         BlockBrightness original = GetBlockBrightness(pos);
 
         BlockBrightness posX = GetBlockBrightness({ x + 1, y, z });
@@ -466,8 +996,8 @@ void ChunkManager::UpdateLight(std::queue<Vec3i> &blocksQueue)
             directSkyLight = BLOCK_BRIGHTNESS_SKY;
         }
 
-        BlockBrightness emission = desc->InitialBrightness();
-        BlockBrightness attenuation = desc->LightAttenuation();
+        BlockBrightness emission = blockDescMgr.InitialBrightness(id);
+        BlockBrightness attenuation = blockDescMgr.LightAttenuation(id);
 
         BlockBrightness propagated = Max(emission, Max(maxNeighborLight - attenuation, directSkyLight));
 
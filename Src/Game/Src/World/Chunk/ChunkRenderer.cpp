@@ -1,4 +1,6 @@
-﻿#include <VRPG/Game/World/Chunk/ChunkRenderer.h>
+﻿#include <tuple>
+
+#include <VRPG/Game/World/Chunk/ChunkRenderer.h>
 
 VRPG_GAME_BEGIN
 
@@ -21,15 +23,26 @@ namespace
         return bbox;
     }
 
-    bool ShouldRender(const Vec3i &globalSectionPosition, const FrustumCuller &culler) noexcept
+    /**
+     * @brief section的排列顺序：同一区块中的section相邻，以便按区块划分连续的下标范围
+     */
+    bool SectionLess(const Vec3i &lhs, const Vec3i &rhs) noexcept
     {
-        return culler.IsVisible(GetSectionBoundingBox(globalSectionPosition));
+        ChunkPosition lhsChunk = DecomposeGlobalSectionByChunk(lhs).first;
+        ChunkPosition rhsChunk = DecomposeGlobalSectionByChunk(rhs).first;
+        if(!(lhsChunk == rhsChunk))
+        {
+            return lhsChunk < rhsChunk;
+        }
+        return std::make_tuple(lhs.x, lhs.z, lhs.y) < std::make_tuple(rhs.x, rhs.z, rhs.y);
     }
 
-    bool ShouldRender(const Vec3i &globalSectionPosition, const Camera &camera) noexcept
-    {
-        return camera.IsVisible(GetSectionBoundingBox(globalSectionPosition));
-    }
+    /**
+     * @brief 方块模型在竖直方向上可能超出方块本身的高度
+     *
+     * 低精度模型以LOD网格为单位生成，其上表面可能比原方块高出不足一个网格
+     */
+    constexpr int SECTION_HEIGHT_MARGIN = SectionLODCellSize(SECTION_LOD_LEVEL_COUNT - 1);
 }
 
 ChunkRenderer::ChunkRenderer()
@@ -38,11 +51,21 @@ ChunkRenderer::ChunkRenderer()
     modelSets_.resize(blockEffectCount);
 }
 
-void ChunkRenderer::AddPartialSectionModel(std::shared_ptr<const PartialSectionModel> model)
+void ChunkRenderer::AddPartialSectionModel(std::shared_ptr<const PartialSectionModel> model, bool isCameraReachable)
 {
     const BlockEffect *effect = model->GetBlockEffect();
+    if(!isCameraReachable && effect->IsTransparent())
+    {
+        return;
+    }
+
     BlockEffectID effectID = effect->GetBlockEffectID();
-    modelSets_[effectID].push_back(std::move(model));
+    modelSets_[effectID].push_back({ std::move(model), 0, isCameraReachable });
+}
+
+void ChunkRenderer::SetChunkMaxHeight(const ChunkPosition &position, int maxHeight)
+{
+    chunkMaxHeights_[position] = maxHeight;
 }
 
 void ChunkRenderer::Done()
@@ -55,7 +78,7 @@ void ChunkRenderer::Done()
             continue;
         }
 
-        if(!modelSet.front()->GetBlockEffect()->IsTransparent())
+        if(!modelSet.front().model->GetBlockEffect()->IsTransparent())
         {
             newSolidModelSets.push_back(std::move(modelSet));
         }
@@ -65,6 +88,123 @@ void ChunkRenderer::Done()
         }
     }
     modelSets_.swap(newSolidModelSets);
+    transparentSortedEyeBlock_.reset();
+
+    // 收集所有出现过的section，按区块分组
+
+    std::vector<Vec3i> sections;
+    auto collectSections = [&](const ChunkModelSet &modelSet)
+    {
+        for(auto &record : modelSet)
+        {
+            sections.push_back(record.model->GetGlobalSectionPosition());
+        }
+    };
+    for(auto &modelSet : modelSets_)
+    {
+        collectSections(modelSet);
+    }
+    collectSections(transparentModelSet_);
+
+    std::sort(sections.begin(), sections.end(), SectionLess);
+    sections.erase(std::unique(sections.begin(), sections.end()), sections.end());
+
+    // 为每个section计算包围盒，并合并为区块的包围盒
+
+    chunkColumns_.clear();
+    sectionBoundingBoxes_.Clear();
+
+    std::optional<ChunkPosition> lastChunk;
+    for(auto &section : sections)
+    {
+        ChunkPosition chunk = DecomposeGlobalSectionByChunk(section).first;
+
+        CullingBoundingBox bbox = GetSectionBoundingBox(section);
+        if(auto it = chunkMaxHeights_.find(chunk); it != chunkMaxHeights_.end())
+        {
+            float maxY = float(it->second + 1 + SECTION_HEIGHT_MARGIN);
+            bbox.high.y = (std::max)(bbox.low.y, (std::min)(bbox.high.y, maxY));
+        }
+
+        uint32_t sectionIndex = uint32_t(sectionBoundingBoxes_.GetSize());
+        sectionBoundingBoxes_.Add(bbox);
+
+        if(!lastChunk || !(*lastChunk == chunk))
+        {
+            chunkColumns_.push_back({ bbox, sectionIndex, sectionIndex });
+            lastChunk = chunk;
+        }
+
+        auto &column = chunkColumns_.back();
+        column.boundingBox.low.y  = (std::min)(column.boundingBox.low.y, bbox.low.y);
+        column.boundingBox.high.y = (std::max)(column.boundingBox.high.y, bbox.high.y);
+        column.boundingBox.low.x  = (std::min)(column.boundingBox.low.x, bbox.low.x);
+        column.boundingBox.high.x = (std::max)(column.boundingBox.high.x, bbox.high.x);
+        column.boundingBox.low.z  = (std::min)(column.boundingBox.low.z, bbox.low.z);
+        column.boundingBox.high.z = (std::max)(column.boundingBox.high.z, bbox.high.z);
+        column.endSection = sectionIndex + 1;
+    }
+
+    auto assignSectionIndices = [&](ChunkModelSet &modelSet)
+    {
+        for(auto &record : modelSet)
+        {
+            auto it = std::lower_bound(
+                sections.begin(), sections.end(), record.model->GetGlobalSectionPosition(), SectionLess);
+            assert(it != sections.end());
+            record.sectionIndex = uint32_t(it - sections.begin());
+        }
+    };
+    for(auto &modelSet : modelSets_)
+    {
+        assignSectionIndices(modelSet);
+    }
+    assignSectionIndices(transparentModelSet_);
+
+    // 一个section只要有一个模型被标记为视线可达，整个section就是可达的
+
+    reachableSections_.assign((sections.size() + 63) / 64, 0);
+    auto markReachableSections = [&](const ChunkModelSet &modelSet)
+    {
+        for(auto &record : modelSet)
+        {
+            if(record.isCameraReachable)
+            {
+                reachableSections_[record.sectionIndex / 64] |= uint64_t(1) << (record.sectionIndex % 64);
+            }
+        }
+    };
+    for(auto &modelSet : modelSets_)
+    {
+        markReachableSections(modelSet);
+    }
+    markReachableSections(transparentModelSet_);
+
+    chunkMaxHeights_.clear();
+    cameraVisibility_.clear();
+
+    for(auto &casterSet : shadowCasterSets_)
+    {
+        casterSet = ShadowCasterSet();
+    }
+}
+
+void ChunkRenderer::UpdateCameraVisibility(const Camera &camera)
+{
+    ComputeVisibility(FrustumCuller(camera.GetViewProjectionMatrix()), cameraVisibility_);
+    cameraVisibilityStatistics_.frustumSectionCount = CountVisibleSections(cameraVisibility_);
+
+    assert(cameraVisibility_.size() == reachableSections_.size());
+    for(size_t i = 0; i < cameraVisibility_.size(); ++i)
+    {
+        cameraVisibility_[i] &= reachableSections_[i];
+    }
+    cameraVisibilityStatistics_.visibleSectionCount = CountVisibleSections(cameraVisibility_);
+}
+
+ChunkRenderer::CameraVisibilityStatistics ChunkRenderer::GetCameraVisibilityStatistics() const noexcept
+{
+    return cameraVisibilityStatistics_;
 }
 
 void ChunkRenderer::RenderForwardOpaque(const ForwardRenderParams &params) const
@@ -76,14 +216,14 @@ void ChunkRenderer::RenderForwardOpaque(const ForwardRenderParams &params) const
             continue;
         }
 
-        auto effect = chunkModelSet.front()->GetBlockEffect();
+        auto effect = chunkModelSet.front().model->GetBlockEffect();
         effect->SetForwardRenderParams(params);
         effect->StartForward();
-        for(auto &chunkModel : chunkModelSet)
+        for(auto &record : chunkModelSet)
         {
-            if(ShouldRender(chunkModel->GetGlobalSectionPosition(), *params.camera))
+            if(IsVisible(cameraVisibility_, record.sectionIndex))
             {
-                chunkModel->Render(*params.camera);
+                record.model->Render(*params.camera);
             }
         }
         effect->EndForward();
@@ -95,32 +235,32 @@ void ChunkRenderer::RenderForwardTransparent(const ForwardRenderParams &params)
     if(!transparentModelSet_.empty())
     {
         Vec3 cameraPosition = params.camera->GetPosition();
-        std::sort(transparentModelSet_.begin(), transparentModelSet_.end(),
-            [eye = cameraPosition](auto &lhs, auto &rhs)
-        {
-            Vec3i lSec = lhs->GetGlobalSectionPosition();
-            Vec3i rSec = rhs->GetGlobalSectionPosition();
-            Vec3 lCen = {
-                CHUNK_SECTION_SIZE_X * lSec.x + 0.5f * CHUNK_SECTION_SIZE_X,
-                CHUNK_SECTION_SIZE_Y * lSec.y + 0.5f * CHUNK_SECTION_SIZE_Y,
-                CHUNK_SECTION_SIZE_Z * lSec.z + 0.5f * CHUNK_SECTION_SIZE_Z
-            };
-            Vec3 rCen = {
-                CHUNK_SECTION_SIZE_X * rSec.x + 0.5f * CHUNK_SECTION_SIZE_X,
-                CHUNK_SECTION_SIZE_Y * rSec.y + 0.5f * CHUNK_SECTION_SIZE_Y,
-                CHUNK_SECTION_SIZE_Z * rSec.z + 0.5f * CHUNK_SECTION_SIZE_Z
-            };
-            return (lCen - eye).length_square() > (rCen - eye).length_square();
-        });
-
-        auto effect = transparentModelSet_.front()->GetBlockEffect();
+        Vec3i eyeBlock = cameraPosition.map([](float f) { return int(std::floor(f)); });
+        if(transparentSortedEyeBlock_ != eyeBlock)
+        {
+            transparentSortKeys_.resize(transparentModelSet_.size());
+            for(size_t i = 0; i < transparentModelSet_.size(); ++i)
+            {
+                Vec3i sec = transparentModelSet_[i].model->GetGlobalSectionPosition();
+                Vec3 centre = {
+                    CHUNK_SECTION_SIZE_X * sec.x + 0.5f * CHUNK_SECTION_SIZE_X,
+                    CHUNK_SECTION_SIZE_Y * sec.y + 0.5f * CHUNK_SECTION_SIZE_Y,
+                    CHUNK_SECTION_SIZE_Z * sec.z + 0.5f * CHUNK_SECTION_SIZE_Z
+                };
+                transparentSortKeys_[i] = BackToFrontSortKey((centre - cameraPosition).length_square());
+            }
+            transparentSorter_.RadixSort(transparentModelSet_, transparentSortKeys_);
+            transparentSortedEyeBlock_ = eyeBlock;
+        }
+
+        auto effect = transparentModelSet_.front().model->GetBlockEffect();
         effect->SetForwardRenderParams(params);
         effect->StartForward();
-        for(auto &model : transparentModelSet_)
+        for(auto &record : transparentModelSet_)
         {
-            if(ShouldRender(model->GetGlobalSectionPosition(), *params.camera))
+            if(IsVisible(cameraVisibility_, record.sectionIndex))
             {
-                model->Render(*params.camera);
+                record.model->Render(*params.camera);
             }
         }
         effect->EndForward();
@@ -129,36 +269,112 @@ void ChunkRenderer::RenderForwardTransparent(const ForwardRenderParams &params)
 
 void ChunkRenderer::RenderShadow(const ShadowRenderParams &params) const
 {
-    FrustumCuller culler(params.shadowViewProj);
+    UpdateShadowCasters(params);
 
-    for(auto &chunkModelSet : modelSets_)
+    auto &casterSet = shadowCasterSets_[params.cascadeIndex];
+    for(size_t i = 0; i < modelSets_.size(); ++i)
     {
-        if(chunkModelSet.empty())
+        auto &casters = casterSet.casters[i];
+        if(casters.empty())
         {
             continue;
         }
 
-        auto effect = chunkModelSet.front()->GetBlockEffect();
+        auto effect = casters.front()->GetBlockEffect();
         effect->SetShadowRenderParams(params);
         effect->StartShadow();
-        for(auto &chunkModel : chunkModelSet)
+        for(auto caster : casters)
         {
-            if(ShouldRender(chunkModel->GetGlobalSectionPosition(), culler))
+            caster->RenderShadow();
+        }
+        effect->EndShadow();
+    }
+}
+
+void ChunkRenderer::UpdateShadowCasters(const ShadowRenderParams &params) const
+{
+    assert(0 <= params.cascadeIndex && params.cascadeIndex < SHADOW_CASCADE_COUNT);
+    auto &casterSet = shadowCasterSets_[params.cascadeIndex];
+
+    if(casterSet.isValid && params.casterCullingRevision &&
+       casterSet.cullingRevision == params.casterCullingRevision)
+    {
+        return;
+    }
+
+    ComputeVisibility(FrustumCuller(params.casterCullingViewProj), shadowVisibility_);
+
+    casterSet.casters.resize(modelSets_.size());
+    for(size_t i = 0; i < modelSets_.size(); ++i)
+    {
+        auto &casters = casterSet.casters[i];
+        casters.clear();
+        for(auto &record : modelSets_[i])
+        {
+            if(IsVisible(shadowVisibility_, record.sectionIndex))
             {
-                chunkModel->RenderShadow();
+                casters.push_back(record.model.get());
             }
         }
-        effect->EndShadow();
     }
+
+    casterSet.isValid         = true;
+    casterSet.cullingRevision = params.casterCullingRevision;
 }
 
 void ChunkRenderer::Clear()
 {
     modelSets_.clear();
     transparentModelSet_.clear();
+    transparentSortedEyeBlock_.reset();
+
+    chunkMaxHeights_.clear();
+    chunkColumns_.clear();
+    sectionBoundingBoxes_.Clear();
+    reachableSections_.clear();
+    cameraVisibility_.clear();
+    cameraVisibilityStatistics_ = CameraVisibilityStatistics();
+
+    for(auto &casterSet : shadowCasterSets_)
+    {
+        casterSet = ShadowCasterSet();
+    }
 
     size_t blockEffectCount = BlockEffectManager::GetInstance().GetBlockEffectCount();
     modelSets_.resize(blockEffectCount);
 }
 
+void ChunkRenderer::ComputeVisibility(const FrustumCuller &culler, std::vector<uint64_t> &visibility) const
+{
+    // 先以区块为单位剔除，再对可见区块中的section进行批量测试
+
+    visibility.assign((sectionBoundingBoxes_.GetSize() + 63) / 64, 0);
+    for(auto &column : chunkColumns_)
+    {
+        if(culler.IsVisible(column.boundingBox))
+        {
+            culler.ComputeVisibility(sectionBoundingBoxes_, column.firstSection, column.endSection, visibility.data());
+        }
+    }
+}
+
+bool ChunkRenderer::IsVisible(const std::vector<uint64_t> &visibility, uint32_t sectionIndex) noexcept
+{
+    size_t word = sectionIndex / 64;
+    return word < visibility.size() && (visibility[word] & (uint64_t(1) << (sectionIndex % 64)));
+}
+
+int ChunkRenderer::CountVisibleSections(const std::vector<uint64_t> &visibility) noexcept
+{
+    int ret = 0;
+    for(uint64_t word : visibility)
+    {
+        for(; word; word &= word - 1)
+        {
+            ++ret;
+        }
+    }
+    return ret;
+}
+
 VRPG_GAME_END
@@ -0,0 +1,95 @@
+﻿#include <VRPG/Game/World/Chunk/SectionModelCache.h>
+
+VRPG_GAME_BEGIN
+
+void SectionModelCache::SetCapacity(size_t capacity)
+{
+    std::lock_guard lk(mutex_);
+    capacity_ = capacity;
+    EvictUntil(capacity_);
+}
+
+std::unique_ptr<SectionModel> SectionModelCache::Find(const SectionContentHash &contentHash, const Vec3i &globalSectionPosition)
+{
+    std::lock_guard lk(mutex_);
+
+    auto it = hash2Entry_.find(contentHash.key);
+    if(it == hash2Entry_.end() || it->second->contentHash.check != contentHash.check)
+    {
+        ++statistics_.missCount;
+        return nullptr;
+    }
+
+    auto entryIt = it->second;
+    auto ret = std::make_unique<SectionModel>(entryIt->model);
+
+    if(entryIt->globalSectionPosition != globalSectionPosition)
+    {
+        for(auto &partialModel : ret->partialModels)
+        {
+            partialModel = partialModel->CloneAt(globalSectionPosition);
+            if(!partialModel)
+            {
+                ++statistics_.missCount;
+                return nullptr;
+            }
+        }
+    }
+
+    entries_.splice(entries_.begin(), entries_, entryIt);
+    ++statistics_.hitCount;
+    return ret;
+}
+
+void SectionModelCache::Insert(const SectionContentHash &contentHash, const Vec3i &globalSectionPosition, const SectionModel &model)
+{
+    std::lock_guard lk(mutex_);
+
+    if(!capacity_)
+    {
+        return;
+    }
+
+    if(auto it = hash2Entry_.find(contentHash.key); it != hash2Entry_.end())
+    {
+        statistics_.memoryUsage -= it->second->memoryUsage;
+        entries_.erase(it->second);
+        hash2Entry_.erase(it);
+    }
+
+    EvictUntil(capacity_ - 1);
+
+    Entry entry;
+    entry.contentHash           = contentHash;
+    entry.globalSectionPosition = globalSectionPosition;
+    entry.model                 = model;
+    for(auto &partialModel : model.partialModels)
+    {
+        entry.memoryUsage += partialModel->GetMemoryUsage();
+    }
+
+    statistics_.memoryUsage += entry.memoryUsage;
+    entries_.push_front(std::move(entry));
+    hash2Entry_[contentHash.key] = entries_.begin();
+}
+
+SectionModelCache::Statistics SectionModelCache::GetStatistics() const
+{
+    std::lock_guard lk(mutex_);
+    Statistics ret = statistics_;
+    ret.entryCount = entries_.size();
+    return ret;
+}
+
+void SectionModelCache::EvictUntil(size_t maxEntryCount)
+{
+    while(entries_.size() > maxEntryCount)
+    {
+        auto &entry = entries_.back();
+        statistics_.memoryUsage -= entry.memoryUsage;
+        hash2Entry_.erase(entry.contentHash.key);
+        entries_.pop_back();
+    }
+}
+
+VRPG_GAME_END
@@ -0,0 +1,445 @@
+﻿#include <VRPG/Game/Misc/BoxModel.h>
+#include <VRPG/Game/World/Block/BlockEffect.h>
+#include <VRPG/Game/World/Chunk/SectionScratchVolume.h>
+
+VRPG_GAME_BEGIN
+
+namespace
+{
+    /**
+     * @brief 对方块种类的多数表决，平票时先出现者胜出
+     */
+    class BlockVote
+    {
+        static constexpr int MAX_CELL_SIZE = SectionLODCellSize(SECTION_LOD_LEVEL_COUNT - 1);
+
+        BlockID ids_[MAX_CELL_SIZE * MAX_CELL_SIZE * MAX_CELL_SIZE];
+        int counts_[MAX_CELL_SIZE * MAX_CELL_SIZE * MAX_CELL_SIZE];
+        int kindCount_ = 0;
+        int totalCount_ = 0;
+
+    public:
+
+        void Add(BlockID id) noexcept
+        {
+            ++totalCount_;
+            for(int i = 0; i < kindCount_; ++i)
+            {
+                if(ids_[i] == id)
+                {
+                    ++counts_[i];
+                    return;
+                }
+            }
+            ids_[kindCount_] = id;
+            counts_[kindCount_] = 1;
+            ++kindCount_;
+        }
+
+        int GetTotalCount() const noexcept
+        {
+            return totalCount_;
+        }
+
+        BlockID GetWinner() const noexcept
+        {
+            int winner = 0;
+            for(int i = 1; i < kindCount_; ++i)
+            {
+                if(counts_[i] > counts_[winner])
+                {
+                    winner = i;
+                }
+            }
+            return kindCount_ ? ids_[winner] : BLOCK_ID_VOID;
+        }
+    };
+}
+
+SectionScratchVolume::SectionScratchVolume()
+    : blocks_(CHUNK_SECTION_PADDED_SIZE_X * CHUNK_SECTION_PADDED_SIZE_Y * CHUNK_SECTION_PADDED_SIZE_Z),
+      extraData_(CHUNK_SECTION_PADDED_SIZE_X * CHUNK_SECTION_PADDED_SIZE_Y * CHUNK_SECTION_PADDED_SIZE_Z)
+{
+    
+}
+
+void SectionScratchVolume::Fill(const Vec3i &sectionInChunk, const Chunk *neighboringChunks[3][3])
+{
+    auto &blockDescMgr = BlockDescManager::GetInstance();
+
+    const CompactBlockInstance VOID_BLOCK = { BLOCK_ID_VOID, BlockOrientation(), BLOCK_BRIGHTNESS_MIN };
+
+    Vec3i lowBlockInChunk = sectionInChunk * Vec3i(CHUNK_SECTION_SIZE_X, CHUNK_SECTION_SIZE_Y, CHUNK_SECTION_SIZE_Z);
+
+    // 按列拷贝，每一列只需确定一次所属的chunk
+
+    for(int x = -1; x <= CHUNK_SECTION_SIZE_X; ++x)
+    {
+        int xInChunk = lowBlockInChunk.x + x;
+        int chunkX = xInChunk < 0 ? 0 : (xInChunk >= CHUNK_SIZE_X ? 2 : 1);
+        xInChunk -= (chunkX - 1) * CHUNK_SIZE_X;
+
+        for(int z = -1; z <= CHUNK_SECTION_SIZE_Z; ++z)
+        {
+            int zInChunk = lowBlockInChunk.z + z;
+            int chunkZ = zInChunk < 0 ? 0 : (zInChunk >= CHUNK_SIZE_Z ? 2 : 1);
+            zInChunk -= (chunkZ - 1) * CHUNK_SIZE_Z;
+
+            const Chunk *chunk = neighboringChunks[chunkX][chunkZ];
+
+            static_assert(BlockNeighborhood::STRIDE_Y == 1);
+            const int columnIndex = Index({ x, -1, z });
+            CompactBlockInstance *column = &blocks_[columnIndex];
+            uint32_t &solidMask = solidMask_[x + 1][z + 1];
+            solidMask = 0;
+
+            for(int y = -1; y <= CHUNK_SECTION_SIZE_Y; ++y)
+            {
+                int yInChunk = lowBlockInChunk.y + y;
+                if(yInChunk < 0 || yInChunk >= CHUNK_SIZE_Y)
+                {
+                    column[y + 1] = VOID_BLOCK;
+                }
+                else
+                {
+                    const Vec3i blockInChunk = { xInChunk, yInChunk, zInChunk };
+                    const BlockID id = chunk->GetID(blockInChunk);
+                    column[y + 1] = { id, chunk->GetOrientation(blockInChunk), chunk->GetBrightness(blockInChunk) };
+
+                    if(blockDescMgr.IsSolidBox(id))
+                    {
+                        solidMask |= 1u << (y + 1);
+                    }
+                    if(blockDescMgr.HasExtraData(id))
+                    {
+                        extraData_[columnIndex + y + 1] = chunk->GetExtraData(blockInChunk);
+                    }
+                }
+            }
+        }
+    }
+
+    ComputeExposedMasks();
+}
+
+void SectionScratchVolume::AddLODModel(ModelBuilderSet &modelBuilders, const Vec3i &globalSectionPosition, int cellSize)
+{
+    assert(1 < cellSize && cellSize <= SectionLODCellSize(SECTION_LOD_LEVEL_COUNT - 1));
+
+    auto &blockDescMgr = BlockDescManager::GetInstance();
+    auto &faceTemplates = BoxFaceTemplateTable::GetInstance();
+
+    const Vec3i cellCount = {
+        CHUNK_SECTION_SIZE_X / cellSize,
+        CHUNK_SECTION_SIZE_Y / cellSize,
+        CHUNK_SECTION_SIZE_Z / cellSize
+    };
+    auto cellIndex = [&](const Vec3i &cell)
+    {
+        return (cell.x * cellCount.z + cell.z) * cellCount.y + cell.y;
+    };
+
+    // 对每个格子进行多数表决
+
+    lodCells_.resize(cellCount.x * cellCount.y * cellCount.z);
+    for(int cx = 0; cx < cellCount.x; ++cx)
+    {
+        for(int cz = 0; cz < cellCount.z; ++cz)
+        {
+            for(int cy = 0; cy < cellCount.y; ++cy)
+            {
+                BlockVote vote;
+                for(int x = cx * cellSize; x < (cx + 1) * cellSize; ++x)
+                {
+                    for(int z = cz * cellSize; z < (cz + 1) * cellSize; ++z)
+                    {
+                        for(int y = cy * cellSize; y < (cy + 1) * cellSize; ++y)
+                        {
+                            BlockID id = GetBlock({ x, y, z }).id;
+                            if(blockDescMgr.HasLODModel(id))
+                            {
+                                vote.Add(id);
+                            }
+                        }
+                    }
+                }
+
+                bool isFilled = 2 * vote.GetTotalCount() >= cellSize * cellSize * cellSize;
+                lodCells_[cellIndex({ cx, cy, cz })] = isFilled ? vote.GetWinner() : BLOCK_ID_VOID;
+            }
+        }
+    }
+
+    // 生成每个格子的六个面
+
+    const Vec3i sectionBase = globalSectionPosition * Vec3i(CHUNK_SECTION_SIZE_X, CHUNK_SECTION_SIZE_Y, CHUNK_SECTION_SIZE_Z);
+
+    for(int cx = 0; cx < cellCount.x; ++cx)
+    {
+        for(int cz = 0; cz < cellCount.z; ++cz)
+        {
+            for(int cy = 0; cy < cellCount.y; ++cy)
+            {
+                const Vec3i cell = { cx, cy, cz };
+                const BlockID cellID = lodCells_[cellIndex(cell)];
+                const Vec3i cellBase = cell * Vec3i(cellSize);
+
+                for(int d = 0; d < 6; ++d)
+                {
+                    Direction dir = Direction(d);
+                    Vec3i neiCell = cell + DirectionToVectori(dir);
+                    bool isOnBoundary = neiCell.x < 0 || neiCell.x >= cellCount.x ||
+                                        neiCell.y < 0 || neiCell.y >= cellCount.y ||
+                                        neiCell.z < 0 || neiCell.z >= cellCount.z;
+
+                    if(!isOnBoundary)
+                    {
+                        if(cellID == BLOCK_ID_VOID)
+                        {
+                            continue;
+                        }
+                        BlockID neiID = lodCells_[cellIndex(neiCell)];
+                        if(neiID != BLOCK_ID_VOID && (blockDescMgr.IsFullOpaque(neiID) || neiID == cellID))
+                        {
+                            continue;
+                        }
+                    }
+
+                    // 遍历格子在dir方向上最外侧的一层方块及与之相邻的外侧方块
+                    // 面片亮度取外侧方块亮度的最大值
+
+                    int normalAxis = d / 2;
+                    int sideAxis0 = (normalAxis + 1) % 3;
+                    int sideAxis1 = (normalAxis + 2) % 3;
+
+                    Vec3i inner;
+                    inner[normalAxis] = cellBase[normalAxis] + (IsPositive(dir) ? cellSize - 1 : 0);
+
+                    BlockVote exposedVote;
+                    bool isExposed = false;
+                    BlockBrightness brightness = BLOCK_BRIGHTNESS_MIN;
+
+                    for(int u = 0; u < cellSize; ++u)
+                    {
+                        for(int v = 0; v < cellSize; ++v)
+                        {
+                            inner[sideAxis0] = cellBase[sideAxis0] + u;
+                            inner[sideAxis1] = cellBase[sideAxis1] + v;
+
+                            const CompactBlockInstance &outer = GetBlock(inner + DirectionToVectori(dir));
+                            brightness = Max(brightness, outer.brightness);
+
+                            if(!isOnBoundary || blockDescMgr.IsFullOpaque(outer.id))
+                            {
+                                continue;
+                            }
+
+                            isExposed = true;
+                            BlockID innerID = GetBlock(inner).id;
+                            if(blockDescMgr.HasLODModel(innerID))
+                            {
+                                exposedVote.Add(innerID);
+                            }
+                        }
+                    }
+
+                    // section边界上的面片：格子非空时只需边界处有暴露的方块，
+                    // 格子为空时以边界上暴露在外的支持LOD的方块作为裙边，填补相邻section的面片被剔除后留下的空隙
+
+                    BlockID faceID = cellID;
+                    if(isOnBoundary)
+                    {
+                        if(!isExposed)
+                        {
+                            continue;
+                        }
+                        if(faceID == BLOCK_ID_VOID)
+                        {
+                            faceID = exposedVote.GetWinner();
+                        }
+                        if(faceID == BLOCK_ID_VOID)
+                        {
+                            continue;
+                        }
+                    }
+
+                    const BoxFaceTemplate &face = faceTemplates.GetTemplate(BlockOrientation(), dir);
+                    Vec3 position[4];
+                    for(int i = 0; i < 4; ++i)
+                    {
+                        position[i] = (sectionBase + cellBase).map([](int c) { return float(c); })
+                                    + float(cellSize) * face.position[i];
+                    }
+
+                    blockDescMgr.GetBlockDescription(faceID)->AddLODBoxFace(
+                        modelBuilders, dir, position, ComputeVertexBrightness(brightness), cellSize);
+                }
+            }
+        }
+    }
+}
+
+std::optional<SectionContentHash> SectionScratchVolume::ComputeContentHash(int lodLevel) const noexcept
+{
+    auto &blockDescMgr = BlockDescManager::GetInstance();
+
+    // splitmix64的混合函数
+    auto mix = [](uint64_t x)
+    {
+        x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27; x *= 0x94d049bb133111ebull;
+        x ^= x >> 31;
+        return x;
+    };
+
+    // 校验用的哈希以MurmurHash3的fmix64混合每个输入，并以旋转和乘法累积，与上面的链式哈希相互独立
+    auto fmix = [](uint64_t x)
+    {
+        x ^= x >> 33; x *= 0xff51afd7ed558ccdull;
+        x ^= x >> 33; x *= 0xc4ceb9fe1a85ec53ull;
+        x ^= x >> 33;
+        return x;
+    };
+    auto rotl = [](uint64_t x, int r)
+    {
+        return (x << r) | (x >> (64 - r));
+    };
+
+    uint64_t hash = mix(uint64_t(lodLevel) + 0x9e3779b97f4a7c15ull);
+    uint64_t check = fmix(uint64_t(lodLevel) ^ 0x6a09e667f3bcc909ull);
+    for(auto &block : blocks_)
+    {
+        BlockID id = block.id;
+        if(blockDescMgr.HasExtraData(id))
+        {
+            return std::nullopt;
+        }
+
+        uint64_t word = uint64_t(id)
+                      | uint64_t(block.orientation.GetRawValue()) << 16
+                      | uint64_t(block.brightness.r) << 24
+                      | uint64_t(block.brightness.g) << 32
+                      | uint64_t(block.brightness.b) << 40
+                      | uint64_t(block.brightness.s) << 48;
+        hash = mix(hash ^ word) + 0x9e3779b97f4a7c15ull;
+        check = rotl(check ^ fmix(word), 27) * 0x9fb21c651e98df25ull;
+    }
+    return SectionContentHash{ hash, check };
+}
+
+SectionConnectivity SectionScratchVolume::ComputeConnectivity()
+{
+    auto &blockDescMgr = BlockDescManager::GetInstance();
+
+    auto isOpen = [&](const Vec3i &blockInSection)
+    {
+        return !blockDescMgr.IsFullOpaque(GetBlock(blockInSection).id);
+    };
+
+    auto localIndex = [](const Vec3i &blockInSection)
+    {
+        return (blockInSection.x * CHUNK_SECTION_SIZE_Z + blockInSection.z) * CHUNK_SECTION_SIZE_Y + blockInSection.y;
+    };
+
+    floodVisited_.assign(CHUNK_SECTION_SIZE_X * CHUNK_SECTION_SIZE_Y * CHUNK_SECTION_SIZE_Z, 0);
+
+    // 对每个由非完全遮光方块构成的连通区域，它接触到的面之间两两连通
+
+    SectionConnectivity ret;
+    for(int x = 0; x < CHUNK_SECTION_SIZE_X; ++x)
+    {
+        for(int z = 0; z < CHUNK_SECTION_SIZE_Z; ++z)
+        {
+            for(int y = 0; y < CHUNK_SECTION_SIZE_Y; ++y)
+            {
+                if(floodVisited_[localIndex({ x, y, z })] || !isOpen({ x, y, z }))
+                {
+                    continue;
+                }
+
+                uint8_t touchedFaces = 0;
+                floodVisited_[localIndex({ x, y, z })] = 1;
+                floodStack_.push_back({ x, y, z });
+
+                while(!floodStack_.empty())
+                {
+                    Vec3i pos = floodStack_.back();
+                    floodStack_.pop_back();
+
+                    if(pos.x == 0)                        touchedFaces |= 1 << NegativeX;
+                    if(pos.x == CHUNK_SECTION_SIZE_X - 1) touchedFaces |= 1 << PositiveX;
+                    if(pos.y == 0)                        touchedFaces |= 1 << NegativeY;
+                    if(pos.y == CHUNK_SECTION_SIZE_Y - 1) touchedFaces |= 1 << PositiveY;
+                    if(pos.z == 0)                        touchedFaces |= 1 << NegativeZ;
+                    if(pos.z == CHUNK_SECTION_SIZE_Z - 1) touchedFaces |= 1 << PositiveZ;
+
+                    for(int dir = 0; dir < 6; ++dir)
+                    {
+                        Vec3i nei = pos + DirectionToVectori(Direction(dir));
+                        if(nei.x < 0 || nei.x >= CHUNK_SECTION_SIZE_X ||
+                           nei.y < 0 || nei.y >= CHUNK_SECTION_SIZE_Y ||
+                           nei.z < 0 || nei.z >= CHUNK_SECTION_SIZE_Z)
+                        {
+                            continue;
+                        }
+
+                        int neiIndex = localIndex(nei);
+                        if(!floodVisited_[neiIndex] && isOpen(nei))
+                        {
+                            floodVisited_[neiIndex] = 1;
+                            floodStack_.push_back(nei);
+                        }
+                    }
+                }
+
+                for(int a = 0; a < 6; ++a)
+                {
+                    for(int b = a + 1; b < 6; ++b)
+                    {
+                        if((touchedFaces & (1 << a)) && (touchedFaces & (1 << b)))
+                        {
+                            ret.Connect(Direction(a), Direction(b));
+                        }
+                    }
+                }
+
+                if(ret.IsAllConnected())
+                {
+                    return ret;
+                }
+            }
+        }
+    }
+
+    return ret;
+}
+
+void SectionScratchVolume::ComputeExposedMasks() noexcept
+{
+    constexpr uint32_t SECTION_BITS = ((1u << CHUNK_SECTION_SIZE_Y) - 1) << 1;
+
+    for(int x = 0; x < CHUNK_SECTION_SIZE_X; ++x)
+    {
+        for(int z = 0; z < CHUNK_SECTION_SIZE_Z; ++z)
+        {
+            uint32_t centre = solidMask_[x + 1][z + 1];
+
+            // 实体方块在某方向上的面可见，当且仅当该方向上的邻居不是实体方块
+
+            uint32_t visiblePosX = centre & ~solidMask_[x + 2][z + 1];
+            uint32_t visibleNegX = centre & ~solidMask_[x][z + 1];
+            uint32_t visiblePosY = centre & ~(centre >> 1);
+            uint32_t visibleNegY = centre & ~(centre << 1);
+            uint32_t visiblePosZ = centre & ~solidMask_[x + 1][z + 2];
+            uint32_t visibleNegZ = centre & ~solidMask_[x + 1][z];
+
+            uint32_t buried = centre & ~(visiblePosX | visibleNegX |
+                                         visiblePosY | visibleNegY |
+                                         visiblePosZ | visibleNegZ);
+
+            exposedMask_[x][z] = (~buried & SECTION_BITS) >> 1;
+        }
+    }
+}
+
+VRPG_GAME_END
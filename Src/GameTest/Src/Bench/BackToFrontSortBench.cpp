@@ -0,0 +1,118 @@
+﻿#include <random>
+
+#include <VRPG/Game/Misc/BackToFrontSorter.h>
+#include <VRPG/Game/World/Chunk/Common.h>
+
+#include <Common/TestCommon.h>
+
+/*
+ * 半透明面片排序性能测试：在一个section中随机放置面片，让摄像机每帧沿直线移动一格，
+ * 比较以浮点距离为比较函数的std::sort、BackToFrontSorter的基数排序，
+ * 以及透明section model实际使用的“先尝试插入排序，移动过多时退回基数排序”三种做法每秒能完成的排序次数
+ */
+
+using namespace VRPG::Test;
+
+namespace
+{
+    constexpr int FACE_COUNT = 4096;
+
+    constexpr int FRAME_COUNT = 2000;
+
+    struct Face
+    {
+        Vec3 position;
+        uint32_t startIndex = 0;
+    };
+
+    std::vector<Face> GenerateFaces(std::mt19937 &rng)
+    {
+        std::uniform_real_distribution<float> posDist(0, float(CHUNK_SECTION_SIZE_X));
+        std::vector<Face> faces(FACE_COUNT);
+        for(int i = 0; i < FACE_COUNT; ++i)
+        {
+            faces[i].position   = Vec3(posDist(rng), posDist(rng), posDist(rng));
+            faces[i].startIndex = uint32_t(6 * i);
+        }
+        return faces;
+    }
+
+    Vec3 EyeAt(int frame) noexcept
+    {
+        // 摄像机在section外侧往返，每帧跨越一个方块
+        const int step = frame % 64;
+        const float x = step < 32 ? float(step) : float(64 - step);
+        return Vec3(x - 8.5f, 20.5f, -6.5f);
+    }
+
+    bool IsBackToFront(const std::vector<Face> &faces, const Vec3 &eye) noexcept
+    {
+        for(size_t i = 1; i < faces.size(); ++i)
+        {
+            if(BackToFrontSortKey((faces[i - 1].position - eye).length_square()) >
+               BackToFrontSortKey((faces[i].position - eye).length_square()))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template<typename Func>
+    void RunCase(const char *name, std::vector<Face> faces, Func &&sortFaces)
+    {
+        Timer timer;
+        for(int frame = 0; frame < FRAME_COUNT; ++frame)
+        {
+            sortFaces(faces, EyeAt(frame), frame);
+        }
+        const double seconds = timer.Seconds();
+
+        std::printf(
+            "%-20s %.1f us/sort, %s\n", name, 1e6 * seconds / FRAME_COUNT,
+            IsBackToFront(faces, EyeAt(FRAME_COUNT - 1)) ? "ordered" : "NOT ordered");
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(42);
+    const std::vector<Face> faces = GenerateFaces(rng);
+
+    std::printf("faces per section: %d\n", FACE_COUNT);
+
+    RunCase("std::sort:", faces, [](std::vector<Face> &faces, const Vec3 &eye, int)
+    {
+        std::sort(faces.begin(), faces.end(), [&](const Face &a, const Face &b)
+        {
+            return (a.position - eye).length_square() > (b.position - eye).length_square();
+        });
+    });
+
+    BackToFrontSorter<Face> sorter;
+    std::vector<uint16_t> keys(FACE_COUNT);
+    auto computeKeys = [&](const std::vector<Face> &faces, const Vec3 &eye)
+    {
+        for(size_t i = 0; i < faces.size(); ++i)
+        {
+            keys[i] = BackToFrontSortKey((faces[i].position - eye).length_square());
+        }
+    };
+
+    RunCase("radix sort:", faces, [&](std::vector<Face> &faces, const Vec3 &eye, int)
+    {
+        computeKeys(faces, eye);
+        sorter.RadixSort(faces, keys);
+    });
+
+    RunCase("insertion + radix:", faces, [&](std::vector<Face> &faces, const Vec3 &eye, int frame)
+    {
+        computeKeys(faces, eye);
+        if(!frame || !sorter.InsertionSort(faces, keys, 2 * faces.size()))
+        {
+            sorter.RadixSort(faces, keys);
+        }
+    });
+
+    return 0;
+}
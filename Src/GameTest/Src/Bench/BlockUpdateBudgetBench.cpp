@@ -0,0 +1,134 @@
+﻿#include <VRPG/Game/World/BlockUpdater/BlockUpdater.h>
+#include <VRPG/Game/World/Chunk/ChunkManager.h>
+#include <VRPG/Game/World/Land/FlatLandGenerator.h>
+
+#include <Common/GameEnvironment.h>
+
+/*
+ * 方块更新时间预算测试：每帧（16ms的模拟时间）产生固定数量的更新任务，并在开始时一次性加入大量任务，
+ * 每个任务忙等一段固定的时间。对不同的时间预算分别统计单次Execute的实际耗时、任务延迟、
+ * 等待中任务数的峰值，以及积压的任务被消化完所需的帧数
+ */
+
+using namespace VRPG::Test;
+
+namespace
+{
+    constexpr int LAND_HEIGHT = 20;
+
+    constexpr int FRAME_COUNT          = 240;
+    constexpr int BURST_UPDATER_COUNT  = 8192;
+    constexpr int STEADY_UPDATER_COUNT = 100;
+
+    constexpr StdClock::duration FRAME_INTERVAL = std::chrono::milliseconds(16);
+    constexpr StdClock::duration UPDATER_COST   = std::chrono::microseconds(20);
+
+    class BusyUpdater : public BlockUpdater
+    {
+    public:
+
+        void Execute(
+            BlockUpdaterManager &updaterManager, ChunkManager &chunkManager,
+            const Vec3i &blockPosition, StdClock::time_point now) override
+        {
+            // 以忙等模拟开销固定的更新逻辑
+            const auto end = StdClock::now() + UPDATER_COST;
+            while(StdClock::now() < end)
+            {
+                continue;
+            }
+        }
+    };
+
+    Vec3i UpdaterPosition(int index) noexcept
+    {
+        // 所有任务都位于被模拟的区块中
+        return { index % 64 - 32, LAND_HEIGHT + 1 + index / 4096, (index / 64) % 64 - 32 };
+    }
+
+    void RunCase(const char *name, ChunkManager &chunkManager, StdClock::duration timeBudget)
+    {
+        BlockUpdaterManager updaterManager(&chunkManager, 0);
+        const BlockUpdaterID updaterID = updaterManager.RegisterUpdater<BusyUpdater>()->GetUpdaterID();
+
+        StdClock::time_point now = StdClock::now();
+        for(int i = 0; i < BURST_UPDATER_COUNT; ++i)
+        {
+            updaterManager.AddUpdater(updaterID, UpdaterPosition(i), now);
+        }
+
+        double maxCallMS = 0, totalCallMS = 0;
+        double totalLateness = 0;
+        float maxLateness = 0;
+        int64_t executedCount = 0;
+        size_t peakPendingCount = updaterManager.GetPendingUpdaterCount();
+        int drainedFrame = -1;
+
+        int nextIndex = BURST_UPDATER_COUNT;
+        for(int frame = 0; frame < FRAME_COUNT; ++frame)
+        {
+            now += FRAME_INTERVAL;
+            for(int i = 0; i < STEADY_UPDATER_COUNT; ++i)
+            {
+                updaterManager.AddUpdater(updaterID, UpdaterPosition(nextIndex++ % (2 * 4096)), now);
+            }
+
+            Timer timer;
+            updaterManager.Execute(timeBudget, now);
+            const double callMS = timer.Milliseconds();
+            maxCallMS = (std::max)(maxCallMS, callMS);
+            totalCallMS += callMS;
+
+            auto statistics = updaterManager.GetStatistics();
+            executedCount += statistics.executedCount;
+            totalLateness += double(statistics.meanLateness) * statistics.executedCount;
+            maxLateness = (std::max)(maxLateness, statistics.maxLateness);
+            peakPendingCount = (std::max)(peakPendingCount, statistics.pendingCount);
+
+            if(drainedFrame < 0 && statistics.pendingCount == 0)
+            {
+                drainedFrame = frame;
+            }
+        }
+
+        std::printf(
+            "%-10s call: mean %.2f ms, max %.2f ms | lateness: mean %.1f ms, max %.1f ms | "
+            "peak queue %zu | drained at frame %d\n",
+            name, totalCallMS / FRAME_COUNT, maxCallMS,
+            executedCount ? totalLateness / executedCount : 0.0, maxLateness,
+            peakPendingCount, drainedFrame);
+    }
+}
+
+int main()
+{
+    GameEnvironment environment;
+
+    ChunkManagerParams chunkParams;
+    chunkParams.renderDistance     = 1;
+    chunkParams.loadDistance       = 3;
+    chunkParams.unloadDistance     = 4;
+    chunkParams.simulationDistance = 2;
+
+    ChunkManager chunkManager(chunkParams, std::make_unique<FlatLandGenerator>(LAND_HEIGHT));
+    chunkManager.SetCentreChunk({ 0, 0 });
+    for(int x = -chunkParams.loadDistance; x <= chunkParams.loadDistance; ++x)
+    {
+        for(int z = -chunkParams.loadDistance; z <= chunkParams.loadDistance; ++z)
+        {
+            chunkManager.GetBlockID({ x * CHUNK_SIZE_X, 0, z * CHUNK_SIZE_Z });
+        }
+    }
+
+    std::printf(
+        "burst: %d updates, steady: %d updates/frame, %lld us/update\n",
+        BURST_UPDATER_COUNT, STEADY_UPDATER_COUNT,
+        static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(UPDATER_COST).count()));
+
+    RunCase("1 ms", chunkManager, std::chrono::milliseconds(1));
+    RunCase("4 ms", chunkManager, std::chrono::milliseconds(4));
+    RunCase("8 ms", chunkManager, std::chrono::milliseconds(8));
+    RunCase("unbounded", chunkManager, std::chrono::hours(1));
+
+    return 0;
+}
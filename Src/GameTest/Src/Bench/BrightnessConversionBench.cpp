@@ -0,0 +1,161 @@
+﻿#include <cstring>
+#include <random>
+
+#include <VRPG/Game/World/Block/BlockBrightness.h>
+#include <VRPG/Game/World/Chunk/Chunk.h>
+#include <VRPG/Game/World/Chunk/SectionModelCache.h>
+
+#include <Common/GameEnvironment.h>
+
+/*
+ * 亮度转换性能测试：分别以查表与逐次调用std::pow（见BLOCK_BRIGHTNESS_TO_FLOAT_USE_POW）将方块亮度转换为浮点数，
+ * 一是对同一组随机分量比较每秒转换的分量数，并检查两者结果是否逐位相同；
+ * 二是对3x3个随机亮度的区块中中心区块的所有section生成模型（禁用模型缓存），比较每个section的平均耗时
+ */
+
+using namespace VRPG::Test;
+
+namespace
+{
+    constexpr int COMPONENT_COUNT = 1 << 20;
+
+    constexpr int COMPONENT_REPEAT_COUNT = 50;
+
+    constexpr int SOLID_HEIGHT = 20;
+    constexpr int MIXED_HEIGHT = 48;
+
+    constexpr int MESHING_REPEAT_COUNT = 10;
+
+    void ConvertComponents(
+        const char *name, bool usePow, const std::vector<uint8_t> &components, std::vector<float> &output)
+    {
+        BLOCK_BRIGHTNESS_TO_FLOAT_USE_POW = usePow;
+
+        Timer timer;
+        for(int i = 0; i < COMPONENT_REPEAT_COUNT; ++i)
+        {
+            for(size_t j = 0; j < components.size(); ++j)
+            {
+                output[j] = BlockBrightnessToFloat(components[j]);
+            }
+        }
+        const double seconds = timer.Seconds();
+
+        std::printf(
+            "%-12s %.1f M components/s\n",
+            name, COMPONENT_REPEAT_COUNT * double(components.size()) / seconds / 1e6);
+    }
+
+    void GenerateChunk(Chunk &chunk, std::mt19937 &rng)
+    {
+        const BlockID types[] = {
+            GameEnvironment::GetID(BuiltinBlockType::Stone),
+            GameEnvironment::GetID(BuiltinBlockType::Soil),
+            GameEnvironment::GetID(BuiltinBlockType::Leaf),
+            GameEnvironment::GetID(BuiltinBlockType::WhiteGlass)
+        };
+        const BlockID stone = types[0];
+
+        std::uniform_int_distribution<int> typeDist(0, int(std::size(types)) - 1);
+        std::uniform_int_distribution<int> lightDist(0, BLOCK_BRIGHTNESS_COMPONENT_LIMIT);
+        std::bernoulli_distribution isAirDist(0.5);
+
+        for(int x = 0; x < CHUNK_SIZE_X; ++x)
+        {
+            for(int z = 0; z < CHUNK_SIZE_Z; ++z)
+            {
+                for(int y = 0; y < CHUNK_SIZE_Y; ++y)
+                {
+                    const Vec3i blockInChunk = { x, y, z };
+                    if(y < SOLID_HEIGHT)
+                    {
+                        chunk.SetID(blockInChunk, stone, {});
+                        chunk.SetBrightness(blockInChunk, BLOCK_BRIGHTNESS_MIN);
+                        continue;
+                    }
+
+                    chunk.SetBrightness(blockInChunk, BlockBrightness{
+                        uint8_t(lightDist(rng)), uint8_t(lightDist(rng)), uint8_t(lightDist(rng)), uint8_t(lightDist(rng)) });
+
+                    if(y < MIXED_HEIGHT && !isAirDist(rng))
+                    {
+                        chunk.SetID(blockInChunk, types[typeDist(rng)], {});
+                    }
+                }
+            }
+        }
+    }
+}
+
+int main()
+{
+    // 分量的取值与光照传播结果一致，即[0, 20]，少量超出上限的值用于覆盖截断逻辑
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> componentDist(0, 24);
+    std::vector<uint8_t> components(COMPONENT_COUNT);
+    for(auto &c : components)
+    {
+        c = uint8_t(componentDist(rng));
+    }
+
+    std::vector<float> powOutput(COMPONENT_COUNT);
+    std::vector<float> lutOutput(COMPONENT_COUNT);
+
+    ConvertComponents("std::pow:", true, components, powOutput);
+    ConvertComponents("lookup table:", false, components, lutOutput);
+
+    const bool isIdentical = std::memcmp(powOutput.data(), lutOutput.data(), sizeof(float) * COMPONENT_COUNT) == 0;
+    std::printf("results %s\n", isIdentical ? "are bit-identical" : "differ");
+
+    // 完整的section模型生成
+
+    GameEnvironment environment;
+    SectionModelCache::GetInstance().SetCapacity(0);
+
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    const Chunk *neighboringChunks[3][3];
+    for(int x = 0; x < 3; ++x)
+    {
+        for(int z = 0; z < 3; ++z)
+        {
+            chunks.push_back(std::make_unique<Chunk>(ChunkPosition{ x - 1, z - 1 }));
+            GenerateChunk(*chunks.back(), rng);
+            neighboringChunks[x][z] = chunks.back().get();
+        }
+    }
+    Chunk &centre = *chunks[4];
+
+    constexpr int SECTION_COUNT = CHUNK_SECTION_COUNT_X * CHUNK_SECTION_COUNT_Y * CHUNK_SECTION_COUNT_Z;
+
+    auto regenerateAll = [&](const char *name, bool usePow)
+    {
+        BLOCK_BRIGHTNESS_TO_FLOAT_USE_POW = usePow;
+
+        Timer timer;
+        for(int i = 0; i < MESHING_REPEAT_COUNT; ++i)
+        {
+            for(int x = 0; x < CHUNK_SECTION_COUNT_X; ++x)
+            {
+                for(int y = 0; y < CHUNK_SECTION_COUNT_Y; ++y)
+                {
+                    for(int z = 0; z < CHUNK_SECTION_COUNT_Z; ++z)
+                    {
+                        centre.RegenerateSectionModel({ x, y, z }, neighboringChunks);
+                    }
+                }
+            }
+        }
+        const double seconds = timer.Seconds();
+
+        std::printf(
+            "meshing with %-12s %.1f us/section\n", name, 1e6 * seconds / (MESHING_REPEAT_COUNT * SECTION_COUNT));
+    };
+
+    regenerateAll("std::pow:", true);
+    regenerateAll("lookup table:", false);
+
+    BLOCK_BRIGHTNESS_TO_FLOAT_USE_POW = false;
+
+    return isIdentical ? 0 : 1;
+}
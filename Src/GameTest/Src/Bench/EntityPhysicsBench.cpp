@@ -0,0 +1,107 @@
+﻿#include <random>
+
+#include <VRPG/Game/Physics/EntityPhysics.h>
+#include <VRPG/Game/World/Land/FlatLandGenerator.h>
+
+#include <Common/GameEnvironment.h>
+
+/*
+ * 实体物理性能测试：1000个实体从空中落到散布着石块的地面上，统计每秒能执行的Update次数，
+ * 分别测试所有实体都醒着的下落阶段、大部分实体睡眠后的阶段，以及批量修改方块唤醒实体的开销
+ */
+
+using namespace VRPG::Test;
+
+namespace
+{
+    constexpr int LAND_HEIGHT = 20;
+    constexpr int BODY_COUNT  = 1000;
+    constexpr float DT        = 1.0f / 60;
+
+    constexpr int REGION_RADIUS = 40;
+
+    void RunTicks(const char *name, EntityPhysics &physics, const std::vector<PhysicsBodyID> &bodies, int tickCount)
+    {
+        Timer timer;
+        for(int i = 0; i < tickCount; ++i)
+        {
+            physics.Update(DT);
+        }
+        const double seconds = timer.Seconds();
+
+        int sleepingCount = 0;
+        for(PhysicsBodyID id : bodies)
+        {
+            sleepingCount += physics.IsSleeping(id) ? 1 : 0;
+        }
+
+        std::printf(
+            "%s: %d ticks in %.3f s, %.1f ticks/s, %.3f ms/tick, %d/%zu bodies sleeping\n",
+            name, tickCount, seconds, tickCount / seconds, 1000 * seconds / tickCount, sleepingCount, bodies.size());
+    }
+}
+
+int main()
+{
+    GameEnvironment environment;
+
+    ChunkManagerParams chunkParams;
+    chunkParams.renderDistance = 1;
+    chunkParams.loadDistance   = 3;
+    chunkParams.unloadDistance = 4;
+
+    ChunkManager chunkManager(chunkParams, std::make_unique<FlatLandGenerator>(LAND_HEIGHT));
+    chunkManager.SetCentreChunk({ 0, 0 });
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> blockDist(-REGION_RADIUS, REGION_RADIUS);
+    std::uniform_int_distribution<int> stackDist(1, 3);
+
+    const BlockID stone = GameEnvironment::GetID(BuiltinBlockType::Stone);
+    std::vector<BlockEdit> edits;
+    for(int i = 0; i < 1500; ++i)
+    {
+        const int x = blockDist(rng), z = blockDist(rng), stack = stackDist(rng);
+        for(int y = 1; y <= stack; ++y)
+        {
+            edits.push_back({ { x, LAND_HEIGHT + y, z }, { stone, {}, BlockOrientation() } });
+        }
+    }
+    chunkManager.SetBlocks(edits);
+
+    const int workerCount = (std::max)(0, int(std::thread::hardware_concurrency()) - 1);
+    ParallelForPool workerPool(workerCount);
+    std::printf("physics workers: %d\n", workerCount);
+
+    EntityPhysics physics({}, &chunkManager, &workerPool);
+
+    std::uniform_real_distribution<float> xzDist(-float(REGION_RADIUS), float(REGION_RADIUS));
+    std::uniform_real_distribution<float> yDist(LAND_HEIGHT + 6.0f, LAND_HEIGHT + 30.0f);
+    std::uniform_real_distribution<float> velDist(-4, 4);
+
+    std::vector<PhysicsBodyID> bodies;
+    for(int i = 0; i < BODY_COUNT; ++i)
+    {
+        const Collision::AACylinder cylinder{ { xzDist(rng), yDist(rng), xzDist(rng) }, 0.3f, 0.9f };
+        bodies.push_back(physics.AddBody(cylinder, { velDist(rng), 0, velDist(rng) }));
+    }
+
+    RunTicks("falling", physics, bodies, 120);
+    RunTicks("settling", physics, bodies, 240);
+    RunTicks("resting", physics, bodies, 600);
+
+    // 清除所有石块，通过方块改变通知唤醒其上的实体
+
+    for(auto &edit : edits)
+    {
+        edit.block.id = BLOCK_ID_VOID;
+    }
+
+    Timer timer;
+    chunkManager.SetBlocks(edits);
+    std::printf("clear %zu blocks with sleeping bodies: %.3f ms\n", edits.size(), timer.Milliseconds());
+
+    RunTicks("after clearing", physics, bodies, 240);
+
+    return 0;
+}
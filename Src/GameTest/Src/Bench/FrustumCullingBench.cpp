@@ -0,0 +1,116 @@
+﻿#include <VRPG/Game/Misc/FrustumCuller.h>
+#include <VRPG/Game/World/Chunk/Common.h>
+
+#include <Common/TestCommon.h>
+
+/*
+ * 视锥剔除性能测试：在摄像机周围放置10000个section大小的包围盒（25x16x25），
+ * 对若干个朝向分别比较逐个调用FrustumCuller::IsVisible与批量的ComputeVisibility每秒能测试的包围盒数量，
+ * 并检查两者得到的可见包围盒是否完全相同
+ */
+
+using namespace VRPG::Test;
+
+namespace
+{
+    constexpr int SECTION_COUNT_X = 25;
+    constexpr int SECTION_COUNT_Y = 16;
+    constexpr int SECTION_COUNT_Z = 25;
+
+    constexpr int REPEAT_COUNT = 2000;
+
+    struct CameraPose
+    {
+        const char *name;
+        Vec3 direction;
+    };
+
+    const CameraPose CAMERA_POSES[] = {
+        { "horizontal", Vec3(1, 0, 0.3f)   },
+        { "diagonal",   Vec3(1, -0.3f, 1)  },
+        { "down",       Vec3(0.1f, -1, 0)  },
+        { "up",         Vec3(0, 1, 0.2f)   }
+    };
+}
+
+int main()
+{
+    std::vector<CullingBoundingBox> boxes;
+    CullingBoundingBoxArray boxArray;
+    for(int x = 0; x < SECTION_COUNT_X; ++x)
+    {
+        for(int y = 0; y < SECTION_COUNT_Y; ++y)
+        {
+            for(int z = 0; z < SECTION_COUNT_Z; ++z)
+            {
+                const Vec3 low = {
+                    float((x - SECTION_COUNT_X / 2) * CHUNK_SECTION_SIZE_X),
+                    float(y * CHUNK_SECTION_SIZE_Y),
+                    float((z - SECTION_COUNT_Z / 2) * CHUNK_SECTION_SIZE_Z)
+                };
+                const CullingBoundingBox bbox = {
+                    low, low + Vec3(float(CHUNK_SECTION_SIZE_X), float(CHUNK_SECTION_SIZE_Y), float(CHUNK_SECTION_SIZE_Z))
+                };
+                boxes.push_back(bbox);
+                boxArray.Add(bbox);
+            }
+        }
+    }
+
+    const size_t boxCount = boxes.size();
+    std::printf("bounding boxes: %zu\n", boxCount);
+
+    const Vec3 eye = { 0.5f, 80.5f, 0.5f };
+    const Mat4 proj = Trans4::perspective(agz::math::deg2rad(60.0f), 16.0f / 9, 0.1f, 1000.0f);
+
+    bool isConsistent = true;
+    for(auto &pose : CAMERA_POSES)
+    {
+        const Mat4 view = Trans4::look_at(eye, eye + pose.direction.normalize(), Vec3(0, 1, 0));
+        const FrustumCuller culler(view * proj);
+
+        std::vector<uint64_t> perBoxVisibility((boxCount + 63) / 64);
+        Timer timer;
+        for(int i = 0; i < REPEAT_COUNT; ++i)
+        {
+            std::fill(perBoxVisibility.begin(), perBoxVisibility.end(), 0);
+            for(size_t j = 0; j < boxCount; ++j)
+            {
+                if(culler.IsVisible(boxes[j]))
+                {
+                    perBoxVisibility[j / 64] |= uint64_t(1) << (j % 64);
+                }
+            }
+        }
+        const double perBoxSeconds = timer.Seconds();
+
+        std::vector<uint64_t> batchVisibility((boxCount + 63) / 64);
+        timer.Restart();
+        for(int i = 0; i < REPEAT_COUNT; ++i)
+        {
+            std::fill(batchVisibility.begin(), batchVisibility.end(), 0);
+            culler.ComputeVisibility(boxArray, 0, boxCount, batchVisibility.data());
+        }
+        const double batchSeconds = timer.Seconds();
+
+        int visibleCount = 0;
+        for(uint64_t word : batchVisibility)
+        {
+            for(; word; word &= word - 1)
+            {
+                ++visibleCount;
+            }
+        }
+
+        const bool isIdentical = perBoxVisibility == batchVisibility;
+        isConsistent &= isIdentical;
+
+        std::printf(
+            "%-10s visible: %5d, per box: %.1f us, batch: %.1f us%s\n",
+            pose.name, visibleCount,
+            1e6 * perBoxSeconds / REPEAT_COUNT, 1e6 * batchSeconds / REPEAT_COUNT,
+            isIdentical ? "" : " (visibility differs)");
+    }
+
+    return isConsistent ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+﻿#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <thread>
+
+#include <VRPG/Game/World/Chunk/ChunkManager.h>
+#include <VRPG/Game/World/Chunk/SectionModelCache.h>
+#include <VRPG/Game/World/Land/FlatLandGenerator.h>
+
+#include <Common/GameEnvironment.h>
+
+/*
+ * 贪心合并测试：分别在平坦世界与随机起伏的世界中，关闭和开启ChunkManager.EnableGreedyMeshing，
+ * 经由ChunkManager的正常流程（加载、光照、生成模型）为中心3x3个区块生成模型（禁用模型缓存），
+ * 输出模型的顶点数、下标数、显存字节数与生成耗时
+ */
+
+using namespace VRPG::Test;
+
+namespace
+{
+    constexpr int LAND_HEIGHT = 40;
+
+    constexpr int COUNTED_CHUNK_RADIUS = 1;
+
+    /**
+     * @brief 以格点哈希插值得到的起伏地形，表层为草地与泥土，并零星露出石头
+     */
+    class NoisyLandGenerator : public LandGenerator
+    {
+        static float LatticeValue(int x, int z) noexcept
+        {
+            uint32_t h = uint32_t(x) * 0x8da6b343u ^ uint32_t(z) * 0xd8163841u;
+            h ^= h >> 13;
+            h *= 0x5bd1e995u;
+            h ^= h >> 15;
+            return (h & 0xffff) / float(0xffff);
+        }
+
+        static float Noise(float x, float z) noexcept
+        {
+            const int x0 = int(std::floor(x)), z0 = int(std::floor(z));
+            const float tx = x - x0, tz = z - z0;
+            const float a = LatticeValue(x0, z0),     b = LatticeValue(x0 + 1, z0);
+            const float c = LatticeValue(x0, z0 + 1), d = LatticeValue(x0 + 1, z0 + 1);
+            return (a * (1 - tx) + b * tx) * (1 - tz) + (c * (1 - tx) + d * tx) * tz;
+        }
+
+    public:
+
+        void Generate(const ChunkPosition &position, ChunkBlockData *blockData) override
+        {
+            auto &builtinBlocks = BuiltinBlockTypeManager::GetInstance();
+            const BlockID stone = builtinBlocks.GetID(BuiltinBlockType::Stone);
+            const BlockID soil  = builtinBlocks.GetID(BuiltinBlockType::Soil);
+            const BlockID lawn  = builtinBlocks.GetID(BuiltinBlockType::Lawn);
+
+            for(int x = 0; x < CHUNK_SIZE_X; ++x)
+            {
+                for(int z = 0; z < CHUNK_SIZE_Z; ++z)
+                {
+                    const int globalX = position.x * CHUNK_SIZE_X + x;
+                    const int globalZ = position.z * CHUNK_SIZE_Z + z;
+                    const int height = LAND_HEIGHT + int(
+                        12 * Noise(globalX / 16.0f, globalZ / 16.0f) + 4 * Noise(globalX / 4.0f, globalZ / 4.0f));
+                    const bool isRocky = LatticeValue(globalX, globalZ) < 0.1f;
+
+                    for(int y = 0; y < height; ++y)
+                    {
+                        const BlockID id = y == height - 1 ? (isRocky ? stone : lawn) : (y >= height - 4 ? soil : stone);
+                        blockData->SetID({ x, y, z }, id, {});
+                    }
+                }
+            }
+
+            ComputeHeightMap(blockData);
+        }
+    };
+
+    struct MeshStatistics
+    {
+        size_t vertexCount = 0;
+        size_t indexCount  = 0;
+        size_t memoryUsage = 0;
+        double seconds     = 0;
+    };
+
+    /**
+     * @brief 以指定的合并开关为中心附近的区块生成模型
+     *
+     * 模型在新线程中生成，因为ModelBuilderSet是thread_local的，已创建的builder会沿用创建时的开关
+     */
+    using LandGeneratorFactory = std::function<std::unique_ptr<LandGenerator>()>;
+
+    MeshStatistics MeshWorld(const LandGeneratorFactory &createLandGenerator, bool enableGreedyMeshing)
+    {
+        MeshStatistics ret;
+        std::thread thread([&]
+        {
+            const auto configFilename = std::filesystem::temp_directory_path() / "vrpg_greedy_meshing_bench.cfg";
+            if(FILE *file = std::fopen(configFilename.string().c_str(), "w"))
+            {
+                std::fprintf(
+                    file, "ChunkManager = { EnableGreedyMeshing = %s; };\n", enableGreedyMeshing ? "true" : "false");
+                std::fclose(file);
+            }
+            GLOBAL_CONFIG.LoadFromFile(configFilename.string().c_str());
+            std::filesystem::remove(configFilename);
+
+            ChunkManagerParams chunkParams;
+            chunkParams.renderDistance     = 2;
+            chunkParams.loadDistance       = 3;
+            chunkParams.unloadDistance     = 4;
+            chunkParams.simulationDistance = 1;
+            chunkParams.fullDetailDistance = 3;
+            chunkParams.halfDetailDistance = 3;
+
+            ChunkManager chunkManager(chunkParams, createLandGenerator());
+            chunkManager.SetCentreChunk({ 0, 0 });
+            for(int x = -chunkParams.loadDistance; x <= chunkParams.loadDistance; ++x)
+            {
+                for(int z = -chunkParams.loadDistance; z <= chunkParams.loadDistance; ++z)
+                {
+                    chunkManager.GetBlockID({ x * CHUNK_SIZE_X, 0, z * CHUNK_SIZE_Z });
+                }
+            }
+            chunkManager.UpdateLight();
+
+            Timer timer;
+            chunkManager.UpdateChunkModels();
+            ret.seconds = timer.Seconds();
+
+            for(int x = -COUNTED_CHUNK_RADIUS; x <= COUNTED_CHUNK_RADIUS; ++x)
+            {
+                for(int z = -COUNTED_CHUNK_RADIUS; z <= COUNTED_CHUNK_RADIUS; ++z)
+                {
+                    const Chunk *chunk = chunkManager.FindChunk({ x, z });
+                    for(int sx = 0; sx < CHUNK_SECTION_COUNT_X; ++sx)
+                    {
+                        for(int sy = 0; sy < CHUNK_SECTION_COUNT_Y; ++sy)
+                        {
+                            for(int sz = 0; sz < CHUNK_SECTION_COUNT_Z; ++sz)
+                            {
+                                auto &sectionModel = chunk->GetChunkModel().sectionModel({ sx, sy, sz });
+                                for(auto &partialModel : sectionModel->partialModels)
+                                {
+                                    ret.vertexCount += partialModel->GetVertexCount();
+                                    ret.indexCount  += partialModel->GetIndexCount();
+                                    ret.memoryUsage += partialModel->GetMemoryUsage();
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        });
+        thread.join();
+        return ret;
+    }
+
+    void RunWorld(const char *name, const LandGeneratorFactory &createLandGenerator)
+    {
+        for(bool enableGreedyMeshing : { false, true })
+        {
+            const MeshStatistics statistics = MeshWorld(createLandGenerator, enableGreedyMeshing);
+            std::printf(
+                "%-6s greedy %-3s: %8zu vertices, %8zu indices, %9zu bytes, meshing %.1f ms\n",
+                name, enableGreedyMeshing ? "on" : "off",
+                statistics.vertexCount, statistics.indexCount, statistics.memoryUsage, 1000 * statistics.seconds);
+        }
+    }
+}
+
+int main()
+{
+    GameEnvironment environment;
+    SectionModelCache::GetInstance().SetCapacity(0);
+
+    std::printf("counted chunks: %dx%d around the centre\n", 2 * COUNTED_CHUNK_RADIUS + 1, 2 * COUNTED_CHUNK_RADIUS + 1);
+
+    RunWorld("flat",  [] { return std::make_unique<FlatLandGenerator>(LAND_HEIGHT); });
+    RunWorld("noisy", [] { return std::make_unique<NoisyLandGenerator>(); });
+
+    return 0;
+}
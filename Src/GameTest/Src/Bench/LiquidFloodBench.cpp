@@ -0,0 +1,134 @@
+﻿#include <thread>
+
+#include <VRPG/Game/World/BlockUpdater/LiquidUpdater.h>
+#include <VRPG/Game/World/Chunk/ChunkManager.h>
+#include <VRPG/Game/World/Land/FlatLandGenerator.h>
+
+#include <Common/GameEnvironment.h>
+
+/*
+ * 方块更新性能测试：在64x64的水池中均匀放置水源，以模拟的时钟逐tick执行更新直至水面静止，
+ * 然后移除所有水源直至水完全退去，统计每秒执行的更新任务数与等待中任务数的峰值
+ */
+
+using namespace VRPG::Test;
+
+namespace
+{
+    constexpr int LAND_HEIGHT = 20;
+    constexpr int BASIN_Y     = LAND_HEIGHT + 1;
+
+    constexpr int BASIN_LOW  = -32;
+    constexpr int BASIN_HIGH = 31;
+    constexpr int SOURCE_INTERVAL = 8;
+
+    constexpr int MAX_TICK_COUNT = 100000;
+
+    void RunUntilQuiet(const char *name, BlockUpdaterManager &updaterManager, StdClock::time_point &now)
+    {
+        size_t peakPendingCount = updaterManager.GetPendingUpdaterCount();
+        int64_t executedCount = 0;
+        int tickCount = 0;
+
+        Timer timer;
+        while(updaterManager.GetPendingUpdaterCount() && tickCount < MAX_TICK_COUNT)
+        {
+            now += BLOCK_UPDATE_TICK_INTERVAL;
+            updaterManager.Execute(std::chrono::hours(1), now);
+            ++tickCount;
+
+            auto statistics = updaterManager.GetStatistics();
+            executedCount += statistics.executedCount;
+            peakPendingCount = (std::max)(peakPendingCount, statistics.pendingCount);
+        }
+        const double seconds = timer.Seconds();
+
+        std::printf(
+            "%s: %d ticks, %lld updates in %.3f s, %.0f updates/s, peak queue %zu\n",
+            name, tickCount, static_cast<long long>(executedCount), seconds, executedCount / seconds, peakPendingCount);
+    }
+}
+
+int main()
+{
+    GameEnvironment environment;
+
+    ChunkManagerParams chunkParams;
+    chunkParams.renderDistance     = 1;
+    chunkParams.loadDistance       = 3;
+    chunkParams.unloadDistance     = 4;
+    chunkParams.simulationDistance = 2;
+
+    ChunkManager chunkManager(chunkParams, std::make_unique<FlatLandGenerator>(LAND_HEIGHT));
+    chunkManager.SetCentreChunk({ 0, 0 });
+    for(int x = -chunkParams.loadDistance; x <= chunkParams.loadDistance; ++x)
+    {
+        for(int z = -chunkParams.loadDistance; z <= chunkParams.loadDistance; ++z)
+        {
+            chunkManager.GetBlockID({ x * CHUNK_SIZE_X, 0, z * CHUNK_SIZE_Z });
+        }
+    }
+
+    // 清空水池范围内地面以上的方块，并在四周围上两格高的石墙
+
+    const BlockID stone = GameEnvironment::GetID(BuiltinBlockType::Stone);
+    std::vector<BlockEdit> edits;
+    for(int x = BASIN_LOW - 1; x <= BASIN_HIGH + 1; ++x)
+    {
+        for(int z = BASIN_LOW - 1; z <= BASIN_HIGH + 1; ++z)
+        {
+            const bool isWall = x < BASIN_LOW || x > BASIN_HIGH || z < BASIN_LOW || z > BASIN_HIGH;
+            for(int y = BASIN_Y; y <= BASIN_Y + 2; ++y)
+            {
+                const BlockID id = isWall && y < BASIN_Y + 2 ? stone : BLOCK_ID_VOID;
+                edits.push_back({ { x, y, z }, { id, {}, BlockOrientation() } });
+            }
+        }
+    }
+    chunkManager.SetBlocks(edits);
+
+    const int workerCount = (std::max)(0, int(std::thread::hardware_concurrency()) - 1);
+    BlockUpdaterManager updaterManager(&chunkManager, workerCount);
+    LiquidUpdater *liquidUpdater = updaterManager.RegisterUpdater<LiquidUpdater>();
+    std::printf("updater workers: %d\n", workerCount);
+
+    auto waterDesc = BuiltinBlockTypeManager::GetInstance().GetDesc(BuiltinBlockType::Water);
+
+    std::vector<Vec3i> sources;
+    for(int x = BASIN_LOW + SOURCE_INTERVAL / 2; x <= BASIN_HIGH; x += SOURCE_INTERVAL)
+    {
+        for(int z = BASIN_LOW + SOURCE_INTERVAL / 2; z <= BASIN_HIGH; z += SOURCE_INTERVAL)
+        {
+            sources.push_back({ x, BASIN_Y, z });
+        }
+    }
+
+    StdClock::time_point now = StdClock::now();
+
+    for(auto &source : sources)
+    {
+        chunkManager.SetBlockID(
+            source, waterDesc->GetBlockID(), {}, MakeLiquidExtraData(waterDesc->GetLiquid()->sourceLevel));
+        liquidUpdater->AddUpdaterForNeighborhood(source, updaterManager, chunkManager, now);
+    }
+    RunUntilQuiet("flood", updaterManager, now);
+
+    int waterCount = 0;
+    for(int x = BASIN_LOW; x <= BASIN_HIGH; ++x)
+    {
+        for(int z = BASIN_LOW; z <= BASIN_HIGH; ++z)
+        {
+            waterCount += chunkManager.GetBlockID({ x, BASIN_Y, z }) == waterDesc->GetBlockID() ? 1 : 0;
+        }
+    }
+    std::printf("water blocks: %d/%d\n", waterCount, (BASIN_HIGH - BASIN_LOW + 1) * (BASIN_HIGH - BASIN_LOW + 1));
+
+    for(auto &source : sources)
+    {
+        chunkManager.SetBlockID(source, BLOCK_ID_VOID, {});
+        liquidUpdater->AddUpdaterForNeighborhood(source, updaterManager, chunkManager, now);
+    }
+    RunUntilQuiet("drain", updaterManager, now);
+
+    return 0;
+}
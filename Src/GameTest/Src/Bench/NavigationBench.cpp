@@ -0,0 +1,150 @@
+﻿#include <map>
+#include <random>
+#include <thread>
+
+#include <VRPG/Game/Navigation/NavigationService.h>
+#include <VRPG/Game/World/Chunk/ChunkManager.h>
+#include <VRPG/Game/World/Land/FlatLandGenerator.h>
+
+#include <Common/GameEnvironment.h>
+
+/*
+ * 寻路服务性能测试：在中心区块周围10个区块的范围内随机放置墙壁，
+ * 然后执行1000次起点和终点均随机的寻路查询，分别统计冷缓存与热缓存下的吞吐量
+ */
+
+using namespace VRPG::Test;
+
+namespace
+{
+    constexpr int LAND_HEIGHT  = 20;
+    constexpr int CHUNK_RADIUS = 10;
+    constexpr int QUERY_COUNT  = 1000;
+    constexpr int WALL_COUNT   = 2000;
+
+    constexpr int BLOCK_RADIUS = CHUNK_RADIUS * CHUNK_SIZE_X;
+
+    const char *StatusName(PathQueryResult::Status status)
+    {
+        switch(status)
+        {
+        case PathQueryResult::Status::Found:           return "found";
+        case PathQueryResult::Status::NoPath:          return "no path";
+        case PathQueryResult::Status::InvalidEndpoint: return "invalid endpoint";
+        case PathQueryResult::Status::Unloaded:        return "unloaded";
+        }
+        return "unknown";
+    }
+
+    void RunQueries(const char *name, NavigationService &navigation, std::mt19937 &rng)
+    {
+        std::uniform_int_distribution<int> dist(-BLOCK_RADIUS, BLOCK_RADIUS - 1);
+
+        Timer timer;
+        for(int i = 0; i < QUERY_COUNT; ++i)
+        {
+            const Vec3i start = { dist(rng), LAND_HEIGHT + 1, dist(rng) };
+            const Vec3i goal  = { dist(rng), LAND_HEIGHT + 1, dist(rng) };
+            navigation.AddQuery(start, goal);
+        }
+
+        // 逻辑线程在Update中为被挂起的查询生成快照，因此需要不断调用Update直到所有查询完成
+
+        std::map<PathQueryResult::Status, int> statusCounts;
+        size_t pathLengthSum = 0;
+        int finishedCount = 0;
+        int updateCount = 0;
+        while(finishedCount < QUERY_COUNT)
+        {
+            navigation.Update();
+            ++updateCount;
+
+            for(auto &result : navigation.TakeFinishedQueries())
+            {
+                ++statusCounts[result.status];
+                pathLengthSum += result.path.size();
+                ++finishedCount;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        const double seconds = timer.Seconds();
+
+        const auto stats = navigation.GetStatistics();
+        std::printf(
+            "%s: %d queries in %.3f s (%.1f queries/s), %d updates, mean query time %.3f ms, "
+            "%zu cached graphs, %zu cached snapshots\n",
+            name, QUERY_COUNT, seconds, QUERY_COUNT / seconds, updateCount,
+            stats.meanQueryTime, stats.cachedGraphCount, stats.cachedSnapshotCount);
+
+        for(auto &[status, count] : statusCounts)
+        {
+            std::printf("    %s: %d\n", StatusName(status), count);
+        }
+        if(statusCounts[PathQueryResult::Status::Found])
+        {
+            std::printf("    mean path length: %.1f cells\n",
+                double(pathLengthSum) / statusCounts[PathQueryResult::Status::Found]);
+        }
+    }
+}
+
+int main()
+{
+    GameEnvironment environment;
+
+    ChunkManagerParams chunkParams;
+    chunkParams.renderDistance        = 1;
+    chunkParams.loadDistance          = CHUNK_RADIUS + 1;
+    chunkParams.unloadDistance        = CHUNK_RADIUS + 2;
+    chunkParams.simulationDistance    = 1;
+    chunkParams.fullDetailDistance    = 1;
+    chunkParams.halfDetailDistance    = 1;
+    chunkParams.backgroundThreadCount = (std::max)(1, int(std::thread::hardware_concurrency()) - 1);
+    chunkParams.backgroundPoolSize    = 1024;
+
+    ChunkManager chunkManager(chunkParams, std::make_unique<FlatLandGenerator>(LAND_HEIGHT));
+    chunkManager.SetCentreChunk({ 0, 0 });
+
+    // GetBlockID会阻塞地加载所在区块
+
+    Timer timer;
+    for(int x = -CHUNK_RADIUS; x < CHUNK_RADIUS; ++x)
+    {
+        for(int z = -CHUNK_RADIUS; z < CHUNK_RADIUS; ++z)
+        {
+            chunkManager.GetBlockID({ x * CHUNK_SIZE_X, 0, z * CHUNK_SIZE_Z });
+        }
+    }
+    std::printf("load chunks: %.2f ms\n", timer.Milliseconds());
+
+    // 随机放置两格高、一格厚的墙壁，使路径需要绕行
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> posDist(-BLOCK_RADIUS, BLOCK_RADIUS - 1);
+    std::uniform_int_distribution<int> lenDist(4, 24);
+    std::bernoulli_distribution dirDist;
+
+    const BlockID stone = GameEnvironment::GetID(BuiltinBlockType::Stone);
+    for(int i = 0; i < WALL_COUNT; ++i)
+    {
+        const Vec3i low = { posDist(rng), LAND_HEIGHT + 1, posDist(rng) };
+        const int length = lenDist(rng);
+        const Vec3i high = dirDist(rng) ? Vec3i(low.x + length, LAND_HEIGHT + 2, low.z)
+                                        : Vec3i(low.x, LAND_HEIGHT + 2, low.z + length);
+        chunkManager.SetBlocks(low, high, stone, BlockOrientation());
+    }
+
+    NavigationServiceParams navigationParams;
+    navigationParams.agent            = NavigationAgentParams::FromCylinder(0.3f, 1.5f);
+    navigationParams.threadCount      = (std::max)(1, int(std::thread::hardware_concurrency()) - 1);
+    navigationParams.maxSearchRegions = 1 << 16;
+    std::printf("navigation threads: %d\n", navigationParams.threadCount);
+
+    NavigationService navigation(navigationParams, &chunkManager);
+
+    RunQueries("cold cache", navigation, rng);
+    RunQueries("warm cache", navigation, rng);
+
+    return 0;
+}
@@ -0,0 +1,133 @@
+﻿#include <random>
+
+#include <VRPG/Game/Physics/CollisionPrimitive.h>
+#include <VRPG/Game/World/Chunk/ChunkManager.h>
+#include <VRPG/Game/World/Land/FlatLandGenerator.h>
+
+#include <Common/GameEnvironment.h>
+
+/*
+ * 角色沿单轴移动的性能测试，步骤与Player::MoveAlongAxis相同：
+ * 求出扫过的方块范围，借助碰撞位掩码枚举其中的方块，并对每个AABB做扫掠测试
+ *
+ * 最坏情况是半径与高度都很大的圆柱体在密集的方块中长距离移动，此时开销与扫过的方块数量成正比
+ */
+
+using namespace VRPG::Test;
+
+namespace
+{
+    constexpr int LAND_HEIGHT = 20;
+    constexpr int MOVE_COUNT  = 2000;
+
+    const Vec3i REGION_LOW  = { -48, LAND_HEIGHT + 1, -48 };
+    const Vec3i REGION_HIGH = { 47, LAND_HEIGHT + 48, 47 };
+
+    struct BenchCase
+    {
+        float radius;
+        float height;
+        float delta;
+    };
+}
+
+int main()
+{
+    GameEnvironment environment;
+
+    ChunkManagerParams chunkParams;
+    chunkParams.renderDistance = 1;
+    chunkParams.loadDistance   = 3;
+    chunkParams.unloadDistance = 4;
+
+    ChunkManager chunkManager(chunkParams, std::make_unique<FlatLandGenerator>(LAND_HEIGHT));
+    chunkManager.SetCentreChunk({ 0, 0 });
+
+    // 在区域中随机放置约30%的石头
+
+    std::mt19937 rng(42);
+    std::bernoulli_distribution solidDist(0.3);
+
+    const BlockID stone = GameEnvironment::GetID(BuiltinBlockType::Stone);
+    std::vector<BlockEdit> edits;
+    for(int x = REGION_LOW.x; x <= REGION_HIGH.x; ++x)
+    {
+        for(int y = REGION_LOW.y; y <= REGION_HIGH.y; ++y)
+        {
+            for(int z = REGION_LOW.z; z <= REGION_HIGH.z; ++z)
+            {
+                if(solidDist(rng))
+                {
+                    edits.push_back({ { x, y, z }, { stone, {}, BlockOrientation() } });
+                }
+            }
+        }
+    }
+    chunkManager.SetBlocks(std::move(edits));
+
+    auto &blockDescMgr = BlockDescManager::GetInstance();
+
+    const BenchCase cases[] = {
+        { 0.3f, 1.8f,  0.05f },
+        { 0.3f, 1.8f,  1     },
+        { 0.3f, 1.8f,  8     },
+        { 2,    4,     1     },
+        { 8,    16,    1     },
+        { 8,    16,    8     },
+        { 16,   32,    16    },
+    };
+
+    std::uniform_real_distribution<float> xzDist(-24, 24);
+    std::uniform_real_distribution<float> yDist(float(LAND_HEIGHT + 1), float(LAND_HEIGHT + 8));
+    std::uniform_int_distribution<int> axisDist(0, 2);
+    std::bernoulli_distribution signDist;
+
+    for(auto &benchCase : cases)
+    {
+        size_t blockCount = 0;
+        size_t blockedCount = 0;
+        double distanceSum = 0;
+
+        Timer timer;
+        for(int i = 0; i < MOVE_COUNT; ++i)
+        {
+            const Collision::AACylinder cylinder{
+                { xzDist(rng), yDist(rng), xzDist(rng) }, benchCase.radius, benchCase.height
+            };
+            const int axis = axisDist(rng);
+            const float delta = signDist(rng) ? benchCase.delta : -benchCase.delta;
+
+            Vec3 newLowCentre = cylinder.lowCentre;
+            newLowCentre[axis] += delta;
+
+            Vec3i low, high;
+            Collision::GetSweptBlockRange(cylinder, newLowCentre, low, high);
+
+            Collision::AxisSweep sweep(cylinder, axis, delta);
+            chunkManager.ForEachCollidableBlock(low, high, true,
+                [&](const Vec3i &globalBlock, BlockID id, BlockOrientation orientation)
+            {
+                ++blockCount;
+                sweep.AddBlock(
+                    globalBlock.map([](int i) { return static_cast<float>(i); }),
+                    blockDescMgr.GetCollisionAABBs(id, orientation));
+            });
+
+            const float movedDistance = sweep.GetMovedDistance();
+            distanceSum += std::abs(movedDistance);
+            if(movedDistance != delta)
+            {
+                ++blockedCount;
+            }
+        }
+        const double microseconds = timer.Milliseconds() * 1000;
+
+        std::printf(
+            "radius %5.2f, height %5.2f, delta %5.2f: %8.3f us/move, %8.1f blocks/move, %5.1f%% blocked, mean distance %.3f\n",
+            benchCase.radius, benchCase.height, benchCase.delta,
+            microseconds / MOVE_COUNT, double(blockCount) / MOVE_COUNT,
+            100.0 * blockedCount / MOVE_COUNT, distanceSum / MOVE_COUNT);
+    }
+
+    return 0;
+}
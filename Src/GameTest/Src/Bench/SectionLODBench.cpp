@@ -0,0 +1,125 @@
+﻿#include <cmath>
+#include <random>
+
+#include <VRPG/Game/World/Chunk/SectionModelCache.h>
+#include <VRPG/Game/World/Chunk/SectionScratchVolume.h>
+
+#include <Common/GameEnvironment.h>
+
+/*
+ * LOD模型性能测试：在3x3个区块中生成起伏的自然地形（石头、泥土、草地与零星的树叶），
+ * 对中心区块的所有section分别以各个细节层次生成模型（禁用模型缓存），
+ * 输出每个层次每秒能生成的section数量，以及模型占用的显存字节数
+ */
+
+using namespace VRPG::Test;
+
+namespace
+{
+    constexpr int BASE_HEIGHT = 40;
+
+    constexpr int REPEAT_COUNT = 10;
+
+    void GenerateTerrain(Chunk &chunk, std::mt19937 &rng)
+    {
+        const BlockID stone = GameEnvironment::GetID(BuiltinBlockType::Stone);
+        const BlockID soil  = GameEnvironment::GetID(BuiltinBlockType::Soil);
+        const BlockID lawn  = GameEnvironment::GetID(BuiltinBlockType::Lawn);
+        const BlockID leaf  = GameEnvironment::GetID(BuiltinBlockType::Leaf);
+
+        std::bernoulli_distribution isLeafDist(0.02);
+
+        const ChunkPosition chunkPosition = chunk.GetPosition();
+        for(int x = 0; x < CHUNK_SIZE_X; ++x)
+        {
+            for(int z = 0; z < CHUNK_SIZE_Z; ++z)
+            {
+                const float globalX = float(chunkPosition.x * CHUNK_SIZE_X + x);
+                const float globalZ = float(chunkPosition.z * CHUNK_SIZE_Z + z);
+                const int height = BASE_HEIGHT + int(
+                    8 * std::sin(globalX * 0.11f) + 6 * std::cos(globalZ * 0.07f) + 3 * std::sin((globalX + globalZ) * 0.23f));
+
+                for(int y = 0; y < CHUNK_SIZE_Y; ++y)
+                {
+                    const Vec3i blockInChunk = { x, y, z };
+                    if(y >= height)
+                    {
+                        chunk.SetBrightness(blockInChunk, BLOCK_BRIGHTNESS_SKY);
+                        if(y < height + 4 && isLeafDist(rng))
+                        {
+                            chunk.SetID(blockInChunk, leaf, {});
+                        }
+                        continue;
+                    }
+
+                    chunk.SetBrightness(blockInChunk, BLOCK_BRIGHTNESS_MIN);
+                    chunk.SetID(blockInChunk, y == height - 1 ? lawn : (y >= height - 4 ? soil : stone), {});
+                }
+            }
+        }
+    }
+}
+
+int main()
+{
+    GameEnvironment environment;
+    SectionModelCache::GetInstance().SetCapacity(0);
+
+    std::mt19937 rng(42);
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    const Chunk *neighboringChunks[3][3];
+    for(int x = 0; x < 3; ++x)
+    {
+        for(int z = 0; z < 3; ++z)
+        {
+            chunks.push_back(std::make_unique<Chunk>(ChunkPosition{ x - 1, z - 1 }));
+            GenerateTerrain(*chunks.back(), rng);
+            neighboringChunks[x][z] = chunks.back().get();
+        }
+    }
+    Chunk &centre = *chunks[4];
+
+    constexpr int SECTION_COUNT = CHUNK_SECTION_COUNT_X * CHUNK_SECTION_COUNT_Y * CHUNK_SECTION_COUNT_Z;
+
+    auto forEachSection = [&](const auto &func)
+    {
+        for(int x = 0; x < CHUNK_SECTION_COUNT_X; ++x)
+        {
+            for(int y = 0; y < CHUNK_SECTION_COUNT_Y; ++y)
+            {
+                for(int z = 0; z < CHUNK_SECTION_COUNT_Z; ++z)
+                {
+                    func(Vec3i(x, y, z));
+                }
+            }
+        }
+    };
+
+    for(int lodLevel = 0; lodLevel < SECTION_LOD_LEVEL_COUNT; ++lodLevel)
+    {
+        Timer timer;
+        for(int i = 0; i < REPEAT_COUNT; ++i)
+        {
+            forEachSection([&](const Vec3i &sectionInChunk)
+            {
+                centre.RegenerateSectionModel(sectionInChunk, neighboringChunks, lodLevel);
+            });
+        }
+        const double seconds = timer.Seconds();
+
+        size_t totalBytes = 0;
+        forEachSection([&](const Vec3i &sectionInChunk)
+        {
+            for(auto &partialModel : centre.GetChunkModel().sectionModel(sectionInChunk)->partialModels)
+            {
+                totalBytes += partialModel->GetMemoryUsage();
+            }
+        });
+
+        std::printf(
+            "lod %d (cell size %d): %.0f sections/s, %zu bytes/chunk\n",
+            lodLevel, SectionLODCellSize(lodLevel), REPEAT_COUNT * SECTION_COUNT / seconds, totalBytes);
+    }
+
+    return 0;
+}
@@ -0,0 +1,324 @@
+﻿#include <random>
+
+#include <VRPG/Game/World/Block/BasicEffect/DiffuseHollowBlockEffect.h>
+#include <VRPG/Game/World/Block/BasicEffect/DiffuseSolidBlockEffect.h>
+#include <VRPG/Game/World/Chunk/SectionModelCache.h>
+#include <VRPG/Game/World/Chunk/SectionScratchVolume.h>
+
+#include <Common/GameEnvironment.h>
+#include <Common/LegacyBoxVertex.h>
+
+/*
+ * section模型生成性能测试：在3x3个区块中生成由实体方块、透明方块、植物和液体混合而成的地形，
+ * 对中心区块的所有section分别统计只填充临时方块数组以及完整生成模型（禁用模型缓存）时每秒能处理的section数量，
+ * 并将经由临时方块数组取得每个可见方块的3x3x3邻居，与逐方块从区块中取出27个邻居的原做法进行对比，
+ * 以及生成的模型平均每个section占用的显存字节数，并与diffuse box面片改用PackedBoxVertex之前的格式进行对比
+ */
+
+using namespace VRPG::Test;
+
+namespace
+{
+    constexpr int SOLID_HEIGHT = 20;
+    constexpr int MIXED_HEIGHT = 48;
+
+    constexpr int REPEAT_COUNT = 20;
+
+    void GenerateChunk(Chunk &chunk, std::mt19937 &rng)
+    {
+        const BlockID types[] = {
+            GameEnvironment::GetID(BuiltinBlockType::Stone),
+            GameEnvironment::GetID(BuiltinBlockType::Soil),
+            GameEnvironment::GetID(BuiltinBlockType::Leaf),
+            GameEnvironment::GetID(BuiltinBlockType::Grass),
+            GameEnvironment::GetID(BuiltinBlockType::WhiteGlass),
+            GameEnvironment::GetID(BuiltinBlockType::Water)
+        };
+        const BlockID stone = types[0];
+        const BlockID water = types[5];
+
+        std::uniform_int_distribution<int> typeDist(0, int(std::size(types)) - 1);
+        std::uniform_int_distribution<int> lightDist(0, 15);
+        std::uniform_int_distribution<int> levelDist(1, 7);
+        std::bernoulli_distribution isAirDist(0.5);
+
+        for(int x = 0; x < CHUNK_SIZE_X; ++x)
+        {
+            for(int z = 0; z < CHUNK_SIZE_Z; ++z)
+            {
+                for(int y = 0; y < CHUNK_SIZE_Y; ++y)
+                {
+                    const Vec3i blockInChunk = { x, y, z };
+                    if(y < SOLID_HEIGHT)
+                    {
+                        chunk.SetID(blockInChunk, stone, {});
+                        chunk.SetBrightness(blockInChunk, BLOCK_BRIGHTNESS_MIN);
+                        continue;
+                    }
+
+                    chunk.SetBrightness(blockInChunk, BlockBrightness{
+                        uint8_t(lightDist(rng)), uint8_t(lightDist(rng)), uint8_t(lightDist(rng)), uint8_t(lightDist(rng)) });
+
+                    if(y >= MIXED_HEIGHT || isAirDist(rng))
+                    {
+                        continue;
+                    }
+
+                    const BlockID id = types[typeDist(rng)];
+                    if(id == water)
+                    {
+                        chunk.SetID(blockInChunk, id, {}, MakeLiquidExtraData(LiquidLevel(levelDist(rng))));
+                    }
+                    else
+                    {
+                        chunk.SetID(blockInChunk, id, {});
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief 同样的模型以改用PackedBoxVertex之前的格式存储时占用的显存字节数，其他模型的格式未发生变化
+     */
+    size_t LegacyMemoryUsage(const PartialSectionModel &model)
+    {
+        const bool isPackedBoxModel =
+            dynamic_cast<const PackedBoxFacePartialSectionModel<DiffuseSolidBlockEffect>*>(&model) ||
+            dynamic_cast<const PackedBoxFacePartialSectionModel<DiffuseHollowBlockEffect>*>(&model);
+        return isPackedBoxModel ?
+               LegacyBoxMeshMemoryUsage(model.GetVertexCount(), model.GetIndexCount()) : model.GetMemoryUsage();
+    }
+
+    uint64_t HashNeighbor(BlockID id, BlockBrightness brightness) noexcept
+    {
+        return id * 31 + brightness.s;
+    }
+
+    /**
+     * @brief 原做法：对section中每个可见方块，逐个从所属区块中取出周围3x3x3个方块
+     *
+     * 返回所有邻居的校验和，用于确认与临时方块数组的结果一致
+     */
+    uint64_t GatherPerBlock(const Vec3i &sectionInChunk, const Chunk *neighboringChunks[3][3])
+    {
+        auto &blockDescMgr = BlockDescManager::GetInstance();
+        const Chunk &centre = *neighboringChunks[1][1];
+
+        auto voidDesc = blockDescMgr.GetBlockDescription(BLOCK_ID_VOID);
+        auto getBlock = [&](int x, int y, int z)
+        {
+            if(y < 0 || y >= CHUNK_SIZE_Y)
+            {
+                return BlockInstance{ voidDesc, nullptr, BLOCK_BRIGHTNESS_MIN, BlockOrientation() };
+            }
+            auto [ckPos, blkPos] = DecomposeGlobalBlockByChunk({ x, y, z });
+            return neighboringChunks[ckPos.x][ckPos.z]->GetBlock(blkPos);
+        };
+
+        const Vec3i low = sectionInChunk * Vec3i(CHUNK_SECTION_SIZE_X, CHUNK_SECTION_SIZE_Y, CHUNK_SECTION_SIZE_Z);
+        const Vec3i high = low + Vec3i(CHUNK_SECTION_SIZE_X, CHUNK_SECTION_SIZE_Y, CHUNK_SECTION_SIZE_Z);
+
+        uint64_t checksum = 0;
+        BlockInstance neighborhood[3][3][3];
+        for(int x = low.x; x < high.x; ++x)
+        {
+            for(int z = low.z; z < high.z; ++z)
+            {
+                for(int y = low.y; y < high.y; ++y)
+                {
+                    if(!blockDescMgr.IsVisible(centre.GetID({ x, y, z })))
+                    {
+                        continue;
+                    }
+
+                    for(int lx = 0; lx <= 2; ++lx)
+                    {
+                        for(int ly = 0; ly <= 2; ++ly)
+                        {
+                            for(int lz = 0; lz <= 2; ++lz)
+                            {
+                                neighborhood[lx][ly][lz] = getBlock(
+                                    x + CHUNK_SIZE_X + lx - 1, y + ly - 1, z + CHUNK_SIZE_Z + lz - 1);
+                            }
+                        }
+                    }
+
+                    for(auto &plane : neighborhood)
+                    {
+                        for(auto &row : plane)
+                        {
+                            for(auto &block : row)
+                            {
+                                checksum += HashNeighbor(block.desc->GetBlockID(), block.brightness);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return checksum;
+    }
+
+    /**
+     * @brief 新做法：填充临时方块数组，再以固定步长取得每个可见方块的3x3x3邻居
+     */
+    uint64_t GatherFromScratchVolume(
+        SectionScratchVolume &volume, const Vec3i &sectionInChunk, const Chunk *neighboringChunks[3][3])
+    {
+        auto &blockDescMgr = BlockDescManager::GetInstance();
+        volume.Fill(sectionInChunk, neighboringChunks);
+
+        uint64_t checksum = 0;
+        for(int x = 0; x < CHUNK_SECTION_SIZE_X; ++x)
+        {
+            for(int z = 0; z < CHUNK_SECTION_SIZE_Z; ++z)
+            {
+                for(int y = 0; y < CHUNK_SECTION_SIZE_Y; ++y)
+                {
+                    if(!blockDescMgr.IsVisible(volume.GetBlock({ x, y, z }).id))
+                    {
+                        continue;
+                    }
+
+                    const BlockNeighborhood neighborhood = volume.GetNeighborhood({ x, y, z });
+                    for(int lx = 0; lx <= 2; ++lx)
+                    {
+                        for(int ly = 0; ly <= 2; ++ly)
+                        {
+                            for(int lz = 0; lz <= 2; ++lz)
+                            {
+                                const CompactBlockInstance &block = neighborhood[lx][ly][lz];
+                                checksum += HashNeighbor(block.id, block.brightness);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return checksum;
+    }
+}
+
+int main()
+{
+    GameEnvironment environment;
+    SectionModelCache::GetInstance().SetCapacity(0);
+
+    std::mt19937 rng(42);
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    const Chunk *neighboringChunks[3][3];
+    for(int x = 0; x < 3; ++x)
+    {
+        for(int z = 0; z < 3; ++z)
+        {
+            chunks.push_back(std::make_unique<Chunk>(ChunkPosition{ x - 1, z - 1 }));
+            GenerateChunk(*chunks.back(), rng);
+            neighboringChunks[x][z] = chunks.back().get();
+        }
+    }
+    Chunk &centre = *chunks[4];
+
+    std::printf(
+        "scratch block record: %zu bytes (BlockInstance: %zu bytes)\n",
+        sizeof(CompactBlockInstance), sizeof(BlockInstance));
+
+    constexpr int SECTION_COUNT = CHUNK_SECTION_COUNT_X * CHUNK_SECTION_COUNT_Y * CHUNK_SECTION_COUNT_Z;
+
+    auto forEachSection = [&](const auto &func)
+    {
+        for(int x = 0; x < CHUNK_SECTION_COUNT_X; ++x)
+        {
+            for(int y = 0; y < CHUNK_SECTION_COUNT_Y; ++y)
+            {
+                for(int z = 0; z < CHUNK_SECTION_COUNT_Z; ++z)
+                {
+                    func(Vec3i(x, y, z));
+                }
+            }
+        }
+    };
+
+    SectionScratchVolume volume;
+    Timer timer;
+    for(int i = 0; i < REPEAT_COUNT; ++i)
+    {
+        forEachSection([&](const Vec3i &sectionInChunk)
+        {
+            volume.Fill(sectionInChunk, neighboringChunks);
+        });
+    }
+    double seconds = timer.Seconds();
+    std::printf(
+        "fill: %d sections in %.3f s, %.0f sections/s\n",
+        REPEAT_COUNT * SECTION_COUNT, seconds, REPEAT_COUNT * SECTION_COUNT / seconds);
+
+    // 取得所有可见方块的邻居：逐方块从区块中读取与经由临时方块数组读取
+
+    uint64_t perBlockChecksum = 0;
+    timer.Restart();
+    for(int i = 0; i < REPEAT_COUNT; ++i)
+    {
+        forEachSection([&](const Vec3i &sectionInChunk)
+        {
+            perBlockChecksum += GatherPerBlock(sectionInChunk, neighboringChunks);
+        });
+    }
+    seconds = timer.Seconds();
+    std::printf(
+        "gather neighbors per block: %d sections in %.3f s, %.0f sections/s\n",
+        REPEAT_COUNT * SECTION_COUNT, seconds, REPEAT_COUNT * SECTION_COUNT / seconds);
+
+    uint64_t volumeChecksum = 0;
+    timer.Restart();
+    for(int i = 0; i < REPEAT_COUNT; ++i)
+    {
+        forEachSection([&](const Vec3i &sectionInChunk)
+        {
+            volumeChecksum += GatherFromScratchVolume(volume, sectionInChunk, neighboringChunks);
+        });
+    }
+    seconds = timer.Seconds();
+    std::printf(
+        "gather neighbors from scratch volume: %d sections in %.3f s, %.0f sections/s%s\n",
+        REPEAT_COUNT * SECTION_COUNT, seconds, REPEAT_COUNT * SECTION_COUNT / seconds,
+        perBlockChecksum == volumeChecksum ? "" : " (neighbors differ)");
+
+    timer.Restart();
+    for(int i = 0; i < REPEAT_COUNT; ++i)
+    {
+        forEachSection([&](const Vec3i &sectionInChunk)
+        {
+            centre.RegenerateSectionModel(sectionInChunk, neighboringChunks);
+        });
+    }
+    seconds = timer.Seconds();
+    std::printf(
+        "regenerate: %d sections in %.3f s, %.0f sections/s\n",
+        REPEAT_COUNT * SECTION_COUNT, seconds, REPEAT_COUNT * SECTION_COUNT / seconds);
+
+    // 生成的模型占用的显存，空section不计入平均值
+
+    size_t totalBytes = 0, legacyTotalBytes = 0;
+    int nonEmptyCount = 0;
+    forEachSection([&](const Vec3i &sectionInChunk)
+    {
+        size_t sectionBytes = 0;
+        for(auto &partialModel : centre.GetChunkModel().sectionModel(sectionInChunk)->partialModels)
+        {
+            sectionBytes += partialModel->GetMemoryUsage();
+            legacyTotalBytes += LegacyMemoryUsage(*partialModel);
+        }
+        totalBytes += sectionBytes;
+        nonEmptyCount += sectionBytes ? 1 : 0;
+    });
+    const double sectionCount = (std::max)(nonEmptyCount, 1);
+    std::printf(
+        "model memory: %zu bytes in %d non-empty sections, %.0f bytes/section\n",
+        totalBytes, nonEmptyCount, totalBytes / sectionCount);
+    std::printf(
+        "model memory before packing: %zu bytes, %.0f bytes/section\n",
+        legacyTotalBytes, legacyTotalBytes / sectionCount);
+
+    return 0;
+}
@@ -0,0 +1,97 @@
+﻿#include <VRPG/Game/Player/Camera/DefaultCamera.h>
+#include <VRPG/Game/World/Chunk/ChunkManager.h>
+#include <VRPG/Game/World/Chunk/ChunkRenderer.h>
+#include <VRPG/Game/World/Land/FlatLandGenerator.h>
+
+#include <Common/GameEnvironment.h>
+
+/*
+ * section可见性剔除测试：在地表下方挖出一条封闭的隧道，对若干固定的摄像机位姿，
+ * 统计位于视锥内的section数量与其中视线可达（经section连通关系搜索）的section数量
+ */
+
+using namespace VRPG::Test;
+
+namespace
+{
+    constexpr int LAND_HEIGHT = 64;
+
+    constexpr int TUNNEL_Y_LOW  = 30;
+    constexpr int TUNNEL_Y_HIGH = 34;
+    constexpr int TUNNEL_LENGTH = 60;
+
+    struct CameraPose
+    {
+        const char *name;
+        Vec3 position;
+        float verticalAngle;
+        float horizontalAngle;
+    };
+}
+
+int main()
+{
+    GameEnvironment environment;
+
+    ChunkManagerParams chunkParams;
+    chunkParams.renderDistance     = 4;
+    chunkParams.loadDistance       = 5;
+    chunkParams.unloadDistance     = 6;
+    chunkParams.simulationDistance = 2;
+    chunkParams.fullDetailDistance = 4;
+    chunkParams.halfDetailDistance = 4;
+
+    ChunkManager chunkManager(chunkParams, std::make_unique<FlatLandGenerator>(LAND_HEIGHT));
+    chunkManager.SetCentreChunk({ 0, 0 });
+    for(int x = -chunkParams.loadDistance; x <= chunkParams.loadDistance; ++x)
+    {
+        for(int z = -chunkParams.loadDistance; z <= chunkParams.loadDistance; ++z)
+        {
+            chunkManager.GetBlockID({ x * CHUNK_SIZE_X, 0, z * CHUNK_SIZE_Z });
+        }
+    }
+
+    chunkManager.SetBlocks(
+        { -TUNNEL_LENGTH, TUNNEL_Y_LOW, -2 }, { TUNNEL_LENGTH, TUNNEL_Y_HIGH, 2 }, BLOCK_ID_VOID, BlockOrientation());
+    chunkManager.UpdateLight();
+    chunkManager.UpdateChunkModels();
+
+    const float PI = agz::math::PI_f;
+    const CameraPose poses[] = {
+        { "surface, horizontal",   { 0.5f, LAND_HEIGHT + 2.5f, 0.5f },   0,       0      },
+        { "surface, looking down", { 0.5f, LAND_HEIGHT + 2.5f, 0.5f },   -PI / 3, 0      },
+        { "surface, looking up",   { 0.5f, LAND_HEIGHT + 2.5f, 0.5f },   PI / 3,  PI / 4 },
+        { "tunnel, along",         { 0.5f, TUNNEL_Y_LOW + 1.5f, 0.5f }, 0,       0      },
+        { "tunnel, across",        { 0.5f, TUNNEL_Y_LOW + 1.5f, 0.5f }, 0,       PI / 2 },
+        { "tunnel, looking up",    { 0.5f, TUNNEL_Y_LOW + 1.5f, 0.5f }, PI / 3,  0      },
+    };
+
+    ChunkRenderer renderer;
+    DefaultCamera camera;
+    camera.SetWOverH(640.0f / 480);
+    camera.SetClipDistance(0.1f, float(chunkParams.renderDistance * CHUNK_SIZE_X));
+
+    for(auto &pose : poses)
+    {
+        camera.SetPosition(pose.position);
+        camera.SetDirection(pose.verticalAngle, pose.horizontalAngle);
+
+        Timer timer;
+        renderer.Clear();
+        chunkManager.FillRenderer(renderer, camera.GetPosition());
+        renderer.Done();
+        const double fillMs = timer.Milliseconds();
+
+        renderer.UpdateCameraVisibility(camera);
+        auto statistics = renderer.GetCameraVisibilityStatistics();
+
+        std::printf(
+            "%-22s: %4d visible / %4d in frustum (%5.1f%% culled by connectivity), fill %.3f ms\n",
+            pose.name, statistics.visibleSectionCount, statistics.frustumSectionCount,
+            statistics.frustumSectionCount ?
+                100.0 * (statistics.frustumSectionCount - statistics.visibleSectionCount) / statistics.frustumSectionCount : 0.0,
+            fillMs);
+    }
+
+    return 0;
+}
@@ -0,0 +1,178 @@
+﻿#include <random>
+
+#include <VRPG/Game/World/Chunk/SectionScratchVolume.h>
+
+#include <Common/GameEnvironment.h>
+
+/*
+ * 实体方块剔除性能测试：生成一个布满随机洞穴的石头区块，对其中所有section比较两种找出可能存在可见面的方块的方法：
+ * 一是SectionScratchVolume在填充时按列构建的位掩码，二是逐方块检查六个邻居是否都是实体方块。
+ * 输出两者的耗时与找到的方块数量（两者应当相同），以及完整生成模型时每秒处理的section数量
+ */
+
+using namespace VRPG::Test;
+
+namespace
+{
+    constexpr int REPEAT_COUNT = 20;
+
+    constexpr double CAVE_RATIO = 0.1;
+
+    void GenerateCarvedStone(Chunk &chunk, std::mt19937 &rng)
+    {
+        const BlockID stone = GameEnvironment::GetID(BuiltinBlockType::Stone);
+
+        std::bernoulli_distribution isCaveDist(CAVE_RATIO);
+        for(int x = 0; x < CHUNK_SIZE_X; ++x)
+        {
+            for(int z = 0; z < CHUNK_SIZE_Z; ++z)
+            {
+                for(int y = 0; y < CHUNK_SIZE_Y; ++y)
+                {
+                    const Vec3i blockInChunk = { x, y, z };
+                    chunk.SetBrightness(blockInChunk, BLOCK_BRIGHTNESS_MIN);
+                    if(!isCaveDist(rng))
+                    {
+                        chunk.SetID(blockInChunk, stone, {});
+                    }
+                }
+            }
+        }
+    }
+
+    int CountExposedByMask(const SectionScratchVolume &volume) noexcept
+    {
+        int count = 0;
+        for(int x = 0; x < CHUNK_SECTION_SIZE_X; ++x)
+        {
+            for(int z = 0; z < CHUNK_SECTION_SIZE_Z; ++z)
+            {
+                uint32_t exposedMask = volume.GetExposedMask(x, z);
+                for(; exposedMask; exposedMask &= exposedMask - 1)
+                {
+                    ++count;
+                }
+            }
+        }
+        return count;
+    }
+
+    int CountExposedPerBlock(const SectionScratchVolume &volume) noexcept
+    {
+        auto &blockDescMgr = BlockDescManager::GetInstance();
+        auto isSolidBox = [&](const Vec3i &blockInSection)
+        {
+            return blockDescMgr.IsSolidBox(volume.GetBlock(blockInSection).id);
+        };
+
+        int count = 0;
+        for(int x = 0; x < CHUNK_SECTION_SIZE_X; ++x)
+        {
+            for(int z = 0; z < CHUNK_SECTION_SIZE_Z; ++z)
+            {
+                for(int y = 0; y < CHUNK_SECTION_SIZE_Y; ++y)
+                {
+                    const bool isBuried =
+                        isSolidBox({ x, y, z }) &&
+                        isSolidBox({ x + 1, y, z }) && isSolidBox({ x - 1, y, z }) &&
+                        isSolidBox({ x, y + 1, z }) && isSolidBox({ x, y - 1, z }) &&
+                        isSolidBox({ x, y, z + 1 }) && isSolidBox({ x, y, z - 1 });
+                    count += isBuried ? 0 : 1;
+                }
+            }
+        }
+        return count;
+    }
+}
+
+int main()
+{
+    GameEnvironment environment;
+    SectionModelCache::GetInstance().SetCapacity(0);
+
+    std::mt19937 rng(42);
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    const Chunk *neighboringChunks[3][3];
+    for(int x = 0; x < 3; ++x)
+    {
+        for(int z = 0; z < 3; ++z)
+        {
+            chunks.push_back(std::make_unique<Chunk>(ChunkPosition{ x - 1, z - 1 }));
+            GenerateCarvedStone(*chunks.back(), rng);
+            neighboringChunks[x][z] = chunks.back().get();
+        }
+    }
+    Chunk &centre = *chunks[4];
+
+    constexpr int SECTION_COUNT = CHUNK_SECTION_COUNT_X * CHUNK_SECTION_COUNT_Y * CHUNK_SECTION_COUNT_Z;
+
+    std::vector<SectionScratchVolume> volumes(SECTION_COUNT);
+    std::vector<Vec3i> sections;
+    for(int x = 0; x < CHUNK_SECTION_COUNT_X; ++x)
+    {
+        for(int y = 0; y < CHUNK_SECTION_COUNT_Y; ++y)
+        {
+            for(int z = 0; z < CHUNK_SECTION_COUNT_Z; ++z)
+            {
+                volumes[sections.size()].Fill({ x, y, z }, neighboringChunks);
+                sections.push_back({ x, y, z });
+            }
+        }
+    }
+
+    int maskCount = 0;
+    Timer timer;
+    for(int i = 0; i < REPEAT_COUNT; ++i)
+    {
+        maskCount = 0;
+        for(auto &volume : volumes)
+        {
+            maskCount += CountExposedByMask(volume);
+        }
+    }
+    const double maskSeconds = timer.Seconds();
+
+    int perBlockCount = 0;
+    timer.Restart();
+    for(int i = 0; i < REPEAT_COUNT; ++i)
+    {
+        perBlockCount = 0;
+        for(auto &volume : volumes)
+        {
+            perBlockCount += CountExposedPerBlock(volume);
+        }
+    }
+    const double perBlockSeconds = timer.Seconds();
+
+    std::printf(
+        "blocks per chunk: %d, cave ratio: %.2f\n",
+        SECTION_COUNT * CHUNK_SECTION_SIZE_X * CHUNK_SECTION_SIZE_Y * CHUNK_SECTION_SIZE_Z, CAVE_RATIO);
+    std::printf("bitmask:   %d exposed blocks, %.3f ms/chunk\n", maskCount, 1000 * maskSeconds / REPEAT_COUNT);
+    std::printf("per block: %d exposed blocks, %.3f ms/chunk\n", perBlockCount, 1000 * perBlockSeconds / REPEAT_COUNT);
+
+    // 位掩码在Fill中构建，因此这里同时给出包含拷贝与掩码构建的填充耗时
+
+    SectionScratchVolume volume;
+    timer.Restart();
+    for(int i = 0; i < REPEAT_COUNT; ++i)
+    {
+        for(auto &sectionInChunk : sections)
+        {
+            volume.Fill(sectionInChunk, neighboringChunks);
+        }
+    }
+    std::printf("fill with masks: %.3f ms/chunk\n", 1000 * timer.Seconds() / REPEAT_COUNT);
+
+    timer.Restart();
+    for(int i = 0; i < REPEAT_COUNT; ++i)
+    {
+        for(auto &sectionInChunk : sections)
+        {
+            centre.RegenerateSectionModel(sectionInChunk, neighboringChunks);
+        }
+    }
+    const double seconds = timer.Seconds();
+    std::printf("regenerate: %.0f sections/s\n", REPEAT_COUNT * SECTION_COUNT / seconds);
+
+    return maskCount == perBlockCount ? 0 : 1;
+}
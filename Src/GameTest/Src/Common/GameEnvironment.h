@@ -0,0 +1,51 @@
+﻿#pragma once
+
+#include <VRPG/Game/Config/GlobalConfig.h>
+#include <VRPG/Game/World/Block/BlockDescription.h>
+#include <VRPG/Game/World/Block/BlockEffect.h>
+#include <VRPG/Game/World/Block/BuiltinBlock.h>
+
+#include "TestCommon.h"
+
+VRPG_TEST_BEGIN
+
+/**
+ * @brief 与Main中相同的游戏运行环境：读取配置、创建窗口（D3D设备）并注册内置方块
+ *
+ * 区块加载会生成section model，因此使用ChunkManager的测试需要先创建该环境
+ */
+class GameEnvironment : public agz::misc::uncopyable_t
+{
+    Base::Window window_;
+
+public:
+
+    GameEnvironment()
+    {
+        GLOBAL_CONFIG.LoadFromFile("config.cfg");
+        GLOBAL_CONFIG.ASSET_PATH.LoadFromFile("asset.cfg");
+
+        Base::WindowDesc desc;
+        desc.clientWidth  = 640;
+        desc.clientHeight = 480;
+        desc.fullscreen   = false;
+        desc.vsync        = false;
+        window_.Initialize(desc);
+
+        BuiltinBlockTypeManager::GetInstance().RegisterBuiltinBlockTypes();
+    }
+
+    ~GameEnvironment()
+    {
+        BuiltinBlockTypeManager::GetInstance().Clear();
+        BlockEffectManager     ::GetInstance().Clear();
+        BlockDescManager       ::GetInstance().Clear();
+    }
+
+    static BlockID GetID(BuiltinBlockType type) noexcept
+    {
+        return BuiltinBlockTypeManager::GetInstance().GetID(type);
+    }
+};
+
+VRPG_TEST_END
@@ -0,0 +1,27 @@
+﻿#pragma once
+
+#include "TestCommon.h"
+
+VRPG_TEST_BEGIN
+
+/**
+ * @brief 改用PackedBoxVertex之前diffuse box面片的顶点格式，配合32位下标，仅用于对比显存占用
+ */
+struct LegacyBoxVertex
+{
+    Vec3 position;
+    Vec2 texCoord;
+    Vec3 normal;
+    Vec4 brightness;
+    uint32_t texIndex = 0;
+};
+
+/**
+ * @brief 以旧的顶点格式和32位下标存储同样的网格所需的显存字节数
+ */
+inline size_t LegacyBoxMeshMemoryUsage(size_t vertexCount, size_t indexCount) noexcept
+{
+    return vertexCount * sizeof(LegacyBoxVertex) + indexCount * sizeof(uint32_t);
+}
+
+VRPG_TEST_END
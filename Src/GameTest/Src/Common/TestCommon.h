@@ -0,0 +1,76 @@
+﻿#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+#include <VRPG/Game/Common.h>
+
+#define VRPG_TEST_BEGIN namespace VRPG::Test {
+#define VRPG_TEST_END   }
+
+VRPG_TEST_BEGIN
+
+using namespace World;
+
+/**
+ * @brief 当前测试程序中失败的检查数量
+ */
+inline int &FailureCount() noexcept
+{
+    static int count = 0;
+    return count;
+}
+
+/**
+ * @brief 所有检查都通过时返回0，作为测试程序的返回值
+ */
+inline int TestResult() noexcept
+{
+    if(FailureCount())
+    {
+        std::printf("%d check(s) failed\n", FailureCount());
+        return 1;
+    }
+    std::printf("all checks passed\n");
+    return 0;
+}
+
+/**
+ * @brief 计时器，用于测试与性能测试中的耗时统计
+ */
+class Timer
+{
+    StdClock::time_point start_ = StdClock::now();
+
+public:
+
+    void Restart() noexcept
+    {
+        start_ = StdClock::now();
+    }
+
+    double Milliseconds() const noexcept
+    {
+        return std::chrono::duration<double, std::milli>(StdClock::now() - start_).count();
+    }
+
+    double Seconds() const noexcept
+    {
+        return std::chrono::duration<double>(StdClock::now() - start_).count();
+    }
+};
+
+VRPG_TEST_END
+
+/**
+ * @brief 检查条件是否成立，不成立时输出位置并记录一次失败，不中断测试
+ */
+#define VRPG_CHECK(COND)                                                                        \
+    do                                                                                          \
+    {                                                                                           \
+        if(!(COND))                                                                             \
+        {                                                                                       \
+            std::printf("check failed: %s (%s:%d)\n", #COND, __FILE__, __LINE__);               \
+            ++::VRPG::Test::FailureCount();                                                     \
+        }                                                                                       \
+    } while(false)
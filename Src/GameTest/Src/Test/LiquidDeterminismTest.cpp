@@ -0,0 +1,263 @@
+﻿#include <random>
+#include <thread>
+
+#include <VRPG/Game/World/BlockUpdater/LiquidSimulation.h>
+
+#include <Common/GameEnvironment.h>
+
+/*
+ * LiquidSimulation的确定性测试：在跨越多个区块的水池中放置两种会相互反应的液体，
+ * 分别用单线程和多线程执行1000步模拟，两者每一步产生的改变及最终的方块状态都应完全相同
+ */
+
+using namespace VRPG::Test;
+
+namespace
+{
+    constexpr int TICK_COUNT = 1000;
+
+    constexpr int FLOOR_Y = 10;
+    constexpr int BASIN_LOW  = -40;
+    constexpr int BASIN_HIGH = 40;
+
+    using Cell    = LiquidSimulation::Cell;
+    using Section = LiquidSimulation::Section;
+
+    /**
+     * @brief 与水相遇时凝固为石头的液体
+     */
+    class TestLiquidDescription : public BlockDescription
+    {
+        class Liquid : public LiquidDescription
+        {
+        public:
+
+            BlockID reactionResult = BLOCK_ID_VOID;
+
+            NewBlockInstance ReactWith(const BlockDescription *, bool, bool) const override
+            {
+                return { reactionResult, BlockExtraData(), BlockOrientation() };
+            }
+        };
+
+        Liquid liquid_;
+
+    public:
+
+        explicit TestLiquidDescription(BlockID reactionResult)
+        {
+            liquid_.isLiquid       = true;
+            liquid_.sourceLevel    = 5;
+            liquid_.reactionResult = reactionResult;
+        }
+
+        const char *GetName() const override { return "test_liquid"; }
+
+        FaceVisibilityType GetFaceVisibility(Direction) const noexcept override { return FaceVisibilityType::Transparent; }
+
+        bool IsFullOpaque() const noexcept override { return false; }
+
+        bool IsLightSource() const noexcept override { return false; }
+
+        BlockBrightness LightAttenuation() const noexcept override { return { 1, 1, 1, 1 }; }
+
+        BlockBrightness InitialBrightness() const noexcept override { return BLOCK_BRIGHTNESS_MIN; }
+
+        void AddBlockModel(ModelBuilderSet &, const Vec3i &, const BlockNeighborhood) const override { }
+
+        bool HasExtraData() const noexcept override { return true; }
+
+        BlockExtraData CreateExtraData() const override { return MakeLiquidExtraData(liquid_.sourceLevel); }
+
+        const LiquidDescription *GetLiquid() const noexcept override { return &liquid_; }
+    };
+
+    /**
+     * @brief 以section为单位稠密存放的测试世界
+     */
+    class World
+    {
+        std::unordered_map<Vec3i, Section> sections_;
+
+    public:
+
+        Cell Get(const Vec3i &globalBlock) const
+        {
+            auto it = sections_.find(GlobalBlockToGlobalSection(globalBlock));
+            if(it == sections_.end())
+            {
+                return Cell();
+            }
+            return it->second.cells[LiquidSimulation::CellIndex(GlobalBlockToBlockInSection(globalBlock))];
+        }
+
+        void Set(const Vec3i &globalBlock, const Cell &cell)
+        {
+            Section &section = sections_[GlobalBlockToGlobalSection(globalBlock)];
+            section.cells[LiquidSimulation::CellIndex(GlobalBlockToBlockInSection(globalBlock))] = cell;
+        }
+
+        void Load(const Vec3i &globalSection, Section &section) const
+        {
+            auto it = sections_.find(globalSection);
+            section = it != sections_.end() ? it->second : Section();
+        }
+
+        bool operator==(const World &rhs) const
+        {
+            if(sections_.size() != rhs.sections_.size())
+            {
+                return false;
+            }
+            for(auto &[position, section] : sections_)
+            {
+                auto it = rhs.sections_.find(position);
+                if(it == rhs.sections_.end())
+                {
+                    return false;
+                }
+                for(int i = 0; i < LiquidSimulation::SECTION_CELL_COUNT; ++i)
+                {
+                    if(section.cells[i].id != it->second.cells[i].id || section.cells[i].level != it->second.cells[i].level)
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+    };
+
+    void ActivateNeighborhood(std::vector<Vec3i> &activeBlocks, const Vec3i &position)
+    {
+        activeBlocks.push_back(position);
+        for(Direction direction : { PositiveX, NegativeX, PositiveZ, NegativeZ, PositiveY, NegativeY })
+        {
+            activeBlocks.push_back(position + DirectionToVectori(direction));
+        }
+    }
+
+    struct SimulationResult
+    {
+        World world;
+        std::vector<size_t> changeCounts;
+        size_t reactionCount = 0;
+    };
+
+    SimulationResult Simulate(int workerCount, BlockID stone, BlockID water, BlockID testLiquid)
+    {
+        auto &blockDescMgr = BlockDescManager::GetInstance();
+        const LiquidLevel waterSource = blockDescMgr.GetBlockDescription(water)->GetLiquid()->sourceLevel;
+        const LiquidLevel testSource  = blockDescMgr.GetBlockDescription(testLiquid)->GetLiquid()->sourceLevel;
+
+        SimulationResult result;
+        World &world = result.world;
+
+        // 跨越多个区块的水池：地面、四周的墙壁以及池中的几根柱子
+
+        for(int x = BASIN_LOW - 1; x <= BASIN_HIGH; ++x)
+        {
+            for(int z = BASIN_LOW - 1; z <= BASIN_HIGH; ++z)
+            {
+                world.Set({ x, FLOOR_Y, z }, { stone, 0 });
+
+                const bool isWall = x == BASIN_LOW - 1 || x == BASIN_HIGH || z == BASIN_LOW - 1 || z == BASIN_HIGH;
+                const bool isPillar = x % 13 == 0 && z % 11 == 0;
+                if(isWall || isPillar)
+                {
+                    for(int y = FLOOR_Y + 1; y <= FLOOR_Y + 3; ++y)
+                    {
+                        world.Set({ x, y, z }, { stone, 0 });
+                    }
+                }
+            }
+        }
+
+        // 两种液体的源头分别位于不同的区块中，流动时会在区块边界附近相遇
+
+        const Vec3i waterSources[] = { { -20, FLOOR_Y + 2, -20 }, { 5, FLOOR_Y + 3, 30 }, { 31, FLOOR_Y + 1, -3 } };
+        const Vec3i testSources[]  = { { 20, FLOOR_Y + 1, 20 }, { -31, FLOOR_Y + 2, 14 } };
+
+        std::vector<Vec3i> activeBlocks;
+        for(auto &position : waterSources)
+        {
+            world.Set(position, { water, waterSource });
+            ActivateNeighborhood(activeBlocks, position);
+        }
+        for(auto &position : testSources)
+        {
+            world.Set(position, { testLiquid, testSource });
+            ActivateNeighborhood(activeBlocks, position);
+        }
+
+        ParallelForPool workerPool(workerCount);
+        LiquidSimulation simulation;
+
+        for(int tick = 0; tick < TICK_COUNT; ++tick)
+        {
+            // 中途移除一个水源，使已经扩散的水逐渐消退
+
+            if(tick == TICK_COUNT / 2)
+            {
+                world.Set(waterSources[0], Cell());
+                ActivateNeighborhood(activeBlocks, waterSources[0]);
+            }
+
+            auto &changes = simulation.Step(activeBlocks, [&](const Vec3i &globalSection, Section &section)
+            {
+                world.Load(globalSection, section);
+            }, workerPool);
+            activeBlocks.clear();
+
+            result.changeCounts.push_back(changes.size());
+            for(auto &change : changes)
+            {
+                if(change.block.id == stone)
+                {
+                    ++result.reactionCount;
+                }
+                world.Set(change.position, LiquidSimulation::MakeCell(change.block.id, change.block.extraData));
+                ActivateNeighborhood(activeBlocks, change.position);
+            }
+        }
+
+        return result;
+    }
+}
+
+int main()
+{
+    GameEnvironment environment;
+
+    const BlockID stone = GameEnvironment::GetID(BuiltinBlockType::Stone);
+    const BlockID water = GameEnvironment::GetID(BuiltinBlockType::Water);
+    const BlockID testLiquid = BlockDescManager::GetInstance().RegisterBlockDescription(
+        std::make_shared<TestLiquidDescription>(stone));
+
+    const int workerCount = (std::max)(3, int(std::thread::hardware_concurrency()) - 1);
+
+    Timer timer;
+    const SimulationResult single = Simulate(0, stone, water, testLiquid);
+    const double singleMs = timer.Milliseconds();
+
+    timer.Restart();
+    const SimulationResult multi = Simulate(workerCount, stone, water, testLiquid);
+    const double multiMs = timer.Milliseconds();
+
+    size_t totalChanges = 0;
+    for(size_t count : single.changeCounts)
+    {
+        totalChanges += count;
+    }
+
+    std::printf(
+        "%d ticks, %zu changes, %zu reactions; 1 thread %.2f ms, %d threads %.2f ms\n",
+        TICK_COUNT, totalChanges, single.reactionCount, singleMs, workerCount + 1, multiMs);
+
+    VRPG_CHECK(totalChanges > 0);
+    VRPG_CHECK(single.reactionCount > 0);
+    VRPG_CHECK(single.changeCounts == multi.changeCounts);
+    VRPG_CHECK(single.world == multi.world);
+
+    return TestResult();
+}
@@ -0,0 +1,158 @@
+﻿#include <random>
+
+#include <VRPG/Game/World/Block/BasicEffect/PackedBoxVertex.h>
+#include <VRPG/Game/World/Block/BlockBrightness.h>
+
+#include <Common/LegacyBoxVertex.h>
+
+/*
+ * PackedBoxVertex的编解码测试：位置的定点量化误差、法线下标、合并面片的纹理坐标、纹理下标，
+ * 以及以平方根曲线编码的亮度在解码后的误差和各亮度等级之间的可区分性
+ */
+
+using namespace VRPG::Test;
+
+namespace
+{
+    const Vec2 DEFAULT_TEXCOORD = Vec2(0);
+    const Vec4 DEFAULT_BRIGHTNESS = Vec4(1);
+
+    UnpackedBoxVertex RoundTrip(
+        const Vec3 &position, Direction normal, const Vec2 &texCoord, uint32_t texIndex, const Vec4 &brightness)
+    {
+        return UnpackBoxVertex(PackBoxVertex(position, normal, texCoord, texIndex, brightness));
+    }
+
+    void TestPosition()
+    {
+        // 方块角点和半方块处的坐标可被精确表示
+
+        for(int x = 0; x <= 32; ++x)
+        {
+            for(int half = 0; half < 2; ++half)
+            {
+                const float coord = x + 0.5f * half;
+                const Vec3 position = { coord, 255 - coord, coord };
+                const UnpackedBoxVertex vertex = RoundTrip(position, PositiveX, DEFAULT_TEXCOORD, 0, DEFAULT_BRIGHTNESS);
+                VRPG_CHECK(vertex.position == position);
+            }
+        }
+
+        // 任意坐标的误差不超过半个量化步长
+
+        const float maxError = 0.5f / PACKED_BOX_VERTEX_POSITION_SCALE + 1e-5f;
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> dist(0, 255.99f);
+        for(int i = 0; i < 100000; ++i)
+        {
+            const Vec3 position = { dist(rng), dist(rng), dist(rng) };
+            const Vec3 decoded = RoundTrip(position, PositiveX, DEFAULT_TEXCOORD, 0, DEFAULT_BRIGHTNESS).position;
+            for(int axis = 0; axis < 3; ++axis)
+            {
+                VRPG_CHECK(std::abs(decoded[axis] - position[axis]) <= maxError);
+            }
+        }
+    }
+
+    void TestNormalAndTexture()
+    {
+        for(Direction normal : { PositiveX, NegativeX, PositiveY, NegativeY, PositiveZ, NegativeZ })
+        {
+            VRPG_CHECK(RoundTrip(Vec3(1), normal, DEFAULT_TEXCOORD, 0, DEFAULT_BRIGHTNESS).normal == normal);
+        }
+
+        // 合并面片的纹理坐标为±16以内的整数，单个面片的纹理坐标为单位正方形的四个角
+
+        for(int u = -16; u <= 16; ++u)
+        {
+            for(int v = -16; v <= 16; ++v)
+            {
+                const Vec2 texCoord = Vec2(float(u), float(v));
+                VRPG_CHECK(RoundTrip(Vec3(1), PositiveY, texCoord, 0, DEFAULT_BRIGHTNESS).texCoord == texCoord);
+            }
+        }
+
+        for(uint32_t texIndex : { 0u, 1u, 255u, 256u, 4097u, 65535u })
+        {
+            VRPG_CHECK(RoundTrip(Vec3(1), PositiveY, DEFAULT_TEXCOORD, texIndex, DEFAULT_BRIGHTNESS).texIndex == texIndex);
+        }
+    }
+
+    void TestBrightness()
+    {
+        // 任意亮度解码后的误差不超过1 / 255
+
+        const float maxError = 1.0f / 255;
+        for(int i = 0; i <= 100000; ++i)
+        {
+            const float x = i / 100000.0f;
+            const Vec4 brightness = Vec4(x, 1 - x, x * x, 0.5f * x);
+            const Vec4 decoded = RoundTrip(Vec3(1), PositiveY, DEFAULT_TEXCOORD, 0, brightness).brightness;
+            for(int c = 0; c < 4; ++c)
+            {
+                VRPG_CHECK(std::abs(decoded[c] - brightness[c]) <= maxError);
+            }
+        }
+
+        // 实际的顶点亮度由1至4个方块亮度等级平均而来，这些值同样满足上述误差
+
+        for(int a = 0; a <= BLOCK_BRIGHTNESS_COMPONENT_LIMIT; ++a)
+        {
+            for(int b = 0; b <= BLOCK_BRIGHTNESS_COMPONENT_LIMIT; ++b)
+            {
+                const uint8_t la = uint8_t(a), lb = uint8_t(b);
+                const Vec4 vertexBrightness[] = {
+                    ComputeVertexBrightness(BlockBrightness{ la, la, la, la }),
+                    ComputeVertexBrightness(BlockBrightness{ la, la, la, la }, BlockBrightness{ lb, lb, lb, lb }),
+                    ComputeVertexBrightness(
+                        BlockBrightness{ la, la, la, la }, BlockBrightness{ lb, lb, lb, lb }, BLOCK_BRIGHTNESS_MIN),
+                    ComputeVertexBrightness(
+                        BlockBrightness{ la, la, la, la }, BlockBrightness{ lb, lb, lb, lb },
+                        BLOCK_BRIGHTNESS_MIN, BLOCK_BRIGHTNESS_SKY)
+                };
+                for(auto &brightness : vertexBrightness)
+                {
+                    const Vec4 decoded = RoundTrip(Vec3(1), PositiveY, DEFAULT_TEXCOORD, 0, brightness).brightness;
+                    for(int c = 0; c < 4; ++c)
+                    {
+                        VRPG_CHECK(std::abs(decoded[c] - brightness[c]) <= maxError);
+                    }
+                }
+            }
+        }
+
+        // 解码结果再次编码时保持不变
+
+        for(int code = 0; code < 256; ++code)
+        {
+            PackedBoxVertex vertex = PackBoxVertex(Vec3(1), PositiveY, DEFAULT_TEXCOORD, 0, DEFAULT_BRIGHTNESS);
+            vertex.brightness[0] = uint8_t(code);
+            const Vec4 decoded = UnpackBoxVertex(vertex).brightness;
+            VRPG_CHECK(PackBoxVertex(Vec3(1), PositiveY, DEFAULT_TEXCOORD, 0, decoded).brightness[0] == code);
+        }
+
+        // 所有方块亮度等级编码后仍两两不同，且保持顺序
+
+        int lastCode = -1;
+        for(int level = 0; level <= BLOCK_BRIGHTNESS_COMPONENT_LIMIT; ++level)
+        {
+            const uint8_t l = uint8_t(level);
+            const Vec4 brightness = ComputeVertexBrightness(BlockBrightness{ l, l, l, l });
+            const PackedBoxVertex vertex = PackBoxVertex(Vec3(1), PositiveY, DEFAULT_TEXCOORD, 0, brightness);
+            VRPG_CHECK(int(vertex.brightness[0]) > lastCode);
+            lastCode = vertex.brightness[0];
+        }
+    }
+}
+
+int main()
+{
+    TestPosition();
+    TestNormalAndTexture();
+    TestBrightness();
+
+    std::printf(
+        "box vertex: %zu bytes packed, %zu bytes before packing\n", sizeof(PackedBoxVertex), sizeof(LegacyBoxVertex));
+
+    return TestResult();
+}
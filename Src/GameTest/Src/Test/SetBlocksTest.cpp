@@ -0,0 +1,173 @@
+﻿#include <random>
+
+#include <VRPG/Game/World/Chunk/ChunkManager.h>
+#include <VRPG/Game/World/Land/FlatLandGenerator.h>
+
+#include <Common/GameEnvironment.h>
+
+/*
+ * 比较逐个调用SetBlockID与批量调用SetBlocks的结果：在32^3的立方体区域上执行相同的修改，
+ * 光照收敛后两者在立方体及其周围16格内的方块id与亮度应完全一致
+ */
+
+using namespace VRPG::Test;
+
+namespace
+{
+    constexpr int LAND_HEIGHT = 20;
+
+    const Vec3i CUBE_LOW  = { -16, LAND_HEIGHT + 1, -16 };
+    const Vec3i CUBE_HIGH = { 15, LAND_HEIGHT + 32, 15 };
+
+    constexpr int COMPARE_MARGIN = 16;
+
+    std::unique_ptr<ChunkManager> CreateChunkManager()
+    {
+        ChunkManagerParams params;
+        params.renderDistance     = 1;
+        params.loadDistance       = 2;
+        params.unloadDistance     = 3;
+        params.simulationDistance = 1;
+        params.fullDetailDistance = 1;
+        params.halfDetailDistance = 1;
+
+        auto chunkManager = std::make_unique<ChunkManager>(params, std::make_unique<FlatLandGenerator>(LAND_HEIGHT));
+        chunkManager->SetCentreChunk({ 0, 0 });
+        return chunkManager;
+    }
+
+    template<typename Func>
+    void ForEachBlockInCube(int margin, Func &&func)
+    {
+        for(int x = CUBE_LOW.x - margin; x <= CUBE_HIGH.x + margin; ++x)
+        {
+            for(int y = (std::max)(CUBE_LOW.y - margin, 0); y <= CUBE_HIGH.y + margin; ++y)
+            {
+                for(int z = CUBE_LOW.z - margin; z <= CUBE_HIGH.z + margin; ++z)
+                {
+                    func(Vec3i(x, y, z));
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief 比较两个ChunkManager在立方体附近的方块id与亮度，返回不一致的方块数量
+     */
+    int CountMismatches(ChunkManager &single, ChunkManager &batch)
+    {
+        int mismatchCount = 0;
+        ForEachBlockInCube(COMPARE_MARGIN, [&](const Vec3i &pos)
+        {
+            if(single.GetBlockID(pos) != batch.GetBlockID(pos) ||
+               single.GetBlockBrightness(pos) != batch.GetBlockBrightness(pos))
+            {
+                if(!mismatchCount)
+                {
+                    std::printf("first mismatch at (%d, %d, %d)\n", pos.x, pos.y, pos.z);
+                }
+                ++mismatchCount;
+            }
+        });
+        return mismatchCount;
+    }
+
+    /**
+     * @brief 分别以SetBlockID与SetBlocks执行一组修改，光照收敛后比较结果
+     */
+    void CompareEdits(const char *name, ChunkManager &single, ChunkManager &batch, const std::vector<BlockEdit> &edits)
+    {
+        Timer timer;
+        for(auto &edit : edits)
+        {
+            single.SetBlockID(edit.globalBlock, edit.block.id, edit.block.orientation);
+        }
+        const double singleSetMs = timer.Milliseconds();
+        single.UpdateLight();
+        const double singleTotalMs = timer.Milliseconds();
+
+        timer.Restart();
+        batch.SetBlocks(edits);
+        const double batchSetMs = timer.Milliseconds();
+        batch.UpdateLight();
+        const double batchTotalMs = timer.Milliseconds();
+
+        std::printf(
+            "%s: %zu edits, SetBlockID %.2f ms (with light %.2f ms), SetBlocks %.2f ms (with light %.2f ms)\n",
+            name, edits.size(), singleSetMs, singleTotalMs, batchSetMs, batchTotalMs);
+
+        const int mismatchCount = CountMismatches(single, batch);
+        if(mismatchCount)
+        {
+            std::printf("%s: %d mismatched blocks\n", name, mismatchCount);
+        }
+        VRPG_CHECK(mismatchCount == 0);
+    }
+
+    std::vector<BlockEdit> FillCube(BlockID id)
+    {
+        std::vector<BlockEdit> edits;
+        ForEachBlockInCube(0, [&](const Vec3i &pos)
+        {
+            edits.push_back({ pos, { id, {}, BlockOrientation() } });
+        });
+        return edits;
+    }
+}
+
+int main()
+{
+    GameEnvironment environment;
+
+    const BlockID stone     = GameEnvironment::GetID(BuiltinBlockType::Stone);
+    const BlockID glass     = GameEnvironment::GetID(BuiltinBlockType::WhiteGlass);
+    const BlockID glowStone = GameEnvironment::GetID(BuiltinBlockType::GlowStone);
+
+    auto single = CreateChunkManager();
+    auto batch  = CreateChunkManager();
+
+    // 整块填充石头，再整块清空
+
+    CompareEdits("fill stone", *single, *batch, FillCube(stone));
+    CompareEdits("clear stone", *single, *batch, FillCube(BLOCK_ID_VOID));
+
+    // 在玻璃内部放置光源，再整块清空：被移除的光源和其残余光照都在区域内部
+
+    CompareEdits("fill glass", *single, *batch, FillCube(glass));
+
+    std::vector<BlockEdit> lights;
+    for(int x = CUBE_LOW.x + 4; x <= CUBE_HIGH.x - 4; x += 8)
+    {
+        for(int y = CUBE_LOW.y + 4; y <= CUBE_HIGH.y - 4; y += 8)
+        {
+            for(int z = CUBE_LOW.z + 4; z <= CUBE_HIGH.z - 4; z += 8)
+            {
+                lights.push_back({ { x, y, z }, { glowStone, {}, BlockOrientation() } });
+            }
+        }
+    }
+    CompareEdits("place lights", *single, *batch, lights);
+    CompareEdits("clear glass with lights", *single, *batch, FillCube(BLOCK_ID_VOID));
+
+    // 随机修改，包含对同一方块的重复修改
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> distX(CUBE_LOW.x, CUBE_HIGH.x);
+    std::uniform_int_distribution<int> distY(CUBE_LOW.y, CUBE_HIGH.y);
+    std::uniform_int_distribution<int> distZ(CUBE_LOW.z, CUBE_HIGH.z);
+    std::uniform_int_distribution<int> distBlock(0, 3);
+    const BlockID randomBlocks[] = { BLOCK_ID_VOID, stone, glass, glowStone };
+
+    for(int round = 0; round < 4; ++round)
+    {
+        std::vector<BlockEdit> edits;
+        for(int i = 0; i < 8192; ++i)
+        {
+            const Vec3i pos = { distX(rng), distY(rng), distZ(rng) };
+            edits.push_back({ pos, { randomBlocks[distBlock(rng)], {}, BlockOrientation() } });
+        }
+        CompareEdits("random edits", *single, *batch, edits);
+    }
+
+    return TestResult();
+}
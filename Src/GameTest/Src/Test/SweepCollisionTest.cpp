@@ -0,0 +1,191 @@
+﻿#include <random>
+
+#include <VRPG/Game/Physics/CollisionPrimitive.h>
+
+#include <Common/TestCommon.h>
+
+/*
+ * 比较逐AABB扫掠的Collision::AxisSweep与原先只检查终点重叠的ResolveCollision：
+ * 在移动距离小于方块厚度的常规情形下两者结果应一致，在移动距离超过方块厚度时前者不应穿过方块
+ */
+
+using namespace VRPG::Test;
+using namespace VRPG::World::Collision;
+
+namespace
+{
+    const AABB UNIT_BOX  = { { 0, 0, 0 }, { 1, 1, 1 } };
+    const AABB THIN_SLAB = { { 0, 0, 0 }, { 1, 0.1f, 1 } };
+
+    /**
+     * @brief 原先Player::MoveAlongAxis中的做法：只根据移动后的位置解除碰撞
+     */
+    float ResolveMove(const std::vector<Vec3> &blocks, const AABB &box, const AACylinder &cylinder, int axis, float delta)
+    {
+        Vec3 newLowCentre = cylinder.lowCentre;
+        newLowCentre[axis] += delta;
+
+        float movedDistance = delta;
+        for(auto &blockPosition : blocks)
+        {
+            const AACylinder localCylinder{ cylinder.lowCentre - blockPosition, cylinder.radius, cylinder.height };
+            float offset[3] = { 0, 0, 0 };
+            if(ResolveCollision(box, localCylinder, newLowCentre - blockPosition, offset))
+            {
+                float resolvedDistance = delta + offset[axis];
+                movedDistance = delta > 0 ? (std::min)(movedDistance, resolvedDistance)
+                                          : (std::max)(movedDistance, resolvedDistance);
+            }
+        }
+
+        return delta > 0 ? (std::max)(movedDistance, 0.0f) : (std::min)(movedDistance, 0.0f);
+    }
+
+    float SweepMove(const std::vector<Vec3> &blocks, const AABB &box, const AACylinder &cylinder, int axis, float delta)
+    {
+        AxisSweep sweep(cylinder, axis, delta);
+        for(auto &blockPosition : blocks)
+        {
+            sweep.AddBlock(blockPosition, { &box, &box + 1 });
+        }
+        return sweep.GetMovedDistance();
+    }
+
+    bool OverlapsAnyBlock(const std::vector<Vec3> &blocks, const AABB &box, const AACylinder &cylinder)
+    {
+        for(auto &blockPosition : blocks)
+        {
+            const AACylinder localCylinder{ cylinder.lowCentre - blockPosition, cylinder.radius, cylinder.height };
+            if(HasCollision(box, localCylinder))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 地面、墙壁和天花板组成的场景
+     */
+    std::vector<Vec3> BuildRoom()
+    {
+        std::vector<Vec3> blocks;
+        for(int x = -4; x <= 4; ++x)
+        {
+            for(int z = -4; z <= 4; ++z)
+            {
+                blocks.push_back(Vec3(float(x), 0, float(z)));
+                blocks.push_back(Vec3(float(x), 4, float(z)));
+            }
+        }
+        for(int y = 1; y <= 3; ++y)
+        {
+            for(int i = -4; i <= 4; ++i)
+            {
+                blocks.push_back(Vec3(-4, float(y), float(i)));
+                blocks.push_back(Vec3(4, float(y), float(i)));
+                blocks.push_back(Vec3(float(i), float(y), -4));
+                blocks.push_back(Vec3(float(i), float(y), 4));
+            }
+        }
+
+        // 房间中的几个柱子与台阶，用于产生角落接触
+
+        blocks.push_back(Vec3(0, 1, 0));
+        blocks.push_back(Vec3(0, 2, 0));
+        blocks.push_back(Vec3(2, 1, -2));
+        blocks.push_back(Vec3(-2, 1, 2));
+        blocks.push_back(Vec3(-2, 3, -2));
+        return blocks;
+    }
+
+    void TestStandardMoves()
+    {
+        const std::vector<Vec3> blocks = BuildRoom();
+
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> posDist(-3.5f, 4.5f);
+        std::uniform_real_distribution<float> heightDist(1, 3.5f);
+        std::uniform_real_distribution<float> deltaDist(-0.5f, 0.5f);
+        std::uniform_int_distribution<int> axisDist(0, 2);
+
+        int caseCount = 0, blockedCount = 0, mismatchCount = 0;
+        for(int i = 0; i < 200000; ++i)
+        {
+            const float radius = i % 2 ? 0.3f : 0.45f;
+            const float height = i % 2 ? 1.8f : 0.9f;
+            const AACylinder cylinder{ { posDist(rng), heightDist(rng), posDist(rng) }, radius, height };
+            const int axis = axisDist(rng);
+            const float delta = deltaDist(rng);
+
+            if(delta == 0 || OverlapsAnyBlock(blocks, UNIT_BOX, cylinder))
+            {
+                continue;
+            }
+
+            const float resolved = ResolveMove(blocks, UNIT_BOX, cylinder, axis, delta);
+            const float swept    = SweepMove(blocks, UNIT_BOX, cylinder, axis, delta);
+
+            ++caseCount;
+            if(resolved != delta)
+            {
+                ++blockedCount;
+            }
+            if(std::abs(resolved - swept) > 1e-4f)
+            {
+                if(!mismatchCount)
+                {
+                    std::printf(
+                        "first mismatch: axis %d, delta %f, resolved %f, swept %f\n",
+                        axis, delta, resolved, swept);
+                }
+                ++mismatchCount;
+            }
+        }
+
+        std::printf("standard moves: %d cases, %d blocked, %d mismatches\n", caseCount, blockedCount, mismatchCount);
+        VRPG_CHECK(blockedCount > 0);
+        VRPG_CHECK(mismatchCount == 0);
+    }
+
+    void TestFastMoves()
+    {
+        // 一次移动的距离超过方块厚度时，原先的做法会直接穿过方块
+
+        const std::vector<Vec3> floor = { Vec3(0, 0, 0) };
+        const AACylinder falling{ { 0.5f, 2, 0.5f }, 0.3f, 1.8f };
+
+        const float resolvedFall = ResolveMove(floor, THIN_SLAB, falling, 1, -5);
+        const float sweptFall    = SweepMove  (floor, THIN_SLAB, falling, 1, -5);
+        std::printf("falling through a slab: resolved %f, swept %f\n", resolvedFall, sweptFall);
+        VRPG_CHECK(std::abs(sweptFall - (THIN_SLAB.high.y - 2)) < 1e-2f);
+
+        const std::vector<Vec3> wall = { Vec3(2, 0, 0) };
+        const AACylinder running{ { 0.5f, 0.2f, 0.5f }, 0.3f, 1.8f };
+
+        const float resolvedRun = ResolveMove(wall, UNIT_BOX, running, 0, 10);
+        const float sweptRun    = SweepMove  (wall, UNIT_BOX, running, 0, 10);
+        std::printf("running through a wall: resolved %f, swept %f\n", resolvedRun, sweptRun);
+        VRPG_CHECK(std::abs(sweptRun - (2 - 0.3f - 0.5f)) < 1e-4f);
+
+        // 沿z轴擦过方块角落：圆柱体在x方向上与方块错开，但半径使其与角落相交
+
+        const AACylinder grazing{ { 2.0f - 0.2f, 0.2f, -5 }, 0.3f, 1.8f };
+        const float sweptGraze = SweepMove(wall, UNIT_BOX, grazing, 2, 10);
+        const float expected   = -std::sqrt(0.3f * 0.3f - 0.2f * 0.2f) + 5;
+        VRPG_CHECK(std::abs(sweptGraze - expected) < 1e-4f);
+
+        // 已经越过的方块不阻挡移动
+
+        const AACylinder passed{ { 4, 0.2f, 0.5f }, 0.3f, 1.8f };
+        VRPG_CHECK(SweepMove(wall, UNIT_BOX, passed, 0, 10) == 10);
+        VRPG_CHECK(SweepMove(wall, UNIT_BOX, passed, 0, -10) < 0);
+    }
+}
+
+int main()
+{
+    TestStandardMoves();
+    TestFastMoves();
+    return TestResult();
+}